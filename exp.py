@@ -14,6 +14,10 @@ fmt_occ = "numactl --interleave=all build/db --cc_type 2  --num_lock_threads {0}
 
 fmt_hek = "build/db --cc_type 3  --num_lock_threads {0} --num_txns {1} --num_records {2} --num_contended 2 --txn_size 10 --experiment {3} --record_size {6} --distribution {4} --theta {5} --occ_epoch 8000000 --read_pct {7} --read_txn_size 10000"
 
+fmt_hek_ts = "build/db --cc_type 3  --num_lock_threads {0} --num_txns {1} --num_records {2} --num_contended 2 --txn_size 10 --experiment {3} --record_size {6} --distribution {4} --theta {5} --occ_epoch 8000000 --read_pct {7} --read_txn_size 10000 --hek_timestamps {8}"
+
+fmt_occ_iso = "numactl --interleave=all build/db --cc_type 2  --num_lock_threads {0} --num_txns {1} --num_records {2} --num_contended 2 --txn_size 10 --experiment {3} --record_size {6} --distribution {4} --theta {5} --occ_epoch 8000000 --read_pct {7} --read_txn_size 10000 --isolation {8} --read_isolation {9}"
+
 fmt_si = "build/si --cc_type 3  --num_lock_threads {0} --num_txns {1} --num_records {2} --num_contended 2 --txn_size 10 --experiment {3} --record_size {6} --distribution {4} --theta {5} --occ_epoch 8000000 --read_pct {7} --read_txn_size 5"
 
 fmt_multi_cc = "build/db --cc_type 0 --num_cc_threads {0} --num_txns {1} --epoch_size 10000 --num_records {2} --num_worker_threads {3} --txn_size {8} --experiment {4} --record_size {7} --distribution {5} --theta {6} --read_pct 0 --read_txn_size 10"
@@ -360,6 +364,55 @@ def hek_expt(outdir, filename, lowThreads, highThreads, txns, records, expt, dis
             os.chdir(saved_dir)
 
             
+# Scale Hekaton over thread counts under each timestamp allocation strategy,
+# 0: global counter, 1: leased ranges, 2: cycle counter + thread id.
+def hek_timestamps():
+    outdir = "results/hekaton/timestamps"
+    os.system("mkdir -p " + outdir)
+    for ts_alloc in [0, 1, 2]:
+        filename = "hek_ts" + str(ts_alloc) + ".txt"
+        outfile = os.path.join(outdir, filename)
+        temp = os.path.join(outdir, "hek_ts" + str(ts_alloc) + "_out.txt")
+        for i in gen_range(4, 40, 4):
+            os.system("rm hek.txt")
+            cmd = fmt_hek_ts.format(str(i), str(3000000), str(1000000), str(0), str(0), str(0.0), str(1000), str(0), str(ts_alloc))
+            os.system(cmd)
+            os.system("cat hek.txt >>" + outfile)
+            clean.clean_fn("occ", outfile, temp)
+
+# Hekaton writers over thread counts and skew, for comparing version install 
+# protocols. Results go to a directory named by label, run once per build.
+def hek_install(label):
+    outdir = os.path.join("results/hekaton/install", label)
+    os.system("mkdir -p " + outdir)
+    for theta in [0.0, 0.6, 0.9, 0.99]:
+        filename = "hek_theta" + str(theta) + ".txt"
+        outfile = os.path.join(outdir, filename)
+        temp = os.path.join(outdir, "hek_theta" + str(theta) + "_out.txt")
+        for i in gen_range(4, 40, 4):
+            os.system("rm hek.txt")
+            cmd = fmt_hek.format(str(i), str(3000000), str(1000000), str(0), str(1), str(theta), str(1000), str(0))
+            os.system(cmd)
+            os.system("cat hek.txt >>" + outfile)
+            clean.clean_fn("occ", outfile, temp)
+
+# Contended OCC with a 10% mix of large read-only txns, serializable updates 
+# and read-only txns at each isolation level, 0: serializable, 2: read 
+# committed.
+def occ_isolation():
+    outdir = "results/occ/isolation"
+    os.system("mkdir -p " + outdir)
+    for read_iso in [0, 2]:
+        filename = "occ_read_iso" + str(read_iso) + ".txt"
+        outfile = os.path.join(outdir, filename)
+        temp = os.path.join(outdir, "occ_read_iso" + str(read_iso) + "_out.txt")
+        for i in gen_range(4, 40, 4):
+            os.system("rm occ.txt")
+            cmd = fmt_occ_iso.format(str(i), str(3000000), str(1000000), str(0), str(1), str(0.9), str(1000), str(10), str(0), str(read_iso))
+            os.system(cmd)
+            os.system("cat occ.txt >>" + outfile)
+            clean.clean_fn("occ", outfile, temp)
+
 def ccontrol():
     outdir = "results/hekaton/concurrency_control"
     for i in range(0, 5):
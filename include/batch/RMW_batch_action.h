@@ -5,23 +5,30 @@
 #include "batch/db_storage_interface.h"
 
 #include <unordered_map>
+#include <vector>
 
 // RMWBatchAction
 //
 //    RMWBatchAction implements the simplest kind of RMW action which
 //    reads all of the records within read and write sets and increments
-//    by 1 the value found within the records of write set. 
+//    by 1 the value found within the records of write set. The value is
+//    the leading RecordValue of a record, the rest of it is written back
+//    as read.
 //
-//    Note that the values read are stored intermittently to simulate
-//    the possibility of an abort of an action.
+//    Note that the records read are copied intermittently to simulate
+//    the possibility of an abort of an action. The copies live in a buffer 
+//    of the executing thread which is reused by every action it runs, so 
+//    running an action does not allocate once the buffer has grown.
 class RMWBatchAction : public BatchAction {
   private:
-    typedef std::unordered_map<RecordKey, IDBStorage::RecordValue> TmpReadMap;
+    // offset of the copy of every record within the thread's buffer.
+    typedef std::unordered_map<RecordKey, uint64_t> TmpReadMap;
     TmpReadMap tmp_reads; 
 
+    static std::vector<char>* get_thread_buffer();
     void add_to_tmp_reads(RecordKey rk);
-    void do_reads(IDBStorage* db);
-    void do_writes(IDBStorage* db);
+    void do_reads();
+    void do_writes();
   public:
     RMWBatchAction(txn* t);
 
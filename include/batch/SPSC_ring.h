@@ -0,0 +1,113 @@
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include "machine.h"
+#include "wait_strategy.h"
+
+#include <cstddef>
+#include <stdint.h>
+
+/*
+ *    SPSC Ring
+ *
+ *    A lock-free, single-producer, single-consumer queue of movable elements
+ *    kept within a ring buffer. The producer and the consumer may change over
+ *    time as long as the hand-off happens under a lock (or another barrier).
+ *
+ *    Elements are moved in on push and destroyed on pop, so no allocation
+ *    happens unless the ring overflows. The counters of the producer and the
+ *    consumer live on separate cache lines and each side caches the counter
+ *    of the other, so the line of the other side is only read when the ring
+ *    looks full (empty).
+ *
+ *    Waiting for elements (or space) follows the wait strategy of the
+ *    process. See wait_strategy.h.
+ *
+ *    A bounded ring makes the producer wait for free space. An unbounded
+ *    ring (the default) links a new ring of twice the size whenever the
+ *    current one is full. The consumer moves on to the new ring once it has
+ *    drained the old one and frees it.
+ *
+ *    Batch operations publish the counters once per batch.
+ */
+template <typename Elt>
+class SPSCRing {
+private:
+  struct Segment {
+    Segment(uint64_t capacity, uint64_t start);
+    ~Segment();
+
+    Elt* get_slot(uint64_t index);
+
+    // the capacity is a power of two.
+    const uint64_t mask;
+    // index of the first element pushed into the segment.
+    const uint64_t start;
+    // set by the producer before it pushes into the next segment.
+    Segment* volatile next;
+    char* slots;
+  };
+
+  const bool unbounded;
+
+  // producer side
+  Segment* tail_seg;
+  volatile uint64_t pushed;
+  uint64_t popped_cache;
+  char pad_producer[CACHE_LINE];
+
+  // consumer side
+  Segment* head_seg;
+  volatile uint64_t popped;
+  uint64_t pushed_cache;
+  char pad_consumer[CACHE_LINE];
+
+  // threads parked on pushed or popped.
+  volatile uint64_t parked;
+  char pad_parked[CACHE_LINE];
+
+  // Make space for the element with index p. Returns false if a bounded
+  // ring is full.
+  bool reserve(uint64_t p);
+  // Get the slot of the element with index p, moving to the next
+  // segment if necessary.
+  Elt* get_head_slot(uint64_t p);
+  void destroy_segments();
+
+public:
+  // param capacity: rounded up to a power of two.
+  SPSCRing(uint64_t capacity = 1024, bool unbounded = true);
+  SPSCRing(const SPSCRing<Elt>& r) = delete;
+  // A moved-from ring may only be destroyed. Must not be used concurrently.
+  SPSCRing(SPSCRing<Elt>&& r);
+
+  // Both the consumer and the producer may check the size.
+  bool is_empty() const;
+  uint64_t get_size() const;
+
+  // consumer interface.
+  Elt& peek_head();
+  void pop_head();
+  // Wait for an element to be pushed. Returns when the ring is not empty
+  // or the wait strategy gives up the current wait slice, so the caller
+  // may check for other conditions (e.g. stop signals) in a loop.
+  void wait_for_push(Waiter& w);
+  // Moves up to max elements to out. Returns the number moved.
+  template <typename OutputIt>
+  uint64_t pop_head_batch(OutputIt out, uint64_t max);
+
+  // producer interface.
+  void push_tail(Elt&& e);
+  void push_tail(const Elt& e);
+  // Returns false if the ring is bounded and full.
+  bool try_push_tail(Elt&& e);
+  // Moves all of [first, last) into the ring.
+  template <typename InputIt>
+  void push_tail_batch(InputIt first, InputIt last);
+
+  virtual ~SPSCRing();
+};
+
+#include "batch/SPSC_ring_impl.h"
+
+#endif // SPSC_RING_H_
@@ -0,0 +1,225 @@
+#include "batch/SPSC_ring.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <utility>
+
+// Definitions of Segment functions.
+template <typename Elt>
+SPSCRing<Elt>::Segment::Segment(uint64_t capacity, uint64_t start):
+  mask(capacity - 1),
+  start(start),
+  next(nullptr),
+  slots(new char[capacity * sizeof(Elt)])
+{
+  assert((capacity & mask) == 0);
+};
+
+template <typename Elt>
+SPSCRing<Elt>::Segment::~Segment() {
+  delete[] slots;
+};
+
+template <typename Elt>
+Elt* SPSCRing<Elt>::Segment::get_slot(uint64_t index) {
+  return reinterpret_cast<Elt*>(slots) + ((index - start) & mask);
+};
+
+// Definitions of SPSCRing functions.
+template <typename Elt>
+SPSCRing<Elt>::SPSCRing(uint64_t capacity, bool unbounded):
+  unbounded(unbounded),
+  pushed(0),
+  popped_cache(0),
+  popped(0),
+  pushed_cache(0),
+  parked(0)
+{
+  uint64_t rounded = 2;
+  while (rounded < capacity) rounded <<= 1;
+
+  tail_seg = new Segment(rounded, 0);
+  head_seg = tail_seg;
+};
+
+template <typename Elt>
+SPSCRing<Elt>::SPSCRing(SPSCRing<Elt>&& r):
+  unbounded(r.unbounded),
+  tail_seg(r.tail_seg),
+  pushed(r.pushed),
+  popped_cache(r.popped_cache),
+  head_seg(r.head_seg),
+  popped(r.popped),
+  pushed_cache(r.pushed_cache),
+  parked(0)
+{
+  r.tail_seg = nullptr;
+  r.head_seg = nullptr;
+};
+
+template <typename Elt>
+bool SPSCRing<Elt>::is_empty() const {
+  return get_size() == 0;
+};
+
+template <typename Elt>
+uint64_t SPSCRing<Elt>::get_size() const {
+  // popped never overtakes pushed, so read it first.
+  uint64_t m_popped = popped;
+  barrier();
+  return pushed - m_popped;
+};
+
+template <typename Elt>
+bool SPSCRing<Elt>::reserve(uint64_t p) {
+  uint64_t capacity = tail_seg->mask + 1;
+  if (p - std::max(popped_cache, tail_seg->start) < capacity) return true;
+
+  popped_cache = popped;
+  barrier();
+  if (p - std::max(popped_cache, tail_seg->start) < capacity) return true;
+  if (unbounded == false) return false;
+
+  // overflow into a new segment. The consumer never looks at the segment
+  // before p is published.
+  Segment* seg = new Segment(capacity * 2, p);
+  barrier();
+  tail_seg->next = seg;
+  tail_seg = seg;
+  return true;
+};
+
+template <typename Elt>
+bool SPSCRing<Elt>::try_push_tail(Elt&& e) {
+  uint64_t p = pushed;
+  if (reserve(p) == false) return false;
+
+  new (tail_seg->get_slot(p)) Elt(std::move(e));
+  barrier();
+  pushed = p + 1;
+  wake_parked(&pushed, &parked);
+  return true;
+};
+
+template <typename Elt>
+void SPSCRing<Elt>::push_tail(Elt&& e) {
+  Waiter w;
+  while (try_push_tail(std::move(e)) == false) {
+    w.wait(&popped, popped_cache, &parked);
+  }
+};
+
+template <typename Elt>
+void SPSCRing<Elt>::push_tail(const Elt& e) {
+  Elt copy(e);
+  push_tail(std::move(copy));
+};
+
+template <typename Elt>
+template <typename InputIt>
+void SPSCRing<Elt>::push_tail_batch(InputIt first, InputIt last) {
+  uint64_t p = pushed;
+  Waiter w;
+  for (; first != last; ++first) {
+    while (reserve(p) == false) {
+      // publish what we have so that the consumer may make space.
+      barrier();
+      pushed = p;
+      wake_parked(&pushed, &parked);
+      w.wait(&popped, popped_cache, &parked);
+    }
+
+    new (tail_seg->get_slot(p)) Elt(std::move(*first));
+    p++;
+  }
+
+  barrier();
+  pushed = p;
+  wake_parked(&pushed, &parked);
+};
+
+template <typename Elt>
+Elt* SPSCRing<Elt>::get_head_slot(uint64_t p) {
+  if (p == pushed_cache) {
+    pushed_cache = pushed;
+    barrier();
+  }
+  assert(p < pushed_cache);
+
+  // the producer has moved on to the next segment and the current one
+  // has been drained.
+  Segment* next;
+  while ((next = head_seg->next) != nullptr && p >= next->start) {
+    delete head_seg;
+    head_seg = next;
+  }
+
+  return head_seg->get_slot(p);
+};
+
+template <typename Elt>
+Elt& SPSCRing<Elt>::peek_head() {
+  return *get_head_slot(popped);
+};
+
+template <typename Elt>
+void SPSCRing<Elt>::pop_head() {
+  uint64_t p = popped;
+  get_head_slot(p)->~Elt();
+  barrier();
+  popped = p + 1;
+  wake_parked(&popped, &parked);
+};
+
+template <typename Elt>
+void SPSCRing<Elt>::wait_for_push(Waiter& w) {
+  uint64_t seen = pushed;
+  barrier();
+  if (seen != popped) return;
+
+  w.wait(&pushed, seen, &parked);
+};
+
+template <typename Elt>
+template <typename OutputIt>
+uint64_t SPSCRing<Elt>::pop_head_batch(OutputIt out, uint64_t max) {
+  uint64_t p = popped;
+  pushed_cache = pushed;
+  barrier();
+
+  uint64_t n = std::min(max, pushed_cache - p);
+  for (uint64_t i = 0; i < n; i++, p++) {
+    Elt* slot = get_head_slot(p);
+    *out = std::move(*slot);
+    ++out;
+    slot->~Elt();
+  }
+
+  barrier();
+  popped = p;
+  wake_parked(&popped, &parked);
+  return n;
+};
+
+template <typename Elt>
+void SPSCRing<Elt>::destroy_segments() {
+  while (head_seg != nullptr) {
+    Segment* next = head_seg->next;
+    delete head_seg;
+    head_seg = next;
+  }
+};
+
+template <typename Elt>
+SPSCRing<Elt>::~SPSCRing() {
+  // moved-from
+  if (head_seg == nullptr) return;
+
+  while (is_empty() == false) {
+    pop_head();
+  }
+
+  destroy_segments();
+};
@@ -10,13 +10,18 @@ class BatchAction : public IBatchAction {
   private:
     RecordKeySet readset;
     RecordKeySet writeset;
+  protected:
+    // storage the action is running against. Set by Run.
+    IDBStorage* db;
   public:
-    BatchAction(txn* t): IBatchAction(t) {
+    BatchAction(txn* t): IBatchAction(t), db(nullptr) {
       readset.reserve(10);
       writeset.reserve(10);
     };
 
-    // override the translator functions
+    // override the translator functions. Both return the record within
+    // the storage and may only be called while the action runs. Records of 
+    // the write set may also be read.
     virtual void *write_ref(uint64_t key, uint32_t table) override;
     virtual void *read(uint64_t key, uint32_t table) override;
  
@@ -42,8 +47,7 @@ class BatchAction : public IBatchAction {
     virtual BatchActionState atomic_change_state(
         BatchActionState new_state) override;
 
-    // TODO: 
-    //    Do this after we fill in the interface
+    // Subclasses must call it before accessing any record.
     virtual void Run(IDBStorage* db) override;
 
     virtual bool operator<(const IBatchAction& ba2) const override;
@@ -30,10 +30,18 @@ public:
   IBatchAction(txn* t): 
     translator(t),
     locks_held(0),
+    packing_slot(0),
+    submit_time_ns(0),
     action_state(static_cast<uint64_t>(BatchActionState::substantiated))
   {};
 
   uint64_t locks_held;
+  // Index of the action within the BitmapPacker of its batch. Only
+  // meaningful while the batch is being scheduled.
+  uint64_t packing_slot;
+  // When the action was handed to the system (TimeUtilities::now_ns). Set
+  // by load generators measuring latency only.
+  uint64_t submit_time_ns;
   virtual uint64_t notify_lock_obtained() = 0; 
   virtual bool ready_to_execute() = 0;
 
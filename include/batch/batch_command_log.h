@@ -0,0 +1,28 @@
+#ifndef BATCH_COMMAND_LOG_H_
+#define BATCH_COMMAND_LOG_H_
+
+#include "batch/batch_action_interface.h"
+#include "command_log.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Batch Command Log
+//
+//    Command logging for the batched engine (see command_log.h). The serial
+//    order of the engine is given by the batch ids and the contents of the 
+//    batches, so batches are logged as they are given their ids and before
+//    any scheduling thread sees them. Actions are logged as their read and
+//    write sets.
+namespace BatchCommandLog {
+  typedef std::vector<std::unique_ptr<IBatchAction>> Batch;
+
+  void append_batch(CommandLog* log, const Batch& batch, uint64_t batch_id);
+  // logged actions are re-created as RMW actions.
+  std::unique_ptr<IBatchAction> create_action(const logged_txn& t);
+  // the batches of the log, in order.
+  std::vector<Batch> read_batches(const std::string& file_name);
+};
+
+#endif // BATCH_COMMAND_LOG_H_
@@ -2,7 +2,7 @@
 #define BATCHED_GLOBAL_INPUT_QUEUE_H_
 
 #include "batch/input_queue_interface.h"
-#include "batch/MS_queue.h"
+#include "batch/SPSC_ring.h"
 #include "batch/batch_action_interface.h"
 #include "batch/scheduler.h"
 
@@ -19,7 +19,7 @@ class Scheduler;
  *    are stored in batches and are returned on request.
  */
 class BatchedInputQueue : 
-  private MSQueue<std::vector<std::unique_ptr<IBatchAction>>>,
+  private SPSCRing<std::vector<std::unique_ptr<IBatchAction>>>,
   public InputQueue
 {
 private:
@@ -30,11 +30,11 @@ private:
 
 public:
   BatchedInputQueue(uint32_t batch_size): 
-    MSQueue<std::vector<std::unique_ptr<IBatchAction>>>(),
+    SPSCRing<std::vector<std::unique_ptr<IBatchAction>>>(),
     InputQueue(batch_size) {};
 
   virtual InputQueue::BatchActions try_get_action_batch() override {
-    if (MSQueue<std::vector<std::unique_ptr<IBatchAction>>>::is_empty()) 
+    if (SPSCRing<std::vector<std::unique_ptr<IBatchAction>>>::is_empty()) 
       return InputQueue::BatchActions();
 
     auto return_value = std::move(this->peek_head());
@@ -58,7 +58,7 @@ public:
   };
 
   virtual bool is_empty() override {
-    return MSQueue<std::vector<std::unique_ptr<IBatchAction>>>::is_empty();
+    return SPSCRing<std::vector<std::unique_ptr<IBatchAction>>>::is_empty();
   };
 
   virtual void flush() override {
@@ -2,26 +2,57 @@
 #define BATCH_DB_STORAGE_H_
 
 #include "batch/db_storage_interface.h"
+#include "bulk_load.h"
 
 #include <unordered_map>
-// TODO:
-//    Description
-//    Preallocates all memory
+#include <vector>
+
+// DBStorage
+//
+//    Preallocates all of the records of every table within a single slab per
+//    table. The slabs are interleaved across NUMA nodes, since any executing 
+//    thread may access any record. Every record starts at a cache line
+//    boundary so that records written by different threads never share a line.
+//
+//    Tables declared with dense keys are indexed directly by key. Other tables
+//    use a hash index from each of their declared keys to its record.
 class DBStorage : public IDBStorage {
 private:
-  typedef std::unordered_map<RecordKey, RecordValue> Data;
+  struct Table {
+    uint64_t num_records;
+    uint64_t record_size;
+    // distance between consecutive records, a multiple of the cache line.
+    uint64_t stride;
+    bool dense_keys;
+    char* records;
+    std::unordered_map<uint64_t, char*> index;
+  };
+
+  // indexed by table id.
+  std::vector<Table> tables;
 
-  Data data;
-  Data::iterator insert_elt(RecordKey key, RecordValue value);
   void preallocate_records(DBStorageConfig db_conf);
+  inline char* get_record(RecordKey key);
 public:
   typedef IDBStorage::RecordValue RecordValue;
 
   DBStorage(DBStorageConfig db_conf);
+  ~DBStorage();
+
+  // Fills the records of the tables with those of source, using a loader
+  // thread on each of the cpus [start_cpu, start_cpu + num_threads). Every
+  // thread fills a range of each table. Values shorter than a record are
+  // zero padded. Must not run concurrently with any other access. Returns 
+  // the number of records loaded.
+  uint64_t bulk_load(
+      BulkLoadSource* source, int start_cpu, uint32_t num_threads);
 
   // override IDBStorage
   RecordValue read_record_value(RecordKey key);
   void write_record_value(RecordKey key, RecordValue value);
+  const void* read_ref(RecordKey key);
+  void* write_ref(RecordKey key);
+  uint64_t get_record_size(uint64_t table_id);
 };
 
 #endif //BATCH_DB_STORAGE_H_
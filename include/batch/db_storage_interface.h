@@ -8,6 +8,20 @@
 struct BatchTableConfig {
   uint64_t table_id;
   uint64_t num_records;
+  // size of a single record in bytes.
+  uint64_t record_size = sizeof(uint64_t);
+  // true if the keys of the table form the dense range [0, num_records). 
+  // Dense tables are stored as arrays indexed by key, others are looked up
+  // through a hash index.
+  bool dense_keys = true;
+  // the num_records keys of a table without dense keys, in any order. If 
+  // empty, the table holds the keys [0, num_records) behind its hash index.
+  std::vector<uint64_t> keys = {};
+
+  // key of the i-th record of the table.
+  uint64_t get_key(uint64_t i) const {
+    return keys.empty() ? i : keys[i];
+  };
 };
 
 struct DBStorageConfig {
@@ -21,12 +35,22 @@ struct DBStorageConfig {
 //    not change over the lifetime of the database. DBStorage is non
 //    thread safe in the meaning that reads and writes must be coordinated
 //    on a higher level to guarantee no cinflicting writes/reads.
+//
+//    Records may be of any size. read_record_value and write_record_value
+//    access the first sizeof(RecordValue) bytes of a record, read_ref and 
+//    write_ref give direct access to all of it.
 class IDBStorage {
 public:
   typedef uint64_t RecordValue;
 
   virtual RecordValue read_record_value(RecordKey key) = 0;
   virtual void write_record_value(RecordKey key, RecordValue value) = 0;
+
+  // Pointers to the record within the storage. They remain valid for the
+  // lifetime of the storage and point to get_record_size(key.table_id) bytes.
+  virtual const void* read_ref(RecordKey key) = 0;
+  virtual void* write_ref(RecordKey key) = 0;
+  virtual uint64_t get_record_size(uint64_t table_id) = 0;
 };
 
 #endif // BATCH_DB_STORAGE_INTERFACE_H_
@@ -1,7 +1,7 @@
 #ifndef BATCH_EXECUTOR_H_
 #define BATCH_EXECUTOR_H_
 
-#include "batch/MS_queue.h"
+#include "batch/SPSC_ring.h"
 #include "batch/batch_action_interface.h"
 #include "batch/executor_thread.h"
 #include "batch/executor_thread_manager.h"
@@ -12,14 +12,12 @@
 
 // ExecutorQueue
 //    
-//    Executor queue is a single-producer, single-consumer ms-queue. Every
+//    Executor queue is a single-producer, single-consumer ring. Every
 //    executor owns two executor queues -- one for input and one for output.
 //    The executor manager contains handles to all the executor threads
 //    and may be used by scheduling threads to assign ownership of actions
 //    to execution threads in a synchronized manner. 
-class ExecutorQueue : public MSQueue<std::unique_ptr<ExecutorThread::BatchActions>> {
-private:
-  using MSQueue<std::unique_ptr<ExecutorThread::BatchActions>>::merge_queue;
+class ExecutorQueue : public SPSCRing<std::unique_ptr<ExecutorThread::BatchActions>> {
 };
 
 // Pending Queue
@@ -42,10 +40,12 @@ protected:
   // belong to the currently processed batch.
   std::unique_ptr<PendingList> pending_list;
   std::unique_ptr<ExecutorThread::BatchActions> currentBatch;
+  volatile uint64_t started_batches;
+  volatile uint64_t finished_batches;
 
   void process_action_batch();
   // true if successful and false otherwise
-  bool process_action(std::shared_ptr<IBatchAction> act);
+  bool process_action(IBatchAction* act);
   void process_pending();
   
 public:
@@ -63,6 +63,8 @@ public:
   void signal_stop_working() override;
   bool is_stop_requested() override;
   void reset() override;
+  uint64_t get_started_batches() override;
+  uint64_t get_finished_batches() override;
 };
 
 #endif //BATCH_EXECUTOR_H_
@@ -47,9 +47,10 @@ public:
   virtual unsigned int get_executor_num() override;
   virtual void signal_execution_threads(
       ExecutorThreadManager::ThreadWorkloads&& workload) override;
-  virtual std::shared_ptr<LockStage> 
-    get_current_lock_holder_for(RecordKey key) override;
-  virtual void finalize_action(std::shared_ptr<IBatchAction> act) override;
+  virtual LockStage* get_current_lock_holder_for(RecordKey key) override;
+  virtual void finalize_action(IBatchAction* act) override;
+  virtual uint64_t get_finished_batches_count() override;
+  virtual uint64_t get_started_batches_count() override;
 
   virtual ~ExecutorManager();
 };
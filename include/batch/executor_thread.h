@@ -37,6 +37,10 @@ public:
   virtual void signal_stop_working() = 0;
   virtual bool is_stop_requested() = 0;
   virtual void reset() = 0;
+  // number of batches handed to the thread that it has started
+  // (finished) processing.
+  virtual uint64_t get_started_batches() = 0;
+  virtual uint64_t get_finished_batches() = 0;
 
   virtual ~ExecutorThread() {
     free(m_rand_state);
@@ -17,9 +17,15 @@ class ExecutorThreadManager {
     virtual IDBStorage* get_db_storage_pointer() = 0;
     virtual unsigned int get_executor_num() = 0;
     virtual void signal_execution_threads(ThreadWorkloads&& workload) = 0;
-    virtual std::shared_ptr<LockStage>
-      get_current_lock_holder_for(RecordKey key) = 0;
-    virtual void finalize_action(std::shared_ptr<IBatchAction> act) = 0;
+    virtual LockStage* get_current_lock_holder_for(RecordKey key) = 0;
+    virtual void finalize_action(IBatchAction* act) = 0;
+
+    // Every executor is handed a part of every batch, in order. Number of
+    // batches finished by every executor and the largest number of batches
+    // started by any executor. Used to tell when lock stages of a batch
+    // may no longer be referenced by the executors.
+    virtual uint64_t get_finished_batches_count() = 0;
+    virtual uint64_t get_started_batches_count() = 0;
 
     virtual ~ExecutorThreadManager() {};
 };
@@ -26,10 +26,10 @@ public:
       const RecordKey& from,
       const RecordKey& to) override;
 
-  std::shared_ptr<LockStage> get_stage_holding_lock_for(
+  LockStage* get_stage_holding_lock_for(
       RecordKey key) override;
   void finalize_execution_of_action(
-      std::shared_ptr<IBatchAction> act) override;
+      IBatchAction* act) override;
 };
 
 #endif
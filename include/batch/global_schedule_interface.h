@@ -23,10 +23,10 @@ public:
       const RecordKey& to) = 0;
 
   // executor thread manager interface:
-  virtual std::shared_ptr<LockStage> get_stage_holding_lock_for(
+  virtual LockStage* get_stage_holding_lock_for(
       RecordKey key) = 0;
   virtual void finalize_execution_of_action(
-      std::shared_ptr<IBatchAction> act) = 0;
+      IBatchAction* act) = 0;
 };
 
 #endif //GLOBAL_SCHEDULE_INTERFACE_H_
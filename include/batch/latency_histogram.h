@@ -0,0 +1,52 @@
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * HDR-style histogram of latencies (or any other non-negative values).
+ *
+ * Values below 2^precision_bits are counted exactly. Above that, every
+ * power of two is split into 2^(precision_bits - 1) equally wide buckets,
+ * so the relative error of any reported value is below 2^-(precision_bits - 1)
+ * and the histogram has a fixed size independent of the recorded range.
+ * Recording a value is a couple of shifts and an increment.
+ *
+ * Not thread safe. Use one histogram per thread and merge them.
+ **/
+class LatencyHistogram {
+private:
+  uint32_t precision_bits;
+  std::vector<uint64_t> counts;
+  uint64_t total_count;
+  uint64_t total_sum;
+  uint64_t min_value;
+  uint64_t max_value;
+
+  uint64_t get_index(uint64_t value) const;
+  // the highest value counted within the bucket.
+  uint64_t get_bucket_max(uint64_t index) const;
+
+public:
+  LatencyHistogram(uint32_t precision_bits = 7);
+
+  void record(uint64_t value);
+  // add all of the values recorded by h. Both must have the same precision.
+  void merge(const LatencyHistogram& h);
+  void reset();
+
+  uint64_t get_count() const;
+  uint64_t get_min() const;
+  uint64_t get_max() const;
+  double get_mean() const;
+  // The value (within precision) not exceeded by percentile % of the 
+  // recorded values. Returns 0 if nothing was recorded.
+  uint64_t get_value_at_percentile(double percentile) const;
+  // (the highest value of the bucket, count) for all non-empty buckets, in
+  // increasing order of values.
+  std::vector<std::pair<uint64_t, uint64_t>> get_buckets() const;
+};
+
+#endif // LATENCY_HISTOGRAM_H_
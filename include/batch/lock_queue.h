@@ -2,27 +2,38 @@
 #define _LOCK_QUEUE_H_
 
 #include "batch/lock_stage.h"
-#include "batch/SPSC_MR_queue.h"
 
-#include <memory>
+#include <stdint.h>
 
 class BatchLockQueue;
 
-// TODO:
-//    - Memory Management. Right now we have memory leakage within the destructor
-//    since the lock stages are never deallocated!
-//    - Overloading of new/delete.
-
 /*
  * LockQueue
  *    
- *    A queue of lock stages implemented as a MS-queue. See batch/MS_queue.h for details. 
+ *    An intrusive queue of lock stages linked through LockStage::next_stage. The queue 
+ *    never allocates and does not own the stages -- see batch/lock_stage_arena.h.
+ *
+ *    Only one thread may merge and only one thread may pop at a time, while any number
+ *    of threads may read the head. Merging and popping serialize on a spin latch; reading
+ *    is latch-free. A reader may hence obtain a stage that is being popped concurrently.
+ *    The stage remains valid until its arena reclaims it.
  */
-class LockQueue : public SPSCMRQueue<std::shared_ptr<LockStage>> {
-private:
-  using SPSCMRQueue<std::shared_ptr<LockStage>>::push_tail;
-  using SPSCMRQueue<std::shared_ptr<LockStage>>::head;
-  using SPSCMRQueue<std::shared_ptr<LockStage>>::tail;
+class LockQueue {
+protected:
+  LockStage* volatile head;
+  LockStage* volatile tail;
+  volatile uint64_t latch;
+
+public:
+  LockQueue();
+
+  bool is_empty() const;
+  LockStage* peek_head() const;
+  LockStage* peek_tail() const;
+
+  void pop_head();
+  // Appends all stages within blq to the queue. blq is left unchanged.
+  void merge_queue(BatchLockQueue* blq);
 };
 
 /*
@@ -32,17 +43,9 @@ private:
  *    addition of lock stages. Used only by the scheduling threads before
  *    merging into the global schedule.
  */
-class BatchLockQueue : public SPSCMRQueue<std::shared_ptr<LockStage>> {
-private:
-  void non_concurrent_push_tail_implem(
-      std::shared_ptr<
-          typename SPSCMRQueue<std::shared_ptr<LockStage>>::QueueElt> ls);
+class BatchLockQueue : public LockQueue {
 public:
-  // TODO:
-  //    This creates an element using the new directive. Make sure to override
-  //    it and return memory whenever necessary.
-  void non_concurrent_push_tail(std::shared_ptr<LockStage>&& ls);
-  void non_concurrent_push_tail(const std::shared_ptr<LockStage>& ls);
+  void non_concurrent_push_tail(LockStage* ls);
 };
 
 #endif // _LOCK_QUEUE_H_
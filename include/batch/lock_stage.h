@@ -4,11 +4,12 @@
 #include "batch/lock_types.h"
 #include "batch/batch_action_interface.h"
 
+#include <initializer_list>
 #include <memory>
 #include <stdint.h>
-#include <unordered_set>
 
-// TODO: Override the new/delete operators
+#define INLINE_REQUESTERS 4
+
 // TODO: implement a public inheritance test class which provides a == operator.
 /*
  *  LockStage
@@ -21,12 +22,43 @@
  *    The only field that may be updated is the holders integer, which is handled using FAI/FAD
  *    instructions. 
  *
- *    Lock stages form a singly linked list. Moving towards the "next_stage" means moving deeper into
- *    the dependency graph. This would likely be done to pass on a lock. 
+ *    Lock stages form an intrusive singly linked list. Moving towards the "next_stage" means moving 
+ *    deeper into the dependency graph. This would likely be done to pass on a lock. Stages do not
+ *    own the actions within them and are allocated from a LockStageArena, which keeps both alive
+ *    for as long as an execution thread may refer to them.
  */
 class LockStage {
 public:
-  typedef std::unordered_set<std::shared_ptr<IBatchAction>> RequestingActions;
+  // RequestingActions
+  //
+  //    Set of actions within a stage. Exclusive stages hold a single action and most
+  //    shared stages only a few, so the actions are kept in a small inline array which
+  //    spills to the heap only when it fills up. Insertion does not check for duplicates.
+  class RequestingActions {
+  public:
+    typedef IBatchAction* const* const_iterator;
+
+    RequestingActions();
+    RequestingActions(std::initializer_list<IBatchAction*> init);
+    RequestingActions(const RequestingActions& ra);
+    RequestingActions& operator=(const RequestingActions& ra);
+    ~RequestingActions();
+
+    void insert(IBatchAction* act);
+    const_iterator find(IBatchAction* act) const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    uint64_t size() const;
+
+    // order-insensitive comparison.
+    bool operator==(const RequestingActions& ra) const;
+
+  private:
+    uint32_t count;
+    uint32_t capacity;
+    IBatchAction** acts;
+    IBatchAction* inline_acts[INLINE_REQUESTERS];
+  };
 
 protected:
   // The number of transactions holding on to the lock.
@@ -37,6 +69,9 @@ protected:
   // this is just to assert that no stage is given a lock more than once.
   uint64_t has_been_given_lock;
 
+  // Next stage within the lock queue. Only ever changed by the lock queues.
+  LockStage* next_stage;
+
 public:
   LockStage();
   LockStage(
@@ -47,19 +82,22 @@ public:
   //
   // May only be called in a single-threaded scenarios. We do not coalesce adjacent shared stages
   // into single stages.
-  bool add_to_stage(std::shared_ptr<IBatchAction> txn, LockType lt);
+  bool add_to_stage(IBatchAction* txn, LockType lt);
   // Returns the new value of holders
   uint64_t decrement_holders(); 
   
   const RequestingActions& get_requesters() const; 
   uint64_t get_holders() const;
+  LockStage* get_next_stage() const;
 
   // return true if all actions within this lock stage have been finished.
-  bool finalize_action(std::shared_ptr<IBatchAction> act);
+  bool finalize_action(IBatchAction* act);
   void notify_lock_obtained();
   bool has_lock();
 
   friend bool operator==(const LockStage& ls1, const LockStage& ls2);
+  friend class LockQueue;
+  friend class BatchLockQueue;
 };
 
 #endif // _LOCK_STAGE_H_
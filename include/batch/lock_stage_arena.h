@@ -0,0 +1,87 @@
+#ifndef _LOCK_STAGE_ARENA_H_
+#define _LOCK_STAGE_ARENA_H_
+
+#include "batch/batch_action_interface.h"
+#include "batch/lock_stage.h"
+#include "batch/lock_types.h"
+
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+#define LOCK_STAGES_PER_CHUNK 1024
+
+// LockStageArena
+//
+//    Pool of lock stages owned by a single scheduling thread. Stages are carved
+//    out of fixed-size chunks and are never freed one by one. Instead, every stage
+//    created for a batch is returned at once, together with the references to the
+//    actions of the batch that the stages point to.
+//
+//    Execution threads read the heads of lock queues without synchronizing with the
+//    threads popping them, so a stage may still be referenced after it has been
+//    popped. A batch's stages are reclaimed in two steps:
+//      1) Once every executor has finished the batch, all of its stages have been
+//         popped and no executor may obtain a new reference to them. We note the
+//         number of batches started by the executors at that point.
+//      2) Once every executor has finished that many batches, no executor can be
+//         holding on to a reference obtained before 1) and the stages are freed.
+//    This relies on every executor being handed a part of every batch, in order.
+//
+//    The arena is NOT thread safe. Only the owning scheduling thread may use it.
+class LockStageArena {
+private:
+  struct Chunk {
+    Chunk* next;
+    unsigned int used;
+    typename std::aligned_storage<sizeof(LockStage), alignof(LockStage)>::type 
+      stages[LOCK_STAGES_PER_CHUNK];
+  };
+
+  struct Segment {
+    uint64_t batch_id;
+    Chunk* chunks;
+    std::vector<std::shared_ptr<IBatchAction>> actions;
+    // number of batches all executors must finish before the segment may
+    // be freed. 0 until the batch itself has been finished.
+    uint64_t grace_batches;
+  };
+
+  Chunk* free_chunks;
+  Segment current;
+  std::deque<Segment> retired;
+
+  void free_segment(Segment& s);
+
+public:
+  LockStageArena();
+  LockStageArena(const LockStageArena& arena) = delete;
+  LockStageArena& operator=(const LockStageArena& arena) = delete;
+  ~LockStageArena();
+
+  // Every stage allocated (and action retained) from now on belongs to batch_id.
+  // Batch ids must be increasing.
+  void start_batch(uint64_t batch_id);
+  LockStage* new_stage(IBatchAction* requester, LockType lt);
+  // Lock stages do not own their actions. The arena keeps them alive for as
+  // long as the stages of the current batch are.
+  void retain_action(std::shared_ptr<IBatchAction>&& act);
+
+  // Free the stages of batches which no executor may refer to anymore.
+  //
+  // param finished_batches: number of batches finished by every executor.
+  // param started_batches: largest number of batches started by an executor.
+  //                        Must be read after finished_batches.
+  void reclaim(uint64_t finished_batches, uint64_t started_batches);
+
+  // Number of chunks holding live stages, including the current batch.
+  uint64_t get_live_chunks_count() const;
+
+  // Arena of the calling thread. Used by batch lock tables that are not given
+  // one explicitly. It is never reclaimed.
+  static LockStageArena* get_thread_arena();
+};
+
+#endif // _LOCK_STAGE_ARENA_H_
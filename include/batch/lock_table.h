@@ -4,11 +4,14 @@
 #include "batch/batch_action_interface.h"
 #include "batch/db_storage_interface.h"
 #include "batch/lock_queue.h"
+#include "batch/lock_stage_arena.h"
 #include "batch/record_key.h"
+#include "machine.h"
 
+#include <cassert>
 #include <unordered_map>
-#include <map>
 #include <mutex>
+#include <vector>
 
 // TODO:
 //    overwrite the new/delete operators when we figure out memory allocators...
@@ -21,6 +24,11 @@ class BatchLockTable;
 //    way to add elements to lock table is to merge in a BatchLockTable which represents
 //    transaction schedule of a batch.
 //
+//    Queues of tables declared with dense keys live in a single flat array, one cache
+//    line per queue, and are indexed by the table's offset within the array plus the
+//    key. Queues of other tables (and of every table when no configuration is given)
+//    live in a hash table.
+//
 //  NOTE:
 //    This lock table implementation is NOT inherently multithreaded and precautions must
 //    be taken to ensure that data is not corrupted. Notice also that merge_batch_table_for
@@ -31,14 +39,37 @@ public:
   typedef std::unordered_map<RecordKey, LockQueue> LockTableType;
 
 protected:
+  struct LockQueueSlot {
+    LockQueue queue;
+  } __attribute__((__aligned__(CACHE_LINE)));
+
+  struct DenseTable {
+    bool dense_keys;
+    uint64_t num_records;
+    // index of the table's first queue within dense_queues.
+    uint64_t offset;
+  };
+
+  // indexed by table id.
+  std::vector<DenseTable> dense_tables;
+  LockQueueSlot* dense_queues;
+  uint64_t dense_queues_count;
+
+  // hashed fallback.
   LockTableType lock_table;
   bool memory_preallocated;
 
   void allocate_mem_for(RecordKey key);
+  void allocate_dense_queues(DBStorageConfig db_conf);
+  // nullptr if there is no queue for key.
+  inline LockQueue* get_queue_for(RecordKey key);
 
 public:
   LockTable();
   LockTable(DBStorageConfig db_conf);
+  LockTable(const LockTable& lt) = delete;
+  LockTable& operator=(const LockTable& lt) = delete;
+  ~LockTable();
   void merge_batch_table(BatchLockTable& blt);
   // from and to are both inclusive.
   void merge_batch_table_for(
@@ -46,10 +77,22 @@ public:
       const RecordKey& from, 
       const RecordKey& to);
   
-  std::shared_ptr<LockStage> get_head_for_record(RecordKey key);
+  LockStage* get_head_for_record(RecordKey key);
   void pass_lock_to_next_stage_for(RecordKey key);
 };
 
+inline LockQueue* LockTable::get_queue_for(RecordKey key) {
+  if (key.table_id < dense_tables.size() && 
+      dense_tables[key.table_id].dense_keys) {
+    const DenseTable& table = dense_tables[key.table_id];
+    assert(key.key < table.num_records);
+    return &dense_queues[table.offset + key.key].queue;
+  }
+
+  auto elt = lock_table.find(key);
+  return elt == lock_table.end() ? nullptr : &elt->second;
+}
+
 // BatchLockTable
 //
 //    BatchLockTable is very similar to the global LockTable, however it only contains
@@ -57,17 +100,43 @@ public:
 //    only every operated on by a single thread, hence it is non-concurrent. 
 //
 //    BatchLockTables are used by scheduling threads for creating tables that may be
-//    easily merged into the global LockTable.
+//    easily merged into the global LockTable. The lock stages are allocated from the
+//    given arena and outlive the BatchLockTable. If no arena is given, the arena of 
+//    the calling thread is used.
+//
+//    Lock requests are only buffered on insertion. build() radix sorts all of them
+//    by key, which keeps the requests for a record in insertion order, and creates
+//    the lock queue of every record from its run of requests. The queues are kept
+//    in a vector sorted on key, so a range of keys is found by binary search.
 class BatchLockTable {
 public:
-  typedef std::map<RecordKey, BatchLockQueue> LockTableType;
+  typedef std::pair<RecordKey, BatchLockQueue> KeyedQueue;
+  typedef std::vector<KeyedQueue> LockTableType;
 
 protected:
+  struct LockRequest {
+    RecordKey key;
+    IBatchAction* action;
+    LockType type;
+  };
+
   LockTableType lock_table;
+  std::vector<LockRequest> requests;
+  LockStageArena* arena;
+
+  void sort_requests();
+  // Returns [lo, hi) of queues with keys within [from, to].
+  std::pair<LockTableType::iterator, LockTableType::iterator> 
+    get_range(const RecordKey& from, const RecordKey& to);
 
 public:
   BatchLockTable();
+  BatchLockTable(LockStageArena* arena);
   void insert_lock_request(std::shared_ptr<IBatchAction> request);
+  // Creates lock queues out of all the buffered requests. Must be called
+  // before the table is merged. Requests may not be inserted afterwards.
+  void build();
+  bool is_built() const;
   const LockTableType& get_lock_table_data();
 
   friend class LockTable;
@@ -0,0 +1,18 @@
+#ifndef NOOP_TXN_H_
+#define NOOP_TXN_H_
+
+#include "db.h"
+
+#include <stdint.h>
+
+// The txn behind batch actions whose logic lives in the action itself, 
+// e.g. generated or replayed RMWBatchActions.
+class NoopTxn : public txn {
+public:
+  NoopTxn() {};
+  bool Run() override {return true;};
+  uint32_t num_reads() override {return 0;};
+  uint32_t num_writes() override {return 0;};
+};
+
+#endif // NOOP_TXN_H_
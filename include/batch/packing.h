@@ -5,6 +5,7 @@
 #include <batch/batch_action_interface.h>
 
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 /**
@@ -28,4 +29,44 @@ public:
   static BatchActions get_packing(Container* c);
 };
 
+/**
+ * Packer which probes bitmaps instead of hash sets.
+ *
+ * On construction, every key locked within the container is mapped to a
+ * compact id, once per batch. Packings are then created by testing and 
+ * setting the bits of the ids in bitmaps of exclusive and shared locks held
+ * within the packing. The ids are exact, so a set bit is always a conflict.
+ * The bitmaps are cleared by unsetting the bits of the packed actions only.
+ *
+ * Produces exactly the same packings as Packer. Single-threaded.
+ **/
+class BitmapPacker {
+private:
+  typedef IBatchAction::RecordKeySet RecordKeySet;
+  typedef Container::BatchActions BatchActions;
+
+  struct ActionLocks {
+    // lock ids of the action are lock_ids[offset, offset + writes + reads),
+    // writes first.
+    uint64_t offset;
+    uint32_t writes;
+    uint32_t reads;
+  };
+
+  std::unordered_map<RecordKey, uint32_t> key_ids;
+  std::vector<uint32_t> lock_ids;
+  std::vector<ActionLocks> actions;
+  std::vector<uint64_t> held_ex_locks;
+  std::vector<uint64_t> held_sh_locks;
+
+  void map_keys(IBatchAction* act);
+  bool txn_conflicts(const ActionLocks& locks) const;
+  void set_locks(const ActionLocks& locks, bool held);
+
+public:
+  // c must contain every action that will be packed.
+  BitmapPacker(Container* c);
+  BatchActions get_packing(Container* c);
+};
+
 #endif // PACKING_H_
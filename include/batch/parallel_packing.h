@@ -0,0 +1,155 @@
+#ifndef PARALLEL_PACKING_H_
+#define PARALLEL_PACKING_H_
+
+#include "batch/container.h"
+#include "batch/batch_action_interface.h"
+#include "runnable.hh"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Spin Barrier
+//
+//    Sense reversing barrier for a fixed number of threads. Threads busy wait,
+//    which is fine since every member of a packing team is pinned.
+class SpinBarrier {
+private:
+  volatile uint64_t arrived;
+  volatile uint64_t generation;
+  uint64_t threads;
+
+public:
+  SpinBarrier(uint64_t threads);
+  void wait();
+};
+
+class ParallelPacker;
+
+// Packing Helper
+//
+//    A thread cooperating with a scheduler thread on the packing of its
+//    batches. Idles until the scheduler starts packing a batch.
+class PackingHelper : public Runnable {
+private:
+  ParallelPacker* packer;
+  unsigned int member_id;
+
+public:
+  PackingHelper(ParallelPacker* packer, int cpu, unsigned int member_id);
+
+  void StartWorking() override;
+  void Init() override;
+};
+
+/**
+ * Packer splitting the work on a single batch among a team of threads. The
+ * scheduler thread is member 0 of the team, the remaining members are
+ * PackingHelpers.
+ *
+ * Let the serial order be the order in which the container presents the
+ * actions. Every member owns a part of the key space and:
+ *
+ *    1) collects the lock requests for the keys it owns in serial order,
+ *    2) derives the conflicts on those keys. On every key an exclusive
+ *       request must follow the shared requests that directly precede it,
+ *       or the exclusive request that directly precedes it otherwise. A
+ *       shared request must follow the exclusive request preceding it.
+ *    3) counts, for every action, the requests it must follow.
+ *
+ * Packings are then peeled off in rounds. A packing contains every action
+ * whose preceding requests are all within earlier packings. Members release
+ * the requests of the packing on the keys they own and the actions that
+ * are left with nothing to follow form the next packing.
+ *
+ * Conflicting actions always end up in the serial order, so the resulting
+ * schedule is equivalent to the serial order. Packings may differ from the
+ * ones created by Packer since an action is not packed ahead of a
+ * conflicting action that precedes it in serial order, even if Packer
+ * would have skipped that action.
+ **/
+class ParallelPacker {
+public:
+  typedef Container::BatchActions BatchActions;
+  typedef std::vector<BatchActions> Packings;
+
+private:
+  struct Request {
+    uint32_t action;
+    bool exclusive;
+    // position of the first exclusive request following this one
+    // within the key queue or the queue size if there is none.
+    uint32_t next_exclusive;
+  };
+
+  typedef std::vector<Request> KeyQueue;
+
+  struct KeyRequest {
+    RecordKey key;
+    uint32_t action;
+    bool exclusive;
+  };
+
+  struct QueueRef {
+    uint32_t queue;
+    uint32_t pos;
+  };
+
+  // Per member state. Reused across batches.
+  struct Member {
+    // requests for keys owned by the member i, by the member that
+    // created them.
+    std::vector<std::vector<KeyRequest>> outbox;
+    std::unordered_map<RecordKey, uint32_t> queue_ids;
+    // queues[0, queue_ids.size()) are in use. The rest keep their memory
+    // for the following batches.
+    std::vector<KeyQueue> queues;
+    // requests of action a are queue_refs[ref_starts[a], ref_starts[a+1]).
+    std::vector<QueueRef> queue_refs;
+    std::vector<uint32_t> ref_starts;
+    std::vector<uint32_t> ready;
+  };
+
+  unsigned int team_size;
+  std::vector<std::unique_ptr<PackingHelper>> helpers;
+  bool helpers_started;
+  volatile uint64_t stop_signal;
+  volatile uint64_t batch_generation;
+  SpinBarrier phase_barrier;
+
+  // The batch being packed, in serial order.
+  BatchActions actions;
+  std::vector<uint64_t> pending;
+  std::vector<Member> members;
+  // Actions within the packing being released.
+  std::vector<uint32_t> frontier;
+  std::vector<std::vector<uint32_t>> rounds;
+
+  unsigned int get_owner(const RecordKey& key) const;
+  void release(Member& m, uint32_t action);
+  void collect_ready(unsigned int member_id);
+  void make_frontier();
+
+  void collect_requests(unsigned int member_id);
+  void build_queues(unsigned int member_id);
+
+public:
+  // param helper_cpus: cpus to pin the helpers to. The team consists of
+  //    the calling thread and one helper per cpu.
+  ParallelPacker(std::vector<int> helper_cpus);
+  ParallelPacker(const ParallelPacker& pp) = delete;
+
+  // Drains c into packings. Must be called by a single thread.
+  Packings get_packings(Container* c);
+  unsigned int get_team_size() const;
+
+  // Entry point of every team member for a single batch.
+  void pack(unsigned int member_id);
+  // Used by helpers.
+  bool is_stop_requested() const;
+  uint64_t get_batch_generation() const;
+
+  ~ParallelPacker();
+};
+
+#endif // PARALLEL_PACKING_H_
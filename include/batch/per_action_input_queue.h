@@ -1,7 +1,7 @@
 #ifndef _GLOBAL_INPUT_QUEUE_H_
 #define _GLOBAL_INPUT_QUEUE_H_
 
-#include "batch/MS_queue.h"
+#include "batch/SPSC_ring.h"
 #include "batch/batch_action_interface.h"
 #include "batch/scheduler.h"
 #include "batch/input_queue_interface.h"
@@ -17,52 +17,54 @@ class Scheduler;
  *
  *    Implementation of the input queue for the system in which every action is
  *    stored separately and the batch is constructed on the fly as request for it
- *    comes in.
+ *    comes in. 
+ *
+ *    A batch is cut when it reaches batch_size, when all of the flushed 
+ *    actions have been taken or, if batch_timeout_us is not 0, once the 
+ *    batch has been open for batch_timeout_us. 
+ *
+ *    With a timeout the batch size also adapts to the load. The consumer
+ *    keeps an estimate of the arrival rate and only waits for as many 
+ *    actions as are expected to arrive within the timeout. Whenever there is 
+ *    a backlog, the batch takes all of it (up to batch_size). So batches 
+ *    are small and cut early at low load and full at peak.
  */
 class PerActionInputQueue : 
-  private MSQueue<std::unique_ptr<IBatchAction>>,
+  private SPSCRing<std::unique_ptr<IBatchAction>>,
   public InputQueue
 {
-public:
-  PerActionInputQueue(uint32_t batch_size): 
-    MSQueue<std::unique_ptr<IBatchAction>>(),
-    InputQueue(batch_size)
-  {};
+private:
+  typedef SPSCRing<std::unique_ptr<IBatchAction>> Ring;
 
-  virtual InputQueue::BatchActions try_get_action_batch() override {
-    // we return the whole batch only if the input queue is not empty. 
-    // otherwise we return an empty vector!
-    if (this->is_empty()) 
-      return InputQueue::BatchActions();
+  const uint64_t batch_timeout_ns;
 
-    // Getting here means that we will be returning the WHOLE batch or
-    // we will be waiting until we can return such.
-    // TODO:
-    //  Implement timeout.
-    InputQueue::BatchActions batch(this->batch_size);
-    for (unsigned int actionsTaken = 0; 
-        actionsTaken < this->batch_size; 
-        actionsTaken ++) {
-      while (this->is_empty()) {};
+  // producer side
+  uint64_t added;
+  // actions [0, flushed) may be cut into a partial batch.
+  volatile uint64_t flushed;
+  char pad_producer[CACHE_LINE];
 
-      batch[actionsTaken] = std::move(this->peek_head());
-      this->pop_head();
-    }
+  // consumer side
+  uint64_t taken;
+  // arrival rate estimate in actions per ns and the sample it is
+  // based on.
+  double arrival_rate;
+  uint64_t last_sample_time;
+  uint64_t last_sample_arrivals;
 
-    return batch;
-  }; 
+  uint64_t now_ns();
+  void update_arrival_rate(uint64_t now);
+  uint64_t get_target_batch_size(uint64_t now);
 
-  virtual void add_action(std::unique_ptr<IBatchAction>&& act) override {
-    MSQueue<std::unique_ptr<IBatchAction>>::push_tail(std::move(act));
-  };
+public:
+  PerActionInputQueue(uint32_t batch_size, uint32_t batch_timeout_us = 0);
 
-  virtual bool is_empty() override {
-    return MSQueue<std::unique_ptr<IBatchAction>>::is_empty();
-  };
+  virtual InputQueue::BatchActions try_get_action_batch() override;
+  virtual void add_action(std::unique_ptr<IBatchAction>&& act) override;
+  virtual bool is_empty() override;
+  virtual void flush() override;
 
-  // flushing does not do anything since the queue is per-action 
-  // any way. 
-  virtual void flush() override {}
+  double get_arrival_rate_per_us() const;
 };
 
 #endif
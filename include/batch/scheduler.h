@@ -3,7 +3,9 @@
 
 #include "batch/batch_action_interface.h"
 #include "batch/lock_table.h"
+#include "batch/lock_stage_arena.h"
 #include "batch/container.h"
+#include "batch/parallel_packing.h"
 #include "batch/scheduler_thread_manager.h"
 #include "batch/scheduler_thread.h"
 #include "batch/diagnostics.h"
@@ -21,13 +23,28 @@
 class Scheduler : public SchedulerThread {
 private:
   uint64_t thread_id;
+  // null unless packings are created by a team of threads.
+  std::unique_ptr<ParallelPacker> parallel_packer;
+  // next free position within workloads while processing a batch.
+  unsigned int curr_workload_item;
+
+  // move the actions of a packing to workloads and the lock table.
+  void add_packing(Container::BatchActions& packing);
+  // frees the lock stages of batches the executors are done with.
+  void reclaim_lock_stages();
 public:
   Scheduler(
       SchedulerThreadManager* manager,
       int m_cpu_number,
-      uint64_t thread_id);
+      uint64_t thread_id,
+      // if non-empty, every batch is packed by this thread together
+      // with a helper thread pinned to each of the cpus.
+      std::vector<int> packing_helper_cpus = {});
 
   SchedulerThreadBatch batch_actions;
+  // Lock stages of all batches created by this thread. Must outlive
+  // their use within the global schedule.
+  LockStageArena stage_arena;
   BatchLockTable lt;
   SchedulerThreadManager::OrderedWorkload workloads;
 
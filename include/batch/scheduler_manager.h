@@ -4,9 +4,12 @@
 #include "batch/scheduler.h"
 #include "batch/lock_table.h"
 #include "batch/batched_input_queue.h"
+#include "batch/per_action_input_queue.h"
+#include "batch/SPSC_ring.h"
 #include "batch/scheduler_system.h"
 #include "batch/scheduler_thread_manager.h"
 #include "batch/db_storage_interface.h"
+#include "batch/batch_command_log.h"
 
 #include <vector>
 #include <memory>
@@ -18,9 +21,7 @@
 //    The queue is filled by one of the scheduling threads when there 
 //    is opportunity for it. Please see request_input for more 
 //    information.
-class ThreadInputQueue : public MSQueue<SchedulerThreadBatch> {
-  private:
-      using MSQueue<SchedulerThreadBatch>::merge_queue;
+class ThreadInputQueue : public SPSCRing<SchedulerThreadBatch> {
 }; 
 
 // Thread Input Queues
@@ -29,17 +30,28 @@ class ThreadInputQueue : public MSQueue<SchedulerThreadBatch> {
 // by a scheduler worker which has obtained the proper lock. Thus, every
 // worker obtains input from its own queue with little contention on 
 // global objects.
+//
+// Without a batch timeout, actions are batched by the producer and batches
+// are only cut when full or flushed (BatchedInputQueue). With a timeout,
+// the worker assigning inputs cuts the batches itself, so that a partial 
+// batch is handed out once the timeout expires (PerActionInputQueue).
+//
+// With a command log, the batches assigned in one go are made durable
+// with a single fsync before they are handed to the workers.
 class ThreadInputQueues {
 private: 
   pthread_rwlock_t input_lock;
   uint64_t input_batch_id;
   std::vector<ThreadInputQueue> queues;
-  BatchedInputQueue iq;
+  std::unique_ptr<InputQueue> iq;
+  std::unique_ptr<CommandLog> log;
 
 public:
   ThreadInputQueues(
       unsigned int thread_number,
-      unsigned int batch_size_act);
+      unsigned int batch_size_act,
+      unsigned int batch_timeout_us = 0,
+      std::string command_log_file = "");
   
   void add_action(std::unique_ptr<IBatchAction>&& act);
   void flush_actions();
@@ -70,9 +82,7 @@ struct AwaitingBatch {
 //    of "former" batches still being processed. Each scheduling thread
 //    has its own queue and there may be only one thread performing the 
 //    handing off.
-class AwaitingBatchQueue : public MSQueue<AwaitingBatch> {
-  private:
-    using MSQueue<AwaitingBatch>::merge_queue;
+class AwaitingBatchQueue : public SPSCRing<AwaitingBatch> {
 };
 
 // Awaiting Scheduler Batches
@@ -164,8 +174,10 @@ public:
   GlobalOrderedBatches sorted_pending_batches;
 
   // Variables necessary for horizontally shareded merging into the 
-  // global schedule.
-  const unsigned int records_per_stage;
+  // global schedule. Stage i merges the keys within stage_ranges[i], 
+  // both ends inclusive.
+  typedef std::pair<RecordKey, RecordKey> KeyRange;
+  const std::vector<KeyRange> stage_ranges;
   BatchMergingStageQueues merging_queues;
   
   std::vector<std::shared_ptr<SchedulerThread>> schedulers;
@@ -176,6 +188,13 @@ public:
       DBStorageConfig db_c,
       ExecutorThreadManager* exec);
 
+  // Splits the keys declared by every table, in RecordKey order, into 
+  // stages_number ranges holding about the same number of keys. Every 
+  // declared key falls within exactly one of them.
+  static std::vector<KeyRange> get_stage_ranges(
+      const DBStorageConfig& db_c, 
+      unsigned int stages_number);
+
   // implementing the SchedulingSystem interface
 	virtual void add_action(std::unique_ptr<IBatchAction>&& act) override;
   virtual void flush_actions() override;
@@ -186,10 +205,8 @@ public:
   virtual void stop_working() override;
 
   // implementing the SchedulerThreadManager interface
-	// TODO:
-	//    - Make sure that one doesn't wait for the batch too long 
-	//    by using a timer. For now we assume high-load within the 
-	//    simulations so that timeout never happens.
+  // Batches are not held back for longer than batch_timeout_us of the 
+  // configuration (if set). See ThreadInputQueues.
   SchedulerThreadBatch request_input(SchedulerThread* s) override;
 
   // In our implementation this overload will merge into global schedule
@@ -6,6 +6,7 @@
 #include "batch/db_storage_interface.h"
 
 #include <memory>
+#include <string>
 
 // Scheduler System Config 
 //
@@ -13,11 +14,22 @@
 struct SchedulingSystemConfig {
   uint32_t scheduling_threads_count;
   uint32_t batch_size_act;
-  uint32_t batch_length_sec;
+  // a partial batch is handed to scheduling once it has been waiting for
+  // this long. 0 waits for full (or flushed) batches only.
+  uint32_t batch_timeout_us;
   // we pin threads within scheduling system sequentially 
   // starting at this cpu.
   uint32_t first_pin_cpu_id;
   uint32_t num_table_merging_shard;
+  // number of threads creating the packings of a single batch, including
+  // the scheduling thread owning the batch. Helpers of the scheduling
+  // thread i are pinned to 
+  //    first_pin_cpu_id + j * scheduling_threads_count + i 
+  // for 0 < j < packing_threads_count.
+  uint32_t packing_threads_count;
+  // if set, the input is command logged to this file. See 
+  // batch/batch_command_log.h.
+  std::string command_log_file;
 };
 
 // Scheduling System
@@ -31,6 +31,15 @@ public:
     sched_system->flush_actions();
   };
 
+  // Hand actions to the system one by one, e.g. to simulate arrivals.
+  virtual void add_action(std::unique_ptr<IBatchAction>&& act) {
+    sched_system->add_action(std::move(act));
+  };
+
+  virtual void flush_actions() {
+    sched_system->flush_actions();
+  };
+
   virtual std::unique_ptr<std::vector<std::shared_ptr<IBatchAction>>> 
     get_output() {
       return std::move(exec_system->try_get_done_batch());
@@ -17,6 +17,8 @@ namespace TimeUtilities {
   double time_function_ms(std::function<void (void)> fun);
 
   TimePoint now();
+  // monotonic, for timestamping events across threads.
+  uint64_t now_ns();
 };
 
 #endif //TIME_UTILITIES_H_
@@ -2,7 +2,7 @@
 #define BATCH_ACTION_FACTORY_IMPL_
 
 #include "batch/txn_factory.h"
-#include "test/test_action.h"
+#include "batch/noop_txn.h"
 
 #include <random>
 
@@ -135,7 +135,7 @@ ActionFactory<ActionClass>::generate_actions (
         read_set);
 
     // construct the action
-    std::unique_ptr<IBatchAction> act = std::make_unique<ActionClass>(new TestTxn());
+    std::unique_ptr<IBatchAction> act = std::make_unique<ActionClass>(new NoopTxn());
     for (auto& key : read_set) act->add_read_key(key);
     for (auto& key : write_set) act->add_write_key(key);
 
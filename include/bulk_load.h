@@ -0,0 +1,148 @@
+#ifndef         BULK_LOAD_H_
+#define         BULK_LOAD_H_
+
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Bulk loading populates an engine's tables at startup directly, in place of
+ * running the loader transactions through concurrency control. Records come
+ * from a BulkLoadSource, and are inserted by loader threads pinned to
+ * consecutive cpus. A thread allocates the records it inserts from its own
+ * NUMA node.
+ *
+ * Every record is inserted by the thread which owns it. Engines pick owners
+ * such that no two threads touch the same part of an index (a range of hash
+ * buckets, a scheduler's partition), so inserts need not synchronize.
+ */
+
+/*
+ * Records to load, addressed by table and index. Every method may be called
+ * by several threads at once.
+ */
+class BulkLoadSource {
+ public:
+        virtual ~BulkLoadSource() {}
+
+        virtual uint32_t NumTables() = 0;
+        virtual uint64_t NumRecords(uint32_t table_id) = 0;
+        virtual uint64_t RecordSize(uint32_t table_id) = 0;
+        virtual uint64_t GetKey(uint32_t table_id, uint64_t index) = 0;
+
+        /*
+         * Returns the value of a record, either in place or written to buf,
+         * which holds RecordSize(table_id) bytes.
+         */
+        virtual const char* GetValue(uint32_t table_id, uint64_t index,
+                                     char *buf) = 0;
+};
+
+/*
+ * The records the loader transactions of a workload write, ycsb_insert or
+ * SmallBank::LoadCustomerRange. Values only depend on the key.
+ */
+class WorkloadLoadSource : public BulkLoadSource {
+ private:
+        bool small_bank;
+        uint64_t num_records;
+
+ public:
+        WorkloadLoadSource(bool small_bank, uint64_t num_records);
+
+        virtual uint32_t NumTables();
+        virtual uint64_t NumRecords(uint32_t table_id);
+        virtual uint64_t RecordSize(uint32_t table_id);
+        virtual uint64_t GetKey(uint32_t table_id, uint64_t index);
+        virtual const char* GetValue(uint32_t table_id, uint64_t index,
+                                     char *buf);
+};
+
+/*
+ * The records of a multiversion checkpoint (see mv_checkpoint.h), read
+ * through a memory mapping of its files.
+ */
+class FileLoadSource : public BulkLoadSource {
+ private:
+        struct table_map {
+                char *data;
+                uint64_t len;
+                uint64_t record_size;
+                uint64_t num_records;
+        };
+
+        uint32_t epoch;
+        std::vector<table_map> tables;
+
+        const char* Record(uint32_t table_id, uint64_t index);
+
+ public:
+        FileLoadSource(const char *dir);
+        virtual ~FileLoadSource();
+
+        /* Epoch of the checkpoint. */
+        uint32_t Epoch();
+
+        virtual uint32_t NumTables();
+        virtual uint64_t NumRecords(uint32_t table_id);
+        virtual uint64_t RecordSize(uint32_t table_id);
+        virtual uint64_t GetKey(uint32_t table_id, uint64_t index);
+        virtual const char* GetValue(uint32_t table_id, uint64_t index,
+                                     char *buf);
+};
+
+/* Loader thread which owns a record. */
+typedef std::function<uint32_t(uint32_t table_id,
+                               uint64_t key)> bulk_owner_fn;
+
+/*
+ * Inserts a record into the engine. The value is size bytes long, which need
+ * not be the engine's record size.
+ */
+typedef std::function<void(uint32_t thread, uint32_t table_id, uint64_t key,
+                           const char *value, uint64_t size)> bulk_insert_fn;
+
+struct BulkLoaderConfig {
+        int start_cpu;
+        uint32_t num_threads;
+        BulkLoadSource *source;
+        /*
+         * Without an owner, each thread loads a range of every table. With
+         * one, the ranges are first split up by owner in a separate pass.
+         */
+        bulk_owner_fn owner;
+        bulk_insert_fn insert;
+};
+
+class BulkLoader {
+ private:
+        struct arena {
+                int cpu;
+                char *cur;
+                uint64_t left;
+        };
+
+        BulkLoaderConfig config;
+        /* One per thread, on the thread's NUMA node. */
+        arena **arenas;
+
+        uint64_t RunThreads(bool partition, std::vector<uint64_t> *owned);
+
+ public:
+        BulkLoader(BulkLoaderConfig config);
+
+        /* Loads every record of the source. Returns the number loaded. */
+        uint64_t Load();
+
+        /*
+         * Memory on the NUMA node of a loader thread, only to be called by
+         * the thread while it inserts. It is never freed.
+         */
+        void* Alloc(uint32_t thread, uint64_t sz);
+
+        /* Copies a value of size bytes into a record, zero-padded. */
+        static void CopyValue(char *record, uint64_t record_size,
+                              const char *value, uint64_t size);
+};
+
+#endif          // BULK_LOAD_H_
@@ -0,0 +1,108 @@
+#ifndef         COMMAND_LOG_H_
+#define         COMMAND_LOG_H_
+
+#include <runnable.hh>
+#include <concurrent_queue.h>
+#include <mv_action.h>
+#include <db.h>
+
+#include <functional>
+#include <vector>
+
+/*
+ * Command logging for the engines which fix the serial order of transactions
+ * before they execute (Bohm and the batched engine). Only the inputs are
+ * logged: every transaction is recorded as its type and the parameters it
+ * was created with (see txn::get_type). Re-executing the log in order
+ * reconstructs the database.
+ *
+ * The log is a sequence of batches, each in serial order. Batches are
+ * buffered and Sync() writes out all of the buffered batches with a single
+ * fsync. A batch must not be handed to the schedulers before it is synced.
+ */
+
+struct command_log_batch_header {
+        uint64_t batch_id;
+        uint32_t num_txns;
+        uint64_t len;
+};
+
+struct command_log_txn_header {
+        uint32_t type;
+        uint32_t num_params;
+};
+
+struct logged_txn {
+        uint32_t type;
+        std::vector<uint64_t> params;
+};
+
+typedef std::function<void(uint64_t batch_id,
+                           std::vector<logged_txn> &txns)> replay_fn;
+
+class CommandLog {
+ private:
+        int fd;
+        std::vector<char> cur_batch;
+        uint32_t cur_txns;
+        std::vector<char> pending;
+
+        void WriteAll(const char *data, uint64_t len);
+
+ public:
+        /* Truncates the log in file_name. */
+        CommandLog(const char *file_name);
+        ~CommandLog();
+
+        virtual void AppendTxn(uint32_t type,
+                               const std::vector<uint64_t> &params);
+        virtual void AppendTxn(txn *t);
+        virtual void EndBatch(uint64_t batch_id);
+        virtual void Sync();
+
+        /*
+         * Calls fn on every complete batch in file_name, in order. Returns
+         * the number of transactions read.
+         */
+        static uint64_t Read(const char *file_name, replay_fn fn);
+
+        /* Re-creates a logged transaction of one of the benchmarks. */
+        static txn* CreateTxn(const logged_txn &t);
+};
+
+struct MVCommandLoggerConfig {
+        int cpu;
+        const char *file_name;
+        /* Batches synced together at most. */
+        uint32_t max_group;
+        SimpleQueue<ActionBatch> *inputQueue;
+        SimpleQueue<ActionBatch> *outputQueue;
+};
+
+/*
+ * First stage of the Bohm pipeline when logging. Batches are logged with
+ * their epoch and handed on to the schedulers once they are durable.
+ * Whatever batches are waiting when the stage gets to them are committed
+ * with a single fsync.
+ */
+class MVCommandLogger : public Runnable {
+ private:
+        MVCommandLoggerConfig config;
+        CommandLog *log;
+        ActionBatch *group;
+
+ protected:
+        virtual void StartWorking();
+        virtual void Init();
+
+ public:
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        MVCommandLogger(MVCommandLoggerConfig config);
+        virtual void LogBatch(const ActionBatch &batch);
+};
+
+#endif          // COMMAND_LOG_H_
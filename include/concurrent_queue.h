@@ -13,6 +13,7 @@
 
 #include "util.h"
 #include "machine.h"
+#include "wait_strategy.h"
 
 
 #define CACHE_PAD 64
@@ -44,6 +45,8 @@ class SimpleQueue {
     uint64_t m_size;
     volatile uint64_t __attribute__((__packed__, __aligned__(CACHE_LINE))) m_head;    
     volatile uint64_t __attribute__((__packed__, __aligned__(CACHE_LINE))) m_tail;    
+    // threads parked on m_head or m_tail. See wait_strategy.h.
+    volatile uint64_t __attribute__((__packed__, __aligned__(CACHE_LINE))) m_parked;
 
     SimpleQueue(char* values, uint64_t size) {
         m_values = values;
@@ -53,6 +56,7 @@ class SimpleQueue {
         memset(values, 0x0, m_size*CACHE_LINE);
         m_head = 0;
         m_tail = 0;        
+        m_parked = 0;
         barrier();
     }
     
@@ -76,6 +80,7 @@ class SimpleQueue {
             
             (*(T*)&m_values[index*CACHE_LINE]) = data;
             fetch_and_increment(&m_head);
+            wake_parked(&m_head, &m_parked);
             return true;
         }
     }
@@ -83,6 +88,7 @@ class SimpleQueue {
     void EnqueueBlocking(T data) {
             uint64_t head = m_head;
             uint64_t tail;
+            Waiter waiter;
             assert(m_head >= m_tail);
             while (true) {
                     barrier();
@@ -90,6 +96,7 @@ class SimpleQueue {
                     barrier();
                     if (head < tail + m_size)
                             break;
+                    waiter.wait(&m_tail, tail, &m_parked);
             }
             //        while (m_head == m_tail + m_size) 
             //            ;
@@ -98,11 +105,13 @@ class SimpleQueue {
         assert(index <= ((m_size - 1) << 6));
         (*(T*)&m_values[index*CACHE_LINE]) = data;
         fetch_and_increment(&m_head);
+        wake_parked(&m_head, &m_parked);
     }
     
     T DequeueBlocking() {
             uint64_t head, tail;
             tail = m_tail;
+        Waiter waiter;
         assert(m_head >= m_tail);
         while (true) {
                 barrier();
@@ -110,6 +119,7 @@ class SimpleQueue {
                 barrier();
                 if (head > tail)
                         break;
+                waiter.wait(&m_head, head, &m_parked);
         }
         //        while (m_head == m_tail) 
         //            ;
@@ -118,6 +128,7 @@ class SimpleQueue {
         assert(index <= ((m_size - 1) << 6));
         T ret = (*(T*)&m_values[index*CACHE_LINE]);
         fetch_and_increment(&m_tail);
+        wake_parked(&m_tail, &m_parked);
         return ret;
     }
 
@@ -132,6 +143,7 @@ class SimpleQueue {
             assert(index <= ((m_size - 1) << 6));
             *value = (*(T*)&m_values[index*CACHE_LINE]);
             fetch_and_increment(&m_tail);
+            wake_parked(&m_tail, &m_parked);
             return true;
         }
     }
@@ -2,6 +2,7 @@
 #define DB_H_
 
 #include <unordered_map>
+#include <vector>
 #include <stdint.h>
 #include <city.h>
 
@@ -72,6 +73,44 @@ enum usage_type {
         RMW,
 };
 
+/*
+ * Transactions which can be command logged. See command_log.h.
+ */
+enum txn_type {
+        TXN_NOT_LOGGED = 0,
+        YCSB_INSERT_TXN,
+        YCSB_READONLY_TXN,
+        YCSB_RMW_TXN,
+        SMALL_BANK_LOAD_TXN,
+        SMALL_BANK_BALANCE_TXN,
+        SMALL_BANK_DEPOSIT_CHECKING_TXN,
+        SMALL_BANK_TRANSACT_SAVING_TXN,
+        SMALL_BANK_AMALGAMATE_TXN,
+        SMALL_BANK_WRITE_CHECK_TXN,
+        BATCH_RMW_TXN,
+};
+
+/*
+ * Isolation level a transaction runs at. OCC and Hekaton honor it per 
+ * transaction; OCC runs snapshot isolation txns as serializable, since it 
+ * keeps a single version of each record. The other engines are always 
+ * serializable. Txns run at DEFAULT_ISOLATION unless the workload picks a 
+ * level, see set_isolation.
+ */
+enum isolation_level {
+        ISOLATION_SERIALIZABLE = 0,
+        ISOLATION_SNAPSHOT,
+        ISOLATION_READ_COMMITTED,
+};
+
+#if READ_COMMITTED
+#define DEFAULT_ISOLATION ISOLATION_READ_COMMITTED
+#elif SNAPSHOT_ISOLATION
+#define DEFAULT_ISOLATION ISOLATION_SNAPSHOT
+#else
+#define DEFAULT_ISOLATION ISOLATION_SERIALIZABLE
+#endif
+
 /*
  * Interface for all database implementations. We want to keep a uniform 
  * interface so that we have a single benchmark implementation that does not 
@@ -83,6 +122,8 @@ class translator {
         
  public:
         translator(txn *t) { this->t = t; };
+        txn* get_txn() { return this->t; };
+        isolation_level get_isolation();
         virtual void *write_ref(uint64_t key, uint32_t table) = 0;
         virtual void *read(uint64_t key, uint32_t table) = 0;
         virtual int rand() = 0;
@@ -96,6 +137,7 @@ class translator {
 class txn {
  private:
         translator *trans;
+        isolation_level isolation;
  protected:
         // These functions return the reference to the memory needed for a 
         // read of write to a particular key. Composite key is created.
@@ -118,7 +160,14 @@ class txn {
         virtual void get_reads(struct big_key *array);
         virtual void get_writes(struct big_key *array);
         virtual void get_rmws(struct big_key *array);
+        // Command logging. A transaction which can be logged returns its 
+        // type and the parameters it was created with. Run() must be 
+        // deterministic given these and the state of the database.
+        virtual txn_type get_type();
+        virtual void get_params(std::vector<uint64_t> *params);
         void set_translator(translator *trans);
+        isolation_level get_isolation();
+        void set_isolation(isolation_level isolation);
         virtual ~txn(){};
 };
 
@@ -37,23 +37,64 @@ struct GarbageBinConfig {
   SimpleQueue<RecordList> **workerChannels;
 };
 
+/* 
+ * Number of epochs whose garbage a GarbageBin tracks separately while waiting 
+ * for the low-water mark to pass them. When more epochs than this are 
+ * outstanding, the newest epochs' garbage is merged.
+ */
+#define GC_GENERATIONS 8
+
+/* 
+ * Minimum number of records handed back to an owning thread in one message 
+ * while executors are busy. Idle executors hand back whatever they have.
+ */
+#define GC_BATCH_SIZE 256
+
+struct GarbageBinStats {
+  uint64_t collectedVersions;
+  uint64_t reclaimedVersions;
+  uint64_t reclaimedPayloads;
+};
+
+/* 
+ * Epoch-based reclamation of MVRecords and their payloads. Versions killed 
+ * during an epoch become a generation tagged with the epoch. Once every 
+ * executor has finished that epoch, the generation's versions and payloads 
+ * are handed back in batches to the allocators they came from, which live on 
+ * their owning threads' NUMA nodes.
+ *
+ * Batches are built per owning thread rather than per socket. Every 
+ * MVRecordAllocator and RecordAllocator is private to the thread that owns it, 
+ * so a per-socket batch would have to be split up again on arrival, by a 
+ * thread that does not own the pools. Per-owner batches of GC_BATCH_SIZE 
+ * already amortize the cross-socket message the same way.
+ */
 class GarbageBin {
  private:
 
-  // curStickies and curRecords correspond to "live" queues, in which new 
-  // garbage is thrown
+  // Garbage produced during the epoch currently being executed.
   MVRecordList *curStickies;
-  RecordList *curRecords;
-  
-  // snapshotStickies and snapshotRecords correspond to a snapshot as of a 
-  // specific epoch
-  MVRecordList *snapshotStickies;
-  RecordList *snapshotRecords;
-  uint32_t snapshotEpoch;
 
+  // Ring of generations waiting on the low-water mark, oldest at genHead. 
+  // Generation i holds one list per CC thread, starting at 
+  // genStickies[i*numCCThreads].
+  MVRecordList *genStickies;
+  uint32_t genEpochs[GC_GENERATIONS];
+  uint32_t genHead;
+  uint32_t genCount;
+
+  // Reclaimed garbage waiting to be handed back to its owners. freeRecords 
+  // is indexed by workerThread*numTables+tableId.
+  MVRecordList *freeStickies;
+  RecordList *freeRecords;
+
+  GarbageBinStats stats;
   GarbageBinConfig config;
 
-  void ReturnGarbage();
+  void SealEpoch(uint32_t epoch);
+  void Reclaim(uint32_t lowWatermark);
+  void ReturnGarbage(bool force);
+  void CollectPayloads(MVRecordList *stickies);
 
  public:
   void* operator new(std::size_t sz, int cpu) {
@@ -62,9 +103,18 @@ class GarbageBin {
   
   GarbageBin(GarbageBinConfig config);
 
+  // rec must no longer be visible to any transaction.
   void AddRecord(uint32_t workerThread, uint32_t tableId, Record *rec);
   void AddMVRecord(uint32_t ccThread, MVRecord *rec);
   void FinishEpoch(uint32_t epoch);
+
+  // Called by idle executors. Reclaims generations the low-water mark has 
+  // passed, and hands back all reclaimed garbage regardless of batch size.
+  void Poll();
+
+  GarbageBinStats GetStats() {
+    return stats;
+  }
 };
 
 /* List of actions still to be completed as part of a particular epoch. */
@@ -113,12 +163,22 @@ class RecordAllocator {
   void Recycle(RecordList recList);
 };
 
+/* 
+ * States of the word a checkpointer uses to hold back the low-water mark (see 
+ * MVCheckpointer). Any other value is the epoch the checkpoint reads. Only 
+ * the checkpointer moves the word from idle to a request and from an epoch 
+ * back to idle, and only the leader executor turns a request into an epoch.
+ */
+#define MV_CKPT_IDLE 0
+#define MV_CKPT_REQUEST 0xFFFFFFFF
+
 struct ExecutorConfig {
         uint32_t threadId;
         uint32_t numExecutors;
         int cpu;
         volatile uint32_t *epochPtr;
         volatile uint32_t *lowWaterMarkPtr;
+        volatile uint32_t *checkpointPtr;       /* NULL without a checkpointer */
         SimpleQueue<ActionBatch> *inputQueue;
         SimpleQueue<ActionBatch> *outputQueue;
         uint32_t numTables;
@@ -142,6 +202,9 @@ class Executor : public Runnable {
         PendingActionList *pendingGC;
         uint64_t counter;
 
+        /* A checkpoint may be reading versions this epoch could overwrite. */
+        bool checkpointing;
+
  protected:
 
         //  Executor(ExecutorConfig config);
@@ -159,17 +222,26 @@ class Executor : public Runnable {
         void RecycleData();
 
         void adjust_lowwatermark();
+        void raise_lowwatermark();
 
         uint32_t DoPendingGC();
         bool ProcessSingleGC(mv_action *action);
         bool check_ready(mv_action *action);
 
+        Record* alloc_payload(uint32_t table_id);
+        void attach_payload(CompositeKey *write);
+        void finish_reads(mv_action *action);
+
  public:
         void* operator new(std::size_t sz, int cpu) {
                 return alloc_mem(sz, cpu);
         }
 
         Executor(ExecutorConfig config);
+
+        GarbageBinStats GetGCStats() {
+                return garbageBin->GetStats();
+        }
 };
 
 #endif          // EXECUTOR_H_
@@ -33,9 +33,61 @@ struct hek_batch {
 };
 
 
+/*
+ * Every HEK_GC_INTERVAL txns, a worker recomputes the watermark below which 
+ * versions are garbage, and reclaims the versions it unlinked earlier.
+ */
+#define HEK_GC_INTERVAL 64
+
+/*
+ * How workers obtain timestamps.
+ *
+ * HEK_TS_GLOBAL: Increment a single counter shared by all workers.
+ *
+ * HEK_TS_LEASE: Lease HEK_TS_LEASE_SIZE consecutive timestamps from the shared 
+ * counter at once, and hand them out locally as begin timestamps. End 
+ * timestamps still come from the shared counter, see end_timestamp.
+ *
+ * HEK_TS_CLOCK: Read the cycle counter, and use the worker's index as the low 
+ * order bits.
+ *
+ * Timestamps are unique, and increase on every worker, but only the global 
+ * counter hands them out in real-time order across workers. A txn may thus 
+ * end before a version which committed earlier in real time. hek_table refuses
+ * to install versions out of timestamp order, see insert_version.
+ */
+enum hek_ts_alloc {
+        HEK_TS_GLOBAL = 0,
+        HEK_TS_LEASE,
+        HEK_TS_CLOCK,
+};
+
+#define HEK_TS_LEASE_SIZE 256
+
+/* 
+ * The begin timestamp of a worker's current (or last) txn in a batch. Workers 
+ * only ever increase it within a batch, so a stale read is lower, and thus 
+ * safe, for GC. Between batches it is HEK_INF, see hek_worker::announce_idle.
+ */
+struct hek_active_begin {
+        volatile uint64_t begin;
+} __attribute__((__aligned__(64)));
+
+/* 
+ * Versions unlinked from a table, waiting for readers which may still be 
+ * traversing them. 
+ */
+struct hek_gc_list {
+        hek_record *head;
+        hek_record *tail;
+};
+
 struct hek_worker_config {
         int cpu;
         volatile uint64_t *global_time;
+        hek_ts_alloc ts_alloc;
+        uint64_t clock_base;		/* rdtsc() at startup, HEK_TS_CLOCK */
+        hek_active_begin *active_begins;	/* one per worker */
         uint32_t num_tables;
         uint32_t num_threads;
         hek_table **tables;
@@ -50,6 +102,8 @@ struct hek_worker_config {
 };
 
 class hek_worker : public Runnable {
+        friend class HekWorkerTest;
+
  private:
         uint32_t num_committed;
         uint32_t num_done;
@@ -58,24 +112,54 @@ class hek_worker : public Runnable {
         
         struct hek_record **records;
 
+        /* Version GC state, see collect_garbage. */
+        uint64_t gc_watermark;
+        uint32_t gc_countdown;
+        hek_gc_list *limbo;
+        hek_gc_list *sealed;
+        bool gc_sealed;
+        uint64_t *gc_snapshot;
+
+        /* Timestamp allocation state, see hek_ts_alloc. */
+        uint64_t ts_next;
+        uint64_t ts_limit;
+        uint64_t ts_last;
+        uint32_t ts_thread_bits;
+
         virtual void init_allocator();
         virtual struct hek_record* get_new_record(uint32_t table_id);
-        //        virtual void return_record(uint32_t table_id,
-        //                                   struct hek_record *record);
+        virtual void return_records(uint32_t table_id, hek_gc_list *list);
+
+        virtual void init_gc();
+        virtual void add_garbage(uint32_t table_id, hek_record *garbage);
+        virtual void announce_idle();
+        virtual uint64_t compute_watermark();
+        virtual bool snapshot_passed();
+        virtual void collect_garbage();
 
         virtual void abort_dependent(hek_action *aborted);
         virtual void commit_dependent(hek_action *committed);
         
         virtual void run_txn(hek_action *txn);
+        virtual void run_readonly(hek_action *txn);
+        virtual bool wait_for_writer(hek_key *key);
+        virtual bool validate_snapshot(hek_action *txn);
         virtual void get_reads(hek_action *txn);
         virtual void get_writes(hek_action *txn);
-        
-        virtual bool validate_single(hek_action *txn, hek_key *key);
-                             
-        virtual bool validate_reads(hek_action *txn);
+
+        /* 
+         * Specialized on the isolation level of the txn. Snapshot isolation 
+         * txns validate reads as of their begin timestamp, and abort on 
+         * write-write conflicts. Read committed txns only validate reads of 
+         * versions which were not yet committed, as commit dependencies.
+         */
+        template<isolation_level L> void run_isolated(hek_action *txn);
+        template<isolation_level L>
+        bool validate_single(hek_action *txn, hek_key *key);
+        template<isolation_level L> bool validate_reads(hek_action *txn);
         //        virtual bool validate(hek_action *txn);
 
-        virtual bool insert_writes(hek_action *txn);                
+        template<isolation_level L> bool insert_writes(hek_action *txn);
         virtual void remove_writes(hek_action *txn);
         virtual void install_writes(hek_action *txn);
         virtual void check_dependents();
@@ -88,7 +172,11 @@ class hek_worker : public Runnable {
         virtual bool add_commit_dep(hek_action *out, hek_key *key,
                                     hek_action *in, uint64_t txn_ts);
                                                                         
+        virtual void init_timestamps();
+        virtual uint64_t lease_timestamp();
+        virtual uint64_t clock_timestamp();
         virtual uint64_t get_timestamp();
+        virtual uint64_t end_timestamp();
         virtual void do_abort(hek_action *txn);
         virtual void do_commit(hek_action *txn);
 
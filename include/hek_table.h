@@ -2,11 +2,18 @@
 #define HEK_TABLE_H_
 
 #include <stdint.h>
+#include <db.h>
 
 struct hek_record;
 
+/*
+ * Versions of a key, newest first. There is no latch, a writer owns the latest
+ * committed version once it swaps its txn pointer into the version's end 
+ * timestamp (see insert_version). Only the owner changes the slot until the 
+ * write commits or aborts. Readers never block, and unlinked versions are only
+ * reused once no reader can hold them, see hek_worker::collect_garbage.
+ */
 struct hek_table_slot {
-        volatile uint64_t latch;
         volatile hek_record *records;
 } __attribute__((__aligned__(64)));
 
@@ -30,12 +37,16 @@ class hek_table {
                                   uint64_t *begin_ts,
                                   uint64_t *txn_ts);
         hek_record* stable_next(uint64_t key, hek_record *iter);                
+        hek_record* unlink_garbage(hek_record *prev, uint64_t watermark);
 
  public:
         hek_table(uint64_t num_slots, int cpu_start, int cpu_end);
         hek_record* get_version(uint64_t key, uint64_t ts, uint64_t *begin_ts,
                                 uint64_t *txn_ts);
-        bool insert_version(hek_record *record, uint64_t txn_begin);
+        template<isolation_level L>
+        bool insert_version(hek_record *record, uint64_t txn_begin,
+                            uint64_t txn_end, uint64_t gc_watermark,
+                            hek_record **garbage);
         void remove_version(hek_record *record);
         void finalize_version(hek_record *record, uint64_t ts);
         void force_insert(hek_record *record);
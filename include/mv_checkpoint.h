@@ -0,0 +1,111 @@
+#ifndef         MV_CHECKPOINT_H_
+#define         MV_CHECKPOINT_H_
+
+#include <runnable.hh>
+#include <mv_table.h>
+#include <executor.h>
+
+#include <functional>
+#include <string>
+
+/*
+ * Checkpoints of the multiversion engine. A checkpoint is the state of the
+ * database at the end of an epoch, read by a background thread straight out
+ * of the schedulers' partitions while they and the executors keep running.
+ * Loading a checkpoint at startup takes the place of the loader transactions,
+ * and bounds how much of a command log must be replayed.
+ *
+ * On disk, a checkpoint is one file per table made of a header followed by
+ * the table's records, each stored as its key and then its payload. A
+ * manifest naming the checkpoint's epoch is written once every table is
+ * durable, so a partially written checkpoint is never used.
+ */
+
+struct mv_checkpoint_header {
+        uint32_t epoch;
+        uint32_t table_id;
+        uint64_t record_size;
+        uint64_t num_records;
+};
+
+struct mv_checkpoint_manifest {
+        uint32_t epoch;
+        uint32_t num_tables;
+};
+
+typedef std::function<void(uint32_t table_id, uint64_t key,
+                           const char *value)> mv_load_fn;
+
+struct MVCheckpointerConfig {
+        int cpu;
+        const char *dir;
+        /* Time from the end of one checkpoint to the start of the next. */
+        uint32_t interval_ms;
+        uint32_t numTables;
+        uint64_t *recordSizes;
+        /* numPartitions partitions of each table, table after table. */
+        uint32_t numPartitions;
+        MVTablePartition **partitions;
+        /* Shared with the executors, see MV_CKPT_IDLE. */
+        volatile uint32_t *checkpointPtr;
+        volatile uint32_t *lowWaterMarkPtr;
+};
+
+/*
+ * Periodically checkpoints the database. A checkpoint asks the leader
+ * executor for an epoch, and waits for every executor to finish it. Until the
+ * checkpoint is written, the low-water mark is held at that epoch so that
+ * garbage collection leaves alone the versions visible at its end, and RMWs
+ * copy rather than take over the payloads of earlier versions. Neither the
+ * schedulers nor the executors wait on the checkpointer.
+ */
+class MVCheckpointer : public Runnable {
+ private:
+        MVCheckpointerConfig config;
+        uint32_t last_epoch;
+        char *buf;
+        uint64_t buf_len;
+
+        uint32_t Pin();
+        void Unpin();
+        void WriteTable(uint32_t table_id, uint32_t epoch);
+        void WriteManifest(uint32_t epoch);
+        void Flush(int fd);
+
+ protected:
+        virtual void StartWorking();
+        virtual void Init();
+
+ public:
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        MVCheckpointer(MVCheckpointerConfig config);
+
+        /* Takes a single checkpoint. Returns its epoch. */
+        uint32_t Checkpoint();
+
+        /*
+         * Writes out the versions visible at the end of epoch, and removes
+         * the previous checkpoint. None of them may be garbage collected
+         * while this runs.
+         */
+        void Write(uint32_t epoch);
+
+        /*
+         * Calls fn on every record of the checkpoint in dir. Returns the
+         * checkpoint's epoch.
+         */
+        static uint32_t Read(const char *dir, mv_load_fn fn);
+
+        /* Reads the manifest of the checkpoint in dir. */
+        static mv_checkpoint_manifest ReadManifest(const char *dir);
+
+        /* The file holding a table's records in the checkpoint of epoch. */
+        static std::string TableFile(const char *dir, uint32_t epoch,
+                                     uint32_t table_id);
+};
+
+#endif          // MV_CHECKPOINT_H_
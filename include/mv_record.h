@@ -13,6 +13,15 @@ class Record;
 
 typedef struct _MVRecord_ MVRecord;
 
+/* 
+ * Not packed; every field is naturally aligned anyway, and doneReaders is 
+ * updated atomically so it must stay that way. 
+ *
+ * tableId, numReaders and doneReaders grew a version from 76 to 96 bytes, so 
+ * an allocator of a given size holds about a fifth fewer versions. They let 
+ * the executor that writes a version attach a payload from its own pool, and 
+ * an RMW take over its predecessor's payload instead of copying it.
+ */
 struct _MVRecord_ {
   
         static uint64_t INFINITY;        
@@ -25,7 +34,9 @@ struct _MVRecord_ {
         // record.
         mv_action *writer;
         
-        // The actual value of the record.
+        // The record's payload. Versions are allocated by scheduler threads 
+        // without a payload; the executor running the writer attaches one from 
+        // its own pool before the writer runs.
         Record *value;        
 
         MVRecord *link;        
@@ -33,8 +44,21 @@ struct _MVRecord_ {
         MVRecord *epoch_ancestor;
         MVRecord *allocLink;
 
+        // Number of transactions the scheduler has directed to read this 
+        // version, and how many of them have finished running. Once they are 
+        // equal, an RMW of the record may take over the payload instead of 
+        // copying it.
+        uint64_t numReaders;
+        volatile uint64_t doneReaders;
+
+        // The table the version belongs to, and the executor whose pool the 
+        // payload was allocated from.
+        uint32_t tableId;
         uint32_t writingThread;
-} __attribute__((__packed__));
+};
+
+static_assert(sizeof(MVRecord) == 96, 
+              "MVRecord size changed, revisit the allocator sizes");
 
 /*
  * MVRecords are returned to the allocator (defined below) in bulk using this 
@@ -3,7 +3,20 @@
 
 #include <mv_record.h>
 #include <mv_action.h>
+#include <machine.h>
 
+#include <functional>
+
+/*
+ * Index structures a table partition can use to map keys to their version
+ * chains. The index is picked per table when the scheduler threads are set up.
+ */
+enum MVIndexType {
+  MV_CHAINED_INDEX = 0,
+  MV_BUCKETED_INDEX,
+};
+
+typedef std::function<void(MVRecord *version)> mv_scan_fn;
 
 /*
  * Single-writer hash table. Each scheduler thread contains a unique 
@@ -11,21 +24,37 @@
  */
 class MVTablePartition {
         
- private:
+ protected:
   MVRecordAllocator *allocator;
-  uint64_t numSlots;
-  MVRecord **tableSlots;
+
+  // Allocate and initialize a new version of pkey produced by action.
+  MVRecord* NewVersion(const CompositeKey &pkey, mv_action *action,
+                       uint64_t version);
+
+  // Make toAdd the newest version of the record whose current newest version
+  // is prev. prev may be NULL if toAdd is the record's first version.
+  static void LinkVersion(MVRecord *toAdd, MVRecord *prev);
+
+  // Walk a record's version chain starting at its newest version, and return
+  // the version visible at timestamp version, or NULL if no such version.
+  static MVRecord* FindVersion(MVRecord *head, uint64_t version);
         
  public:
 
       void* operator new (std::size_t sz, int cpu) {
             return alloc_mem(sz, cpu);
       }
-  // Constructor. 
+
+  // Create a partition of the given index type.
   //
-  // param size: Number of slots in the hash table.
+  // param type: Index structure to use for the partition.
+  // param size: Number of records we expect the partition to hold.
   // param alloc: Allocator to use for creating MVRecords.
-  MVTablePartition(uint64_t size, int cpu, MVRecordAllocator *alloc);     
+  static MVTablePartition* Create(MVIndexType type, uint64_t size, int cpu,
+                                  MVRecordAllocator *alloc);
+
+  MVTablePartition(MVRecordAllocator *alloc);
+  virtual ~MVTablePartition() {}
         
   // Get the latest version for the given primary key. If we're unable to find
   // a live instance of the record, return false. Otherwise, return true.
@@ -44,18 +73,102 @@ class MVTablePartition {
   // param version: Version of the record to write out.
   // 
   // return value: true if the write is successful, false otherwise. 
-  bool WriteNewVersion(CompositeKey &pkey, mv_action *action, uint64_t version);
+  virtual bool WriteNewVersion(CompositeKey &pkey, mv_action *action,
+                               uint64_t version) = 0;
 
 
-  MVRecord* GetMVRecord(const CompositeKey &pkey, uint64_t version);
+  virtual MVRecord* GetMVRecord(const CompositeKey &pkey, uint64_t version) = 0;
 
-  
+  // Prefetch the index entry pkey hashes to. Used by the scheduler to overlap
+  // the index misses of upcoming transactions with useful work.
+  virtual void PrefetchSlot(const CompositeKey &pkey) = 0;
+
+  // Prefetch the newest version of pkey. Reads the index entry, so it should
+  // only be called once a PrefetchSlot on the same key has had time to land.
+  virtual void PrefetchHead(const CompositeKey &pkey) = 0;
+
+  // Call fn on the version of every key visible at timestamp version. Safe to
+  // run on a thread other than the partition's scheduler, as long as none of
+  // the versions visible at version, or written after it, are recycled while
+  // the scan is in progress. Keys inserted during the scan may be missed.
+  virtual void Scan(uint64_t version, mv_scan_fn fn) = 0;
   
   //  void WritePartition();
         
   //  MVRecordAllocator* GetAlloc();
 };
 
+/*
+ * Chained hash table. Each slot points to a list of packed MVRecords, one per
+ * key, linked through MVRecord::link. Every key on a slot's list costs a
+ * dependent cache miss.
+ */
+class MVChainedPartition : public MVTablePartition {
+
+ private:
+  uint64_t numSlots;
+  MVRecord **tableSlots;
+
+ public:
+
+  // Constructor.
+  //
+  // param size: Number of slots in the hash table.
+  // param alloc: Allocator to use for creating MVRecords.
+  MVChainedPartition(uint64_t size, int cpu, MVRecordAllocator *alloc);
+
+  virtual bool WriteNewVersion(CompositeKey &pkey, mv_action *action,
+                               uint64_t version);
+  virtual MVRecord* GetMVRecord(const CompositeKey &pkey, uint64_t version);
+  virtual void PrefetchSlot(const CompositeKey &pkey);
+  virtual void PrefetchHead(const CompositeKey &pkey);
+  virtual void Scan(uint64_t version, mv_scan_fn fn);
+};
+
+#define MV_BUCKET_SLOTS 6
+
+/*
+ * A single cache line of the bucketed index. Each slot keeps a 16-bit
+ * fingerprint of its key's hash next to a pointer to the key's newest
+ * version, so a probe only dereferences a version whose fingerprint matches.
+ */
+struct MVBucket {
+        uint16_t fingerprints[MV_BUCKET_SLOTS];
+        uint16_t count;
+        MVRecord *heads[MV_BUCKET_SLOTS];
+} __attribute__((__aligned__(CACHE_LINE)));
+
+/*
+ * Open-addressing hash table made of cache line sized buckets. A key whose
+ * home bucket is full is placed in the next bucket with a free slot (linear
+ * probing over buckets). Keys are never removed from the index, so a bucket
+ * with a free slot terminates a probe.
+ */
+class MVBucketedPartition : public MVTablePartition {
+
+ private:
+  uint64_t numBuckets;
+  MVBucket *buckets;
+
+  MVRecord** FindHead(const CompositeKey &pkey, bool insert);
+
+ public:
+
+  // Constructor.
+  //
+  // param size: Number of records we expect the partition to hold. The index
+  //             is sized to keep buckets at most half full on average.
+  // param alloc: Allocator to use for creating MVRecords.
+  MVBucketedPartition(uint64_t size, int cpu, MVRecordAllocator *alloc);
+
+  virtual bool WriteNewVersion(CompositeKey &pkey, mv_action *action,
+                               uint64_t version);
+  virtual MVRecord* GetMVRecord(const CompositeKey &pkey, uint64_t version);
+  virtual void PrefetchSlot(const CompositeKey &pkey);
+  virtual void PrefetchHead(const CompositeKey &pkey);
+  virtual void Scan(uint64_t version, mv_scan_fn fn);
+};
+
 /*
  * MVTable is just a convenience class that wraps on top of MVTablePartition.
  * Scheduler and worker threads do not directly call MVTablePartition table 
@@ -7,19 +7,14 @@
 #include <occ_action.h>
 #include <exception>
 #include <record_buffer.h>
+#include <occ_log.h>
+#include <occ_retry.h>
 
 struct OCCActionBatch {
         uint32_t batchSize;
         OCCAction **batch;
 };
 
-struct occ_log_header {
-        uint32_t table_id;
-        uint64_t key;
-        uint64_t tid;
-        uint32_t record_len;
-};
-
 struct OCCWorkerConfig {
         SimpleQueue<OCCActionBatch> *inputQueue;
         SimpleQueue<OCCActionBatch> *outputQueue;
@@ -33,6 +28,15 @@ struct OCCWorkerConfig {
         uint64_t log_size;
         bool globalTimestamps;
         uint32_t num_tables;
+        /* NULL disables logging. See occ_log.h. */
+        OCCLogBuffer *log;
+        /* 
+         * Consume input batches indefinitely, deferring aborted 
+         * transactions as retry decides. Otherwise run the fixed batches of
+         * a measurement.
+         */
+        bool continuous;
+        OCCRetryConfig retry;
 };
 
 
@@ -44,12 +48,20 @@ class OCCWorker : public Runnable {
         uint32_t last_epoch;
         uint32_t txn_counter;
         RecordBuffers *bufs;
+        OCCRetryPolicy *retry;
+        /* Why the last RunSingle aborted. */
+        validation_err_t last_err;
         
         virtual bool RunSingle(OCCAction *action);
+        template<isolation_level L> bool RunIsolated(OCCAction *action);
+        virtual void Defer(OCCAction **pending_list, OCCAction *action);
+        virtual void ContinuousRunner();
         virtual uint32_t exec_pending(OCCAction **action_list);
         virtual void UpdateEpoch();
         virtual void EpochManager();
         virtual void TxnRunner();
+        virtual OCCActionBatch NextBatch();
+        virtual void WaitDurable();
         
  protected:
         virtual void StartWorking();
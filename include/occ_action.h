@@ -5,6 +5,7 @@
 #include <table.h>
 #include <db.h>
 #include <record_buffer.h>
+#include <occ_log.h>
 
 #define TIMESTAMP_MASK (0xFFFFFFFFFFFFFFF0)
 #define EPOCH_MASK (0xFFFFFFFF00000000)
@@ -95,6 +96,7 @@ class OCCAction : public translator {
         OCCAction(const OCCAction&);
 
         RecordBuffers *record_alloc;
+        OCCLogBuffer *log;
         Table **tables;
         Table **lock_tables;
         uint64_t tid;
@@ -107,25 +109,50 @@ class OCCAction : public translator {
                                      void *record); 
         virtual void validate_single(occ_composite_key &comp_key);
         virtual void cleanup_single(occ_composite_key &comp_key);
-        virtual void install_single_write(occ_composite_key &comp_key);
+        template<isolation_level L>
+        void install_single_write(occ_composite_key &comp_key);
+        virtual void *read_in_place(occ_composite_key *comp_key);
         
  public:
         
         OCCAction(txn *txn);
         OCCAction *link;
+
+        /* 
+         * A transaction without writes reads records in place rather than 
+         * copying them, and only validates the TIDs it read (see 
+         * validate_read_only). Until then, its logic may see values which 
+         * are being overwritten.
+         */
+        bool read_only;
+
+        /* Retry state of a deferred transaction, see occ_retry.h. */
+        uint32_t retries;
+        uint64_t retry_at;
         
         virtual void *write_ref(uint64_t key, uint32_t table);
         virtual void *read(uint64_t key, uint32_t table);
         virtual int rand();
         
         virtual void set_allocator(RecordBuffers *buf);
+        virtual void set_log(OCCLogBuffer *log);
         virtual void set_tables(Table **tables, Table **lock_tables);
 
         virtual bool run();
-        virtual void acquire_locks();
         virtual void validate();
+        virtual void validate_read_only();
         virtual uint64_t compute_tid(uint32_t epoch, uint64_t last_tid);
-        virtual void install_writes();
+
+        /* 
+         * Specialized on the isolation level of the txn, which is one of 
+         * ISOLATION_SERIALIZABLE or ISOLATION_READ_COMMITTED. Serializable 
+         * txns lock the records they write until they validate and install 
+         * them. Read committed txns don't validate, they lock the writes in 
+         * lock_tables to order them, and only hold the record's lock while 
+         * copying in a write.
+         */
+        template<isolation_level L> void acquire_locks();
+        template<isolation_level L> void install_writes();
         virtual void release_locks();
         virtual void cleanup();
         
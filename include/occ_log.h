@@ -0,0 +1,192 @@
+#ifndef         OCC_LOG_H_
+#define         OCC_LOG_H_
+
+#include <runnable.hh>
+#include <concurrent_queue.h>
+#include <table.h>
+#include <machine.h>
+
+/*
+ * Redo logging for OCC with epoch based group commit (as in Silo).
+ *
+ * Every worker appends a record (occ_log_header followed by the value) for
+ * each write it installs into its own OCCLogBuffer. A buffer is made of 
+ * segments which only ever hold records of a single epoch. Segments are 
+ * handed to the logger of the worker when they fill up, when the worker 
+ * starts committing in a new epoch, or when the worker is idle.
+ *
+ * Every worker publishes log_epoch: all of its commits in earlier epochs 
+ * have been handed off, and all of its future commits happen in log_epoch 
+ * or later. A logger writes the segments of its workers to its own file 
+ * (a block per segment), fsyncs, and then knows that all epochs below the 
+ * minimum log_epoch of its workers are durable. Logger 0 persists the 
+ * minimum over all of the loggers in occ_durable_epoch. 
+ *
+ * Workers release the results of transactions only once the persisted
+ * bound is above their epoch, so a single fsync commits all of the 
+ * transactions of an epoch.
+ */
+
+struct occ_log_header {
+        uint32_t table_id;
+        uint64_t key;
+        uint64_t tid;
+        uint32_t record_len;
+};
+
+/* 
+ * The checksum covers the rest of the header and the block's records, so 
+ * that recovery can tell torn or zero-filled blocks from real ones. 
+ */
+struct occ_log_block_header {
+        uint32_t epoch;
+        uint32_t worker;
+        uint64_t len;
+        uint64_t checksum;
+};
+
+struct occ_log_segment {
+        uint32_t epoch;
+        uint64_t len;
+        char *data;
+};
+
+struct OCCLogConfig {
+        const char *dir;
+        uint32_t num_workers;
+        uint32_t num_loggers;
+        /* Bytes of log buffer per worker, split among segments. */
+        uint64_t buffer_size;
+        uint32_t segments_per_worker;
+        /* Loggers are pinned to consecutive cpus starting here. */
+        int first_logger_cpu;
+        /* 
+         * The durable epoch Recover returned. The log in dir is appended to, 
+         * and every commit must be in this epoch or later. 0 starts a new log.
+         */
+        uint32_t recovered_epoch;
+};
+
+class OCCLogBuffer {
+        friend class OCCLogger;
+
+ private:
+        uint32_t worker_id;
+        uint64_t segment_size;
+        occ_log_segment *cur;
+        SimpleQueue<occ_log_segment*> *full_segs;
+        SimpleQueue<occ_log_segment*> *free_segs;
+        volatile uint32_t *durable_epoch_ptr;
+        char pad_worker[CACHE_LINE];
+        
+        volatile uint64_t log_epoch;
+        char pad_epoch[CACHE_LINE];
+
+        void HandOff();
+        void PublishEpoch(uint32_t epoch);
+        
+ public:
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        OCCLogBuffer(uint32_t worker_id, uint64_t segment_size,
+                     uint32_t num_segments, volatile uint32_t *durable_epoch_ptr,
+                     int cpu);
+
+        /* Called before the writes of a transaction committing in epoch. */
+        virtual void BeginCommit(uint32_t epoch);
+        virtual void Append(uint32_t table_id, uint64_t key, uint64_t tid,
+                            void *value, uint32_t len);
+        /* 
+         * Called while the worker does not commit. epoch must have been read
+         * from the global epoch after the last commit.
+         */
+        virtual void Refresh(uint32_t epoch);
+        virtual bool IsDurable(uint32_t epoch);
+        virtual uint64_t LogEpoch();
+};
+
+class OCCLog;
+
+class OCCLogger : public Runnable {
+ private:
+        uint32_t logger_id;
+        OCCLog *log;
+        int fd;
+        OCCLogBuffer **buffers;
+        uint32_t num_buffers;
+        volatile uint64_t stop;
+        char pad_stop[CACHE_LINE];
+        
+        volatile uint64_t durable_epoch;
+        char pad_durable[CACHE_LINE];
+
+        void WriteAll(const char *data, uint64_t len);
+        
+ protected:
+        virtual void StartWorking();
+        virtual void Init();
+        
+ public:
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        OCCLogger(uint32_t logger_id, OCCLog *log, const char *dir,
+                  bool append, OCCLogBuffer **buffers, uint32_t num_buffers,
+                  int cpu);
+
+        /* Writes out the handed off segments. Returns the number written. */
+        virtual uint32_t FlushRound();
+        /* All epochs below the returned one are durable within this log. */
+        virtual uint64_t DurableEpoch();
+        virtual void Stop();
+};
+
+class OCCLog {
+ private:
+        OCCLogConfig config;
+        OCCLogBuffer **buffers;
+        OCCLogger **loggers;
+        int epoch_fd;
+        volatile uint32_t durable_epoch;
+        char pad_durable[CACHE_LINE];
+
+        void PersistDurableEpoch();
+        
+ public:
+        OCCLog(OCCLogConfig config);
+
+        OCCLogBuffer* GetBuffer(uint32_t worker);
+        void Run();
+        /* Flushes everything handed off and stops the loggers. */
+        void Stop();
+        /* All epochs below the returned one are durable. */
+        uint32_t DurableEpoch();
+
+        /* 
+         * Called by logger 0 after every round. Persists the minimum durable 
+         * epoch over all loggers.
+         */
+        void UpdateDurableEpoch();
+
+        /* 
+         * Rebuilds the contents of tables from the log in dir. Only epochs 
+         * below the persisted durable epoch are replayed and the write with 
+         * the highest tid wins. Must run before the tables are SetInit. 
+         * Returns the number of records applied, and the durable epoch in 
+         * durable_epoch.
+         *
+         * Blocks which are not durable are dropped from the log, so that it 
+         * can be appended to by an OCCLog given the durable epoch. So is 
+         * everything from the first block whose checksum doesn't match on.
+         */
+        static uint64_t Recover(const char *dir, uint32_t num_loggers,
+                                Table **tables, uint32_t num_tables,
+                                uint32_t *durable_epoch);
+};
+
+#endif          // OCC_LOG_H_
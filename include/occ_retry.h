@@ -0,0 +1,72 @@
+#ifndef         OCC_RETRY_H_
+#define         OCC_RETRY_H_
+
+#include <occ_action.h>
+#include <cpuinfo.h>
+#include <stdint.h>
+
+/*
+ * Contention management for OCC workers which run continuously.
+ *
+ * An aborted transaction is not retried right away. It is deferred for a
+ * number of cycles which depend on why it aborted, and how often the worker
+ * has recently aborted for that reason:
+ *
+ *    READ_ERR -- a writer was installing the record while it was read. The
+ *                writer is done within a commit, so the delay only grows
+ *                linearly with the retries of the transaction, scaled by
+ *                the worker's rate of read failures.
+ *    VALIDATION_ERR -- a record read changed before commit. On a hot record
+ *                an immediate retry mostly fails the same way, so the delay
+ *                doubles with every retry, scaled by the worker's rate of
+ *                validation failures. Without contention the rate is close
+ *                to zero, and transactions are retried immediately.
+ *
+ * While transactions are deferred the worker moves on to the next ones in
+ * its input, so hot transactions are reordered behind cold ones.
+ */
+
+/* Abort rates are fixed point fractions of OCC_RETRY_ONE. */
+#define OCC_RETRY_ONE (((uint64_t)1)<<16)
+
+/* Weight of the newest outcome in the moving average, as a shift. */
+#define OCC_RETRY_DECAY 5
+
+struct OCCRetryConfig {
+        /* Maximum number of deferred transactions. */
+        uint32_t window;
+        /* Delays are in cycles. */
+        uint64_t base_delay;
+        uint64_t max_delay;
+};
+
+class OCCRetryPolicy {
+ private:
+        OCCRetryConfig config;
+        uint64_t read_rate;
+        uint64_t validation_rate;
+
+        static void update(uint64_t *rate, bool aborted);
+
+ public:
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        OCCRetryPolicy(OCCRetryConfig config);
+
+        /* Record an attempt which committed. */
+        void Committed();
+
+        /*
+         * Record an attempt which aborted, the retries'th of its transaction.
+         * Returns the number of cycles to defer the transaction for.
+         */
+        uint64_t Aborted(validation_err_t err, uint32_t retries);
+
+        uint64_t ReadRate();
+        uint64_t ValidationRate();
+};
+
+#endif          // OCC_RETRY_H_
@@ -73,6 +73,8 @@ struct MVSchedulerConfig {
   size_t allocatorSize;         // Scheduler thread's local sticky allocator
   uint32_t numTables;           // Number of tables in the system
   size_t *tblPartitionSizes;    // Size of each table's partition
+  MVIndexType *tblIndexTypes;   // Index structure of each table's partition
+  uint32_t prefetchWindow;      // Actions to prefetch ahead, 0 disables
   
   uint32_t numOutputs;
         
@@ -126,6 +128,8 @@ class MVScheduler : public Runnable {
         virtual void StartWorking();
         void ProcessWriteset(mv_action *action);
         void ScheduleTransaction(mv_action *action);
+        void PrefetchAction(mv_action *action, bool heads);
+        void ScheduleBatch(const ActionBatch &batch);
         //    void Leader(uint32_t epoch);
         //    void Subordinate(uint32_t epoch);
     virtual void Init();
@@ -154,6 +158,17 @@ class MVScheduler : public Runnable {
 
         static uint32_t NUM_CC_THREADS;
         MVScheduler(MVSchedulerConfig config);
+
+        /* 
+         * The scheduler's partition of a table. Other threads may only scan 
+         * it (see MVTablePartition::Scan), or write to it before the 
+         * scheduler runs.
+         */
+        MVTablePartition* GetPartition(uint32_t tableId)
+        {
+                assert(tableId < config.numTables);
+                return partitions[tableId];
+        }
 };
 
 
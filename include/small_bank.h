@@ -31,9 +31,13 @@ namespace SmallBank {
         public:
                 LoadCustomerRange(uint64_t customer_start,
                                   uint64_t customer_end);
+                LoadCustomerRange(std::vector<uint64_t> customers,
+                                  std::vector<long> balances);
                 virtual bool Run();
                 virtual uint32_t num_writes();
                 virtual void get_writes(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };
         
         class Balance : public txn {
@@ -45,6 +49,8 @@ namespace SmallBank {
                 virtual bool Run();
                 virtual uint32_t num_reads();
                 virtual void get_reads(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };
 
         class DepositChecking : public txn {
@@ -57,6 +63,8 @@ namespace SmallBank {
                 virtual bool Run();
                 virtual uint32_t num_rmws();
                 virtual void get_rmws(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };
 
         class TransactSaving : public txn {    
@@ -69,6 +77,8 @@ namespace SmallBank {
                 virtual bool Run();
                 virtual uint32_t num_rmws();
                 virtual void get_rmws(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };
 
         class Amalgamate : public txn {
@@ -80,6 +90,8 @@ namespace SmallBank {
                 virtual bool Run();
                 virtual uint32_t num_rmws();
                 virtual void get_rmws(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };
   
         class WriteCheck : public txn {
@@ -94,6 +106,8 @@ namespace SmallBank {
                 virtual uint32_t num_rmws();
                 virtual void get_reads(struct big_key *array);
                 virtual void get_rmws(struct big_key *array);
+                virtual txn_type get_type();
+                virtual void get_params(std::vector<uint64_t> *params);
         };  
 };
 
@@ -72,6 +72,28 @@ class Table {
     //    memset(default_value->value, 0x0, conf.valueSz);
   }
 
+  uint64_t NumBuckets()
+  {
+          return conf.numBuckets;
+  }
+
+  uint64_t BucketOf(uint64_t key)
+  {
+          return Hash128to64(std::make_pair(conf.tableId, key)) % 
+                  conf.numBuckets;
+  }
+
+  /* 
+   * Link in a record allocated by the caller. Used by bulk loading, which 
+   * inserts into disjoint ranges of buckets concurrently.
+   */
+  void Insert(TableRecord *rec)
+  {
+          uint64_t index = BucketOf(rec->key);
+          rec->next = buckets[index];
+          buckets[index] = rec;
+  }
+
   virtual void PutEmpty(uint64_t key)
   {
     uint64_t index = 
@@ -34,7 +34,7 @@ public:
 
   DBTestHelper():
     db_conf({{}}),
-    sched_conf({0,0,0,0,3}),
+    sched_conf({0,0,0,0,3,1}),
     exec_conf({0, 0}),
     action_num(0)
   {};
@@ -45,6 +45,10 @@ public:
     }  
     return *this;
   };
+  DBTestHelper& set_db_conf(DBStorageConfig conf) {
+    db_conf = conf;
+    return *this;
+  };
   DBTestHelper& set_exec_thread_num(unsigned int threads) {
     exec_conf.executing_threads_count = threads; 
     return *this;
@@ -57,8 +61,12 @@ public:
     sched_conf.batch_size_act = size;
     return *this;
   };
-  DBTestHelper& set_batch_timeout(unsigned int sec) {
-    sched_conf.batch_length_sec = sec;
+  DBTestHelper& set_batch_timeout(unsigned int us) {
+    sched_conf.batch_timeout_us = us;
+    return *this;
+  };
+  DBTestHelper& set_packing_thread_num(unsigned int threads) {
+    sched_conf.packing_threads_count = threads;
     return *this;
   };
   DBTestHelper& set_merging_shard_num(unsigned int num) {
@@ -78,7 +86,8 @@ public:
   void runTest(DBAssertion assertion = [](IDBStorage* db){(void) db;}) {
     assert(test_properly_initialized());
     sched_conf.first_pin_cpu_id = 1;
-    exec_conf.first_pin_cpu_id = sched_conf.scheduling_threads_count + 1;
+    exec_conf.first_pin_cpu_id = 
+      sched_conf.scheduling_threads_count * sched_conf.packing_threads_count + 1;
 
     std::unique_ptr<ISupervisor> s = std::make_unique<SupervisorInterfaceChild>(
        db_conf, sched_conf, exec_conf);
@@ -17,16 +17,20 @@ public:
     signal_execution_threads_called ++;
   };
 
-  std::shared_ptr<LockStage> get_current_lock_holder_for(RecordKey key) override {
+  LockStage* get_current_lock_holder_for(RecordKey key) override {
     (void) key;
     get_current_lock_holder_for_called ++;
     return nullptr;
   };
 
-  void finalize_action(std::shared_ptr<IBatchAction> act) override {
+  void finalize_action(IBatchAction* act) override {
     (void) act;
     finalize_action_called ++;
   };
+
+  // batches are never actually executed.
+  uint64_t get_finished_batches_count() override { return 0; }
+  uint64_t get_started_batches_count() override { return 0; }
 };
 
 #endif // TEST_EXECUTOR_THREAD_MANAGER_H_
@@ -7,26 +7,33 @@
 class TestLockTable : public LockTable {
   public:
     TestLockTable(): LockTable() {};
+    TestLockTable(DBStorageConfig db_conf): LockTable(db_conf) {};
+
+    // hashed queues only.
     const LockTable::LockTableType& get_lock_table_data() {
       return lock_table;
     }
 
+    LockQueue* get_lock_queue(RecordKey k) {
+      return get_queue_for(k);
+    }
+
     bool lock_table_contains_stage(
         RecordKey k, 
-        std::shared_ptr<LockStage> ls) {
-      auto lq = lock_table.find(k);
-      if (lq == lock_table.end()) return false;
+        LockStage* ls) {
+      LockQueue* lq = get_queue_for(k);
+      if (lq == nullptr) return false;
 
       // look through the whole queue to see if we actually
       // have the correct stage in the queue
       //
       // We need to use the test lock stage class to access the type
       // of the lock easily.
-      std::shared_ptr<LockQueue::QueueElt> curr = lq->second.peek_head_elt();
+      LockStage* curr = lq->peek_head();
       while (curr != nullptr) {
-        if (*ls == **curr->get_contents()) return true;
+        if (*ls == *curr) return true;
 
-        curr = curr->get_next_elt();
+        curr = curr->get_next_stage();
       }
 
       return false;
@@ -14,6 +14,12 @@ barrier() {
   asm volatile("":::"memory");
 }
 
+// Orders earlier stores before later loads, which x86 otherwise doesn't.
+inline void
+fence() {
+  asm volatile("mfence":::"memory");
+}
+
 // An indivisible unit of work. 
 inline void
 single_work() 
@@ -128,6 +134,18 @@ fetch_and_decrement(volatile uint64_t *variable)
   return counter_value - 1;
 }    
 
+// Returns the new value, like fetch_and_increment.
+inline uint64_t
+fetch_and_add(volatile uint64_t *variable, uint64_t amount)
+{
+  uint64_t counter_value = amount;
+  asm volatile ("lock; xaddq %%rax, %1;"
+                : "=a" (counter_value), "+m" (*variable)
+                : "a" (counter_value)
+                : "memory");
+  return counter_value + amount;
+}
+
 
 
 // Use this function to read the timestamp counter. 
@@ -0,0 +1,93 @@
+#ifndef WAIT_STRATEGY_H_
+#define WAIT_STRATEGY_H_
+
+#include <stdint.h>
+
+/*
+ * How a thread waits for a word to be changed by another thread:
+ *
+ *    WAIT_SPIN -- re-check the word as fast as possible. Lowest latency,
+ *                 burns the core and starves a SMT sibling.
+ *    WAIT_BACKOFF -- PAUSE between the checks, doubling the number of PAUSEs
+ *                 up to a limit.
+ *    WAIT_PARK -- back off for a number of checks, then sleep on a futex
+ *                 until the writer wakes us up. Idle threads use no cpu, but
+ *                 waking up costs a system call on both sides.
+ *
+ * The default strategy is chosen at build time with -DWAIT_STRATEGY=<n>, and
+ * may be changed at run time with WaitStrategy::configure before any of the
+ * threads start waiting.
+ */
+#define WAIT_SPIN 0
+#define WAIT_BACKOFF 1
+#define WAIT_PARK 2
+
+#ifndef WAIT_STRATEGY
+#define WAIT_STRATEGY WAIT_SPIN
+#endif
+
+struct WaitStrategyConfig {
+  uint32_t strategy;
+  // the number of PAUSEs between checks stops doubling at this value.
+  uint32_t max_backoff;
+  // the number of checks before a parking thread goes to sleep.
+  uint32_t spin_budget;
+  // a parked thread re-checks the word at least this often, so that
+  // conditions without a wake up (e.g. stop signals) are still noticed.
+  uint32_t park_timeout_us;
+};
+
+class WaitStrategy {
+private:
+  static WaitStrategyConfig config;
+
+public:
+  static void configure(WaitStrategyConfig c);
+  static const WaitStrategyConfig& get_config() {
+    return config;
+  };
+
+  static const char* get_name(uint32_t strategy);
+};
+
+/*
+ * State of a single wait. Create one per wait loop and call wait each time
+ * the condition is found to be false:
+ *
+ *    Waiter w;
+ *    while ((seen = *word) == old)
+ *      w.wait(word, seen, &parked);
+ *
+ * word is the word the writer changes to end the wait. parked counts the
+ * threads sleeping on any of the words a writer changes, so that writers
+ * only make a system call when someone sleeps. Writers must call
+ * wake_parked after changing the word.
+ */
+class Waiter {
+private:
+  uint32_t checks;
+  uint32_t backoff;
+
+  void park(volatile uint64_t* word, uint64_t seen, volatile uint64_t* parked);
+
+public:
+  Waiter():
+    checks(0),
+    backoff(1)
+  {};
+
+  void wait(volatile uint64_t* word, uint64_t seen, volatile uint64_t* parked);
+  // Wait without a word to sleep on. Parking degrades to yielding the cpu.
+  void wait();
+};
+
+// Slow path of wake_parked.
+void wake_parked_slow(volatile uint64_t* word, volatile uint64_t* parked);
+
+inline void wake_parked(volatile uint64_t* word, volatile uint64_t* parked) {
+  if (WaitStrategy::get_config().strategy != WAIT_PARK) return;
+
+  wake_parked_slow(word, parked);
+}
+
+#endif // WAIT_STRATEGY_H_
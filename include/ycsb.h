@@ -13,13 +13,16 @@ class ycsb_insert : public txn {
         uint64_t start;
         uint64_t end;
 
-        void gen_rand(char *array);
-        
  public:
+        /* Fills array with the YCSB_RECORD_SIZE bytes of key's record. */
+        static void gen_rand(uint64_t key, char *array);
+
         ycsb_insert(uint64_t start, uint64_t end);
         virtual bool Run();
         virtual uint32_t num_writes();
         virtual void get_writes(struct big_key *array);
+        virtual txn_type get_type();
+        virtual void get_params(std::vector<uint64_t> *params);
 };
 
 class ycsb_readonly : public txn {
@@ -31,6 +34,8 @@ class ycsb_readonly : public txn {
         virtual bool Run();
         virtual uint32_t num_reads();
         virtual void get_reads(struct big_key *array);
+        virtual txn_type get_type();
+        virtual void get_params(std::vector<uint64_t> *params);
 };
 
 class ycsb_rmw : public txn {
@@ -45,6 +50,8 @@ class ycsb_rmw : public txn {
         virtual uint32_t num_rmws();
         virtual void get_reads(struct big_key *array);
         virtual void get_rmws(struct big_key *array);
+        virtual txn_type get_type();
+        virtual void get_params(std::vector<uint64_t> *params);
 };
 
 #endif // YCSB_H_
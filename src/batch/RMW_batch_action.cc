@@ -1,6 +1,7 @@
 #include "batch/RMW_batch_action.h"
 
 #include <cassert>
+#include <cstring>
 
 RMWBatchAction::RMWBatchAction(txn* t) : BatchAction(t) {};
 
@@ -22,18 +23,34 @@ void RMWBatchAction::add_write_key(RecordKey rk) {
 };
 
 void RMWBatchAction::Run(IDBStorage* db) {
-  do_reads(db);
-  do_writes(db);
+  BatchAction::Run(db);
+  do_reads();
+  do_writes();
 };
 
-void RMWBatchAction::do_reads(IDBStorage* db) {
-  auto read_for_set = [db, this](auto key_set_ptr){
+std::vector<char>* RMWBatchAction::get_thread_buffer() {
+  static thread_local std::vector<char> buffer;
+  return &buffer;
+};
+
+void RMWBatchAction::do_reads() {
+  std::vector<char>* buffer = get_thread_buffer();
+  uint64_t offset = 0;
+  auto read_for_set = [this, buffer, &offset](auto key_set_ptr){
     TmpReadMap::iterator it;
     for (const auto& key : *key_set_ptr) {
       it = tmp_reads.find(key);
       assert(it != tmp_reads.end());
-      assert(it->second == 0);
-      it->second = db->read_record_value(key);
+
+      uint64_t size = db->get_record_size(key.table_id);
+      assert(size >= sizeof(IDBStorage::RecordValue));
+      if (buffer->size() < offset + size) {
+        buffer->resize(2 * (offset + size));
+      }
+
+      memcpy(buffer->data() + offset, read(key.key, key.table_id), size);
+      it->second = offset;
+      offset += size;
     }
   };
 
@@ -41,12 +58,22 @@ void RMWBatchAction::do_reads(IDBStorage* db) {
   read_for_set(this->get_writeset_handle());
 };
 
-void RMWBatchAction::do_writes(IDBStorage* db) {
+void RMWBatchAction::do_writes() {
   auto write_set_handle = this->get_writeset_handle();
+  char* buffer = get_thread_buffer()->data();
   TmpReadMap::iterator it;
+  IDBStorage::RecordValue value;
   for (const auto& key : *write_set_handle) {
     it = tmp_reads.find(key);
     assert(it != tmp_reads.end());
-    db->write_record_value(key, it->second + 1); 
+
+    char* record = buffer + it->second;
+    memcpy(&value, record, sizeof(value));
+    value++;
+    memcpy(record, &value, sizeof(value));
+    memcpy(
+        write_ref(key.key, key.table_id), 
+        record, 
+        db->get_record_size(key.table_id));
   }
 };
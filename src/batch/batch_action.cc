@@ -20,22 +20,17 @@ void BatchAction::add_read_key(RecordKey rk) {
 
 void* BatchAction::write_ref(uint64_t key, uint32_t table) {
   RecordKey rk(key, table);
-  auto it = writeset.find(rk);
-  assert(it != writeset.end());//record must be part of this action
-  // TODO:
-  //    Do we need this anywhere?
-  //return it->record;
-  return nullptr;
+  assert(db != nullptr);
+  assert(writeset.find(rk) != writeset.end());//record must be part of this action
+  return db->write_ref(rk);
 }
 
 void* BatchAction::read(uint64_t key, uint32_t table) {
   RecordKey rk(key, table);
-  auto it = readset.find(rk);
-  assert(it != readset.end());
-  // TODO:
-  //    Do we need this anywhere?
-  // return it->record;
-  return nullptr;
+  assert(db != nullptr);
+  assert(readset.find(rk) != readset.end() || 
+      writeset.find(rk) != writeset.end());
+  return const_cast<void*>(db->read_ref(rk));
 };
 
 uint64_t BatchAction::notify_lock_obtained() {
@@ -82,5 +77,5 @@ int BatchAction::rand() {
 }
 
 void BatchAction::Run(IDBStorage* db) {
-  (void) db;
+  this->db = db;
 }
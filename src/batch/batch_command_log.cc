@@ -0,0 +1,65 @@
+#include "batch/batch_command_log.h"
+#include "batch/RMW_batch_action.h"
+#include "batch/noop_txn.h"
+
+#include <cassert>
+
+namespace BatchCommandLog {
+  // the number of reads followed by the (key, table) pairs of the reads
+  // and then of the writes.
+  static std::vector<uint64_t> get_params(IBatchAction* act) {
+    std::vector<uint64_t> params;
+    params.push_back(act->get_readset_size());
+    for (auto* set : {act->get_readset_handle(), act->get_writeset_handle()}) {
+      for (const auto& rk : *set) {
+        params.push_back(rk.key);
+        params.push_back(rk.table_id);
+      }
+    }
+
+    return params;
+  };
+
+  void append_batch(CommandLog* log, const Batch& batch, uint64_t batch_id) {
+    for (const auto& act : batch) {
+      log->AppendTxn(BATCH_RMW_TXN, get_params(act.get()));
+    }
+
+    log->EndBatch(batch_id);
+  };
+
+  std::unique_ptr<IBatchAction> create_action(const logged_txn& t) {
+    assert(t.type == BATCH_RMW_TXN);
+    assert(t.params.size() % 2 == 1);
+
+    std::unique_ptr<IBatchAction> act = 
+      std::make_unique<RMWBatchAction>(new NoopTxn());
+    uint64_t reads = t.params[0];
+    for (uint64_t i = 1; i < t.params.size(); i += 2) {
+      RecordKey rk(t.params[i], t.params[i + 1]);
+      if ((i - 1) / 2 < reads) {
+        act->add_read_key(rk);
+      } else {
+        act->add_write_key(rk);
+      }
+    }
+
+    return act;
+  };
+
+  std::vector<Batch> read_batches(const std::string& file_name) {
+    std::vector<Batch> batches;
+    CommandLog::Read(
+        file_name.c_str(),
+        [&batches](uint64_t, std::vector<logged_txn>& txns) {
+          Batch batch;
+          for (const auto& t : txns) {
+            batch.push_back(create_action(t));
+          }
+
+          batches.push_back(std::move(batch));
+        });
+
+    return batches;
+  };
+};
@@ -1,5 +1,10 @@
 #include "batch/db_storage.h"
+#include "cpuinfo.h"
+#include "machine.h"
 
+#include <numa.h>
+
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -7,38 +12,115 @@ DBStorage::DBStorage(DBStorageConfig db_conf) {
   preallocate_records(db_conf);
 }
 
-DBStorage::Data::iterator DBStorage::insert_elt(RecordKey key, RecordValue val) {
-  auto insert_res = data.insert(
-      std::make_pair(key, val));
-  // assert that insertion was successful
-  assert(insert_res.second);
+DBStorage::~DBStorage() {
+  for (auto& table : tables) {
+    if (table.records != nullptr) {
+      numa_free(
+          table.records, 
+          std::max(table.num_records, (uint64_t) 1) * table.stride);
+    }
+  }
+}
+
+inline char* DBStorage::get_record(RecordKey key) {
+  assert(key.table_id < tables.size());
+  Table& table = tables[key.table_id];
+  assert(table.records != nullptr);
+
+  if (table.dense_keys) {
+    assert(key.key < table.num_records);
+    return table.records + key.key * table.stride;
+  }
 
-  return insert_res.first;
+  auto res = table.index.find(key.key);
+  assert(res != table.index.end());
+  return res->second;
+}
+
+uint64_t DBStorage::bulk_load(
+    BulkLoadSource* source, int start_cpu, uint32_t num_threads) {
+  BulkLoaderConfig conf = {
+    start_cpu,
+    num_threads,
+    source,
+    nullptr,
+    [this](uint32_t, uint32_t table_id, uint64_t key, const char* value,
+        uint64_t size) {
+      BulkLoader::CopyValue(
+          get_record({key, table_id}), get_record_size(table_id), value, size);
+    }
+  };
+
+  BulkLoader loader(conf);
+  return loader.Load();
 }
 
 DBStorage::RecordValue DBStorage::read_record_value(RecordKey key) {
-  auto res = data.find(key);
-  assert(res != data.end());
+  assert(get_record_size(key.table_id) >= sizeof(RecordValue));
 
-  return res->second;
+  RecordValue value;
+  memcpy((void*) &value, (const void*) get_record(key), sizeof(RecordValue));
+  return value;
 };
 
 void DBStorage::write_record_value(RecordKey key, RecordValue value) {
-  auto elt = data.find(key);
-  // we assume all of the records are inside the db from get go
-  if (elt == data.end()) {
-    assert(false);
-  }
-  
-  // avoid using any writes of std::unordered_map to guarantee
-  // that we are not changing the structure of the map.
-  memcpy((void*) &elt->second, (const void*) &value, sizeof(RecordValue));
+  assert(get_record_size(key.table_id) >= sizeof(RecordValue));
+
+  memcpy((void*) get_record(key), (const void*) &value, sizeof(RecordValue));
+}
+
+const void* DBStorage::read_ref(RecordKey key) {
+  return get_record(key);
+}
+
+void* DBStorage::write_ref(RecordKey key) {
+  return get_record(key);
+}
+
+uint64_t DBStorage::get_record_size(uint64_t table_id) {
+  assert(table_id < tables.size());
+  return tables[table_id].record_size;
 }
 
 void DBStorage::preallocate_records(DBStorageConfig conf) {
+  uint64_t max_table_id = 0;
   for (auto& table_conf : conf.tables_definitions) {
-    for (uint64_t i = 0; i < table_conf.num_records; i++) {
-      insert_elt({i, table_conf.table_id}, 0);
+    max_table_id = std::max(max_table_id, table_conf.table_id);
+  }
+
+  tables.resize(max_table_id + 1);
+  for (auto& table : tables) {
+    table.records = nullptr;
+  }
+
+  for (auto& table_conf : conf.tables_definitions) {
+    Table& table = tables[table_conf.table_id];
+    // every table may only be defined once.
+    assert(table.records == nullptr);
+    assert(table_conf.record_size > 0);
+
+    table.num_records = table_conf.num_records;
+    table.record_size = table_conf.record_size;
+    table.stride = 
+      (table_conf.record_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    table.dense_keys = table_conf.dense_keys;
+    assert(table_conf.keys.empty() || 
+        (!table.dense_keys && table_conf.keys.size() == table.num_records));
+
+    // allocations are page aligned and therefore cache line aligned.
+    uint64_t size = std::max(table.num_records, (uint64_t) 1) * table.stride;
+    table.records = (char*) alloc_interleaved_all(size);
+    memset(table.records, 0x00, size);
+
+    if (table.dense_keys) continue;
+
+    table.index.reserve(table.num_records);
+    for (uint64_t i = 0; i < table.num_records; i++) {
+      auto insert_res = table.index.insert(
+          std::make_pair(
+            table_conf.get_key(i), table.records + i * table.stride));
+      // assert that insertion was successful
+      assert(insert_res.second);
     }
   }
 };
@@ -5,7 +5,9 @@
 BatchExecutor::BatchExecutor(
       ExecutorThreadManager* manager, 
       int m_cpu_number):
-    ExecutorThread(manager, m_cpu_number) {
+    ExecutorThread(manager, m_cpu_number),
+    started_batches(0),
+    finished_batches(0) {
   this->input_queue = std::make_unique<ExecutorQueue>();;
   this->output_queue = std::make_unique<ExecutorQueue>();
   this->pending_list = std::make_unique<PendingList>();
@@ -16,13 +18,19 @@ void BatchExecutor::StartWorking() {
     // get a batch to execute or busy wait until we may do that
     currentBatch.reset(nullptr);
 
+    Waiter w;
     while(input_queue->is_empty()) {
       if (is_stop_requested()) return; 
+      input_queue->wait_for_push(w);
     }
     currentBatch = std::move(input_queue->peek_head());
     input_queue->pop_head();
 
+    // Lock stages may only be freed once we are done with the batch. 
+    // The increments must be visible before we look at any lock stage.
+    fetch_and_increment(&started_batches);
     process_action_batch();
+    fetch_and_increment(&finished_batches);
   }
 };
 
@@ -44,7 +52,7 @@ void BatchExecutor::process_action_batch() {
     process_pending();
 
     assert(currentBatch->at(i) != nullptr);
-    if (!process_action(currentBatch->at(i))) {
+    if (!process_action(currentBatch->at(i).get())) {
       pending_list->push_back(currentBatch->at(i));        
       pending_list->size();
     } 
@@ -59,7 +67,7 @@ void BatchExecutor::process_action_batch() {
   output_queue->push_tail(std::move(currentBatch));
 };
 
-bool BatchExecutor::process_action(std::shared_ptr<IBatchAction> act) {
+bool BatchExecutor::process_action(IBatchAction* act) {
   assert(act != nullptr);
 
   uint64_t action_state = act->action_state;
@@ -91,7 +99,7 @@ bool BatchExecutor::process_action(std::shared_ptr<IBatchAction> act) {
     // attempt to execute blockers.
     auto execute_blockers = [this, act](
         IBatchAction::RecordKeySet* set) {
-      std::shared_ptr<LockStage> blocking_stage = nullptr;
+      LockStage* blocking_stage = nullptr;
       for (auto rec_key : *set) {
         blocking_stage = 
           this->exec_manager->get_current_lock_holder_for(rec_key);
@@ -104,8 +112,8 @@ bool BatchExecutor::process_action(std::shared_ptr<IBatchAction> act) {
           continue;
         }
 
-        for (auto action_sptr : blocking_actions) {
-          this->process_action(action_sptr); 
+        for (auto action_ptr : blocking_actions) {
+          this->process_action(action_ptr); 
         }
       } 
     };
@@ -126,7 +134,7 @@ void BatchExecutor::process_pending() {
   // attempt to execute everything within the pending queue
   auto it = pending_list->begin();
   while (it != pending_list->end()) {
-    if (process_action(*it)) {
+    if (process_action(it->get())) {
       it = pending_list->erase(it);
       continue;
     }
@@ -156,3 +164,11 @@ bool BatchExecutor::is_stop_requested() {
 
 void BatchExecutor::reset() {
 };
+
+uint64_t BatchExecutor::get_started_batches() {
+  return started_batches;
+};
+
+uint64_t BatchExecutor::get_finished_batches() {
+  return finished_batches;
+};
@@ -1,5 +1,7 @@
 #include "batch/executor_manager.h"
 
+#include <algorithm>
+
 ExecutorManager::ExecutorManager(ExecutingSystemConfig conf):
   ExecutingSystem(conf),
   next_signaled_executor(0),
@@ -84,15 +86,34 @@ void ExecutorManager::set_db_storage_ptr(IDBStorage* db) {
   this->db = db;
 }
 
-std::shared_ptr<LockStage> 
-ExecutorManager::get_current_lock_holder_for(RecordKey key) {
+LockStage* ExecutorManager::get_current_lock_holder_for(RecordKey key) {
   return gs->get_stage_holding_lock_for(key);
 }
 
-void ExecutorManager::finalize_action(std::shared_ptr<IBatchAction> act) {
+void ExecutorManager::finalize_action(IBatchAction* act) {
   gs->finalize_execution_of_action(act);
 }
 
+uint64_t ExecutorManager::get_finished_batches_count() {
+  if (executors.empty()) return 0;
+
+  uint64_t finished = executors[0]->get_finished_batches();
+  for (auto executor : executors) {
+    finished = std::min(finished, executor->get_finished_batches());
+  }
+
+  return finished;
+}
+
+uint64_t ExecutorManager::get_started_batches_count() {
+  uint64_t started = 0;
+  for (auto executor : executors) {
+    started = std::max(started, executor->get_started_batches());
+  }
+
+  return started;
+}
+
 ExecutorManager::~ExecutorManager() {
   // just to be safe
   stop_working();
@@ -18,15 +18,15 @@ inline void GlobalSchedule::merge_into_global_schedule_for(
   lt.merge_batch_table_for(blt, from, to);
 };
 
-std::shared_ptr<LockStage> GlobalSchedule::get_stage_holding_lock_for(
+LockStage* GlobalSchedule::get_stage_holding_lock_for(
     RecordKey key) {
   return lt.get_head_for_record(key);
 };
 
 void GlobalSchedule::finalize_execution_of_action(
-    std::shared_ptr<IBatchAction> act) {
+    IBatchAction* act) {
   auto finalize_from_set = [this, act](IBatchAction::RecordKeySet* s){
-    std::shared_ptr<LockStage> ls;
+    LockStage* ls;
     for (auto& key : *s) {
       ls = get_stage_holding_lock_for(key);
       assert(ls != nullptr);
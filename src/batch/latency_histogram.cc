@@ -0,0 +1,111 @@
+#include "batch/latency_histogram.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram(uint32_t precision_bits):
+  precision_bits(precision_bits)
+{
+  assert(precision_bits > 0 && precision_bits < 32);
+  // values below 2^precision_bits take a bucket each. Every power of two 
+  // above takes half as many.
+  uint64_t sub_buckets = 1 << precision_bits;
+  counts.resize(sub_buckets + (64 - precision_bits) * (sub_buckets / 2));
+  reset();
+};
+
+uint64_t LatencyHistogram::get_index(uint64_t value) const {
+  if (value >> precision_bits == 0) return value;
+
+  uint32_t msb = 63 - __builtin_clzll(value);
+  uint32_t exp = msb - precision_bits + 1;
+  return ((uint64_t) exp << (precision_bits - 1)) + (value >> exp);
+};
+
+uint64_t LatencyHistogram::get_bucket_max(uint64_t index) const {
+  uint64_t sub_buckets = 1 << precision_bits;
+  if (index < sub_buckets) return index;
+
+  uint64_t half = sub_buckets / 2;
+  uint32_t exp = (index - half) / half;
+  uint64_t mantissa = index - (uint64_t) exp * half;
+  return ((mantissa + 1) << exp) - 1;
+};
+
+void LatencyHistogram::record(uint64_t value) {
+  counts[get_index(value)] ++;
+  total_count ++;
+  total_sum += value;
+  min_value = std::min(min_value, value);
+  max_value = std::max(max_value, value);
+};
+
+void LatencyHistogram::merge(const LatencyHistogram& h) {
+  assert(h.precision_bits == precision_bits);
+  for (unsigned int i = 0; i < counts.size(); i++) {
+    counts[i] += h.counts[i];
+  }
+
+  total_count += h.total_count;
+  total_sum += h.total_sum;
+  min_value = std::min(min_value, h.min_value);
+  max_value = std::max(max_value, h.max_value);
+};
+
+void LatencyHistogram::reset() {
+  std::fill(counts.begin(), counts.end(), 0);
+  total_count = 0;
+  total_sum = 0;
+  min_value = UINT64_MAX;
+  max_value = 0;
+};
+
+uint64_t LatencyHistogram::get_count() const {
+  return total_count;
+};
+
+uint64_t LatencyHistogram::get_min() const {
+  return total_count == 0 ? 0 : min_value;
+};
+
+uint64_t LatencyHistogram::get_max() const {
+  return max_value;
+};
+
+double LatencyHistogram::get_mean() const {
+  if (total_count == 0) return 0;
+
+  return (double) total_sum / total_count;
+};
+
+uint64_t LatencyHistogram::get_value_at_percentile(double percentile) const {
+  if (total_count == 0) return 0;
+
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  uint64_t wanted = (uint64_t) std::ceil(percentile / 100 * total_count);
+  wanted = std::max(wanted, (uint64_t) 1);
+
+  uint64_t seen = 0;
+  for (uint64_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= wanted) {
+      // never report more than what was actually recorded.
+      return std::min(get_bucket_max(i), max_value);
+    }
+  }
+
+  assert(false);
+  return max_value;
+};
+
+std::vector<std::pair<uint64_t, uint64_t>> LatencyHistogram::get_buckets() const {
+  std::vector<std::pair<uint64_t, uint64_t>> buckets;
+  for (uint64_t i = 0; i < counts.size(); i++) {
+    if (counts[i] == 0) continue;
+
+    buckets.push_back(std::make_pair(get_bucket_max(i), counts[i]));
+  }
+
+  return buckets;
+};
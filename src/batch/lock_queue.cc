@@ -3,29 +3,61 @@
 
 #include <cassert>
 
-void BatchLockQueue::non_concurrent_push_tail(
-    std::shared_ptr<LockStage>&& ls) {
-  non_concurrent_push_tail_implem(
-      std::make_shared
-        <typename SPSCMRQueue<std::shared_ptr<LockStage>>::QueueElt>
-       (std::move(ls)));
+LockQueue::LockQueue():
+  head(nullptr),
+  tail(nullptr),
+  latch(0)
+{};
+
+bool LockQueue::is_empty() const {
+  return head == nullptr;
+}
+
+LockStage* LockQueue::peek_head() const {
+  return head;
+}
+
+LockStage* LockQueue::peek_tail() const {
+  return tail;
+}
+
+void LockQueue::pop_head() {
+  lock(&latch);
+  LockStage* old_head = head;
+  assert(old_head != nullptr);
+
+  head = old_head->next_stage;
+  if (head == nullptr) {
+    tail = nullptr;
+  }
+  unlock(&latch);
 }
 
-void BatchLockQueue::non_concurrent_push_tail(
-    const std::shared_ptr<LockStage>& ls) {
-  non_concurrent_push_tail_implem(
-      std::make_shared
-        <typename SPSCMRQueue<std::shared_ptr<LockStage>>::QueueElt>(ls));
+void LockQueue::merge_queue(BatchLockQueue* blq) {
+  if (blq->is_empty()) return;
+
+  lock(&latch);
+  assert(blq->tail->next_stage == nullptr);
+  if (head == nullptr) {
+    assert(tail == nullptr);
+    tail = blq->tail;
+    head = blq->head;
+  } else {
+    assert(tail->next_stage == nullptr);
+    tail->next_stage = blq->head;
+    tail = blq->tail;
+  }
+  unlock(&latch);
 }
 
-void BatchLockQueue::non_concurrent_push_tail_implem(
-    std::shared_ptr<typename SPSCMRQueue<std::shared_ptr<LockStage>>::QueueElt> ls) {
+void BatchLockQueue::non_concurrent_push_tail(LockStage* ls) {
+  assert(ls->next_stage == nullptr);
   if (tail == nullptr) {
     assert(head == nullptr);
     head = ls;
     tail = ls;
   } else {
-    tail->set_next_elt(ls);
+    tail->next_stage = ls;
     tail = ls; 
   }
 }
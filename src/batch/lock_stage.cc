@@ -1,19 +1,105 @@
 #include "batch/lock_stage.h"
 #include "util.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+LockStage::RequestingActions::RequestingActions():
+    count(0),
+    capacity(INLINE_REQUESTERS),
+    acts(inline_acts)
+{};
+
+LockStage::RequestingActions::RequestingActions(
+    std::initializer_list<IBatchAction*> init):
+  RequestingActions()
+{
+  for (auto act : init) {
+    insert(act);
+  }
+};
+
+LockStage::RequestingActions::RequestingActions(const RequestingActions& ra):
+  RequestingActions()
+{
+  *this = ra;
+};
+
+LockStage::RequestingActions& LockStage::RequestingActions::operator=(
+    const RequestingActions& ra) {
+  if (this == &ra) return *this;
+
+  count = 0;
+  for (auto act : ra) {
+    insert(act);
+  }
+
+  return *this;
+};
+
+LockStage::RequestingActions::~RequestingActions() {
+  if (acts != inline_acts) {
+    free(acts);
+  }
+};
+
+void LockStage::RequestingActions::insert(IBatchAction* act) {
+  if (count == capacity) {
+    // spill over to (or grow) the heap array.
+    IBatchAction** bigger = 
+      (IBatchAction**) malloc(sizeof(IBatchAction*) * capacity * 2);
+    assert(bigger != nullptr);
+    memcpy(bigger, acts, sizeof(IBatchAction*) * count);
+    if (acts != inline_acts) {
+      free(acts);
+    }
+
+    acts = bigger;
+    capacity *= 2;
+  }
+
+  acts[count++] = act;
+};
+
+LockStage::RequestingActions::const_iterator 
+LockStage::RequestingActions::find(IBatchAction* act) const {
+  return std::find(begin(), end(), act);
+};
+
+LockStage::RequestingActions::const_iterator 
+LockStage::RequestingActions::begin() const {
+  return acts;
+};
+
+LockStage::RequestingActions::const_iterator 
+LockStage::RequestingActions::end() const {
+  return acts + count;
+};
+
+uint64_t LockStage::RequestingActions::size() const {
+  return count;
+};
+
+bool LockStage::RequestingActions::operator==(
+    const RequestingActions& ra) const {
+  if (count != ra.count) return false;
+
+  for (auto act : ra) {
+    if (find(act) == end()) return false;
+  }
+
+  return true;
+};
 
 LockStage::LockStage(): 
     holders(0),
     l_type(LockType::shared),
-    requesters({}),
-    has_been_given_lock(false)
-{
-  // TODO:
-  //    Figure out how much space to reserve up front 
-  //    in this place. It might be better to do more...
-  requesters.reserve(10);
-};
+    requesters(),
+    has_been_given_lock(false),
+    next_stage(nullptr)
+{};
 
 LockStage::LockStage(
       RequestingActions requesters,
@@ -21,12 +107,13 @@ LockStage::LockStage(
     holders(requesters.size()),
     l_type(lt),
     requesters(requesters),
-    has_been_given_lock(false)
+    has_been_given_lock(false),
+    next_stage(nullptr)
 {
   assert(!(lt == LockType::exclusive && requesters.size() > 1));
 };
 
-bool LockStage::add_to_stage(std::shared_ptr<IBatchAction> txn, LockType lt) {
+bool LockStage::add_to_stage(IBatchAction* txn, LockType lt) {
   // can only add to a stage when both the request and the stage are shared
   // or when the stage is empty.
   if ((lt == LockType::exclusive && requesters.size() > 0) ||
@@ -52,7 +139,11 @@ uint64_t LockStage::get_holders() const {
   return holders;
 };
 
-bool LockStage::finalize_action(std::shared_ptr<IBatchAction> act) {
+LockStage* LockStage::get_next_stage() const {
+  return next_stage;
+};
+
+bool LockStage::finalize_action(IBatchAction* act) {
   // act is a part of this stage!
   assert(requesters.find(act) != requesters.end());
   assert(has_lock());
@@ -0,0 +1,111 @@
+#include "batch/lock_stage_arena.h"
+
+#include <cassert>
+#include <new>
+
+LockStageArena::LockStageArena():
+  free_chunks(nullptr),
+  current({0, nullptr, {}, 0})
+{};
+
+LockStageArena::~LockStageArena() {
+  free_segment(current);
+  for (auto& s : retired) {
+    free_segment(s);
+  }
+
+  while (free_chunks != nullptr) {
+    Chunk* next = free_chunks->next;
+    delete free_chunks;
+    free_chunks = next;
+  }
+};
+
+void LockStageArena::start_batch(uint64_t batch_id) {
+  if (current.chunks != nullptr || current.actions.empty() == false) {
+    retired.push_back(std::move(current));
+  }
+
+  current = {batch_id, nullptr, {}, 0};
+};
+
+LockStage* LockStageArena::new_stage(IBatchAction* requester, LockType lt) {
+  if (current.chunks == nullptr || 
+      current.chunks->used == LOCK_STAGES_PER_CHUNK) {
+    Chunk* c = free_chunks;
+    if (c != nullptr) {
+      free_chunks = c->next;
+    } else {
+      c = new Chunk;
+    }
+
+    c->used = 0;
+    c->next = current.chunks;
+    current.chunks = c;
+  }
+
+  void* mem = &current.chunks->stages[current.chunks->used++];
+  return new (mem) LockStage({requester}, lt);
+};
+
+void LockStageArena::retain_action(std::shared_ptr<IBatchAction>&& act) {
+  current.actions.push_back(std::move(act));
+};
+
+void LockStageArena::reclaim(
+    uint64_t finished_batches,
+    uint64_t started_batches) {
+  while (retired.empty() == false) {
+    Segment& s = retired.front();
+    if (s.grace_batches == 0) {
+      // the batch itself must be finished first.
+      if (finished_batches <= s.batch_id) return;
+
+      assert(started_batches >= finished_batches);
+      s.grace_batches = started_batches;
+    }
+
+    if (finished_batches < s.grace_batches) return;
+
+    free_segment(s);
+    retired.pop_front();
+  }
+};
+
+void LockStageArena::free_segment(Segment& s) {
+  while (s.chunks != nullptr) {
+    Chunk* c = s.chunks;
+    s.chunks = c->next;
+    for (unsigned int i = 0; i < c->used; i++) {
+      reinterpret_cast<LockStage*>(&c->stages[i])->~LockStage();
+    }
+
+    c->next = free_chunks;
+    free_chunks = c;
+  }
+
+  s.actions.clear();
+};
+
+uint64_t LockStageArena::get_live_chunks_count() const {
+  auto count_chunks = [](const Segment& s) {
+    uint64_t count = 0;
+    for (Chunk* c = s.chunks; c != nullptr; c = c->next) {
+      count ++;
+    }
+
+    return count;
+  };
+
+  uint64_t count = count_chunks(current);
+  for (auto& s : retired) {
+    count += count_chunks(s);
+  }
+
+  return count;
+};
+
+LockStageArena* LockStageArena::get_thread_arena() {
+  static thread_local LockStageArena arena;
+  return &arena;
+};
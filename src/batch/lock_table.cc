@@ -1,21 +1,72 @@
 #include "batch/lock_table.h"
 #include "batch/lock_types.h"
+#include "cpuinfo.h"
 
+#include <numa.h>
+
+#include <algorithm>
 #include <cassert>
+#include <new>
 
-LockTable::LockTable(): memory_preallocated(false) {};
+LockTable::LockTable(): 
+  dense_queues(nullptr),
+  dense_queues_count(0),
+  memory_preallocated(false) 
+{};
 
 LockTable::LockTable(DBStorageConfig db_conf): 
+  dense_queues(nullptr),
+  dense_queues_count(0),
   memory_preallocated(true) 
 {
+  allocate_dense_queues(db_conf);
   for (auto& table_conf : db_conf.tables_definitions) {
+    if (table_conf.dense_keys) continue;
+
+    lock_table.reserve(lock_table.size() + table_conf.num_records);
     for (uint64_t i = 0; i < table_conf.num_records; i++) {
-      allocate_mem_for({i, table_conf.table_id});
+      allocate_mem_for({table_conf.get_key(i), table_conf.table_id});
     }
   }
 } 
 
+LockTable::~LockTable() {
+  if (dense_queues != nullptr) {
+    numa_free(dense_queues, dense_queues_count * sizeof(LockQueueSlot));
+  }
+}
+
+void LockTable::allocate_dense_queues(DBStorageConfig db_conf) {
+  uint64_t max_table_id = 0;
+  for (auto& table_conf : db_conf.tables_definitions) {
+    max_table_id = std::max(max_table_id, table_conf.table_id);
+  }
+
+  dense_tables.resize(max_table_id + 1, {false, 0, 0});
+  for (auto& table_conf : db_conf.tables_definitions) {
+    if (table_conf.dense_keys == false) continue;
+
+    DenseTable& table = dense_tables[table_conf.table_id];
+    // every table may only be defined once.
+    assert(table.dense_keys == false);
+    table.dense_keys = true;
+    table.num_records = table_conf.num_records;
+    table.offset = dense_queues_count;
+    dense_queues_count += table_conf.num_records;
+  }
+
+  if (dense_queues_count == 0) return;
+
+  // allocations are page aligned and therefore cache line aligned.
+  dense_queues = (LockQueueSlot*) alloc_interleaved_all(
+      dense_queues_count * sizeof(LockQueueSlot));
+  for (uint64_t i = 0; i < dense_queues_count; i++) {
+    new (&dense_queues[i]) LockQueueSlot();
+  }
+}
+
 void LockTable::merge_batch_table(BatchLockTable& blt) {
+  blt.build();
   auto smallest_it = blt.lock_table.begin();
   auto biggest_it = blt.lock_table.rbegin();
   if (smallest_it == blt.lock_table.end() || 
@@ -34,32 +85,31 @@ void LockTable::merge_batch_table_for(
     const RecordKey& from,
     const RecordKey& to) {
   
-  LockTableType::iterator lt_it;
-  BatchLockTable::LockTableType::iterator lo, hi;
-  lo = blt.lock_table.lower_bound(from);
-  hi = blt.lock_table.upper_bound(to);
+  LockQueue* lq;
+  assert(blt.is_built());
+  auto range = blt.get_range(from, to);
+  auto lo = range.first;
+  auto hi = range.second;
 
   // merge queue by queue
   for (auto& elt = lo; elt != hi; elt++) {
-    if (!memory_preallocated) {
+    lq = get_queue_for(elt->first);
+    if (lq == nullptr) {
+      assert(!memory_preallocated);
       // this defualt-constructs the lock queue without any move or copy instructions.
-      lock_table[elt->first];
+      lq = &lock_table[elt->first];
     }
 
-    lt_it = lock_table.find(elt->first);
-    assert(lt_it != lock_table.end());
-
-    auto& head_blt = *elt->second.peek_head();
-    lt_it->second.merge_queue(&elt->second);
+    auto head_blt = elt->second.peek_head();
+    lq->merge_queue(&elt->second);
 
     // if the lock stage at the head has NOT been given the lock,
     // we should give it the lock. That means that we have merged into a queue 
     // that was empty and the execution thread must know that this stage
     // has the lock.
-    auto head_pt = lt_it->second.peek_head();
-    if (head_pt == nullptr) return;
+    auto head = lq->peek_head();
+    if (head == nullptr) return;
 
-    auto& head = *head_pt;
     if (head == head_blt && 
         head->has_lock() == false) {
       head->notify_lock_obtained();
@@ -67,27 +117,24 @@ void LockTable::merge_batch_table_for(
   }
 }
 
-std::shared_ptr<LockStage> LockTable::get_head_for_record(RecordKey key) {
-  auto elt = lock_table.find(key);
-  assert(elt != lock_table.end());
-  auto head_pt = elt->second.peek_head();
+LockStage* LockTable::get_head_for_record(RecordKey key) {
+  LockQueue* lq = get_queue_for(key);
+  assert(lq != nullptr);
 
-  return head_pt == nullptr ? nullptr : *head_pt;
+  return lq->peek_head();
 };
 
 void LockTable::pass_lock_to_next_stage_for(RecordKey key) {
-  auto elt = lock_table.find(key);
-  assert(elt != lock_table.end());
+  LockQueue* lq = get_queue_for(key);
+  assert(lq != nullptr);
 
-  // Lock Queue
-  auto& lq = elt->second;
   // Pop the old lock stage
-  lq.pop_head();
+  lq->pop_head();
 
   // notify the new stage if there is one present.
-  auto head_pt = lq.peek_head();
-  if (head_pt != nullptr) {
-    (*head_pt)->notify_lock_obtained();
+  auto head = lq->peek_head();
+  if (head != nullptr) {
+    head->notify_lock_obtained();
   }
 }
 
@@ -97,26 +144,132 @@ void LockTable::allocate_mem_for(RecordKey key) {
   assert(insert_res.second);
 };
 
-BatchLockTable::BatchLockTable() {}
+BatchLockTable::BatchLockTable():
+  arena(LockStageArena::get_thread_arena())
+{}
+
+BatchLockTable::BatchLockTable(LockStageArena* arena):
+  arena(arena)
+{
+  assert(arena != nullptr);
+}
 
 void BatchLockTable::insert_lock_request(std::shared_ptr<IBatchAction> req) {
-  auto add_request = [this, &req](
+  assert(lock_table.empty());
+  IBatchAction* act = req.get();
+  auto add_request = [this, act](
       IBatchAction::RecordKeySet* set, LockType typ) {
     for (auto& i : *set) {
-      BatchLockQueue& blq = lock_table.emplace(i, BatchLockQueue()).first->second;
-      if (blq.is_empty() || 
-          ((*blq.peek_tail())->add_to_stage(req, typ) == false)) {
-        // insertion into the stage failed. Make a new stage and add it in.
-        blq.non_concurrent_push_tail(std::move(
-              std::make_shared<LockStage>(LockStage({req}, typ))));
-      }
+      requests.push_back({i, act, typ});
     }
   };
   
-  add_request(req->get_writeset_handle(), LockType::exclusive);  
-  add_request(req->get_readset_handle(), LockType::shared);  
+  add_request(act->get_writeset_handle(), LockType::exclusive);  
+  add_request(act->get_readset_handle(), LockType::shared);  
+  arena->retain_action(std::move(req));
+}
+
+void BatchLockTable::build() {
+  if (requests.empty()) return;
+  assert(lock_table.empty());
+
+  sort_requests();
+
+  // every run of requests for the same key forms a lock queue.
+  for (auto& req : requests) {
+    if (lock_table.empty() || !(lock_table.back().first == req.key)) {
+      lock_table.emplace_back(req.key, BatchLockQueue());
+    }
+
+    BatchLockQueue& blq = lock_table.back().second;
+    if (blq.is_empty() || 
+        (blq.peek_tail()->add_to_stage(req.action, req.type) == false)) {
+      // insertion into the stage failed. Make a new stage and add it in.
+      blq.non_concurrent_push_tail(arena->new_stage(req.action, req.type));
+    }
+  }
+
+  // the requests are not needed while the batch awaits merging.
+  std::vector<LockRequest>().swap(requests);
+}
+
+bool BatchLockTable::is_built() const {
+  return requests.empty();
+}
+
+void BatchLockTable::sort_requests() {
+  // Sort on (table_id, key) packed into a single word. Only as many bits
+  // as the largest ids need are sorted on, so a batch over a table of
+  // a million records is sorted in two passes.
+  const unsigned int RADIX_BITS = 11;
+  const uint64_t RADIX_MASK = (1 << RADIX_BITS) - 1;
+
+  uint64_t max_key = 0, max_table = 0;
+  for (auto& req : requests) {
+    max_key = std::max(max_key, req.key.key);
+    max_table = std::max(max_table, req.key.table_id);
+  }
+
+  auto bits_for = [](uint64_t v) {
+    unsigned int bits = 0;
+    for (; v != 0; v >>= 1) bits ++;
+    return bits;
+  };
+
+  const unsigned int key_bits = bits_for(max_key);
+  const unsigned int sort_bits = key_bits + bits_for(max_table);
+  if (sort_bits > 64) {
+    std::stable_sort(requests.begin(), requests.end(),
+        [](const LockRequest& r1, const LockRequest& r2) {
+          return r1.key < r2.key;
+        });
+    return;
+  }
+
+  auto sort_key = [key_bits](const LockRequest& r) {
+    return key_bits == 64 ? r.key.key : (r.key.table_id << key_bits) | r.key.key;
+  };
+
+  std::vector<LockRequest> sorted(requests.size(), requests[0]);
+  std::vector<uint64_t> offsets(RADIX_MASK + 1);
+  for (unsigned int shift = 0; shift < sort_bits; shift += RADIX_BITS) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (auto& req : requests) {
+      offsets[(sort_key(req) >> shift) & RADIX_MASK] ++;
+    }
+
+    uint64_t sum = 0;
+    for (auto& offset : offsets) {
+      uint64_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+
+    for (auto& req : requests) {
+      sorted[offsets[(sort_key(req) >> shift) & RADIX_MASK]++] = req;
+    }
+
+    requests.swap(sorted);
+  }
+}
+
+std::pair<
+  BatchLockTable::LockTableType::iterator, 
+  BatchLockTable::LockTableType::iterator> 
+BatchLockTable::get_range(const RecordKey& from, const RecordKey& to) {
+  auto lo = std::lower_bound(lock_table.begin(), lock_table.end(), from,
+      [](const KeyedQueue& q, const RecordKey& k) {
+        return q.first < k;
+      });
+  auto hi = std::upper_bound(lo, lock_table.end(), to,
+      [](const RecordKey& k, const KeyedQueue& q) {
+        return k < q.first;
+      });
+
+  return std::make_pair(lo, hi);
 }
 
 const BatchLockTable::LockTableType& BatchLockTable::get_lock_table_data() {
+  build();
   return lock_table; 
 }
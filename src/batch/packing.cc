@@ -1,6 +1,8 @@
 #include "batch/packing.h"
 #include "batch/batch_action_interface.h"
 
+#include <cassert>
+
 bool Packer::txn_conflicts(
     IBatchAction* t,
     RecordKeySet* ex_locks_in_packing, 
@@ -80,3 +82,104 @@ Packer::BatchActions Packer::get_packing(Container* c) {
 
   return actions_in_packing;
 }
+
+BitmapPacker::BitmapPacker(Container* c) {
+  actions.reserve(c->get_remaining_count());
+  key_ids.reserve(c->get_remaining_count());
+
+  IBatchAction* act;
+  while ((act = c->peek_curr_elt()) != nullptr) {
+    map_keys(act);
+    c->advance_to_next_elt();
+  }
+  c->sort_remaining();
+
+  held_ex_locks.resize((key_ids.size() + 63) / 64, 0);
+  held_sh_locks.resize((key_ids.size() + 63) / 64, 0);
+}
+
+void BitmapPacker::map_keys(IBatchAction* act) {
+  auto add_ids = [this](RecordKeySet* set) {
+    for (auto& key : *set) {
+      auto res = key_ids.emplace(key, key_ids.size());
+      lock_ids.push_back(res.first->second);
+    }
+  };
+
+  act->packing_slot = actions.size();
+  actions.push_back({
+      lock_ids.size(),
+      (uint32_t) act->get_writeset_handle()->size(),
+      (uint32_t) act->get_readset_handle()->size()});
+  add_ids(act->get_writeset_handle());
+  add_ids(act->get_readset_handle());
+}
+
+bool BitmapPacker::txn_conflicts(const ActionLocks& locks) const {
+  auto is_set = [](const std::vector<uint64_t>& bits, uint32_t id) {
+    return (bits[id >> 6] >> (id & 63)) & 1;
+  };
+
+  // exclusive locks conflict with both exclusive and shared locks held,
+  // shared locks only with exclusive locks held.
+  const uint32_t* ids = &lock_ids[locks.offset];
+  for (uint32_t i = 0; i < locks.writes; i++) {
+    if (is_set(held_ex_locks, ids[i]) || is_set(held_sh_locks, ids[i])) {
+      return true;
+    }
+  }
+
+  ids += locks.writes;
+  for (uint32_t i = 0; i < locks.reads; i++) {
+    if (is_set(held_ex_locks, ids[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void BitmapPacker::set_locks(const ActionLocks& locks, bool held) {
+  auto set = [held](std::vector<uint64_t>& bits, uint32_t id) {
+    if (held) {
+      bits[id >> 6] |= ((uint64_t) 1 << (id & 63));
+    } else {
+      bits[id >> 6] &= ~((uint64_t) 1 << (id & 63));
+    }
+  };
+
+  const uint32_t* ids = &lock_ids[locks.offset];
+  for (uint32_t i = 0; i < locks.writes; i++) {
+    set(held_ex_locks, ids[i]);
+  }
+
+  ids += locks.writes;
+  for (uint32_t i = 0; i < locks.reads; i++) {
+    set(held_sh_locks, ids[i]);
+  }
+}
+
+BitmapPacker::BatchActions BitmapPacker::get_packing(Container* c) {
+  BatchActions actions_in_packing;
+  actions_in_packing.reserve(c->get_remaining_count());
+  IBatchAction* next_action;
+
+  while ((next_action = c->peek_curr_elt()) != nullptr) {
+    assert(next_action->packing_slot < actions.size());
+    const ActionLocks& locks = actions[next_action->packing_slot];
+    if (!txn_conflicts(locks)) {
+      // add the txn to packing and transition the ownership
+      set_locks(locks, true);
+      actions_in_packing.push_back(c->take_curr_elt());
+      continue;
+    }
+    c->advance_to_next_elt();
+  }
+
+  // leave the bitmaps empty for the next packing.
+  for (auto& act : actions_in_packing) {
+    set_locks(actions[act->packing_slot], false);
+  }
+
+  return actions_in_packing;
+}
@@ -0,0 +1,287 @@
+#include "batch/parallel_packing.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cassert>
+
+SpinBarrier::SpinBarrier(uint64_t threads):
+  arrived(0),
+  generation(0),
+  threads(threads)
+{};
+
+void SpinBarrier::wait() {
+  uint64_t gen = generation;
+  barrier();
+  if (fetch_and_increment(&arrived) == threads) {
+    // the last thread to arrive releases the others.
+    arrived = 0;
+    barrier();
+    xchgq(&generation, gen + 1);
+    return;
+  }
+
+  while (generation == gen) {
+    do_pause();
+  }
+};
+
+PackingHelper::PackingHelper(
+    ParallelPacker* packer,
+    int cpu,
+    unsigned int member_id):
+  Runnable(cpu),
+  packer(packer),
+  member_id(member_id)
+{};
+
+void PackingHelper::Init() {
+};
+
+void PackingHelper::StartWorking() {
+  uint64_t packed_generation = 0;
+  while (true) {
+    uint64_t gen;
+    while ((gen = packer->get_batch_generation()) == packed_generation) {
+      if (packer->is_stop_requested()) return;
+      do_pause();
+    }
+
+    packed_generation = gen;
+    packer->pack(member_id);
+  }
+};
+
+ParallelPacker::ParallelPacker(std::vector<int> helper_cpus):
+  team_size(helper_cpus.size() + 1),
+  helpers_started(false),
+  stop_signal(0),
+  batch_generation(0),
+  phase_barrier(helper_cpus.size() + 1),
+  members(helper_cpus.size() + 1)
+{
+  for (unsigned int i = 0; i < helper_cpus.size(); i++) {
+    helpers.push_back(
+        std::make_unique<PackingHelper>(this, helper_cpus[i], i + 1));
+  }
+
+  for (auto& m : members) {
+    m.outbox.resize(team_size);
+  }
+};
+
+ParallelPacker::~ParallelPacker() {
+  xchgq(&stop_signal, 1);
+  for (auto& h : helpers) {
+    h->Join();
+  }
+};
+
+unsigned int ParallelPacker::get_team_size() const {
+  return team_size;
+};
+
+bool ParallelPacker::is_stop_requested() const {
+  return stop_signal;
+};
+
+uint64_t ParallelPacker::get_batch_generation() const {
+  return batch_generation;
+};
+
+unsigned int ParallelPacker::get_owner(const RecordKey& key) const {
+  return std::hash<RecordKey>()(key) % team_size;
+};
+
+ParallelPacker::Packings ParallelPacker::get_packings(Container* c) {
+  assert(actions.empty());
+  actions.reserve(c->get_remaining_count());
+  while (c->peek_curr_elt() != nullptr) {
+    actions.push_back(c->take_curr_elt());
+  }
+
+  pending.assign(actions.size(), 0);
+  rounds.clear();
+
+  if (helpers_started == false) {
+    for (auto& h : helpers) {
+      h->Run();
+    }
+    helpers_started = true;
+  }
+
+  // the generation is bumped after the batch is set up, so the helpers
+  // never see a partially set up batch.
+  barrier();
+  xchgq(&batch_generation, batch_generation + 1);
+  pack(0);
+
+  Packings packings(rounds.size());
+  for (unsigned int i = 0; i < rounds.size(); i++) {
+    packings[i].reserve(rounds[i].size());
+    for (auto& act : rounds[i]) {
+      packings[i].push_back(std::move(actions[act]));
+    }
+  }
+
+  actions.clear();
+  return packings;
+};
+
+void ParallelPacker::pack(unsigned int member_id) {
+  collect_requests(member_id);
+  phase_barrier.wait();
+  build_queues(member_id);
+  phase_barrier.wait();
+  collect_ready(member_id);
+
+  while (true) {
+    phase_barrier.wait();
+    if (member_id == 0) {
+      make_frontier();
+    }
+
+    phase_barrier.wait();
+    if (frontier.empty()) break;
+
+    for (auto& act : frontier) {
+      release(members[member_id], act);
+    }
+  }
+};
+
+void ParallelPacker::collect_requests(unsigned int member_id) {
+  Member& m = members[member_id];
+  for (auto& out : m.outbox) {
+    out.clear();
+  }
+
+  uint32_t start = (uint64_t) actions.size() * member_id / team_size;
+  uint32_t end = (uint64_t) actions.size() * (member_id + 1) / team_size;
+  for (uint32_t i = start; i < end; i++) {
+    auto writes = actions[i]->get_writeset_handle();
+    auto reads = actions[i]->get_readset_handle();
+    for (auto& key : *writes) {
+      m.outbox[get_owner(key)].push_back({key, i, true});
+    }
+
+    for (auto& key : *reads) {
+      // the exclusive lock covers the shared one.
+      if (writes->count(key) != 0) continue;
+      m.outbox[get_owner(key)].push_back({key, i, false});
+    }
+  }
+};
+
+void ParallelPacker::build_queues(unsigned int member_id) {
+  Member& m = members[member_id];
+  m.queue_ids.clear();
+  m.queue_refs.clear();
+  m.ref_starts.resize(actions.size() + 1);
+  for (auto& q : m.queues) {
+    q.clear();
+  }
+
+  // members own consecutive ranges of actions, so requests arrive in
+  // serial order.
+  uint32_t next_action = 0;
+  for (auto& sender : members) {
+    for (auto& req : sender.outbox[member_id]) {
+      auto res = m.queue_ids.emplace(req.key, m.queue_ids.size());
+      uint32_t queue = res.first->second;
+      if (queue == m.queues.size()) {
+        m.queues.emplace_back();
+      }
+
+      while (next_action <= req.action) {
+        m.ref_starts[next_action++] = m.queue_refs.size();
+      }
+
+      m.queue_refs.push_back({queue, (uint32_t) m.queues[queue].size()});
+      m.queues[queue].push_back({req.action, req.exclusive, 0});
+    }
+  }
+
+  while (next_action <= actions.size()) {
+    m.ref_starts[next_action++] = m.queue_refs.size();
+  }
+
+  for (uint32_t i = 0; i < m.queue_ids.size(); i++) {
+    KeyQueue& q = m.queues[i];
+    uint32_t next_exclusive = q.size();
+    for (uint32_t pos = q.size(); pos-- > 0;) {
+      q[pos].next_exclusive = next_exclusive;
+      if (q[pos].exclusive) next_exclusive = pos;
+    }
+
+    // count the requests every request must follow.
+    uint64_t shared_since_exclusive = 0;
+    bool exclusive_seen = false;
+    for (auto& req : q) {
+      uint64_t to_follow;
+      if (req.exclusive) {
+        to_follow = shared_since_exclusive > 0 ?
+          shared_since_exclusive : exclusive_seen;
+        shared_since_exclusive = 0;
+        exclusive_seen = true;
+      } else {
+        to_follow = exclusive_seen;
+        shared_since_exclusive ++;
+      }
+
+      for (uint64_t j = 0; j < to_follow; j++) {
+        fetch_and_increment(&pending[req.action]);
+      }
+    }
+  }
+};
+
+void ParallelPacker::collect_ready(unsigned int member_id) {
+  Member& m = members[member_id];
+  m.ready.clear();
+
+  uint32_t start = (uint64_t) actions.size() * member_id / team_size;
+  uint32_t end = (uint64_t) actions.size() * (member_id + 1) / team_size;
+  for (uint32_t i = start; i < end; i++) {
+    if (pending[i] == 0) m.ready.push_back(i);
+  }
+};
+
+void ParallelPacker::release(Member& m, uint32_t action) {
+  auto follow_released = [this, &m](uint32_t act) {
+    if (fetch_and_decrement(&pending[act]) == 0) {
+      m.ready.push_back(act);
+    }
+  };
+
+  for (uint32_t i = m.ref_starts[action]; i < m.ref_starts[action + 1]; i++) {
+    QueueRef& ref = m.queue_refs[i];
+    KeyQueue& q = m.queues[ref.queue];
+    uint32_t pos = ref.pos + 1;
+
+    if (q[ref.pos].exclusive == false) {
+      // shared requests are followed by the next exclusive request only.
+      pos = q[ref.pos].next_exclusive;
+      if (pos < q.size()) follow_released(q[pos].action);
+    } else if (pos < q.size() && q[pos].exclusive) {
+      follow_released(q[pos].action);
+    } else {
+      for (; pos < q.size() && q[pos].exclusive == false; pos++) {
+        follow_released(q[pos].action);
+      }
+    }
+  }
+};
+
+void ParallelPacker::make_frontier() {
+  frontier.clear();
+  for (auto& m : members) {
+    frontier.insert(frontier.end(), m.ready.begin(), m.ready.end());
+    m.ready.clear();
+  }
+
+  if (frontier.empty()) return;
+
+  std::sort(frontier.begin(), frontier.end());
+  rounds.push_back(frontier);
+};
@@ -0,0 +1,107 @@
+#include "batch/per_action_input_queue.h"
+#include "batch/time_util.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+PerActionInputQueue::PerActionInputQueue(
+    uint32_t batch_size,
+    uint32_t batch_timeout_us):
+  Ring(),
+  InputQueue(batch_size),
+  batch_timeout_ns((uint64_t) batch_timeout_us * 1000),
+  added(0),
+  flushed(0),
+  taken(0),
+  arrival_rate(0),
+  last_sample_time(0),
+  last_sample_arrivals(0)
+{};
+
+uint64_t PerActionInputQueue::now_ns() {
+  return TimeUtilities::now_ns();
+};
+
+void PerActionInputQueue::update_arrival_rate(uint64_t now) {
+  // everything taken or waiting has arrived.
+  uint64_t arrivals = taken + Ring::get_size();
+  if (last_sample_time == 0) {
+    last_sample_time = now;
+    last_sample_arrivals = arrivals;
+    return;
+  }
+
+  // samples shorter than the timeout are too noisy.
+  uint64_t elapsed = now - last_sample_time;
+  if (elapsed < batch_timeout_ns) return;
+
+  double rate = (double) (arrivals - last_sample_arrivals) / elapsed;
+  arrival_rate = arrival_rate == 0 ? rate : 0.75 * arrival_rate + 0.25 * rate;
+  last_sample_time = now;
+  last_sample_arrivals = arrivals;
+};
+
+uint64_t PerActionInputQueue::get_target_batch_size(uint64_t now) {
+  if (batch_timeout_ns == 0) return this->batch_size;
+
+  update_arrival_rate(now);
+  uint64_t expected = (uint64_t) std::ceil(arrival_rate * batch_timeout_ns);
+  uint64_t backlog = Ring::get_size();
+  uint64_t target = std::max(expected, backlog);
+  return std::min(std::max(target, (uint64_t) 1), (uint64_t) this->batch_size);
+};
+
+InputQueue::BatchActions PerActionInputQueue::try_get_action_batch() {
+  // we return a batch only if the input queue is not empty. 
+  // otherwise we return an empty vector!
+  if (this->is_empty()) 
+    return InputQueue::BatchActions();
+
+  uint64_t now = now_ns();
+  uint64_t target = get_target_batch_size(now);
+  uint64_t deadline = batch_timeout_ns == 0 ? UINT64_MAX : now + batch_timeout_ns;
+
+  InputQueue::BatchActions batch;
+  batch.reserve(target);
+  Waiter w;
+  while (batch.size() < target) {
+    if (Ring::pop_head_batch(
+          std::back_inserter(batch), target - batch.size()) > 0) {
+      continue;
+    }
+
+    // everything within the batch has been flushed and nothing else is there.
+    if (taken + batch.size() <= flushed) break;
+    if (batch_timeout_ns != 0) {
+      if (now_ns() >= deadline) break;
+      // a parked thread might oversleep the deadline, so never park.
+      w.wait();
+    } else {
+      this->wait_for_push(w);
+    }
+  }
+
+  taken += batch.size();
+  return batch;
+};
+
+void PerActionInputQueue::add_action(std::unique_ptr<IBatchAction>&& act) {
+  Ring::push_tail(std::move(act));
+  added ++;
+};
+
+bool PerActionInputQueue::is_empty() {
+  return Ring::is_empty();
+};
+
+void PerActionInputQueue::flush() {
+  // the actions must be visible before the flush is.
+  barrier();
+  flushed = added;
+};
+
+double PerActionInputQueue::get_arrival_rate_per_us() const {
+  return arrival_rate * 1000;
+};
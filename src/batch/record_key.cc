@@ -10,5 +10,6 @@ bool RecordKey::operator==(const RecordKey& other) const {
 
 bool RecordKey::operator<(const RecordKey& other) const {
   // Order tables increasingly and order records by key within tables.
-  return (table_id < other.table_id || key < other.key);
+  return (table_id < other.table_id || 
+      (table_id == other.table_id && key < other.key));
 }
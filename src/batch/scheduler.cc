@@ -8,9 +8,15 @@
 Scheduler::Scheduler(
     SchedulerThreadManager* manager,
     int m_cpu_number,
-    uint64_t thread_id):
-  SchedulerThread(manager, m_cpu_number, thread_id)
-{};
+    uint64_t thread_id,
+    std::vector<int> packing_helper_cpus):
+  SchedulerThread(manager, m_cpu_number, thread_id),
+  curr_workload_item(0)
+{
+  if (packing_helper_cpus.size() > 0) {
+    parallel_packer = std::make_unique<ParallelPacker>(packing_helper_cpus);
+  }
+};
 
 void Scheduler::StartWorking() {
   while(!is_stop_requested()) {
@@ -36,27 +42,52 @@ void Scheduler::Init() {
 
 void Scheduler::process_batch() {
   workloads = SchedulerThreadManager::OrderedWorkload(batch_actions.batch.size());
-  lt = BatchLockTable();
+  reclaim_lock_stages();
+  stage_arena.start_batch(batch_actions.batch_id);
+  lt = BatchLockTable(&stage_arena);
   ArrayContainer ac(std::move(batch_actions.batch));
 
   // populate the batch lock table and workloads
-  unsigned int curr_workload_item = 0;
-  std::vector<std::unique_ptr<IBatchAction>> packing;
-  while (ac.get_remaining_count() != 0) {
-    // get packing
-    packing = std::move(Packer::get_packing(&ac));
-    ac.sort_remaining();
-    // translate a packing into lock request
-    for (std::unique_ptr<IBatchAction>& act : packing) {
-      auto act_sptr = std::shared_ptr<IBatchAction>(std::move(act));
-      workloads[curr_workload_item++] = act_sptr;
-      lt.insert_lock_request(act_sptr);
+  curr_workload_item = 0;
+  if (parallel_packer != nullptr) {
+    for (auto& packing : parallel_packer->get_packings(&ac)) {
+      add_packing(packing);
+    }
+  } else {
+    std::vector<std::unique_ptr<IBatchAction>> packing;
+    BitmapPacker packer(&ac);
+    while (ac.get_remaining_count() != 0) {
+      // get packing
+      packing = std::move(packer.get_packing(&ac));
+      ac.sort_remaining();
+      add_packing(packing);
     }
   }
 
+  lt.build();
+
   assert(curr_workload_item == workloads.size());
 };
 
+void Scheduler::add_packing(Container::BatchActions& packing) {
+  // translate a packing into lock request
+  for (std::unique_ptr<IBatchAction>& act : packing) {
+    auto act_sptr = std::shared_ptr<IBatchAction>(std::move(act));
+    workloads[curr_workload_item++] = act_sptr;
+    lt.insert_lock_request(act_sptr);
+  }
+};
+
+void Scheduler::reclaim_lock_stages() {
+  if (manager == nullptr || manager->exec_manager == nullptr) return;
+
+  // the order of reads matters. See LockStageArena.
+  uint64_t finished = manager->exec_manager->get_finished_batches_count();
+  barrier();
+  uint64_t started = manager->exec_manager->get_started_batches_count();
+  stage_arena.reclaim(finished, started);
+};
+
 Scheduler::~Scheduler() {
 };
 
@@ -6,24 +6,35 @@
 
 ThreadInputQueues::ThreadInputQueues(
     unsigned int thread_number,
-    unsigned int batch_size_act):
-  input_batch_id(0),
-  iq(batch_size_act)
+    unsigned int batch_size_act,
+    unsigned int batch_timeout_us,
+    std::string command_log_file):
+  input_batch_id(0)
 {
+  if (batch_timeout_us == 0) {
+    iq = std::make_unique<BatchedInputQueue>(batch_size_act);
+  } else {
+    iq = std::make_unique<PerActionInputQueue>(batch_size_act, batch_timeout_us);
+  }
+
+  if (command_log_file.empty() == false) {
+    log = std::make_unique<CommandLog>(command_log_file.c_str());
+  }
+
   pthread_rwlock_init(&input_lock, NULL);
   queues.resize(thread_number);
 };
 
 void ThreadInputQueues::add_action(std::unique_ptr<IBatchAction>&& act) {
-  iq.add_action(std::move(act));
+  iq->add_action(std::move(act));
 };
 
 void ThreadInputQueues::flush_actions() {
-  iq.flush();
+  iq->flush();
 };
 
 bool ThreadInputQueues::unassigned_input_exists() {
-  return iq.is_empty() == false;
+  return iq->is_empty() == false;
 };
 
 ThreadInputQueue& ThreadInputQueues::get_my_queue(SchedulerThread* s) {
@@ -69,15 +80,27 @@ void ThreadInputQueues::assign_inputs(SchedulerThread* s) {
     return; 
   }
 
-  // Lock is granted. Assign inputs.
+  // Lock is granted. Assign inputs. Batches are held back until the input
+  // runs dry or all queues are served, so that they are logged together.
   InputQueue::BatchActions actions;
+  std::vector<std::pair<unsigned int, SchedulerThreadBatch>> assigned;
+  auto hand_out = [this, &assigned]() {
+    if (log != nullptr) log->Sync();
+    for (auto& a : assigned) {
+      queues[a.first].push_tail(std::move(a.second));
+    }
+
+    assigned.clear();
+  };
+
   unsigned int thread_count = queues.size();
   for (unsigned int i = 0; i < thread_count; i++) {
     auto& cur_queue = queues[i]; 
     if (cur_queue.is_empty() == false) continue;
 
-    while((actions = iq.try_get_action_batch()).size() == 0) {
+    while((actions = iq->try_get_action_batch()).size() == 0) {
       // No input to the system available.
+      hand_out();
       if (input_awaits(s)) {
         // if the distributing thread has unfinished work, stop waiting
         // and continue execution.
@@ -92,11 +115,18 @@ void ThreadInputQueues::assign_inputs(SchedulerThread* s) {
     }
 
     // Input to the system exists, assign it.
-    cur_queue.push_tail({
+    SchedulerThreadBatch batch = {
         .batch = std::move(actions),
         .batch_id = input_batch_id ++ 
-    });
+    };
+    if (log != nullptr) {
+      BatchCommandLog::append_batch(log.get(), batch.batch, batch.batch_id);
+    }
+
+    assigned.push_back(std::make_pair(i, std::move(batch)));
   } 
+
+  hand_out();
 };
 
 SchedulerManager::SchedulerManager(
@@ -108,23 +138,57 @@ SchedulerManager::SchedulerManager(
   IF_SCHED_MAN_DIAG(diag(c.num_table_merging_shard) COMMA)
   thread_input(
       c.scheduling_threads_count,
-      c.batch_size_act),
+      c.batch_size_act,
+      c.batch_timeout_us,
+      c.command_log_file),
   pending_batches(c.scheduling_threads_count),
   sorted_pending_batches(),
-  records_per_stage(
-      db_c.tables_definitions[0].num_records /\
-      (c.num_table_merging_shard - 1)),
+  stage_ranges(get_stage_ranges(db_c, c.num_table_merging_shard)),
   merging_queues(c.num_table_merging_shard)
 {
-  // This system is designed to only work with a single 
-  // database storage table. If you want more, please redesign it. 
-  // Look at how the db is horizontally sharded for passing to execution.
-  assert(db_c.tables_definitions.size() == 1);
-  assert(db_c.tables_definitions[0].table_id == 0);
-
 	create_threads();
 };
 
+std::vector<SchedulerManager::KeyRange> SchedulerManager::get_stage_ranges(
+    const DBStorageConfig& db_c,
+    unsigned int stages_number) {
+  std::vector<BatchTableConfig> tables = db_c.tables_definitions;
+  std::sort(tables.begin(), tables.end(), 
+      [](const BatchTableConfig& a, const BatchTableConfig& b) {
+        return a.table_id < b.table_id;
+      });
+
+  uint64_t total = 0;
+  for (auto& table : tables) {
+    std::sort(table.keys.begin(), table.keys.end());
+    total += table.num_records;
+  }
+  assert(stages_number > 0 && total >= stages_number);
+
+  // the key at position pos of the ordering of all keys.
+  auto key_at = [&tables](uint64_t pos) {
+    for (auto& table : tables) {
+      if (pos < table.num_records) {
+        return RecordKey(table.get_key(pos), table.table_id);
+      }
+
+      pos -= table.num_records;
+    }
+
+    assert(false);
+    return RecordKey(0);
+  };
+
+  std::vector<KeyRange> ranges;
+  for (uint64_t i = 0; i < stages_number; i++) {
+    ranges.push_back(std::make_pair(
+          key_at(total * i / stages_number),
+          key_at(total * (i + 1) / stages_number - 1)));
+  }
+
+  return ranges;
+};
+
 bool SchedulerManager::system_is_initialized() {
   return schedulers.size() > 0;
 }
@@ -145,8 +209,15 @@ void SchedulerManager::create_threads() {
   for (int i = 0; 
       i < this->conf.scheduling_threads_count; 
       i++) {
+    std::vector<int> helper_cpus;
+    for (unsigned int j = 1; j < conf.packing_threads_count; j++) {
+      helper_cpus.push_back(
+          conf.first_pin_cpu_id + j * conf.scheduling_threads_count + i);
+    }
+
 		schedulers.push_back(
-			std::make_shared<Scheduler>(this, conf.first_pin_cpu_id + i, i));
+			std::make_shared<Scheduler>(
+        this, conf.first_pin_cpu_id + i, i, helper_cpus));
   }
 };
 
@@ -332,15 +403,11 @@ void SchedulerManager::merge_into_global_schedule(unsigned int stage) {
 
   TIME_IF_SCHED_MAN_DIAGNOSTICS(
     auto& m_queue = merging_queues.merging_stages[stage];
-    RecordKey lo(records_per_stage * stage);
-    RecordKey hi(records_per_stage * (stage + 1) - 1);
+    const RecordKey& lo = stage_ranges[stage].first;
+    const RecordKey& hi = stage_ranges[stage].second;
     AwaitingBatchQueue* next_queue;
 
     if (stage == merging_queues.merging_stages.size() - 1) {
-      // NOTE: 
-      //  As mentioned before, we assume only ONE table. In this case we
-      //  must have that each table has the same size, which is weaker.
-      hi.key = (this->db_conf.tables_definitions[0].num_records  - 1); 
       next_queue = &merging_queues.merged_batches;
     } else {
       next_queue = &merging_queues.merging_stages[stage + 1];
@@ -392,8 +459,8 @@ void SchedulerManager::signal_execution_threads() {
     while (m_queue.is_empty() == false) {
       auto& curr_aw_batch = m_queue.peek_head();
       exec_manager->signal_execution_threads(std::move(curr_aw_batch.tw));  
-      m_queue.pop_head();
       tmp_aw_batches.push_back(std::move(curr_aw_batch));
+      m_queue.pop_head();
     }
     
     IF_SCHED_MAN_DIAG(
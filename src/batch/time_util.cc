@@ -21,3 +21,8 @@ TimeUtilities::TimePoint TimeUtilities::now() {
   return system_clock::now(); 
 }
 
+uint64_t TimeUtilities::now_ns() {
+  return duration_cast<nanoseconds>(
+      steady_clock::now().time_since_epoch()).count();
+}
+
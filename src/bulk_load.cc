@@ -0,0 +1,385 @@
+#include <bulk_load.h>
+#include <mv_checkpoint.h>
+#include <runnable.hh>
+#include <cpuinfo.h>
+#include <ycsb.h>
+#include <small_bank.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Loader threads allocate records in chunks of this size. */
+#define BULK_LOAD_CHUNK (((uint64_t)1) << 24)
+
+WorkloadLoadSource::WorkloadLoadSource(bool small_bank, uint64_t num_records)
+{
+        this->small_bank = small_bank;
+        this->num_records = num_records;
+}
+
+uint32_t WorkloadLoadSource::NumTables()
+{
+        if (small_bank)
+                return 2;
+        return 1;
+}
+
+uint64_t WorkloadLoadSource::NumRecords(__attribute__((unused))
+                                        uint32_t table_id)
+{
+        return num_records;
+}
+
+uint64_t WorkloadLoadSource::RecordSize(__attribute__((unused))
+                                        uint32_t table_id)
+{
+        if (small_bank)
+                return sizeof(SmallBankRecord);
+        return YCSB_RECORD_SIZE;
+}
+
+uint64_t WorkloadLoadSource::GetKey(__attribute__((unused)) uint32_t table_id,
+                                    uint64_t index)
+{
+        return index;
+}
+
+/*
+ * LoadCustomerRange draws balances in [0, 100) with rand(), these are drawn
+ * from the key so that any thread can produce them.
+ */
+const char* WorkloadLoadSource::GetValue(uint32_t table_id, uint64_t index,
+                                         char *buf)
+{
+        SmallBankRecord *rec;
+        uint64_t state;
+
+        if (small_bank == false) {
+                ycsb_insert::gen_rand(index, buf);
+                return buf;
+        }
+        rec = (SmallBankRecord*)buf;
+        memset(rec, 0x0, sizeof(SmallBankRecord));
+        state = (2*index + table_id)*0x9E3779B97F4A7C15 + 1;
+        state ^= state >> 29;
+        rec->amount = (long)(state % 100);
+        return buf;
+}
+
+FileLoadSource::FileLoadSource(const char *dir)
+{
+        mv_checkpoint_manifest manifest;
+        mv_checkpoint_header header;
+        std::string file_name;
+        struct stat st;
+        table_map map;
+        uint32_t i;
+        int fd;
+
+        manifest = MVCheckpointer::ReadManifest(dir);
+        this->epoch = manifest.epoch;
+        for (i = 0; i < manifest.num_tables; ++i) {
+                file_name = MVCheckpointer::TableFile(dir, manifest.epoch, i);
+                fd = open(file_name.c_str(), O_RDONLY);
+                if (fd < 0 || fstat(fd, &st) != 0 ||
+                    (uint64_t)st.st_size < sizeof(header)) {
+                        std::cerr << "Couldn't read checkpoint " << file_name;
+                        std::cerr << "\n";
+                        exit(-1);
+                }
+                map.len = st.st_size;
+                map.data = (char*)mmap(NULL, map.len, PROT_READ, MAP_PRIVATE,
+                                       fd, 0);
+                close(fd);
+                if (map.data == MAP_FAILED) {
+                        std::cerr << "Couldn't map checkpoint " << file_name;
+                        std::cerr << "\n";
+                        exit(-1);
+                }
+                memcpy(&header, map.data, sizeof(header));
+                if (header.epoch != manifest.epoch || header.table_id != i ||
+                    map.len != sizeof(header) + header.num_records*
+                    (sizeof(uint64_t) + header.record_size)) {
+                        std::cerr << "Checkpoint " << file_name;
+                        std::cerr << " is corrupt\n";
+                        exit(-1);
+                }
+                map.record_size = header.record_size;
+                map.num_records = header.num_records;
+                tables.push_back(map);
+        }
+}
+
+FileLoadSource::~FileLoadSource()
+{
+        for (table_map &map : tables)
+                munmap(map.data, map.len);
+}
+
+uint32_t FileLoadSource::Epoch()
+{
+        return epoch;
+}
+
+const char* FileLoadSource::Record(uint32_t table_id, uint64_t index)
+{
+        table_map *map;
+
+        assert(table_id < tables.size());
+        map = &tables[table_id];
+        assert(index < map->num_records);
+        return map->data + sizeof(mv_checkpoint_header) +
+                index*(sizeof(uint64_t) + map->record_size);
+}
+
+uint32_t FileLoadSource::NumTables()
+{
+        return tables.size();
+}
+
+uint64_t FileLoadSource::NumRecords(uint32_t table_id)
+{
+        assert(table_id < tables.size());
+        return tables[table_id].num_records;
+}
+
+uint64_t FileLoadSource::RecordSize(uint32_t table_id)
+{
+        assert(table_id < tables.size());
+        return tables[table_id].record_size;
+}
+
+uint64_t FileLoadSource::GetKey(uint32_t table_id, uint64_t index)
+{
+        uint64_t key;
+
+        memcpy(&key, Record(table_id, index), sizeof(uint64_t));
+        return key;
+}
+
+const char* FileLoadSource::GetValue(uint32_t table_id, uint64_t index,
+                                     __attribute__((unused)) char *buf)
+{
+        return Record(table_id, index) + sizeof(uint64_t);
+}
+
+class BulkLoadThread : public Runnable {
+ private:
+        BulkLoaderConfig config;
+        uint32_t id;
+        bool partition;
+        std::vector<uint64_t> *owned;
+        char *buf;
+
+        /* Indexes of table_id's records which scanner found owner owns. */
+        std::vector<uint64_t>* Owned(uint32_t scanner, uint32_t owner,
+                                     uint32_t table_id)
+        {
+                return &owned[(scanner*config.num_threads + owner)*
+                              config.source->NumTables() + table_id];
+        }
+
+        /*
+         * Sort this thread's range of every table by owner. Each scanner 
+         * appends to its own lists only.
+         */
+        void Partition()
+        {
+                BulkLoadSource *source;
+                uint64_t n, i;
+                uint32_t table_id, owner;
+
+                source = config.source;
+                for (table_id = 0; table_id < source->NumTables(); ++table_id) {
+                        n = source->NumRecords(table_id);
+                        for (i = n*id/config.num_threads;
+                             i < n*(id+1)/config.num_threads; ++i) {
+                                owner = config.owner(table_id,
+                                                     source->GetKey(table_id,
+                                                                    i));
+                                assert(owner < config.num_threads);
+                                Owned(id, owner, table_id)->push_back(i);
+                        }
+                }
+        }
+
+        void Insert(uint32_t table_id, uint64_t i)
+        {
+                BulkLoadSource *source;
+                const char *value;
+
+                source = config.source;
+                value = source->GetValue(table_id, i, buf);
+                config.insert(id, table_id, source->GetKey(table_id, i), value,
+                              source->RecordSize(table_id));
+                num_loaded += 1;
+        }
+
+ protected:
+        virtual void Init()
+        {
+                uint64_t buf_size;
+                uint32_t i;
+
+                if (partition)
+                        return;
+                buf_size = 0;
+                for (i = 0; i < config.source->NumTables(); ++i)
+                        buf_size = std::max(buf_size,
+                                            config.source->RecordSize(i));
+                buf = (char*)alloc_mem(std::max(buf_size, (uint64_t)1),
+                                       m_cpu_number);
+                assert(buf != NULL);
+        }
+
+        /*
+         * Without an owner, a thread inserts its range of every table. With 
+         * one, it inserts the records the partition pass found it owns.
+         */
+        virtual void StartWorking()
+        {
+                uint64_t n, i;
+                uint32_t table_id, scanner;
+
+                num_loaded = 0;
+                if (partition) {
+                        Partition();
+                        return;
+                }
+                for (table_id = 0; table_id < config.source->NumTables();
+                     ++table_id) {
+                        if (config.owner) {
+                                for (scanner = 0; scanner < config.num_threads;
+                                     ++scanner)
+                                        for (uint64_t j :
+                                             *Owned(scanner, id, table_id))
+                                                Insert(table_id, j);
+                                continue;
+                        }
+                        n = config.source->NumRecords(table_id);
+                        for (i = n*id/config.num_threads;
+                             i < n*(id+1)/config.num_threads; ++i)
+                                Insert(table_id, i);
+                }
+        }
+
+ public:
+        uint64_t num_loaded;
+
+        void* operator new(std::size_t sz, int cpu)
+        {
+                return alloc_mem(sz, cpu);
+        }
+
+        BulkLoadThread(BulkLoaderConfig config, uint32_t id, bool partition,
+                       std::vector<uint64_t> *owned)
+                : Runnable(config.start_cpu + id)
+        {
+                this->config = config;
+                this->id = id;
+                this->partition = partition;
+                this->owned = owned;
+                this->buf = NULL;
+                this->num_loaded = 0;
+        }
+};
+
+BulkLoader::BulkLoader(BulkLoaderConfig config)
+{
+        uint32_t i;
+        int cpu;
+
+        assert(config.num_threads > 0);
+        assert(config.source != NULL && config.insert);
+        this->config = config;
+        this->arenas = (arena**)malloc(sizeof(arena*)*config.num_threads);
+        assert(this->arenas != NULL);
+        for (i = 0; i < config.num_threads; ++i) {
+                cpu = config.start_cpu + i;
+                arenas[i] = (arena*)alloc_mem(sizeof(arena), cpu);
+                assert(arenas[i] != NULL);
+                arenas[i]->cpu = cpu;
+                arenas[i]->cur = NULL;
+                arenas[i]->left = 0;
+        }
+}
+
+/* Runs one loader thread per cpu, returns the number of records inserted. */
+uint64_t BulkLoader::RunThreads(bool partition, std::vector<uint64_t> *owned)
+{
+        BulkLoadThread **threads;
+        uint64_t ret;
+        uint32_t i;
+
+        threads = (BulkLoadThread**)malloc(sizeof(BulkLoadThread*)*
+                                           config.num_threads);
+        assert(threads != NULL);
+        for (i = 0; i < config.num_threads; ++i) {
+                threads[i] = new(config.start_cpu + i)
+                        BulkLoadThread(config, i, partition, owned);
+                threads[i]->Run();
+        }
+        ret = 0;
+        for (i = 0; i < config.num_threads; ++i) {
+                threads[i]->Join();
+                ret += threads[i]->num_loaded;
+        }
+        free(threads);
+        return ret;
+}
+
+/*
+ * With an owner, the threads first split their ranges of every table up by 
+ * owner, so that each key is looked at once rather than by every thread.
+ */
+uint64_t BulkLoader::Load()
+{
+        std::vector<uint64_t> *owned;
+        uint64_t ret;
+
+        if (!config.owner)
+                return RunThreads(false, NULL);
+
+        owned = new std::vector<uint64_t>[config.num_threads*
+                                          config.num_threads*
+                                          config.source->NumTables()];
+        RunThreads(true, owned);
+        ret = RunThreads(false, owned);
+        delete[] owned;
+        return ret;
+}
+
+void* BulkLoader::Alloc(uint32_t thread, uint64_t sz)
+{
+        arena *a;
+        void *ret;
+
+        assert(thread < config.num_threads);
+        a = arenas[thread];
+        sz = (sz + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+        if (sz > a->left) {
+                a->left = std::max(sz, (uint64_t)BULK_LOAD_CHUNK);
+                a->cur = (char*)alloc_mem(a->left, a->cpu);
+                assert(a->cur != NULL);
+        }
+        ret = a->cur;
+        a->cur += sz;
+        a->left -= sz;
+        return ret;
+}
+
+void BulkLoader::CopyValue(char *record, uint64_t record_size,
+                           const char *value, uint64_t size)
+{
+        if (size >= record_size) {
+                memcpy(record, value, record_size);
+        } else {
+                memcpy(record, value, size);
+                memset(record + size, 0x0, record_size - size);
+        }
+}
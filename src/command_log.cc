@@ -0,0 +1,252 @@
+#include <command_log.h>
+#include <ycsb.h>
+#include <small_bank.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+CommandLog::CommandLog(const char *file_name)
+{
+        this->fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (this->fd < 0) {
+                std::cerr << "Couldn't open command log " << file_name << "\n";
+                exit(-1);
+        }
+        this->cur_txns = 0;
+}
+
+CommandLog::~CommandLog()
+{
+        Sync();
+        close(fd);
+}
+
+void CommandLog::WriteAll(const char *data, uint64_t len)
+{
+        ssize_t written;
+
+        while (len > 0) {
+                written = write(fd, data, len);
+                if (written < 0 && errno == EINTR)
+                        continue;
+                if (written < 0) {
+                        std::cerr << "Couldn't write the command log\n";
+                        exit(-1);
+                }
+                data += written;
+                len -= written;
+        }
+}
+
+void CommandLog::AppendTxn(uint32_t type, const std::vector<uint64_t> &params)
+{
+        command_log_txn_header header;
+        const char *data;
+
+        assert(type != TXN_NOT_LOGGED);
+        header = {
+                type,
+                (uint32_t)params.size(),
+        };
+        data = (const char*)&header;
+        cur_batch.insert(cur_batch.end(), data, data + sizeof(header));
+        data = (const char*)params.data();
+        cur_batch.insert(cur_batch.end(), data,
+                         data + sizeof(uint64_t)*params.size());
+        cur_txns += 1;
+}
+
+void CommandLog::AppendTxn(txn *t)
+{
+        std::vector<uint64_t> params;
+
+        if (t->get_type() == TXN_NOT_LOGGED) {
+                std::cerr << "Transaction can't be command logged\n";
+                exit(-1);
+        }
+        t->get_params(&params);
+        AppendTxn(t->get_type(), params);
+}
+
+void CommandLog::EndBatch(uint64_t batch_id)
+{
+        command_log_batch_header header;
+        const char *data;
+
+        header = {
+                batch_id,
+                cur_txns,
+                cur_batch.size(),
+        };
+        data = (const char*)&header;
+        pending.insert(pending.end(), data, data + sizeof(header));
+        pending.insert(pending.end(), cur_batch.begin(), cur_batch.end());
+        cur_batch.clear();
+        cur_txns = 0;
+}
+
+/* This is the group commit. */
+void CommandLog::Sync()
+{
+        if (pending.size() == 0)
+                return;
+        WriteAll(pending.data(), pending.size());
+        if (fdatasync(fd) != 0) {
+                std::cerr << "Couldn't sync the command log\n";
+                exit(-1);
+        }
+        pending.clear();
+}
+
+uint64_t CommandLog::Read(const char *file_name, replay_fn fn)
+{
+        FILE *f;
+        std::vector<char> data;
+        std::vector<logged_txn> txns;
+        command_log_batch_header batch;
+        command_log_txn_header header;
+        uint64_t pos, batch_end, num_read;
+        long sz;
+        uint32_t i;
+
+        f = fopen(file_name, "rb");
+        if (f == NULL) {
+                std::cerr << "Couldn't open command log " << file_name << "\n";
+                exit(-1);
+        }
+        fseek(f, 0, SEEK_END);
+        sz = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        data.resize(sz);
+        data.resize(fread(data.data(), 1, sz, f));
+        fclose(f);
+
+        num_read = 0;
+        pos = 0;
+        while (pos + sizeof(batch) <= data.size()) {
+                memcpy(&batch, &data[pos], sizeof(batch));
+                pos += sizeof(batch);
+
+                /* 
+                 * A torn write at the end of the log was never synced. Nor 
+                 * was a batch whose contents don't add up to its length.
+                 */
+                if (batch.len > data.size() - pos ||
+                    batch.num_txns > batch.len/sizeof(header))
+                        break;
+                batch_end = pos + batch.len;
+                txns.resize(batch.num_txns);
+                for (i = 0; i < batch.num_txns; ++i) {
+                        if (sizeof(header) > batch_end - pos)
+                                break;
+                        memcpy(&header, &data[pos], sizeof(header));
+                        pos += sizeof(header);
+                        if (header.num_params >
+                            (batch_end - pos)/sizeof(uint64_t))
+                                break;
+                        txns[i].type = header.type;
+                        txns[i].params.resize(header.num_params);
+                        memcpy(txns[i].params.data(), &data[pos],
+                               sizeof(uint64_t)*header.num_params);
+                        pos += sizeof(uint64_t)*header.num_params;
+                }
+                if (i < batch.num_txns || pos != batch_end)
+                        break;
+                fn(batch.batch_id, txns);
+                num_read += batch.num_txns;
+        }
+        return num_read;
+}
+
+txn* CommandLog::CreateTxn(const logged_txn &t)
+{
+        std::vector<uint64_t>::const_iterator mid;
+        uint64_t num_customers;
+
+        switch (t.type) {
+        case YCSB_INSERT_TXN:
+                return new ycsb_insert(t.params[0], t.params[1]);
+        case YCSB_READONLY_TXN:
+                return new ycsb_readonly(t.params);
+        case YCSB_RMW_TXN:
+                mid = t.params.begin() + 1 + t.params[0];
+                return new ycsb_rmw(std::vector<uint64_t>(t.params.begin() + 1,
+                                                          mid),
+                                    std::vector<uint64_t>(mid,
+                                                          t.params.end()));
+        case SMALL_BANK_LOAD_TXN:
+                num_customers = t.params.size() / 3;
+                mid = t.params.begin() + num_customers;
+                return new SmallBank::LoadCustomerRange(
+                        std::vector<uint64_t>(t.params.begin(), mid),
+                        std::vector<long>(mid, t.params.end()));
+        case SMALL_BANK_BALANCE_TXN:
+                return new SmallBank::Balance(t.params[0]);
+        case SMALL_BANK_DEPOSIT_CHECKING_TXN:
+                return new SmallBank::DepositChecking(t.params[0],
+                                                      (long)t.params[1]);
+        case SMALL_BANK_TRANSACT_SAVING_TXN:
+                return new SmallBank::TransactSaving(t.params[0],
+                                                     (long)t.params[1]);
+        case SMALL_BANK_AMALGAMATE_TXN:
+                return new SmallBank::Amalgamate(t.params[0], t.params[1]);
+        case SMALL_BANK_WRITE_CHECK_TXN:
+                return new SmallBank::WriteCheck(t.params[0],
+                                                 (long)t.params[1]);
+        default:
+                std::cerr << "Unknown command log transaction " << t.type;
+                std::cerr << "\n";
+                exit(-1);
+        }
+}
+
+MVCommandLogger::MVCommandLogger(MVCommandLoggerConfig config)
+        : Runnable(config.cpu)
+{
+        assert(config.max_group > 0);
+        this->config = config;
+        this->log = new CommandLog(config.file_name);
+        this->group = (ActionBatch*)alloc_mem(sizeof(ActionBatch)*
+                                              config.max_group, config.cpu);
+        assert(this->group != NULL);
+}
+
+void MVCommandLogger::Init()
+{
+}
+
+/* Actions of a batch carry the epoch of the batch in their versions. */
+void MVCommandLogger::LogBatch(const ActionBatch &batch)
+{
+        uint32_t i;
+        uint64_t epoch;
+
+        epoch = 0;
+        for (i = 0; i < batch.numActions; ++i) {
+                epoch = GET_MV_EPOCH(batch.actionBuf[i]->__version) >> 32;
+                log->AppendTxn(batch.actionBuf[i]->get_txn());
+        }
+        log->EndBatch(epoch);
+}
+
+void MVCommandLogger::StartWorking()
+{
+        uint32_t i, num_batches;
+
+        while (true) {
+                group[0] = config.inputQueue->DequeueBlocking();
+                num_batches = 1;
+                while (num_batches < config.max_group &&
+                       config.inputQueue->Dequeue(&group[num_batches]))
+                        num_batches += 1;
+                for (i = 0; i < num_batches; ++i)
+                        LogBatch(group[i]);
+                log->Sync();
+                for (i = 0; i < num_batches; ++i)
+                        config.outputQueue->EnqueueBlocking(group[i]);
+        }
+}
@@ -4,6 +4,7 @@
 txn::txn()
 {
         this->trans = NULL;
+        this->isolation = DEFAULT_ISOLATION;
 }
 
 void txn::set_translator(translator *trans)
@@ -12,6 +13,21 @@ void txn::set_translator(translator *trans)
         this->trans = trans;
 }
 
+isolation_level txn::get_isolation()
+{
+        return this->isolation;
+}
+
+void txn::set_isolation(isolation_level isolation)
+{
+        this->isolation = isolation;
+}
+
+isolation_level translator::get_isolation()
+{
+        return this->t->get_isolation();
+}
+
 void* txn::get_write_ref(uint64_t key, uint32_t table_id)
 {
         return trans->write_ref(key, table_id);
@@ -52,6 +68,16 @@ void txn::get_rmws(__attribute__((unused)) struct big_key *array)
         return;
 }
 
+txn_type txn::get_type()
+{
+        return TXN_NOT_LOGGED;
+}
+
+void txn::get_params(__attribute__((unused)) std::vector<uint64_t> *params)
+{
+        return;
+}
+
 int txn::txn_rand()
 {
         return trans->rand();
@@ -109,23 +109,52 @@ Executor::Executor(ExecutorConfig cfg) : Runnable (cfg.cpu)
 {        
         this->config = cfg;
         this->counter = 0;
+        this->checkpointing = false;
         this->pendingList = new (config.cpu) PendingActionList(1000);
         this->garbageBin = new (config.cpu) GarbageBin(config.garbageConfig);
+
+        /* Payloads of the versions this executor writes, one pool per table. */
+        this->allocators = 
+                (RecordAllocator**)alloc_mem(sizeof(RecordAllocator*)*config.numTables,
+                                             config.cpu);
+        for (uint32_t i = 0; i < config.numTables; ++i) {
+                this->allocators[i] = 
+                        new (config.cpu) RecordAllocator(config.recordSizes[i],
+                                                         (uint32_t)config.allocatorSizes[i],
+                                                         config.cpu);
+        }
 }
 
 void Executor::Init() 
 {
 }
 
-/* Adjusts the low watermark of completed epoch#s across execution threads */
+/* 
+ * Adjusts the low watermark of completed epoch#s across execution threads. 
+ * 
+ * A checkpoint requested before the executors' epochs are read is given the 
+ * epoch after the newest one any executor has finished. An executor reads 
+ * the request before starting each epoch, so every epoch after the 
+ * checkpoint's copies RMW payloads rather than taking them over. The 
+ * low-water mark is held at the checkpoint's epoch until the checkpoint is 
+ * done, so that none of the versions it reads are garbage collected.
+ */
 void Executor::adjust_lowwatermark()
 {
         assert(config.threadId == 0);
         
         volatile uint32_t min_epoch;
-        uint32_t i, temp;
+        uint32_t i, temp, max_epoch, ckpt;
+
+        ckpt = MV_CKPT_IDLE;
+        if (config.checkpointPtr != NULL) {
+                barrier();
+                ckpt = *config.checkpointPtr;
+                barrier();
+        }
 
         min_epoch = *config.epochPtr;
+        max_epoch = 0;
         for (i = 0; i < config.numExecutors; ++i) {
                 barrier();
                 temp = config.epochPtr[i];
@@ -134,10 +163,58 @@ void Executor::adjust_lowwatermark()
                 if (temp < min_epoch) {
                         min_epoch = temp;
                 }                
+                if (temp > max_epoch)
+                        max_epoch = temp;
         }        
+
+        if (ckpt == MV_CKPT_REQUEST) {
+                ckpt = max_epoch + 1;
+                barrier();
+                *config.checkpointPtr = ckpt;
+                barrier();
+        }
+        if (ckpt != MV_CKPT_IDLE && ckpt < min_epoch)
+                min_epoch = ckpt;
         
+        // Idle executors poll the low-water mark, avoid needless invalidations.
+        barrier();
+        if (*config.lowWaterMarkPtr != min_epoch)
+                *config.lowWaterMarkPtr = min_epoch;
+        barrier();
+}
+
+/* 
+ * Raise the low-water mark to the oldest epoch every executor has finished, 
+ * for executors other than the leader. The epochs are read before the 
+ * checkpoint word, so a checkpoint requested in between pins a later epoch 
+ * than any of them. The leader may still write an older mark in between, 
+ * which only delays garbage collection.
+ */
+void Executor::raise_lowwatermark()
+{
+        volatile uint32_t *epochs;
+        uint32_t i, temp, min_epoch, ckpt;
+
+        /* Executors publish their epochs in consecutive words. */
+        epochs = config.epochPtr - config.threadId;
+        min_epoch = 0xFFFFFFFF;
+        for (i = 0; i < config.numExecutors; ++i) {
+                barrier();
+                temp = epochs[i];
+                barrier();
+                if (temp < min_epoch)
+                        min_epoch = temp;
+        }
+
+        fence();
+        ckpt = *config.checkpointPtr;
+        barrier();
+        if (ckpt != MV_CKPT_IDLE && ckpt != MV_CKPT_REQUEST && ckpt < min_epoch)
+                min_epoch = ckpt;
+
         barrier();
-        *config.lowWaterMarkPtr = min_epoch;
+        if (*config.lowWaterMarkPtr < min_epoch)
+                *config.lowWaterMarkPtr = min_epoch;
         barrier();
 }
 
@@ -148,19 +225,29 @@ void Executor::StartWorking()
 
         while (true) {
 
-                if (config.threadId == 0) {
-                        while (!config.inputQueue->Dequeue(&batch)) {
+                /* 
+                 * While waiting for the next batch, keep handing back garbage 
+                 * the low-water mark has passed, so that threads blocked on 
+                 * their allocators don't wait for the next epoch to end.
+                 */
+                while (!config.inputQueue->Dequeue(&batch)) {
+                        if (config.threadId == 0)
                                 adjust_lowwatermark();
-                        }
-                        ProcessBatch(batch);
-                } else {
-                        batch = config.inputQueue->DequeueBlocking();
-                        ProcessBatch(batch);    
+                        garbageBin->Poll();
                 }
+                ProcessBatch(batch);
 
                 barrier();
                 *config.epochPtr = epoch;
                 barrier();
+
+                /* The epoch must be visible before the request is read. */
+                if (config.checkpointPtr != NULL) {
+                        fence();
+                        checkpointing = 
+                                (*config.checkpointPtr != MV_CKPT_IDLE);
+                        barrier();
+                }
     
                 // If this is the leader thread, try to advance the low-water mark to 
                 // trigger garbage collection
@@ -169,6 +256,7 @@ void Executor::StartWorking()
 
                 // Try to return records that are no longer visible to their owners
                 garbageBin->FinishEpoch(epoch);
+                RecycleData();
                 epoch += 1;
         }
 }
@@ -319,7 +407,6 @@ bool Executor::check_ready(mv_action *action)
         bool ready;
         mv_action *depend_action;
         MVRecord *prev;
-        void *new_data, *old_data;
         uint32_t *read_index, *write_index;
 
         ready = true;
@@ -351,22 +438,110 @@ bool Executor::check_ready(mv_action *action)
                             !ProcessSingle(depend_action)) {
                                 ready = false;
                                 break;
-                        } else if (action->__writeset[i].initialized == false) {
-                                /* 
-                                 * XXX This is super hacky. Need to separate 
-                                 * record allocation from version allocation to 
-                                 * make it work -- "engineering work". 
-                                 */
-                                new_data = action->__writeset[i].value->value;
-                                old_data = prev->value;
-                                memcpy(new_data, old_data, GLOBAL_RECORD_SIZE);
-                                action->__writeset[i].initialized = true;
                         }
                 }
+                if (action->__writeset[i].initialized == false) {
+                        attach_payload(&action->__writeset[i]);
+                        action->__writeset[i].initialized = true;
+                }
         }
         return ready;
 }
 
+/* 
+ * Take a payload from this executor's pool for the given table. If the pool 
+ * is empty, pick up payloads other executors have garbage collected.
+ */
+Record* Executor::alloc_payload(uint32_t table_id)
+{
+        Record *rec;
+        uint32_t finished;
+        bool waiting;
+
+        if (allocators[table_id]->GetRecord(&rec) == false) {
+                RecycleData();
+                allocators[table_id]->GetRecord(&rec);
+        }
+
+        /* 
+         * A checkpoint holds back garbage collection while it is pinned, and 
+         * the garbage it held back takes a while to come back after. Keep 
+         * garbage moving until the low-water mark has caught up with this 
+         * executor. The other executors can get there without this one, and 
+         * the leader may be waiting on it, so don't rely on the leader to 
+         * move the mark. Then give up.
+         */
+        finished = *config.epochPtr;
+        waiting = (config.checkpointPtr != NULL);
+        while (rec == NULL && waiting) {
+                barrier();
+                waiting = (*config.lowWaterMarkPtr < finished);
+                barrier();
+                if (config.threadId == 0)
+                        adjust_lowwatermark();
+                else
+                        raise_lowwatermark();
+                garbageBin->Poll();
+                RecycleData();
+                allocators[table_id]->GetRecord(&rec);
+        }
+        assert(rec != NULL);    // Can't deal with allocation failures yet.
+        return rec;
+}
+
+/* 
+ * Give a version a payload before its writer runs. An RMW's payload starts 
+ * out with the previous version's contents. If every reader the scheduler 
+ * directed to the previous version has finished, the previous version's 
+ * payload is taken over instead of copied; the previous version is dead to 
+ * everyone else, unless a checkpoint is in progress. 
+ */
+void Executor::attach_payload(CompositeKey *write)
+{
+        MVRecord *version, *prev;
+        uint32_t table_id;
+
+        version = write->value;
+        prev = version->recordLink;
+        table_id = write->tableId;
+        assert(version->value == NULL);
+        if (write->is_rmw == true) {
+                assert(prev != NULL && prev->value != NULL);
+                barrier();
+                if (prev->doneReaders == prev->numReaders && 
+                    checkpointing == false) {
+                        version->value = prev->value;
+                        version->writingThread = prev->writingThread;
+                        prev->value = NULL;
+                        return;
+                }
+        }
+
+        version->value = alloc_payload(table_id);
+        version->writingThread = config.threadId;
+        if (write->is_rmw == true) 
+                memcpy(version->value->value, prev->value->value, 
+                       config.recordSizes[table_id]);
+}
+
+/* Tell the versions an action has read that it is done reading them. */
+void Executor::finish_reads(mv_action *action)
+{
+        uint32_t num_reads, i;
+        uint64_t read_epoch;
+        MVRecord *rec;
+
+        read_epoch = GET_MV_EPOCH(action->__version);
+        num_reads = action->__readset.size();
+        for (i = 0; i < num_reads; ++i) {
+                rec = action->__readset[i].value;
+                if (action->__readonly == true && 
+                    read_epoch == GET_MV_EPOCH(rec->createTimestamp))
+                        rec = rec->epoch_ancestor;
+                fetch_and_increment(&rec->doneReaders);
+        }
+}
+
 /* 
  * Run a read-only transaction against an epoch which immediately precedes that 
  * of the transaction. 
@@ -381,7 +556,7 @@ bool Executor::run_readonly(mv_action *action)
         uint32_t num_reads, i;
         uint64_t read_epoch;
         MVRecord *rec, *snapshot;
-        void *value_ptr;
+        mv_action *depend_action;
 
         read_epoch = GET_MV_EPOCH(action->__version);
         num_reads = action->__readset.size();
@@ -393,13 +568,15 @@ bool Executor::run_readonly(mv_action *action)
                         snapshot = rec;
 
                 barrier();
-                value_ptr = snapshot->value;
+                depend_action = snapshot->writer;
                 barrier();
-                if (value_ptr == NULL)
+                if (depend_action != NULL && 
+                    depend_action->__state != SUBSTANTIATED)
                         return false;
         }
         action->exec = this;
         action->Run();
+        finish_reads(action);
         xchgq(&action->__state, SUBSTANTIATED);
         return true;
         
@@ -424,9 +601,14 @@ bool Executor::ProcessTxn(mv_action *action)
         
         action->exec = this;
         action->Run();
+        finish_reads(action);
         xchgq(&action->__state, SUBSTANTIATED);
 
-        /* Register over-written versions for garbage collection */
+        /* 
+         * Register over-written versions for garbage collection. Their 
+         * payloads are collected along with them, see 
+         * GarbageBin::CollectPayloads.
+         */
         num_writes = action->__writeset.size();
         for (i = 0; i < num_writes; ++i) {
                 pred_version = action->__writeset[i].value->recordLink;
@@ -437,47 +619,61 @@ bool Executor::ProcessTxn(mv_action *action)
         return true;
 }
 
+template<class List>
+static inline void clear_list(List *list)
+{
+        list->head = NULL;
+        list->tail = &list->head;
+        list->count = 0;
+}
+
+/* Move every element of from to the end of to. */
+template<class List>
+static inline void append_list(List *to, List *from)
+{
+        if (from->head == NULL)
+                return;
+        *(to->tail) = from->head;
+        to->tail = from->tail;
+        to->count += from->count;
+        clear_list(from);
+}
+
 GarbageBin::GarbageBin(GarbageBinConfig config) 
 {
         assert(sizeof(MVRecordList) == sizeof(RecordList));
         this->config = config;
-        this->snapshotEpoch = 0;
-
-        // total number of structs
-        uint32_t numStructs = 
-                (config.numCCThreads + config.numWorkers*config.numTables);
-        uint32_t ccOffset = config.numCCThreads*sizeof(MVRecordList);
-        uint32_t workerOffset = 
-                config.numWorkers*config.numTables*sizeof(MVRecordList);
-
-        // twice #structs: one for live, one for snapshot
-        void *data = alloc_mem(2*numStructs*sizeof(MVRecordList), config.cpu);
-        memset(data, 0x00, 2*numStructs*sizeof(MVRecordList));
-  
+        this->genHead = 0;
+        this->genCount = 0;
+        memset(&this->stats, 0x0, sizeof(GarbageBinStats));
+
+        // Current, free, and one set per generation of sticky lists, plus one 
+        // free record list per (worker, table).
+        uint32_t numStickies = (GC_GENERATIONS + 2)*config.numCCThreads;
+        uint32_t numRecords = config.numWorkers*config.numTables;
+        size_t sz = (numStickies + numRecords)*sizeof(MVRecordList);
+        void *data = alloc_mem(sz, config.cpu);
+        memset(data, 0x00, sz);
+
         this->curStickies = (MVRecordList*)data;
-        this->snapshotStickies = (MVRecordList*)((char*)data + ccOffset);
-        for (uint32_t i = 0; i < 2*config.numCCThreads; ++i) {
-                curStickies[i].tail = &curStickies[i].head;
-                curStickies[i].head = NULL;
-                curStickies[i].count = 0;
-        }
-  
-        this->curRecords = (RecordList*)((char*)data + 2*ccOffset);
-        this->snapshotRecords = (RecordList*)((char*)data + 2*ccOffset+workerOffset);
-        for (uint32_t i = 0; i < 2*config.numWorkers; ++i) {
-                curRecords[i].tail = &curRecords[i].head;
-                curRecords[i].head = NULL;
-                curRecords[i].count = 0;
-        }
+        this->genStickies = &curStickies[config.numCCThreads];
+        this->freeStickies = 
+                &genStickies[GC_GENERATIONS*config.numCCThreads];
+        this->freeRecords = 
+                (RecordList*)&freeStickies[config.numCCThreads];
+        for (uint32_t i = 0; i < numStickies; ++i)
+                clear_list(&curStickies[i]);
+        for (uint32_t i = 0; i < numRecords; ++i)
+                clear_list(&freeRecords[i]);
 }
 
 void GarbageBin::AddMVRecord(uint32_t ccThread, MVRecord *rec) 
 {
         rec->allocLink = NULL;
-        // rec->allocLink = NULL;
         *(curStickies[ccThread].tail) = rec;
         curStickies[ccThread].tail = &rec->allocLink;
         curStickies[ccThread].count += 1;
+        stats.collectedVersions += 1;
         assert(curStickies[ccThread].head != NULL);
 }
 
@@ -485,32 +681,107 @@ void GarbageBin::AddRecord(uint32_t workerThread, uint32_t tableId,
                            Record *rec) 
 {
         //  rec->next = NULL;
-        *(curRecords[workerThread*config.numTables+tableId].tail) = rec;
-        curRecords[workerThread*config.numTables+tableId].tail = &rec->next;  
-        curRecords[workerThread*config.numTables+tableId].count += 1;
+        *(freeRecords[workerThread*config.numTables+tableId].tail) = rec;
+        freeRecords[workerThread*config.numTables+tableId].tail = &rec->next;  
+        freeRecords[workerThread*config.numTables+tableId].count += 1;
 }
 
-void GarbageBin::ReturnGarbage() 
+/* 
+ * Move the payloads of dead versions to the lists of the executors whose pools 
+ * they came from. A version whose payload was taken over by an RMW of the 
+ * record has none.
+ *
+ * Also cut the dead versions out of their chains, so that nothing in a pool 
+ * still points at versions which may already have been recycled. The newer 
+ * version that killed a dead version keeps its recordLink to it, but that link 
+ * is only followed by readers older than the newer version, and the low-water 
+ * mark has passed all of them.
+ */
+void GarbageBin::CollectPayloads(MVRecordList *stickies)
 {
-        for (uint32_t i = 0; i < config.numCCThreads; ++i) {
-                // *curStickies[i].tail = NULL;
+        for (MVRecord *rec = stickies->head; rec != NULL; rec = rec->allocLink) {
+                if (rec->value != NULL) {
+                        AddRecord(rec->writingThread, rec->tableId, rec->value);
+                        rec->value = NULL;
+                        stats.reclaimedPayloads += 1;
+                }
+                rec->link = NULL;
+                rec->recordLink = NULL;
+                rec->epoch_ancestor = NULL;
+        }
+}
 
-                // Try to enqueue garbage. If enqueue fails, we'll just try again during the
-                // next call.
-                if (snapshotStickies[i].head != NULL) {
-                        if (!config.ccChannels[i]->Enqueue(snapshotStickies[i])) {
-                                *(curStickies[i].tail) = snapshotStickies[i].head;
-                                curStickies[i].tail = snapshotStickies[i].tail;
-                                curStickies[i].count += snapshotStickies[i].count;
-                        }
-                        else {
-                                //        std::cout << "Recycle!\n";
-                        }
+/* Turn the garbage produced during epoch into a generation. */
+void GarbageBin::SealEpoch(uint32_t epoch)
+{
+        uint32_t slot, i;
+        bool empty;
+
+        empty = true;
+        for (i = 0; i < config.numCCThreads; ++i) 
+                empty &= (curStickies[i].head == NULL);
+        if (empty)
+                return;
+
+        if (genCount == GC_GENERATIONS) {
+                // Out of generations, merge into the newest one.
+                slot = (genHead + genCount - 1) % GC_GENERATIONS;
+        } else {
+                slot = (genHead + genCount) % GC_GENERATIONS;
+                genCount += 1;
+        }
+        genEpochs[slot] = epoch;
+        for (i = 0; i < config.numCCThreads; ++i)
+                append_list(&genStickies[slot*config.numCCThreads+i], 
+                            &curStickies[i]);
+}
+
+/* 
+ * Reclaim every generation killed in an epoch all executors have finished. 
+ * Every writer that could have attached a payload to a generation's versions 
+ * has finished by then, and so has every reader.
+ */
+void GarbageBin::Reclaim(uint32_t lowWatermark)
+{
+        MVRecordList *stickies;
+        uint32_t i;
+
+        while (genCount > 0 && genEpochs[genHead] <= lowWatermark) {
+                for (i = 0; i < config.numCCThreads; ++i) {
+                        stickies = &genStickies[genHead*config.numCCThreads+i];
+                        CollectPayloads(stickies);
+                        stats.reclaimedVersions += stickies->count;
+                        append_list(&freeStickies[i], stickies);
                 }
-                snapshotStickies[i] = curStickies[i];
-                curStickies[i].head = NULL;
-                curStickies[i].tail = &curStickies[i].head;
-                curStickies[i].count = 0;
+                genHead = (genHead + 1) % GC_GENERATIONS;
+                genCount -= 1;
+        }
+}
+
+/* 
+ * Hand reclaimed garbage back to its owners. Unless forced, only batches of at 
+ * least GC_BATCH_SIZE are sent. If an owner's queue is full, try again during 
+ * the next call.
+ */
+void GarbageBin::ReturnGarbage(bool force) 
+{
+        uint32_t i, numRecords;
+
+        /* Unlinking must be visible before the owners reuse the versions. */
+        barrier();
+        for (i = 0; i < config.numCCThreads; ++i) {
+                if (freeStickies[i].head != NULL && 
+                    (force || freeStickies[i].count >= GC_BATCH_SIZE) &&
+                    config.ccChannels[i]->Enqueue(freeStickies[i]))
+                        clear_list(&freeStickies[i]);
+        }
+
+        numRecords = config.numWorkers*config.numTables;
+        for (i = 0; i < numRecords; ++i) {
+                if (freeRecords[i].head != NULL && 
+                    (force || freeRecords[i].count >= GC_BATCH_SIZE) &&
+                    config.workerChannels[i]->Enqueue(freeRecords[i]))
+                        clear_list(&freeRecords[i]);
         }
 }
 
@@ -519,12 +790,20 @@ void GarbageBin::FinishEpoch(uint32_t epoch)
         barrier();
         uint32_t lowWatermark = *config.lowWaterMarkPtr;
         barrier();
-  
-        if (lowWatermark >= snapshotEpoch) {
-                ReturnGarbage();
-                snapshotEpoch = epoch;
-                //    std::cout << "Success: " << epoch << "\n";
-        }
+
+        SealEpoch(epoch);
+        Reclaim(lowWatermark);
+        ReturnGarbage(false);
+}
+
+void GarbageBin::Poll()
+{
+        barrier();
+        uint32_t lowWatermark = *config.lowWaterMarkPtr;
+        barrier();
+
+        Reclaim(lowWatermark);
+        ReturnGarbage(true);
 }
 
 RecordAllocator::RecordAllocator(size_t recordSize, uint32_t numRecords, 
@@ -20,11 +20,68 @@ static void init_list(char *start, uint32_t num_records, uint32_t record_sz)
         cur->next = NULL;
 }
 
+void hek_worker::init_timestamps()
+{
+        ts_next = 0;
+        ts_limit = 0;
+        ts_last = 0;
+        ts_thread_bits = 0;
+        while (((uint32_t)1 << ts_thread_bits) < config.num_threads)
+                ts_thread_bits += 1;
+}
+
+/* Hand out the next timestamp of the lease, leasing more when it runs out. */
+uint64_t hek_worker::lease_timestamp()
+{
+        if (ts_next == ts_limit) {
+                ts_limit = fetch_and_add(config.global_time,
+                                         HEK_TS_LEASE_SIZE) + 1;
+                ts_next = ts_limit - HEK_TS_LEASE_SIZE;
+        }
+        return ts_next++;
+}
+
+/* 
+ * Worker indexes in the low order bits keep timestamps unique. The clock is 
+ * bumped if it did not advance since the last timestamp. 
+ */
+uint64_t hek_worker::clock_timestamp()
+{
+        uint64_t ts;
+
+        ts = ((rdtsc() - config.clock_base + 1) << ts_thread_bits) | 
+                (uint64_t)config.cpu;
+        if (ts <= ts_last)
+                ts = ts_last + ((uint64_t)1 << ts_thread_bits);
+        assert(CREATE_EXEC_TIMESTAMP(ts) >> 8 == ts);
+        ts_last = ts;
+        return ts;
+}
+
 uint64_t hek_worker::get_timestamp()
 {
-        return fetch_and_increment(config.global_time);
-        //        uint64_t ts = rdtsc();
-        //        return (ts << 8);
+        switch (config.ts_alloc) {
+        case HEK_TS_LEASE:
+                return lease_timestamp();
+        case HEK_TS_CLOCK:
+                return clock_timestamp();
+        default:
+                return fetch_and_increment(config.global_time);
+        }
+}
+
+/* 
+ * Only begin timestamps are leased. A lease may lag behind txns which already 
+ * committed, and a txn ending below them would validate its reads against a 
+ * stale snapshot. Two txns which each missed the other's writes could then 
+ * both commit. Ending at the shared counter orders the txn after every txn 
+ * which committed before it prepared.
+ */
+uint64_t hek_worker::end_timestamp()
+{
+        if (config.ts_alloc == HEK_TS_LEASE)
+                return fetch_and_increment(config.global_time);
+        return get_timestamp();
 }
 
 /*
@@ -66,10 +123,37 @@ void hek_worker::init_allocator()
         }
 }
 
+/*
+ * Unlinked versions go to limbo. Once the previous batch has been reclaimed, 
+ * limbo is sealed along with a snapshot of every worker's begin timestamp, and
+ * reclaimed when every worker has begun a txn after it.
+ */
+void hek_worker::init_gc()
+{
+        uint32_t i;
+
+        gc_watermark = 0;
+        gc_countdown = HEK_GC_INTERVAL;
+        gc_sealed = false;
+        limbo = (hek_gc_list*)alloc_mem(sizeof(hek_gc_list)*config.num_tables,
+                                        config.cpu);
+        sealed = (hek_gc_list*)alloc_mem(sizeof(hek_gc_list)*config.num_tables,
+                                         config.cpu);
+        gc_snapshot = (uint64_t*)alloc_mem(sizeof(uint64_t)*config.num_threads,
+                                           config.cpu);
+        assert(limbo != NULL && sealed != NULL && gc_snapshot != NULL);
+        for (i = 0; i < config.num_tables; ++i) {
+                limbo[i] = { NULL, NULL };
+                sealed[i] = { NULL, NULL };
+        }
+}
+
 hek_worker::hek_worker(hek_worker_config config) : Runnable(config.cpu)
 {
         this->config = config;
         init_allocator();
+        init_gc();
+        init_timestamps();
 }
 
 
@@ -207,14 +291,25 @@ void hek_worker::StartWorking()
                 num_committed = 0;
                 num_done = 0;
                 input_batch = config.input_queue->DequeueBlocking();
+
+                /* 
+                 * Hold back GC until the first txn announces its begin 
+                 * timestamp, see announce_idle.
+                 */
+                xchgq(&config.active_begins[config.cpu].begin, 0);
                 for (i = 0; i < input_batch.num_txns; ++i) {
                         run_txn(input_batch.txns[i]);
                         check_dependents();                
+                        if (--gc_countdown == 0) {
+                                collect_garbage();
+                                gc_countdown = HEK_GC_INTERVAL;
+                        }
                 }
 
                 /* Wait for all txns with commit dependencies. */
                 while (num_done != input_batch.num_txns) 
                         check_dependents();
+                announce_idle();
                 output_batch.num_txns = num_committed;
                 config.output_queue->EnqueueBlocking(output_batch);
         }
@@ -238,7 +333,7 @@ void hek_worker::transition_begin(__attribute__((unused)) hek_action *txn)
 void hek_worker::transition_preparing(hek_action *txn)
 {
         uint64_t end_ts;
-        end_ts = get_timestamp();
+        end_ts = end_timestamp();
         end_ts = CREATE_PREP_TIMESTAMP(end_ts);
         lock(&txn->latch);
         //        txn->end = end_ts;
@@ -370,6 +465,7 @@ bool hek_worker::add_commit_dep(hek_action *out, hek_key *key, hek_action *in,
         
 }
 
+template<isolation_level L>
 bool hek_worker::validate_single(hek_action *txn, hek_key *key)
 {
         assert(!IS_TIMESTAMP(txn->end) && HEK_STATE(txn->end) == PREPARING);
@@ -377,7 +473,9 @@ bool hek_worker::validate_single(hek_action *txn, hek_key *key)
         uint64_t vis_ts, read_ts, record_key, end_ts, vis_txn_ts, read_txn_ts;
         uint32_t table_id;
 
-        if (SNAPSHOT_ISOLATION || txn->readonly == true)
+        if (L == ISOLATION_READ_COMMITTED && IS_TIMESTAMP(key->time))
+                return true;
+        if (L != ISOLATION_SERIALIZABLE)
                 end_ts = HEK_TIME(txn->begin);
         else 
                 end_ts = HEK_TIME(txn->end);
@@ -416,15 +514,128 @@ hek_record* hek_worker::get_new_record(uint32_t table_id)
         return ret;       
 }
 
+/* 
+ * Reclaimed versions go to this worker's free list, regardless of which 
+ * worker allocated them; records of a table all have the same size. 
+ */
+void hek_worker::return_records(uint32_t table_id, hek_gc_list *list)
+{
+        assert(list->head != NULL && list->tail != NULL);
+        list->tail->next = records[table_id];
+        records[table_id] = list->head;
+        list->head = NULL;
+        list->tail = NULL;
+}
+
+/* Append a chain of versions unlinked by insert_version to limbo. */
+void hek_worker::add_garbage(uint32_t table_id, hek_record *garbage)
+{
+        hek_record *tail;
+
+        tail = garbage;
+        while (tail->next != NULL)
+                tail = tail->next;
+        if (limbo[table_id].head == NULL)
+                limbo[table_id].head = garbage;
+        else
+                limbo[table_id].tail->next = garbage;
+        limbo[table_id].tail = tail;
+}
+
+/* 
+ * A worker waiting for input must not hold back GC, so it announces HEK_INF. 
+ * Before it takes a begin timestamp again it announces 0. A watermark computed
+ * while the worker was idle is thus at most the computing worker's own begin 
+ * timestamp, which was handed out before the idle worker's next one. A lease 
+ * may hold older timestamps, so the rest of it is given up.
+ */
+void hek_worker::announce_idle()
+{
+        if (config.ts_alloc == HEK_TS_LEASE)
+                ts_next = ts_limit;
+        xchgq(&config.active_begins[config.cpu].begin, HEK_INF);
+}
+
+/* The oldest begin timestamp of any active txn. */
+uint64_t hek_worker::compute_watermark()
+{
+        uint64_t ret, begin;
+        uint32_t i;
+
+        ret = HEK_INF;
+        for (i = 0; i < config.num_threads; ++i) {
+                barrier();
+                begin = config.active_begins[i].begin;
+                barrier();
+                if (begin < ret)
+                        ret = begin;
+        }
+        return ret;
+}
+
+/* 
+ * Check whether every other worker has begun a txn, or gone idle, since the 
+ * snapshot. Begin timestamps are announced with a fenced store, so a worker 
+ * whose new begin timestamp is visible cannot still be reading through 
+ * versions unlinked before the snapshot. Neither can a worker which was idle 
+ * when the snapshot was taken.
+ */
+bool hek_worker::snapshot_passed()
+{
+        uint64_t begin;
+        uint32_t i;
+
+        for (i = 0; i < config.num_threads; ++i) {
+                if (i == (uint32_t)config.cpu || gc_snapshot[i] == HEK_INF)
+                        continue;
+                barrier();
+                begin = config.active_begins[i].begin;
+                barrier();
+                if (begin != HEK_INF && begin <= gc_snapshot[i])
+                        return false;
+        }
+        return true;
+}
+
 /*
-void hek_worker::return_record(uint32_t table_id, hek_record *record)
+ * Versions unlinked before the seal may still be traversed by txns which began
+ * before it. Once every worker has moved on to a later txn, they are 
+ * reclaimed. Timestamps need not be handed out in real-time order (see 
+ * hek_ts_alloc), so progress is tracked per worker rather than by comparing 
+ * against the global time.
+ */
+void hek_worker::collect_garbage()
 {
-        //        memset(record, 0x0, sizeof(hek_record));
-        record->next = records[table_id];
-        records[table_id] = record;
+        uint32_t i;
+        bool empty;
+
+        gc_watermark = compute_watermark();
+        if (gc_sealed && snapshot_passed()) {
+                for (i = 0; i < config.num_tables; ++i)
+                        if (sealed[i].head != NULL)
+                                return_records(i, &sealed[i]);
+                gc_sealed = false;
+        }
+        if (gc_sealed)
+                return;
+        empty = true;
+        for (i = 0; i < config.num_tables; ++i) {
+                if (limbo[i].head != NULL)
+                        empty = false;
+                sealed[i] = limbo[i];
+                limbo[i] = { NULL, NULL };
+        }
+        if (empty)
+                return;
+        for (i = 0; i < config.num_threads; ++i) {
+                barrier();
+                gc_snapshot[i] = config.active_begins[i].begin;
+                barrier();
+        }
+        gc_sealed = true;
 }
-*/
 
+template<isolation_level L>
 bool hek_worker::validate_reads(hek_action *txn)
 {
         assert(!IS_TIMESTAMP(txn->end));
@@ -439,7 +650,7 @@ bool hek_worker::validate_reads(hek_action *txn)
         fetch_and_increment(&txn->dep_count);
         num_reads = txn->readset.size();
         for (i = 0; i < num_reads; ++i) {
-                if (!validate_single(txn, &txn->readset[i])) {
+                if (!validate_single<L>(txn, &txn->readset[i])) {
                         if (cmp_and_swap((volatile uint64_t*)&txn->dep_flag,
                                          PREPARING,
                                          ABORT)) {
@@ -480,12 +691,13 @@ void hek_worker::install_writes(hek_action *txn)
  * not mean that the txn will commit. Reads must still be validated, and writes 
  * subsequently finalized.      
  */
+template<isolation_level L>
 bool hek_worker::insert_writes(hek_action *txn)
 {
 
         uint32_t num_writes, i, tbl_id;
         hek_table *table;
-        hek_record *rec;
+        hek_record *rec, *garbage;
 
         num_writes = txn->writeset.size();
         for (i = 0; i < num_writes; ++i) {
@@ -496,29 +708,125 @@ bool hek_worker::insert_writes(hek_action *txn)
                 rec->end = HEK_INF;
                 tbl_id = txn->writeset[i].table_id;
                 table = config.tables[tbl_id];
-                if (!table->insert_version(rec, txn->begin)) 
+                if (!table->insert_version<L>(rec, txn->begin, txn->end,
+                                              gc_watermark, &garbage)) 
                         return false;                
                 else
                         txn->writeset[i].written = true;
+                if (garbage != NULL)
+                        add_garbage(tbl_id, garbage);
         }
 
         return true;
 }
 
-/*
+/* 
+ * A read of a version whose writer was preparing stands if the writer commits 
+ * with the end timestamp the version was read with. Keep processing commit 
+ * dependencies while waiting, the writer may be waiting on them.
+ */
+bool hek_worker::wait_for_writer(hek_key *key)
+{
+        assert(!IS_TIMESTAMP(key->time));
+        hek_action *writer;
+        uint64_t end;
+
+        writer = GET_TXN(key->time);
+        while (true) {
+                barrier();
+                end = writer->end;
+                barrier();
+                if (HEK_TIME(end) != HEK_TIME(key->txn_ts))
+                        return false;	/* writer was rerun */
+                else if (HEK_STATE(end) == COMMIT)
+                        return true;
+                else if (HEK_STATE(end) == ABORT)
+                        return false;
+                check_dependents();
+        }
+}
+
+/* 
+ * A writer takes its end timestamp before it inserts its versions, so reads 
+ * as of a later begin timestamp may see some of its writes and miss others. 
+ * Once every writer the txn read from has committed, all of their versions 
+ * are in place. If the same versions are still the ones visible as of the 
+ * txn's begin timestamp, no write was missed and the reads are a snapshot.
+ */
+bool hek_worker::validate_snapshot(hek_action *txn)
+{
+        hek_record *vis_record;
+        uint64_t ts, vis_ts, vis_txn_ts;
+        uint32_t num_reads, i;
+        hek_key *key;
+
+        ts = HEK_TIME(txn->begin);
+        num_reads = txn->readset.size();
+        for (i = 0; i < num_reads; ++i) {
+                key = &txn->readset[i];
+                if (!IS_TIMESTAMP(key->time) && !wait_for_writer(key))
+                        return false;
+        }
+        for (i = 0; i < num_reads; ++i) {
+                key = &txn->readset[i];
+                vis_record = config.tables[key->table_id]->get_version(key->key,
+                                                                       ts,
+                                                                       &vis_ts,
+                                                                       &vis_txn_ts);
+                if (vis_record != key->value)
+                        return false;
+        }
+        return true;
+}
+
+/* 
+ * Read-only txns read the versions visible as of their begin timestamp, at 
+ * every isolation level. They don't prepare or take commit dependencies. A 
+ * txn only waits if it read a version which was not yet committed, and is 
+ * rerun if the version's writer aborts or its reads were not a snapshot.
+ */
 void hek_worker::run_readonly(hek_action *txn)
 {
-        assert(txn->is_readonly == true);
-        volatile uint64_t cur_time;
+        assert(txn->readonly == true && txn->writeset.size() == 0);
+
+        txn->worker = this;
+        do {
+                txn->begin = CREATE_EXEC_TIMESTAMP(get_timestamp());
+                xchgq(&config.active_begins[config.cpu].begin,
+                      HEK_TIME(txn->begin));
+                get_reads(txn);
+        } while (!validate_snapshot(txn));
+        txn->Run();
+        num_committed += 1;
+        num_done += 1;
+}
+
+void hek_worker::run_txn(hek_action *txn)
+{
+        if (txn->readonly == true) {
+                run_readonly(txn);
+                return;
+        }
+        switch (txn->get_isolation()) {
+        case ISOLATION_SERIALIZABLE:
+                run_isolated<ISOLATION_SERIALIZABLE>(txn);
+                break;
+        case ISOLATION_SNAPSHOT:
+                run_isolated<ISOLATION_SNAPSHOT>(txn);
+                break;
+        case ISOLATION_READ_COMMITTED:
+                run_isolated<ISOLATION_READ_COMMITTED>(txn);
+                break;
+        }
 }
-*/
 
 // 1. Run txn logic (may abort due to write-write conflicts)
 // 2. Validate reads
 // 3. Check if the txn depends on others. If yes, wait for commit dependencies,
 // otherwise, abort.
 // 
-void hek_worker::run_txn(hek_action *txn)
+template<isolation_level L>
+void hek_worker::run_isolated(hek_action *txn)
 {
         hek_status status;
         bool validated;
@@ -530,16 +838,18 @@ void hek_worker::run_txn(hek_action *txn)
         get_writes(txn);
         while (true) {
                 txn->begin = CREATE_EXEC_TIMESTAMP(get_timestamp());
+                xchgq(&config.active_begins[config.cpu].begin,
+                      HEK_TIME(txn->begin));
         
                 //                CREATE_EXEC_TIMESTAMP(fetch_and_increment(config.global_time));
                 transition_begin(txn);
                 get_reads(txn);
                 status = txn->Run();
                 transition_preparing(txn);
-                if (!insert_writes(txn))
+                if (!insert_writes<L>(txn))
                         goto abort;
                 //                if (!SNAPSHOT_ISOLATION)
-                        validated = validate_reads(txn);
+                        validated = validate_reads<L>(txn);
                         //                else
                         //                        validated = true;
                 if (validated == true) {
@@ -552,6 +862,13 @@ void hek_worker::run_txn(hek_action *txn)
         abort:
                 transition_abort(txn);
 
+                /* 
+                 * The txn may have lost to a writer with later timestamps, 
+                 * retry with fresh ones. 
+                 */
+                if (config.ts_alloc == HEK_TS_LEASE)
+                        ts_next = ts_limit;
+
         }
         //        do_abort(txn);
 }
@@ -175,12 +175,45 @@ hek_record* hek_table::get_version(uint64_t key, uint64_t ts,
         return search_bucket(key, ts, slot, begin_ts, txn_ts);
 }
 
+/*
+ * Unlink the versions older than prev which no active txn can read, and return
+ * them. A version whose end precedes the watermark (the oldest begin timestamp
+ * of any active txn) has been superseded for every reader. The caller must own
+ * prev.
+ *
+ * A slot holds the versions of a single key (see get_slot), newest first, so
+ * once one version is garbage, so are all those after it. Readers may still be
+ * traversing the unlinked versions, the caller must not reuse them until every
+ * worker has begun a new txn.
+ */
+hek_record* hek_table::unlink_garbage(hek_record *prev, uint64_t watermark)
+{
+        hek_record *pred, *cur;
+
+        pred = prev;
+        cur = prev->next;
+        while (cur != NULL) {
+                assert(cur->key == prev->key && IS_TIMESTAMP(cur->end));
+                if (HEK_TIME(cur->end) < watermark) {
+                        xchgq((volatile uint64_t*)&pred->next, (uint64_t)NULL);
+                        return cur;
+                }
+                pred = cur;
+                cur = cur->next;
+        }
+        return NULL;
+}
+
 /* 
  * Used to perform a write during txn execution. The write is _not_ committed, 
- * but serves as a lock to protect the given bucket from concurrent 
- * modification.
+ * but its txn owns the previous version, which protects the slot from 
+ * concurrent modification. Versions which became garbage as of gc_watermark 
+ * are unlinked and returned through garbage.
  */
-bool hek_table::insert_version(hek_record *record, uint64_t txn_begin)
+template<isolation_level L>
+bool hek_table::insert_version(hek_record *record, uint64_t txn_begin,
+                               uint64_t txn_end, uint64_t gc_watermark,
+                               hek_record **garbage)
 {
         assert(init_done == true);	/* table should be initialized */
         assert(record != NULL);
@@ -191,28 +224,64 @@ bool hek_table::insert_version(hek_record *record, uint64_t txn_begin)
                
         hek_table_slot *slot;
         hek_record *prev;
+        uint64_t prev_begin;
 
+        *garbage = NULL;
         slot = get_slot(record->key);
-        if (try_lock((volatile uint64_t*)&slot->latch)) {
-                record->next = (hek_record*)slot->records;
-                xchgq((volatile uint64_t*)&slot->records, (uint64_t)record);
-                prev = stable_next(record->key, record->next);
-                assert(prev == NULL || prev->end == HEK_INF);
-                if (prev != NULL && prev->end == HEK_INF) 
-                        prev->end = record->begin;
-                if (SNAPSHOT_ISOLATION) 
-                        if (prev->begin > txn_begin) { /* check for ww conflict */
-                                remove_version(record);
-                                goto failure;
-                        }
-                return true;
-        }
- failure:
-        return false;
-                
+        barrier();
+        prev = (hek_record*)slot->records;
+        barrier();
+        prev_begin = prev->begin;
+        barrier();
+        assert(prev->key == record->key);
+
+        /* Another txn's write is in progress. */
+        if (!IS_TIMESTAMP(prev_begin))
+                return false;
+
+        /* 
+         * Under snapshot isolation, the first committer wins. The txn can't 
+         * overwrite a version committed since it began.
+         */
+        if (L == ISOLATION_SNAPSHOT && prev_begin > HEK_TIME(txn_begin))
+                return false;
+
+        /* 
+         * Versions must be installed in timestamp order, but the txn may end 
+         * before the latest committed version began. Workers do not obtain 
+         * timestamps in real-time order (see hek_ts_alloc), and even a global 
+         * counter hands out the end timestamp before the write is inserted.
+         */
+        if (prev_begin >= HEK_TIME(txn_end))
+                return false;
+
+        /* 
+         * Claim prev. Only one txn can swap out an infinite end timestamp, 
+         * the others conflict with it. A committed version has a finite one.
+         */
+        if (!cmp_and_swap((volatile uint64_t*)&prev->end, HEK_INF,
+                          record->begin))
+                return false;
+        record->next = prev;
+        barrier();
+        slot->records = record;
+        barrier();
+        *garbage = unlink_garbage(prev, gc_watermark);
+        return true;
 }
 
-/* Used to abort a write. Remove the version and clear the bucket's lock bit. */
+template bool hek_table::insert_version<ISOLATION_SERIALIZABLE>(
+        hek_record*, uint64_t, uint64_t, uint64_t, hek_record**);
+template bool hek_table::insert_version<ISOLATION_SNAPSHOT>(
+        hek_record*, uint64_t, uint64_t, uint64_t, hek_record**);
+template bool hek_table::insert_version<ISOLATION_READ_COMMITTED>(
+        hek_record*, uint64_t, uint64_t, uint64_t, hek_record**);
+
+/* 
+ * Used to abort a write. Unlink the version, then give up prev, which other 
+ * txns may claim right after. Stores are not reordered with each other on x86,
+ * so the owner of a version doesn't need fences to update it.
+ */
 void hek_table::remove_version(hek_record *record)
 {
         assert(init_done == true);
@@ -220,15 +289,20 @@ void hek_table::remove_version(hek_record *record)
         hek_record *prev;
 
         slot = get_slot(record->key);
-        assert(slot->latch == 1 && slot->records == record);
+        assert(slot->records == record && !IS_TIMESTAMP(record->begin));
         prev = stable_next(record->key, record->next);
         assert(prev != NULL && prev->end == record->begin);
+        barrier();
+        slot->records = prev;
+        barrier();
         prev->end = HEK_INF;
-        xchgq((volatile uint64_t*)&slot->records, (uint64_t)prev);
-        xchgq(&slot->latch, 0x0);
+        barrier();
 }
 
-/* Used to commit a write. Clear the lock bit corresponding to the bucket. */
+/* 
+ * Used to commit a write. prev ends at ts, and is no longer the latest 
+ * version, once the new version begins at ts other txns may claim it.
+ */
 void hek_table::finalize_version(hek_record *record, uint64_t ts)
 {
         assert(init_done == true);
@@ -237,15 +311,17 @@ void hek_table::finalize_version(hek_record *record, uint64_t ts)
         hek_record *prev;
 
         slot = get_slot(record->key);
-        assert(slot->latch == 1 && slot->records == record);
+        assert(slot->records == record && !IS_TIMESTAMP(record->begin));
 
         prev = stable_next(record->key, record->next);
         assert(prev != NULL && !IS_TIMESTAMP(prev->end));
         //        assert(!IS_TIMESTAMP(prev->end) || prev->end != HEK_INF);
         assert(prev->end == record->begin);
+        barrier();
         prev->end = ts;
-        record->begin = ts;        
-        xchgq(&slot->latch, 0x0);
+        barrier();
+        record->begin = ts;
+        barrier();
 }
 
 /* Insert a record without any concurrency control. Used for initialization. */
@@ -256,7 +332,6 @@ void hek_table::force_insert(hek_record *rec)
         hek_table_slot *slot;
         
         slot = get_slot(rec->key);
-        assert(slot->latch == 0);
         assert(slot->records == NULL);
         rec->next = (hek_record*)slot->records;
         slot->records = rec;
@@ -34,9 +34,9 @@ void* Action::Read(uint32_t index)
         if (__readonly == true &&
             GET_MV_EPOCH(__version) == GET_MV_EPOCH(record->createTimestamp)) {
                 MVRecord *snapshot = record->epoch_ancestor;
-                return (void*)snapshot->value;
+                return (void*)snapshot->value->value;
         } else {
-                return (void*)__readset[index].value->value;
+                return (void*)__readset[index].value->value->value;
         }
 }
 
@@ -46,7 +46,7 @@ void* Action::GetWriteRef(uint32_t index)
         //        return mv_tables[0]->Get(key);
         MVRecord *record = __writeset[index].value;
         assert(record->value != NULL);
-        return record->value;
+        return record->value->value;
 }
 
 void* Action::ReadWrite(uint32_t index)
@@ -55,7 +55,13 @@ void* Action::ReadWrite(uint32_t index)
         //        return mv_tables[0]->Get(key);
         assert(__writeset[index].is_rmw);
         MVRecord *record = __writeset[index].value;
-        return (void*)record->recordLink->value;
+
+        /* 
+         * The executor initializes the new version with the previous version's 
+         * contents (and may have taken over its payload), so read through the 
+         * new version.
+         */
+        return (void*)record->value->value;
 }
 
 void Action::AddReadKey(uint32_t tableId, uint64_t key)
@@ -353,7 +359,7 @@ void* mv_action::write_ref(uint64_t key, uint32_t table_id)
                     this->__writeset[i].tableId == table_id) {
                         assert(!this->__writeset[i].is_rmw || 
                                this->__writeset[i].initialized == true);
-                        return this->__writeset[i].value->value;
+                        return this->__writeset[i].value->value->value;
                 }
         }
         assert(false);
@@ -386,9 +392,9 @@ void* mv_action::read(uint64_t key, uint32_t table_id)
              GET_MV_EPOCH(record->createTimestamp)
              )) {
                 snapshot = record->epoch_ancestor;
-                ret = (void*)snapshot->value;
+                ret = (void*)snapshot->value->value;
         } else {
-                ret = (void*)record->value;
+                ret = (void*)record->value->value;
         }
         return ret;
 
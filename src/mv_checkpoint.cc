@@ -0,0 +1,285 @@
+#include <mv_checkpoint.h>
+#include <util.h>
+#include <wait_strategy.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define MV_CKPT_FILE "mv_checkpoint_"
+#define MV_CKPT_MANIFEST_FILE "mv_checkpoint"
+
+/* Records are written out sequentially through a buffer of this size. */
+#define MV_CKPT_BUF_SIZE (1<<20)
+
+static std::string manifest_file_name(const char *dir)
+{
+        return std::string(dir) + "/" + MV_CKPT_MANIFEST_FILE;
+}
+
+static void write_all(int fd, const char *data, uint64_t len)
+{
+        ssize_t written;
+
+        while (len > 0) {
+                written = write(fd, data, len);
+                if (written < 0 && errno == EINTR)
+                        continue;
+                if (written < 0) {
+                        std::cerr << "Couldn't write the checkpoint\n";
+                        exit(-1);
+                }
+                data += written;
+                len -= written;
+        }
+}
+
+static void sync_file(int fd)
+{
+        if (fdatasync(fd) != 0) {
+                std::cerr << "Couldn't sync the checkpoint\n";
+                exit(-1);
+        }
+}
+
+static int open_file(const std::string &file_name)
+{
+        int fd;
+
+        fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+                std::cerr << "Couldn't open " << file_name << "\n";
+                exit(-1);
+        }
+        return fd;
+}
+
+MVCheckpointer::MVCheckpointer(MVCheckpointerConfig config)
+        : Runnable(config.cpu)
+{
+        uint32_t i;
+
+        for (i = 0; i < config.numTables; ++i)
+                assert(sizeof(uint64_t) + config.recordSizes[i] <=
+                       MV_CKPT_BUF_SIZE);
+        this->config = config;
+        this->last_epoch = 0;
+        this->buf = (char*)alloc_mem(MV_CKPT_BUF_SIZE, config.cpu);
+        assert(this->buf != NULL);
+        this->buf_len = 0;
+}
+
+void MVCheckpointer::Init()
+{
+}
+
+void MVCheckpointer::StartWorking()
+{
+        while (true) {
+                usleep(config.interval_ms*1000);
+                Checkpoint();
+        }
+}
+
+/* See Executor::adjust_lowwatermark. */
+uint32_t MVCheckpointer::Pin()
+{
+        Waiter waiter;
+        uint32_t epoch;
+
+        assert(*config.checkpointPtr == MV_CKPT_IDLE);
+        barrier();
+        *config.checkpointPtr = MV_CKPT_REQUEST;
+        barrier();
+        while ((epoch = *config.checkpointPtr) == MV_CKPT_REQUEST)
+                waiter.wait();
+
+        /* Every version visible at the end of epoch has been written. */
+        waiter = Waiter();
+        while (*config.lowWaterMarkPtr < epoch)
+                waiter.wait();
+        return epoch;
+}
+
+void MVCheckpointer::Unpin()
+{
+        barrier();
+        *config.checkpointPtr = MV_CKPT_IDLE;
+        barrier();
+}
+
+uint32_t MVCheckpointer::Checkpoint()
+{
+        uint32_t epoch;
+
+        epoch = Pin();
+        Write(epoch);
+        Unpin();
+        return epoch;
+}
+
+void MVCheckpointer::Flush(int fd)
+{
+        write_all(fd, buf, buf_len);
+        buf_len = 0;
+}
+
+void MVCheckpointer::WriteTable(uint32_t table_id, uint32_t epoch)
+{
+        mv_checkpoint_header header;
+        uint64_t version, record_size, num_records;
+        uint32_t i;
+        MVTablePartition *partition;
+        int fd;
+
+        fd = open_file(TableFile(config.dir, epoch, table_id));
+        record_size = config.recordSizes[table_id];
+        version = CREATE_MV_TIMESTAMP(epoch, 0xFFFFFFFF);
+        num_records = 0;
+
+        /* The header is filled in once the records have been counted. */
+        memset(&header, 0x0, sizeof(header));
+        memcpy(buf, &header, sizeof(header));
+        buf_len = sizeof(header);
+        for (i = 0; i < config.numPartitions; ++i) {
+                partition =
+                        config.partitions[table_id*config.numPartitions + i];
+                partition->Scan(version, [&](MVRecord *rec) {
+                        assert(rec->value != NULL);
+                        if (buf_len + sizeof(uint64_t) + record_size >
+                            MV_CKPT_BUF_SIZE)
+                                Flush(fd);
+                        memcpy(&buf[buf_len], &rec->key, sizeof(uint64_t));
+                        memcpy(&buf[buf_len + sizeof(uint64_t)],
+                               rec->value->value, record_size);
+                        buf_len += sizeof(uint64_t) + record_size;
+                        num_records += 1;
+                });
+        }
+        Flush(fd);
+
+        header = {
+                epoch,
+                table_id,
+                record_size,
+                num_records,
+        };
+        if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+                std::cerr << "Couldn't write the checkpoint\n";
+                exit(-1);
+        }
+        sync_file(fd);
+        close(fd);
+}
+
+/* The manifest is replaced atomically, it names the latest checkpoint. */
+void MVCheckpointer::WriteManifest(uint32_t epoch)
+{
+        mv_checkpoint_manifest manifest;
+        std::string file_name, tmp_name;
+        int fd;
+
+        file_name = manifest_file_name(config.dir);
+        tmp_name = file_name + ".tmp";
+        manifest = {
+                epoch,
+                config.numTables,
+        };
+        fd = open_file(tmp_name);
+        write_all(fd, (const char*)&manifest, sizeof(manifest));
+        sync_file(fd);
+        close(fd);
+        if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+                std::cerr << "Couldn't rename " << tmp_name << "\n";
+                exit(-1);
+        }
+
+        /* Make the rename durable. */
+        fd = open(config.dir, O_RDONLY);
+        if (fd < 0 || fsync(fd) != 0) {
+                std::cerr << "Couldn't sync " << config.dir << "\n";
+                exit(-1);
+        }
+        close(fd);
+}
+
+void MVCheckpointer::Write(uint32_t epoch)
+{
+        uint32_t i;
+
+        assert(epoch != MV_CKPT_IDLE && epoch != MV_CKPT_REQUEST);
+        for (i = 0; i < config.numTables; ++i)
+                WriteTable(i, epoch);
+        WriteManifest(epoch);
+        if (last_epoch != 0 && last_epoch != epoch)
+                for (i = 0; i < config.numTables; ++i)
+                        unlink(TableFile(config.dir, last_epoch,
+                                         i).c_str());
+        last_epoch = epoch;
+}
+
+std::string MVCheckpointer::TableFile(const char *dir, uint32_t epoch,
+                                      uint32_t table_id)
+{
+        return std::string(dir) + "/" + MV_CKPT_FILE + std::to_string(epoch) +
+                "_" + std::to_string(table_id);
+}
+
+mv_checkpoint_manifest MVCheckpointer::ReadManifest(const char *dir)
+{
+        mv_checkpoint_manifest manifest;
+        std::string file_name;
+        FILE *f;
+
+        file_name = manifest_file_name(dir);
+        f = fopen(file_name.c_str(), "rb");
+        if (f == NULL || fread(&manifest, sizeof(manifest), 1, f) != 1) {
+                std::cerr << "Couldn't read checkpoint manifest " << file_name;
+                std::cerr << "\n";
+                exit(-1);
+        }
+        fclose(f);
+        return manifest;
+}
+
+uint32_t MVCheckpointer::Read(const char *dir, mv_load_fn fn)
+{
+        mv_checkpoint_manifest manifest;
+        mv_checkpoint_header header;
+        std::string file_name;
+        std::vector<char> record;
+        uint64_t key, i;
+        uint32_t table_id;
+        FILE *f;
+
+        manifest = ReadManifest(dir);
+        for (table_id = 0; table_id < manifest.num_tables; ++table_id) {
+                file_name = TableFile(dir, manifest.epoch, table_id);
+                f = fopen(file_name.c_str(), "rb");
+                if (f == NULL || fread(&header, sizeof(header), 1, f) != 1 ||
+                    header.epoch != manifest.epoch ||
+                    header.table_id != table_id) {
+                        std::cerr << "Couldn't read checkpoint " << file_name;
+                        std::cerr << "\n";
+                        exit(-1);
+                }
+                record.resize(header.record_size);
+                for (i = 0; i < header.num_records; ++i) {
+                        if (fread(&key, sizeof(key), 1, f) != 1 ||
+                            fread(record.data(), 1, header.record_size, f) !=
+                            header.record_size) {
+                                std::cerr << "Checkpoint " << file_name;
+                                std::cerr << " is truncated\n";
+                                exit(-1);
+                        }
+                        fn(table_id, key, record.data());
+                }
+                fclose(f);
+        }
+        return manifest.epoch;
+}
@@ -21,33 +21,13 @@ MVRecordAllocator::MVRecordAllocator(uint64_t size, int cpu, int worker_start, i
   this->size = size;
   this->count = 0;
   uint64_t numRecords = size/sizeof(MVRecord);
-  
-  uint64_t recordDataSize = recordSize*numRecords;
-  //  std::cout << "Record size: " << recordSize << "\nRecord data size: " << recordDataSize << "\n";
-  //  std::cout << "Worker start:" << worker_start << " Worker end: " << worker_end << "\n";
-  //  std::cout << "Cpus: " << numa_num_configured_cpus() << "\n";
-  //    char *recordData = NULL;
-  //  int cntr = 0;
-  //  while (recordData == NULL) {
-  //          recordData = (char*)alloc_interleaved(recordDataSize, worker_start, worker_end+cntr*10);
-  //          ++cntr;
-  //  }
-  //  char *recordData = (char*)alloc_interleaved(recordDataSize, worker_start+10, 79);
 
-  //  char *recordData = (char*)alloc_mem(recordDataSize, 19);
-  
-    char *recordData = (char*)alloc_interleaved_all(recordDataSize);
-  //char *recordData = (char*)alloc_mem(recordDataSize, recordCpu);
-
-  //  char *recordData = (char*)alloc_interleaved(recordDataSize, worker_start, 79);
-    assert(recordData != NULL);
-    memset(recordData, 0xA3, recordDataSize);
-  //  std::cout << "Done initializing record data\n";
-  //  uint64_t endIndex = numRecords-1;
+  // Versions carry no payload of their own. Executors attach one from their 
+  // local pools when the version's writer is about to run (see 
+  // src/executor.cc).
   for (uint64_t i = 0; i < numRecords; ++i) {
     data[i].allocLink = &data[i+1];
-    //data[i].value = NULL;
-    data[i].value = (Record*)(&recordData[i*recordSize]);
+    data[i].value = NULL;
     data[i].writer = NULL;
     this->count += 1;
   }
@@ -86,7 +66,9 @@ bool MVRecordAllocator::GetRecord(MVRecord **OUT_recordPtr) {
   ret->allocLink = NULL;
   ret->epoch_ancestor = NULL;
   ret->writer = NULL;
-  //  ret->value = NULL;
+  ret->value = NULL;
+  ret->numReaders = 0;
+  ret->doneReaders = 0;
   *OUT_recordPtr = ret;
   count -= 1;
   return true;
@@ -1,5 +1,6 @@
 #include <mv_table.h>
 #include <cpuinfo.h>
+#include <util.h>
 #include <iostream>
 
 MVTable::MVTable(uint32_t numPartitions) {
@@ -34,14 +35,77 @@ bool MVTable::WriteNewVersion(uint32_t partition, CompositeKey &pkey,
   return tablePartitions[partition]->WriteNewVersion(pkey, action, version);
 }
 
-MVTablePartition::MVTablePartition(uint64_t size, 
-                                   int cpu,
-                                   MVRecordAllocator *alloc) {
+MVTablePartition::MVTablePartition(MVRecordAllocator *alloc) 
+{
+        this->allocator = alloc;
+}
+
+MVTablePartition* MVTablePartition::Create(MVIndexType type, uint64_t size, 
+                                           int cpu, 
+                                           MVRecordAllocator *alloc)
+{
+        switch (type) {
+        case MV_CHAINED_INDEX:
+                return new (cpu) MVChainedPartition(size, cpu, alloc);
+        case MV_BUCKETED_INDEX:
+                return new (cpu) MVBucketedPartition(size, cpu, alloc);
+        default:
+                assert(false);
+                return NULL;
+        }
+}
+
+MVRecord* MVTablePartition::NewVersion(const CompositeKey &pkey, 
+                                       mv_action *action, 
+                                       uint64_t version)
+{
+        // Allocate an MVRecord to hold the new record.
+        MVRecord *toAdd;
+        bool success = allocator->GetRecord(&toAdd);
+        assert(success);        // Can't deal with allocation failures yet.
+        assert(toAdd->link == NULL && toAdd->recordLink == NULL);
+        assert(toAdd->writer == NULL);
+        toAdd->createTimestamp = version;
+        toAdd->deleteTimestamp = MVRecord::INFINITY;
+        toAdd->writer = action;
+        toAdd->key = pkey.key;  
+        toAdd->tableId = pkey.tableId;
+        return toAdd;
+}
+
+void MVTablePartition::LinkVersion(MVRecord *toAdd, MVRecord *prev)
+{
+        if (prev == NULL)
+                return;
+        toAdd->recordLink = prev;
+        if (GET_MV_EPOCH(prev->createTimestamp) == 
+            GET_MV_EPOCH(toAdd->createTimestamp))
+                toAdd->epoch_ancestor = prev->epoch_ancestor;
+        else
+                toAdd->epoch_ancestor = prev;
+}
+
+MVRecord* MVTablePartition::FindVersion(MVRecord *cur, uint64_t version)
+{
+        while (cur != NULL && cur->deleteTimestamp > version) {
+                // Found a valid version
+                if (cur->createTimestamp <= version && 
+                    cur->deleteTimestamp > version) {
+                        return cur;
+                }
+                cur = cur->recordLink;
+        }
+        return NULL;
+}
+
+MVChainedPartition::MVChainedPartition(uint64_t size, 
+                                       int cpu,
+                                       MVRecordAllocator *alloc) 
+        : MVTablePartition(alloc) {
   if (size < 1) {
     size = 1;
   }
   this->numSlots = size;
-  this->allocator = alloc;
         
   // Allocate a contiguous chunk of memory in which to store the table's slots
   this->tableSlots = (MVRecord**)alloc_mem(sizeof(MVRecord*)*size, cpu);
@@ -51,8 +115,8 @@ MVTablePartition::MVTablePartition(uint64_t size,
   //  std::cout << "asldkjfasdf\n";
 }
 
-MVRecord* MVTablePartition::GetMVRecord(const CompositeKey &pkey, 
-                                        uint64_t version) {
+MVRecord* MVChainedPartition::GetMVRecord(const CompositeKey &pkey, 
+                                          uint64_t version) {
   // Get the slot number the record hashes to, and try to find if a previous
   // version of the record already exists.
   uint64_t slotNumber = CompositeKey::Hash(&pkey) % numSlots;
@@ -62,20 +126,55 @@ MVRecord* MVTablePartition::GetMVRecord(const CompositeKey &pkey,
                 
     // We found the record. Link to the old record.
     if (cur->key == pkey.key) {
-      while (cur != NULL && cur->deleteTimestamp > version) {
-        // Found a valid version
-        if (cur->createTimestamp <= version && cur->deleteTimestamp > version) {
-          return cur;
-        }
-        cur = cur->recordLink;
-      }
-      break;
+      return FindVersion(cur, version);
     }
     cur = cur->link;
   }
   return NULL;
 }
 
+/* 
+ * The scheduler only ever replaces the head of a key's version chain, and 
+ * the replaced head keeps its link to the rest of the slot's list. 
+ */
+void MVChainedPartition::Scan(uint64_t version, mv_scan_fn fn)
+{
+        uint64_t i;
+        MVRecord *cur, *visible;
+
+        for (i = 0; i < numSlots; ++i) {
+                barrier();
+                cur = tableSlots[i];
+                barrier();
+                while (cur != NULL) {
+                        visible = FindVersion(cur, version);
+                        if (visible != NULL)
+                                fn(visible);
+                        barrier();
+                        cur = cur->link;
+                        barrier();
+                }
+        }
+}
+
+void MVChainedPartition::PrefetchSlot(const CompositeKey &pkey)
+{
+        uint64_t slotNumber = CompositeKey::Hash(&pkey) % numSlots;
+        __builtin_prefetch(&tableSlots[slotNumber], 0, 3);
+}
+
+/* 
+ * Only prefetches the first record on the slot's list. If pkey is further down
+ * the list, the lookup still misses on the records in front of it.
+ */
+void MVChainedPartition::PrefetchHead(const CompositeKey &pkey)
+{
+        uint64_t slotNumber = CompositeKey::Hash(&pkey) % numSlots;
+        MVRecord *head = tableSlots[slotNumber];
+        if (head != NULL)
+                __builtin_prefetch(head, 0, 3);
+}
+
 /*
 bool MVTablePartition::GetVersion(const CompositeKey &pkey, uint64_t version, 
                                   Record *OUT_rec) {
@@ -154,43 +253,171 @@ bool MVTablePartition::GetLatestVersion(const CompositeKey &pkey,
 /*
  * Write out a new version for record pkey.
  */
-bool MVTablePartition::WriteNewVersion(CompositeKey &pkey, mv_action *action, 
-                                       uint64_t version) {
-
-  // Allocate an MVRecord to hold the new record.
-  MVRecord *toAdd;
-  bool success = allocator->GetRecord(&toAdd);
-  assert(success);        // Can't deal with allocation failures yet.
-  assert(toAdd->link == NULL && toAdd->recordLink == NULL);
-  assert(toAdd->writer == NULL);
-  toAdd->createTimestamp = version;
-  toAdd->deleteTimestamp = MVRecord::INFINITY;
-  toAdd->writer = action;
-  toAdd->key = pkey.key;  
+bool MVChainedPartition::WriteNewVersion(CompositeKey &pkey, mv_action *action, 
+                                         uint64_t version) {
+
+  MVRecord *toAdd = NewVersion(pkey, action, version);
 
   // Get the slot number the record hashes to, and try to find if a mvprevious
   // version of the record already exists.
   uint64_t slotNumber = CompositeKey::Hash(&pkey) % numSlots;
   MVRecord *cur = tableSlots[slotNumber];
   MVRecord **prev = &tableSlots[slotNumber];
-  uint64_t epoch = GET_MV_EPOCH(version);
   
   while (cur != NULL) {                
     // We found the record. Link to the old record.
     if (cur->key == pkey.key) {
       toAdd->link = cur->link;
-      toAdd->recordLink = cur;
-      if (GET_MV_EPOCH(cur->createTimestamp) == epoch)
-              toAdd->epoch_ancestor = cur->epoch_ancestor;
-      else
-              toAdd->epoch_ancestor = cur;
+      LinkVersion(toAdd, cur);
       break;
     }
 
     prev = &cur->link;
     cur = cur->link;
   }
+
+  // Concurrent scans must never see a partially initialized version.
+  barrier();
   *prev = toAdd;
   pkey.value = toAdd;
   return true;
 }
+
+MVBucketedPartition::MVBucketedPartition(uint64_t size, int cpu, 
+                                         MVRecordAllocator *alloc)
+        : MVTablePartition(alloc)
+{
+        uint64_t sz;
+        char *data;
+
+        this->numBuckets = (2*size)/MV_BUCKET_SLOTS + 1;
+        
+        /* Over-allocate by a cache line so that buckets never straddle lines. */
+        sz = sizeof(MVBucket)*numBuckets;
+        data = (char*)alloc_mem(sz + CACHE_LINE, cpu);
+        assert(data != NULL);
+        data += (CACHE_LINE - ((uintptr_t)data % CACHE_LINE)) % CACHE_LINE;
+        memset(data, 0x0, sz);
+        this->buckets = (MVBucket*)data;
+}
+
+/*
+ * Find the slot which holds the newest version of pkey. Each bucket probed 
+ * costs a single cache miss, and a version is only dereferenced to confirm a 
+ * matching fingerprint. If the key is absent and insert is true, claim a slot 
+ * for the key and return it with a NULL head.
+ */
+MVRecord** MVBucketedPartition::FindHead(const CompositeKey &pkey, bool insert)
+{
+        uint64_t hash, index, probes;
+        uint16_t fingerprint;
+        uint32_t i;
+        MVBucket *bucket;
+
+        hash = CompositeKey::Hash(&pkey);
+        fingerprint = (uint16_t)(hash >> 48);
+        index = hash % numBuckets;
+        for (probes = 0; probes < numBuckets; ++probes) {
+                bucket = &buckets[index];
+                for (i = 0; i < bucket->count; ++i) {
+                        if (bucket->fingerprints[i] == fingerprint && 
+                            bucket->heads[i]->key == pkey.key)
+                                return &bucket->heads[i];
+                }
+                
+                /* A bucket with a free slot terminates the probe sequence. */
+                if (bucket->count < MV_BUCKET_SLOTS) {
+                        if (insert == false)
+                                return NULL;
+                        bucket->fingerprints[i] = fingerprint;
+                        bucket->heads[i] = NULL;
+                        barrier();
+                        bucket->count += 1;
+                        return &bucket->heads[i];
+                }
+                index = (index + 1 == numBuckets)? 0 : index + 1;
+        }
+        assert(insert == false);        // Index is full.
+        return NULL;
+}
+
+MVRecord* MVBucketedPartition::GetMVRecord(const CompositeKey &pkey, 
+                                           uint64_t version)
+{
+        MVRecord **head;
+        
+        head = FindHead(pkey, false);
+        if (head == NULL)
+                return NULL;
+        return FindVersion(*head, version);
+}
+
+bool MVBucketedPartition::WriteNewVersion(CompositeKey &pkey, 
+                                          mv_action *action, 
+                                          uint64_t version)
+{
+        MVRecord *toAdd, **head;
+        
+        toAdd = NewVersion(pkey, action, version);
+        head = FindHead(pkey, true);
+        LinkVersion(toAdd, *head);
+
+        /* Concurrent scans must never see a partially initialized version. */
+        barrier();
+        *head = toAdd;
+        pkey.value = toAdd;
+        return true;
+}
+
+void MVBucketedPartition::PrefetchSlot(const CompositeKey &pkey)
+{
+        uint64_t index = CompositeKey::Hash(&pkey) % numBuckets;
+        __builtin_prefetch(&buckets[index], 0, 3);
+}
+
+/* 
+ * Only looks in the key's home bucket. Keys that overflowed into a neighbouring
+ * bucket are rare at the index's load factor, and are not worth the extra
+ * probes here.
+ */
+void MVBucketedPartition::PrefetchHead(const CompositeKey &pkey)
+{
+        uint64_t hash;
+        uint16_t fingerprint;
+        uint32_t i;
+        MVBucket *bucket;
+        
+        hash = CompositeKey::Hash(&pkey);
+        fingerprint = (uint16_t)(hash >> 48);
+        bucket = &buckets[hash % numBuckets];
+        for (i = 0; i < bucket->count; ++i) {
+                if (bucket->fingerprints[i] == fingerprint) {
+                        __builtin_prefetch(bucket->heads[i], 0, 3);
+                        return;
+                }
+        }
+}
+
+/* A slot is claimed before its head is set, skip slots caught in between. */
+void MVBucketedPartition::Scan(uint64_t version, mv_scan_fn fn)
+{
+        uint64_t i;
+        uint32_t j, count;
+        MVRecord *head, *visible;
+
+        for (i = 0; i < numBuckets; ++i) {
+                barrier();
+                count = buckets[i].count;
+                barrier();
+                for (j = 0; j < count; ++j) {
+                        barrier();
+                        head = buckets[i].heads[j];
+                        barrier();
+                        if (head == NULL)
+                                continue;
+                        visible = FindVersion(head, version);
+                        if (visible != NULL)
+                                fn(visible);
+                }
+        }
+}
@@ -7,7 +7,11 @@ OCCWorker::OCCWorker(OCCWorkerConfig conf, struct RecordBuffersConfig rb_conf)
         : Runnable(conf.cpu)
 {
         this->config = conf;
+        this->last_epoch = 0;
         this->bufs = new(conf.cpu) RecordBuffers(rb_conf);
+        this->retry = NULL;
+        if (conf.continuous)
+                this->retry = new(conf.cpu) OCCRetryPolicy(conf.retry);
 }
 
 void OCCWorker::Init()
@@ -65,22 +69,92 @@ uint32_t OCCWorker::exec_pending(OCCAction **pending_list)
         return num_done;
 }
 
+/* Keep deferred transactions ordered by the time they may be retried. */
+void OCCWorker::Defer(OCCAction **pending_list, OCCAction *action)
+{
+        OCCAction **iter;
+
+        iter = pending_list;
+        while (*iter != NULL && (*iter)->retry_at <= action->retry_at)
+                iter = &(*iter)->link;
+        action->link = *iter;
+        *iter = action;
+}
+
+/*
+ * Deferred transactions are retried once their delay is up, in between new 
+ * ones. At most config.retry.window transactions are deferred at a time, a 
+ * full window stalls the worker until the first of them is due. A batch is 
+ * released once all of its transactions commit.
+ */
+void OCCWorker::ContinuousRunner()
+{
+        OCCActionBatch input, output;
+        OCCAction *pending_list, *action;
+        uint32_t next, num_pending, num_done;
+
+        pending_list = NULL;
+        num_pending = 0;
+        output.batch = NULL;
+        while (true) {
+                input = NextBatch();
+                next = 0;
+                num_done = 0;
+                while (num_done < input.batchSize) {
+                        if (pending_list != NULL &&
+                            pending_list->retry_at <= rdtsc()) {
+                                action = pending_list;
+                                pending_list = action->link;
+                                num_pending -= 1;
+                        } else if (next < input.batchSize &&
+                                   num_pending < config.retry.window) {
+                                action = input.batch[next++];
+                                action->retries = 0;
+                        } else {
+                                do_pause();
+                                continue;
+                        }
+
+                        if (RunSingle(action)) {
+                                retry->Committed();
+                                num_done += 1;
+                        } else {
+                                action->retries += 1;
+                                action->retry_at = rdtsc() +
+                                        retry->Aborted(last_err,
+                                                       action->retries);
+                                Defer(&pending_list, action);
+                                num_pending += 1;
+                        }
+                }
+                assert(pending_list == NULL && num_pending == 0);
+                output.batchSize = input.batchSize;
+                WaitDurable();
+                config.outputQueue->EnqueueBlocking(output);
+        }
+}
+
 void OCCWorker::TxnRunner()
 {
         uint32_t i, j, num_pending;
         OCCActionBatch input, output;//, batches[2];
         OCCAction *pending_list;
         
+        if (config.continuous) {
+                ContinuousRunner();
+                return;
+        }
         num_pending = 0;
         pending_list = NULL;
         output.batch = NULL;
         
         /* This is very hacky. For measurement purposes only!!! */
         if (config.cpu == 1) {
-                input = config.inputQueue->DequeueBlocking();
+                input = NextBatch();
                 for (i = 0; i < input.batchSize; ++i) 
                         if (!RunSingle(input.batch[i]))
                                 assert(false);
+                WaitDurable();
                 config.outputQueue->EnqueueBlocking(input);                
         }
         
@@ -89,7 +163,7 @@ void OCCWorker::TxnRunner()
         barrier();
 
         for (j = 0; j < 3 ; ++j) {
-                input = config.inputQueue->DequeueBlocking();
+                input = NextBatch();
                 if (j < 1) {
                         for (i = 0; i < input.batchSize; ++i) {
                                 while (num_pending >= 50) 
@@ -104,6 +178,7 @@ void OCCWorker::TxnRunner()
                                 num_pending -= exec_pending(&pending_list);
                         assert(pending_list == NULL);
                         output.batchSize = input.batchSize;
+                        WaitDurable();
                         config.outputQueue->EnqueueBlocking(output);
                 } else {
                         uint32_t batch_sz = input.batchSize;
@@ -121,6 +196,43 @@ void OCCWorker::TxnRunner()
         
 }
 
+/*
+ * With logging, an idle worker must keep publishing the epoch or no epoch
+ * would ever become durable.
+ */
+OCCActionBatch OCCWorker::NextBatch()
+{
+        OCCActionBatch ret;
+        Waiter waiter;
+        
+        if (config.log == NULL)
+                return config.inputQueue->DequeueBlocking();
+        while (!config.inputQueue->Dequeue(&ret)) {
+                barrier();
+                config.log->Refresh(*config.epoch_ptr);
+                barrier();
+                waiter.wait();
+        }
+        return ret;
+}
+
+/*
+ * Results of transactions are released only once their epoch is durable.
+ */
+void OCCWorker::WaitDurable()
+{
+        Waiter waiter;
+        
+        if (config.log == NULL)
+                return;
+        while (!config.log->IsDurable(this->last_epoch)) {
+                barrier();
+                config.log->Refresh(*config.epoch_ptr);
+                barrier();
+                waiter.wait();
+        }
+}
+
 void OCCWorker::UpdateEpoch()
 {
         uint32_t temp;
@@ -145,37 +257,66 @@ uint64_t OCCWorker::NumCompleted()
 
 /*
  * Run the action to completion. If the transaction aborts due to a conflict, 
- * retry.
+ * retry. Read-only transactions skip locking, TID computation and installing
+ * writes, they only re-check the TIDs of the records they read.
  */
 bool OCCWorker::RunSingle(OCCAction *action)
 {
-        volatile uint32_t epoch;
-        bool validated;
-
         action->set_tables(this->config.tables, this->config.lock_tables);
         action->set_allocator(this->bufs);
+        action->set_log(this->config.log);
         action->worker = this;
 
+        /* OCC keeps a single version of each record, no snapshot to read. */
+        if (action->get_isolation() == ISOLATION_READ_COMMITTED)
+                return RunIsolated<ISOLATION_READ_COMMITTED>(action);
+        else
+                return RunIsolated<ISOLATION_SERIALIZABLE>(action);
+}
+
+/* 
+ * Read committed txns skip validation and TID computation, reads which see a 
+ * write in progress are retried instead of aborting the txn.
+ */
+template<isolation_level L>
+bool OCCWorker::RunIsolated(OCCAction *action)
+{
+        volatile uint32_t epoch;
+        bool validated;
+
         try {
                 action->run();
-                action->acquire_locks();
+                if (action->read_only) {
+                        action->validate_read_only();
+                        barrier();
+                        this->last_epoch = *config.epoch_ptr;
+                        barrier();
+                        action->cleanup();
+                        fetch_and_increment(&config.num_completed);
+                        return true;
+                }
+                action->acquire_locks<L>();
                 barrier();
                 epoch = *config.epoch_ptr;
                 barrier();                        
-                if (!READ_COMMITTED) {
+                if (L == ISOLATION_SERIALIZABLE) {
                         action->validate();
                         this->last_tid = action->compute_tid(epoch,
                                                              this->last_tid);
                 }
-                action->install_writes();
+                if (config.log != NULL) 
+                        config.log->BeginCommit(epoch);
+                this->last_epoch = epoch;
+                action->install_writes<L>();
                 action->cleanup();
                 fetch_and_increment(&config.num_completed);
                 validated = true;
         } catch(const occ_validation_exception &e) {
-                if (READ_COMMITTED)
-                        assert(false);
+                /* Read-only txns validate at every isolation level. */
+                assert(L == ISOLATION_SERIALIZABLE || action->read_only);
                 if (e.err == VALIDATION_ERR)
                         action->release_locks();
+                last_err = e.err;
                 action->cleanup();
                 validated = false;
         }        
@@ -132,6 +132,10 @@ void OCCAction::add_read_key(uint32_t tableId, uint64_t key)
 
 OCCAction::OCCAction(txn *txn) : translator(txn)
 {
+        this->log = NULL;
+        this->read_only = true;
+        this->retries = 0;
+        this->retry_at = 0;
 }
 
 void OCCAction::add_write_key(uint32_t tableId, uint64_t key, bool is_rmw)
@@ -139,6 +143,7 @@ void OCCAction::add_write_key(uint32_t tableId, uint64_t key, bool is_rmw)
         occ_composite_key k(tableId, key, is_rmw);
         writeset.push_back(k);
         shadow_writeset.push_back(k);
+        read_only = false;
 }
 
 void OCCAction::set_allocator(RecordBuffers *bufs)
@@ -146,6 +151,11 @@ void OCCAction::set_allocator(RecordBuffers *bufs)
         this->record_alloc = bufs;
 }
 
+void OCCAction::set_log(OCCLogBuffer *log)
+{
+        this->log = log;
+}
+
 void OCCAction::set_tables(Table **tables, Table **lock_tables)
 {
         this->tables = tables;
@@ -174,7 +184,7 @@ uint64_t OCCAction::stable_copy(uint64_t key, uint32_t table_id, void *record)
                         barrier();
                         if (after_read == ret)
                                 return ret;
-                        else if (READ_COMMITTED)
+                        else if (get_isolation() == ISOLATION_READ_COMMITTED)
                                 continue;
                         else
                                 throw occ_validation_exception(READ_ERR);
@@ -201,6 +211,22 @@ void OCCAction::validate_single(occ_composite_key &comp_key)
                 throw occ_validation_exception(VALIDATION_ERR);
 }
 
+/* 
+ * No record read has been written since, so all of the values the logic saw 
+ * were current at once, once all of the reads were done. 
+ */
+void OCCAction::validate_read_only()
+{
+        uint32_t num_reads, i;
+
+        assert(this->read_only);
+        num_reads = this->readset.size();
+        for (i = 0; i < num_reads; ++i)
+                if (this->readset[i].is_initialized &&
+                    !this->readset[i].ValidateRead())
+                        throw occ_validation_exception(VALIDATION_ERR);
+}
+
 void OCCAction::validate()
 {
         uint32_t num_reads, num_writes, i;
@@ -247,6 +273,18 @@ int OCCAction::rand()
         return worker->gen_random();
 }
 
+/* Remember the TID of the record, and hand out the value in the table. */
+void* OCCAction::read_in_place(occ_composite_key *comp_key)
+{
+        if (comp_key->is_initialized == false) {
+                comp_key->value =
+                        this->tables[comp_key->tableId]->Get(comp_key->key);
+                comp_key->is_initialized = true;
+                return comp_key->StartRead();
+        }
+        return comp_key->GetValue();
+}
+
 void* OCCAction::read(uint64_t key, uint32_t table_id)
 {
         uint64_t tid;
@@ -265,6 +303,8 @@ void* OCCAction::read(uint64_t key, uint32_t table_id)
                 }                
         }
         assert(comp_key != NULL);
+        if (this->read_only)
+                return read_in_place(comp_key);
         if (comp_key->is_initialized == false) {
                 record = this->record_alloc->GetRecord(table_id);
                 comp_key->is_initialized = true;
@@ -275,6 +315,7 @@ void* OCCAction::read(uint64_t key, uint32_t table_id)
         return RECORD_VALUE_PTR(comp_key->value);
 }
 
+template<isolation_level L>
 void OCCAction::acquire_locks()
 {
         uint32_t i, num_writes, table_id;
@@ -288,7 +329,7 @@ void OCCAction::acquire_locks()
                 assert(this->writeset[i].is_locked == false);
                 table_id = this->writeset[i].tableId;
                 key = this->writeset[i].key;
-                if (READ_COMMITTED)
+                if (L == ISOLATION_READ_COMMITTED)
                         value = this->lock_tables[table_id]->GetAlways(key);
                 else
                         value = this->tables[table_id]->GetAlways(key);
@@ -374,41 +415,64 @@ void OCCAction::cleanup()
         }
         num_reads = this->readset.size();
         for (i = 0; i < num_reads; ++i) {
-                if (this->readset[i].is_initialized == true) 
+                if (this->read_only) {
+                        /* Values are in the table, not from record_alloc. */
+                        this->readset[i].value = NULL;
+                        this->readset[i].is_initialized = false;
+                } else if (this->readset[i].is_initialized == true) {
                         cleanup_single(this->readset[i]);
+                }
         }
 }
 
+template<isolation_level L>
 void OCCAction::install_single_write(occ_composite_key &comp_key)
 {
-        if (READ_COMMITTED)
-                this->tid = 0;
-        assert(IS_LOCKED(this->tid) == false);
+        assert(L == ISOLATION_READ_COMMITTED || IS_LOCKED(this->tid) == false);
 
         void *value;
-        uint64_t old_tid;
+        uint64_t old_tid, new_tid;
         uint32_t record_size;
 
         record_size = this->tables[comp_key.tableId]->RecordSize();
         value = this->tables[comp_key.tableId]->GetAlways(comp_key.key);
-        if (READ_COMMITTED)
+        if (L == ISOLATION_READ_COMMITTED)
                 acquire_single((volatile uint64_t*)value);
         old_tid = *(uint64_t*)value;
         assert(IS_LOCKED(old_tid) == true);
+
+        /* 
+         * Without tids, the record word counts the versions of the record.
+         * This orders the writes to the record in the log.
+         */
+        if (L == ISOLATION_READ_COMMITTED)
+                new_tid = GET_TIMESTAMP(old_tid) + 0x10;
+        else 
+                new_tid = this->tid;
         memcpy(RECORD_VALUE_PTR(value), RECORD_VALUE_PTR(comp_key.value),
                record_size - sizeof(uint64_t));
-        xchgq((volatile uint64_t*)value, this->tid);
-        if (READ_COMMITTED) {
+        xchgq((volatile uint64_t*)value, new_tid);
+        if (L == ISOLATION_READ_COMMITTED) {
                 value = this->lock_tables[comp_key.tableId]->GetAlways(comp_key.key);
                 release_single((volatile uint64_t*)value);
         }
         comp_key.is_locked = false;
+        if (this->log != NULL) 
+                this->log->Append(comp_key.tableId, comp_key.key, new_tid,
+                                  RECORD_VALUE_PTR(comp_key.value),
+                                  record_size - sizeof(uint64_t));
 }
 
+template<isolation_level L>
 void OCCAction::install_writes()
 {
         uint32_t i, num_writes;
         num_writes = this->writeset.size();
         for (i = 0; i < num_writes; ++i) 
-                install_single_write(this->writeset[i]);        
+                install_single_write<L>(this->writeset[i]);        
 }
+
+template void OCCAction::acquire_locks<ISOLATION_SERIALIZABLE>();
+template void OCCAction::acquire_locks<ISOLATION_READ_COMMITTED>();
+template void OCCAction::install_writes<ISOLATION_SERIALIZABLE>();
+template void OCCAction::install_writes<ISOLATION_READ_COMMITTED>();
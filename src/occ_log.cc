@@ -0,0 +1,593 @@
+#include <occ_log.h>
+#include <occ_action.h>
+#include <util.h>
+#include <city.h>
+#include <wait_strategy.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define OCC_LOG_FILE "occ_log_"
+#define OCC_DURABLE_EPOCH_FILE "occ_durable_epoch"
+
+/* Keeps the checksum of an all zero block from being zero. */
+#define OCC_LOG_CHECKSUM_SEED 0x4F43434C4F47ULL
+
+static std::string log_file_name(const char *dir, uint32_t logger_id)
+{
+        return std::string(dir) + "/" + OCC_LOG_FILE + 
+                std::to_string(logger_id);
+}
+
+static std::string durable_epoch_file_name(const char *dir)
+{
+        return std::string(dir) + "/" + OCC_DURABLE_EPOCH_FILE;
+}
+
+static uint32_t next_pow_2(uint32_t n)
+{
+        uint32_t ret = 1;
+        while (ret < n)
+                ret <<= 1;
+        return ret;
+}
+
+static SimpleQueue<occ_log_segment*>* create_segment_queue(uint32_t size,
+                                                           int cpu)
+{
+        char *data;
+
+        size = next_pow_2(size);
+        data = (char*)alloc_mem(CACHE_LINE*size, cpu);
+        assert(data != NULL);
+        return new SimpleQueue<occ_log_segment*>(data, size);
+}
+
+OCCLogBuffer::OCCLogBuffer(uint32_t worker_id, uint64_t segment_size,
+                           uint32_t num_segments,
+                           volatile uint32_t *durable_epoch_ptr, int cpu)
+{
+        uint32_t i;
+        occ_log_segment *seg;
+
+        assert(num_segments > 1);
+        this->worker_id = worker_id;
+        this->segment_size = segment_size;
+        this->durable_epoch_ptr = durable_epoch_ptr;
+        this->full_segs = create_segment_queue(num_segments, cpu);
+        this->free_segs = create_segment_queue(num_segments, cpu);
+        for (i = 0; i < num_segments; ++i) {
+                seg = (occ_log_segment*)alloc_mem(sizeof(occ_log_segment), cpu);
+                seg->epoch = 0;
+                seg->len = 0;
+                seg->data = (char*)alloc_mem(segment_size, cpu);
+                assert(seg->data != NULL);
+                free_segs->EnqueueBlocking(seg);
+        }
+        this->cur = free_segs->DequeueBlocking();
+        this->log_epoch = 0;
+}
+
+/*
+ * Hands the current segment off to the logger and takes a free one, waiting 
+ * for the logger if there is none.
+ */
+void OCCLogBuffer::HandOff()
+{
+        uint32_t epoch;
+
+        if (cur->len == 0)
+                return;
+        epoch = cur->epoch;
+        full_segs->EnqueueBlocking(cur);
+        cur = free_segs->DequeueBlocking();
+        cur->epoch = epoch;
+        cur->len = 0;
+}
+
+/* 
+ * The segments must be visible to the logger before the epoch is, since 
+ * the logger reads the epoch before it drains the segments.
+ */
+void OCCLogBuffer::PublishEpoch(uint32_t epoch)
+{
+        assert(epoch >= log_epoch);
+        barrier();
+        log_epoch = epoch;
+        barrier();
+}
+
+void OCCLogBuffer::BeginCommit(uint32_t epoch)
+{
+        assert(epoch >= cur->epoch);
+        if (epoch == cur->epoch)
+                return;
+        HandOff();
+        cur->epoch = epoch;
+        PublishEpoch(epoch);
+}
+
+void OCCLogBuffer::Append(uint32_t table_id, uint64_t key, uint64_t tid,
+                          void *value, uint32_t len)
+{
+        occ_log_header header;
+        uint64_t rec_len;
+        
+        rec_len = sizeof(occ_log_header) + len;
+        assert(rec_len <= segment_size);
+        if (cur->len + rec_len > segment_size) 
+                HandOff();
+        header = {
+                table_id,
+                key,
+                tid,
+                len,
+        };
+        memcpy(&cur->data[cur->len], &header, sizeof(occ_log_header));
+        memcpy(&cur->data[cur->len + sizeof(occ_log_header)], value, len);
+        cur->len += rec_len;
+}
+
+void OCCLogBuffer::Refresh(uint32_t epoch)
+{
+        HandOff();
+        if (epoch > cur->epoch)
+                cur->epoch = epoch;
+        if (epoch > log_epoch)
+                PublishEpoch(epoch);
+}
+
+bool OCCLogBuffer::IsDurable(uint32_t epoch)
+{
+        bool ret;
+        barrier();
+        ret = (epoch < *durable_epoch_ptr);
+        barrier();
+        return ret;
+}
+
+uint64_t OCCLogBuffer::LogEpoch()
+{
+        uint64_t ret;
+        barrier();
+        ret = log_epoch;
+        barrier();
+        return ret;
+}
+
+OCCLogger::OCCLogger(uint32_t logger_id, OCCLog *log, const char *dir,
+                     bool append, OCCLogBuffer **buffers, uint32_t num_buffers,
+                     int cpu)
+        : Runnable(cpu)
+{
+        std::string file_name;
+        int flags;
+
+        this->logger_id = logger_id;
+        this->log = log;
+        this->buffers = buffers;
+        this->num_buffers = num_buffers;
+        this->stop = 0;
+        this->durable_epoch = 0;
+
+        file_name = log_file_name(dir, logger_id);
+        flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+        this->fd = open(file_name.c_str(), flags, 0644);
+        if (this->fd < 0) {
+                std::cerr << "Couldn't open log file " << file_name << "\n";
+                exit(-1);
+        }
+}
+
+void OCCLogger::Init()
+{
+}
+
+void OCCLogger::WriteAll(const char *data, uint64_t len)
+{
+        ssize_t written;
+        
+        while (len > 0) {
+                written = write(fd, data, len);
+                if (written < 0 && errno == EINTR)
+                        continue;
+                if (written < 0) {
+                        std::cerr << "Couldn't write the OCC log\n";
+                        exit(-1);
+                }
+                data += written;
+                len -= written;
+        }
+}
+
+/* Checksum of a block's header, without the checksum, and its records. */
+static uint64_t block_checksum(const occ_log_block_header *block,
+                               const char *data)
+{
+        uint64_t sum, word, i;
+
+        sum = Hash128to64(std::make_pair(OCC_LOG_CHECKSUM_SEED ^ 
+                                         ((uint64_t)block->epoch << 32 | 
+                                          block->worker),
+                                         block->len));
+        for (i = 0; i < block->len; i += sizeof(uint64_t)) {
+                word = 0;
+                memcpy(&word, &data[i], 
+                       std::min((uint64_t)sizeof(uint64_t), block->len - i));
+                sum = Hash128to64(std::make_pair(sum, word));
+        }
+        return sum;
+}
+
+uint32_t OCCLogger::FlushRound()
+{
+        uint32_t i, num_written;
+        uint64_t min_epoch;
+        occ_log_segment *seg;
+        occ_log_block_header header;
+
+        /* 
+         * Read the epochs first. Everything handed off before they were 
+         * published is in the queues by now.
+         */
+        min_epoch = UINT64_MAX;
+        for (i = 0; i < num_buffers; ++i) 
+                min_epoch = std::min(min_epoch, buffers[i]->LogEpoch());
+        barrier();
+
+        num_written = 0;
+        for (i = 0; i < num_buffers; ++i) {
+                while (buffers[i]->full_segs->Dequeue(&seg)) {
+                        header = {
+                                seg->epoch,
+                                buffers[i]->worker_id,
+                                seg->len,
+                                0,
+                        };
+                        header.checksum = block_checksum(&header, seg->data);
+                        WriteAll((char*)&header, sizeof(header));
+                        WriteAll(seg->data, seg->len);
+                        buffers[i]->free_segs->EnqueueBlocking(seg);
+                        num_written += 1;
+                }
+        }
+        
+        /* This is the group commit. */
+        if (num_written > 0 && fdatasync(fd) != 0) {
+                std::cerr << "Couldn't sync the OCC log\n";
+                exit(-1);
+        }
+
+        if (num_buffers > 0 && min_epoch > durable_epoch) {
+                barrier();
+                durable_epoch = min_epoch;
+                barrier();
+        }
+        return num_written;
+}
+
+void OCCLogger::StartWorking()
+{
+        Waiter waiter;
+
+        while (!stop) {
+                if (FlushRound() > 0)
+                        waiter = Waiter();
+                else 
+                        waiter.wait();
+                if (logger_id == 0) 
+                        log->UpdateDurableEpoch();
+        }
+}
+
+uint64_t OCCLogger::DurableEpoch()
+{
+        uint64_t ret;
+        barrier();
+        ret = (num_buffers == 0 ? UINT64_MAX : durable_epoch);
+        barrier();
+        return ret;
+}
+
+void OCCLogger::Stop()
+{
+        barrier();
+        stop = 1;
+        barrier();
+        Join();
+        FlushRound();
+        close(fd);
+}
+
+OCCLog::OCCLog(OCCLogConfig config)
+{
+        uint32_t i, j, num_buffers;
+        OCCLogBuffer **logger_buffers;
+        std::string file_name;
+        
+        assert(config.num_loggers > 0);
+        this->config = config;
+        this->durable_epoch = config.recovered_epoch;
+        
+        file_name = durable_epoch_file_name(config.dir);
+        this->epoch_fd = open(file_name.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (this->epoch_fd < 0) {
+                std::cerr << "Couldn't open " << file_name << "\n";
+                exit(-1);
+        }
+        PersistDurableEpoch();
+        
+        buffers = (OCCLogBuffer**)malloc(sizeof(OCCLogBuffer*)*
+                                         config.num_workers);
+        for (i = 0; i < config.num_workers; ++i) 
+                buffers[i] = new(i) OCCLogBuffer(i, config.buffer_size/
+                                                 config.segments_per_worker,
+                                                 config.segments_per_worker,
+                                                 &this->durable_epoch, i);
+
+        /* Worker i is served by logger i % num_loggers. */
+        loggers = (OCCLogger**)malloc(sizeof(OCCLogger*)*config.num_loggers);
+        for (i = 0; i < config.num_loggers; ++i) {
+                logger_buffers = (OCCLogBuffer**)malloc(sizeof(OCCLogBuffer*)*
+                                                        config.num_workers);
+                num_buffers = 0;
+                for (j = i; j < config.num_workers; j += config.num_loggers) 
+                        logger_buffers[num_buffers++] = buffers[j];
+                loggers[i] = new(config.first_logger_cpu + i)
+                        OCCLogger(i, this, config.dir,
+                                  config.recovered_epoch > 0, logger_buffers,
+                                  num_buffers, config.first_logger_cpu + i);
+        }
+}
+
+OCCLogBuffer* OCCLog::GetBuffer(uint32_t worker)
+{
+        assert(worker < config.num_workers);
+        return buffers[worker];
+}
+
+void OCCLog::Run()
+{
+        uint32_t i;
+        for (i = 0; i < config.num_loggers; ++i) {
+                loggers[i]->Run();
+                loggers[i]->WaitInit();
+        }
+}
+
+void OCCLog::Stop()
+{
+        uint32_t i;
+        for (i = 0; i < config.num_loggers; ++i) 
+                loggers[i]->Stop();
+        UpdateDurableEpoch();
+        close(epoch_fd);
+}
+
+uint32_t OCCLog::DurableEpoch()
+{
+        uint32_t ret;
+        barrier();
+        ret = durable_epoch;
+        barrier();
+        return ret;
+}
+
+void OCCLog::PersistDurableEpoch()
+{
+        uint32_t epoch = durable_epoch;
+        if (pwrite(epoch_fd, &epoch, sizeof(epoch), 0) != sizeof(epoch) ||
+            fdatasync(epoch_fd) != 0) {
+                std::cerr << "Couldn't persist the durable OCC epoch\n";
+                exit(-1);
+        }
+}
+
+void OCCLog::UpdateDurableEpoch()
+{
+        uint32_t i;
+        uint64_t min_epoch;
+
+        min_epoch = UINT64_MAX;
+        for (i = 0; i < config.num_loggers; ++i) 
+                min_epoch = std::min(min_epoch, loggers[i]->DurableEpoch());
+        if (min_epoch == UINT64_MAX || min_epoch <= durable_epoch)
+                return;
+        
+        /* Workers may only learn about the epoch once it is persisted. */
+        barrier();
+        durable_epoch = (uint32_t)min_epoch;
+        PersistDurableEpoch();
+        barrier();
+}
+
+static bool read_file(std::string file_name, char **data, uint64_t *len)
+{
+        FILE *f;
+        long sz;
+
+        f = fopen(file_name.c_str(), "rb");
+        if (f == NULL)
+                return false;
+        fseek(f, 0, SEEK_END);
+        sz = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        *data = (char*)malloc(sz + 1);
+        *len = fread(*data, 1, sz, f);
+        fclose(f);
+        return true;
+}
+
+/* Maps all of file_name. Returns false if it is missing or empty. */
+static bool map_file(std::string file_name, char **data, uint64_t *len)
+{
+        struct stat st;
+        int fd;
+
+        fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0)
+                return false;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                close(fd);
+                return false;
+        }
+        *len = st.st_size;
+        *data = (char*)mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (*data == MAP_FAILED) {
+                std::cerr << "Couldn't map " << file_name << "\n";
+                exit(-1);
+        }
+        return true;
+}
+
+/* A run of consecutive log blocks kept by Recover. */
+struct occ_log_extent {
+        uint64_t start;
+        uint64_t len;
+};
+
+/* 
+ * Cuts file_name down to the given extents of data, its old contents. If they
+ * are a prefix, the file is truncated, otherwise it is replaced atomically.
+ */
+static void compact_file(std::string file_name, const char *data,
+                         std::vector<occ_log_extent> &extents)
+{
+        std::string temp_name;
+        const char *cur;
+        uint64_t len;
+        ssize_t written;
+        int fd;
+
+        if (extents.size() == 0 || 
+            (extents.size() == 1 && extents[0].start == 0)) {
+                len = (extents.size() == 0 ? 0 : extents[0].len);
+                if (truncate(file_name.c_str(), len) != 0) {
+                        std::cerr << "Couldn't truncate " << file_name << "\n";
+                        exit(-1);
+                }
+                return;
+        }
+
+        temp_name = file_name + ".tmp";
+        fd = open(temp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+                std::cerr << "Couldn't open " << temp_name << "\n";
+                exit(-1);
+        }
+        for (occ_log_extent &extent : extents) {
+                cur = &data[extent.start];
+                len = extent.len;
+                while (len > 0) {
+                        written = write(fd, cur, len);
+                        if (written < 0 && errno == EINTR)
+                                continue;
+                        if (written < 0) {
+                                std::cerr << "Couldn't write " << temp_name;
+                                std::cerr << "\n";
+                                exit(-1);
+                        }
+                        cur += written;
+                        len -= written;
+                }
+        }
+        if (fdatasync(fd) != 0 || close(fd) != 0 ||
+            rename(temp_name.c_str(), file_name.c_str()) != 0) {
+                std::cerr << "Couldn't replace " << file_name << "\n";
+                exit(-1);
+        }
+}
+
+static bool apply_record(Table **tables, uint32_t num_tables,
+                         occ_log_header *header, char *value)
+{
+        uint64_t *record;
+
+        assert(header->table_id < num_tables);
+        assert(OCC_RECORD_SIZE(header->record_len) == 
+               tables[header->table_id]->RecordSize());
+        record = (uint64_t*)tables[header->table_id]->GetAlways(header->key);
+        if (record[0] > header->tid)
+                return false;
+        record[0] = header->tid;
+        memcpy(&record[1], value, header->record_len);
+        return true;
+}
+
+uint64_t OCCLog::Recover(const char *dir, uint32_t num_loggers, Table **tables,
+                         uint32_t num_tables, uint32_t *durable_epoch)
+{
+        uint32_t i, durable;
+        uint64_t len, pos, block_start, block_end, kept, applied;
+        char *data;
+        std::string file_name;
+        std::vector<occ_log_extent> extents;
+        occ_log_block_header block;
+        occ_log_header header;
+        
+        *durable_epoch = 0;
+        if (!read_file(durable_epoch_file_name(dir), &data, &len) ||
+            len < sizeof(uint32_t))
+                return 0;
+        memcpy(&durable, data, sizeof(uint32_t));
+        free(data);
+        *durable_epoch = durable;
+        
+        applied = 0;
+        for (i = 0; i < num_loggers; ++i) {
+                file_name = log_file_name(dir, i);
+                if (!map_file(file_name, &data, &len))
+                        continue;
+                extents.clear();
+                kept = 0;
+                pos = 0;
+                while (pos + sizeof(block) <= len) {
+                        block_start = pos;
+                        memcpy(&block, &data[pos], sizeof(block));
+                        pos += sizeof(block);
+                        /* 
+                         * A torn write at the end of the log, or a block 
+                         * that was never completely written. 
+                         */
+                        if (block.len > len - pos ||
+                            block_checksum(&block, &data[pos]) != 
+                            block.checksum)
+                                break;
+                        block_end = pos + block.len;
+                        if (block.epoch >= durable) {
+                                pos = block_end;
+                                continue;
+                        }
+                        while (pos < block_end) {
+                                memcpy(&header, &data[pos], sizeof(header));
+                                pos += sizeof(header);
+                                if (apply_record(tables, num_tables, &header,
+                                                 &data[pos]))
+                                        applied += 1;
+                                pos += header.record_len;
+                        }
+                        if (extents.size() > 0 &&
+                            extents.back().start + extents.back().len == 
+                            block_start)
+                                extents.back().len += block_end - block_start;
+                        else 
+                                extents.push_back({block_start, 
+                                                   block_end - block_start});
+                        kept += block_end - block_start;
+                }
+                if (kept < len)
+                        compact_file(file_name, data, extents);
+                munmap(data, len);
+        }
+        return applied;
+}
@@ -0,0 +1,59 @@
+#include <occ_retry.h>
+#include <cassert>
+
+OCCRetryPolicy::OCCRetryPolicy(OCCRetryConfig config)
+{
+        assert(config.window > 0);
+        assert(config.base_delay <= config.max_delay);
+        this->config = config;
+        this->read_rate = 0;
+        this->validation_rate = 0;
+}
+
+/* Exponentially weighted moving average of the outcomes. */
+void OCCRetryPolicy::update(uint64_t *rate, bool aborted)
+{
+        *rate -= *rate >> OCC_RETRY_DECAY;
+        if (aborted)
+                *rate += OCC_RETRY_ONE >> OCC_RETRY_DECAY;
+}
+
+void OCCRetryPolicy::Committed()
+{
+        update(&read_rate, false);
+        update(&validation_rate, false);
+}
+
+uint64_t OCCRetryPolicy::Aborted(validation_err_t err, uint32_t retries)
+{
+        uint64_t delay;
+        uint32_t i;
+
+        assert(retries > 0);
+        update(&read_rate, err == READ_ERR);
+        update(&validation_rate, err == VALIDATION_ERR);
+        if (err == READ_ERR) {
+                delay = config.base_delay*retries;
+                if (delay > config.max_delay)
+                        delay = config.max_delay;
+                delay = delay*read_rate/OCC_RETRY_ONE;
+        } else {
+                delay = config.base_delay;
+                for (i = 1; i < retries && delay < config.max_delay; ++i)
+                        delay <<= 1;
+                if (delay > config.max_delay)
+                        delay = config.max_delay;
+                delay = delay*validation_rate/OCC_RETRY_ONE;
+        }
+        return delay;
+}
+
+uint64_t OCCRetryPolicy::ReadRate()
+{
+        return read_rate;
+}
+
+uint64_t OCCRetryPolicy::ValidationRate()
+{
+        return validation_rate;
+}
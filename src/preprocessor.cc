@@ -101,8 +101,9 @@ MVScheduler::MVScheduler(MVSchedulerConfig config) :
 
                 /* Track the partition locally and add it to the database's catalog. */
                 this->partitions[i] =
-                        new (config.cpuNumber) MVTablePartition(config.tblPartitionSizes[i],
-                                                                config.cpuNumber, alloc);
+                        MVTablePartition::Create(config.tblIndexTypes[i],
+                                                 config.tblPartitionSizes[i],
+                                                 config.cpuNumber, alloc);
                 assert(this->partitions[i] != NULL);
         }
         this->threadId = config.threadId;
@@ -119,8 +120,7 @@ void MVScheduler::StartWorking()
                 ActionBatch curBatch = config.inputQueue->DequeueBlocking();
                 for (uint32_t i = 0; i < config.numSubords; ++i) 
                         config.pubQueues[i]->EnqueueBlocking(curBatch);
-                for (uint32_t i = 0; i < curBatch.numActions; ++i) 
-                        ScheduleTransaction(curBatch.actionBuf[i]);
+                ScheduleBatch(curBatch);
                 for (uint32_t i = 0; i < config.numSubords; ++i) 
                         config.subQueues[i]->DequeueBlocking();
                 for (uint32_t i = 0; i < config.numOutputs; ++i) 
@@ -176,6 +176,17 @@ void MVScheduler::ProcessWriteset(mv_action *action)
                 MVRecord *ref = this->partitions[action->__readset[i].tableId]->
                         GetMVRecord(action->__readset[i], action->__version);
                 action->__readset[i].value = ref;
+
+                /*
+                 * Count the read against the version the action will actually
+                 * see. Read-only actions read the previous epoch's snapshot.
+                 */
+                if (ref != NULL && action->__readonly == true &&
+                    GET_MV_EPOCH(action->__version) ==
+                    GET_MV_EPOCH(ref->createTimestamp))
+                        ref = ref->epoch_ancestor;
+                if (ref != NULL)
+                        ref->numReaders += 1;
                 r_index = action->__readset[i].next;
         }
 
@@ -194,3 +205,72 @@ inline void MVScheduler::ScheduleTransaction(mv_action *action)
                 ProcessWriteset(action);
         }
 }
+
+/*
+ * Issue prefetches for every key of action this thread is responsible for. If 
+ * heads is false, prefetch the index entries the keys hash to. Otherwise, 
+ * prefetch the newest version of each key, which reads the index entries.
+ */
+void MVScheduler::PrefetchAction(mv_action *action, bool heads)
+{
+        int index;
+        CompositeKey *key;
+        
+        if ((action->__combinedHash & txnMask) == 0)
+                return;
+
+        index = action->__read_starts[threadId];
+        while (index != -1) {
+                key = &action->__readset[index];
+                if (heads)
+                        this->partitions[key->tableId]->PrefetchHead(*key);
+                else
+                        this->partitions[key->tableId]->PrefetchSlot(*key);
+                index = key->next;
+        }
+        
+        index = action->__write_starts[threadId];
+        while (index != -1) {
+                key = &action->__writeset[index];
+                if (heads)
+                        this->partitions[key->tableId]->PrefetchHead(*key);
+                else
+                        this->partitions[key->tableId]->PrefetchSlot(*key);
+                index = key->next;
+        }
+}
+
+/*
+ * Schedule every action in the batch, in order. With a non-zero prefetch 
+ * window, the index lookups are software pipelined: while action i is being 
+ * scheduled, the index entries of action i+window and the version chain heads 
+ * of action i+window/2 are prefetched. Prefetches are only hints, so the 
+ * serial order in which versions are created is unchanged.
+ */
+void MVScheduler::ScheduleBatch(const ActionBatch &batch)
+{
+        uint32_t i, slot_dist, head_dist, num_actions;
+        
+        num_actions = batch.numActions;
+        slot_dist = config.prefetchWindow;
+        head_dist = slot_dist/2;
+        if (slot_dist == 0) {
+                for (i = 0; i < num_actions; ++i) 
+                        ScheduleTransaction(batch.actionBuf[i]);
+                return;
+        }
+
+        /* Prime the pipeline. */
+        for (i = 0; i < slot_dist && i < num_actions; ++i) 
+                PrefetchAction(batch.actionBuf[i], false);
+        for (i = 0; i < head_dist && i < num_actions; ++i)
+                PrefetchAction(batch.actionBuf[i], true);
+        
+        for (i = 0; i < num_actions; ++i) {
+                if (i + slot_dist < num_actions)
+                        PrefetchAction(batch.actionBuf[i + slot_dist], false);
+                if (head_dist > 0 && i + head_dist < num_actions)
+                        PrefetchAction(batch.actionBuf[i + head_dist], true);
+                ScheduleTransaction(batch.actionBuf[i]);
+        }
+}
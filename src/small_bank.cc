@@ -16,6 +16,14 @@ SmallBank::LoadCustomerRange::LoadCustomerRange(uint64_t customer_start,
         }
 }
 
+SmallBank::LoadCustomerRange::LoadCustomerRange(std::vector<uint64_t> customers,
+                                                std::vector<long> balances)
+{
+        assert(balances.size() == 2*customers.size());
+        this->customers = customers;
+        this->balances = balances;
+}
+
 bool SmallBank::LoadCustomerRange::Run()
 {
         long savings, checking;
@@ -219,3 +227,69 @@ void SmallBank::WriteCheck::get_rmws(struct big_key *array)
         array[0].key = this->customer_id;
         array[0].table_id = CHECKING;
 }
+
+/* The customers, followed by the savings and checking balance of each. */
+txn_type SmallBank::LoadCustomerRange::get_type()
+{
+        return SMALL_BANK_LOAD_TXN;
+}
+
+void SmallBank::LoadCustomerRange::get_params(std::vector<uint64_t> *params)
+{
+        params->insert(params->end(), customers.begin(), customers.end());
+        params->insert(params->end(), balances.begin(), balances.end());
+}
+
+txn_type SmallBank::Balance::get_type()
+{
+        return SMALL_BANK_BALANCE_TXN;
+}
+
+void SmallBank::Balance::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->customer_id);
+}
+
+txn_type SmallBank::DepositChecking::get_type()
+{
+        return SMALL_BANK_DEPOSIT_CHECKING_TXN;
+}
+
+void SmallBank::DepositChecking::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->customer_id);
+        params->push_back((uint64_t)this->amount);
+}
+
+txn_type SmallBank::TransactSaving::get_type()
+{
+        return SMALL_BANK_TRANSACT_SAVING_TXN;
+}
+
+void SmallBank::TransactSaving::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->customer_id);
+        params->push_back((uint64_t)this->amount);
+}
+
+txn_type SmallBank::Amalgamate::get_type()
+{
+        return SMALL_BANK_AMALGAMATE_TXN;
+}
+
+void SmallBank::Amalgamate::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->from_customer);
+        params->push_back(this->to_customer);
+}
+
+txn_type SmallBank::WriteCheck::get_type()
+{
+        return SMALL_BANK_WRITE_CHECK_TXN;
+}
+
+void SmallBank::WriteCheck::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->customer_id);
+        params->push_back((uint64_t)this->check_amount);
+}
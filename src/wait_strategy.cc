@@ -0,0 +1,104 @@
+#include <wait_strategy.h>
+#include <util.h>
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+WaitStrategyConfig WaitStrategy::config = {
+  WAIT_STRATEGY,
+  64,
+  64,
+  1000
+};
+
+void WaitStrategy::configure(WaitStrategyConfig c) {
+  config = c;
+}
+
+const char* WaitStrategy::get_name(uint32_t strategy) {
+  switch (strategy) {
+    case WAIT_SPIN: return "spin";
+    case WAIT_BACKOFF: return "backoff";
+    case WAIT_PARK: return "park";
+    default: return "unknown";
+  }
+}
+
+/*
+ * Futexes operate on 32 bit words. Counters are 64 bit and little endian, so
+ * we sleep on their lower half, which changes with every increment.
+ */
+static inline int* futex_word(volatile uint64_t* word) {
+  return (int*) word;
+}
+
+void Waiter::wait(volatile uint64_t* word, uint64_t seen, volatile uint64_t* parked) {
+  const WaitStrategyConfig& c = WaitStrategy::get_config();
+  if (c.strategy == WAIT_PARK && checks >= c.spin_budget) {
+    park(word, seen, parked);
+    return;
+  }
+
+  wait();
+}
+
+void Waiter::wait() {
+  const WaitStrategyConfig& c = WaitStrategy::get_config();
+  checks ++;
+  switch (c.strategy) {
+    case WAIT_SPIN:
+      barrier();
+      return;
+    case WAIT_PARK:
+      if (checks > c.spin_budget) {
+        sched_yield();
+        return;
+      }
+      // fall through
+    case WAIT_BACKOFF:
+      for (uint32_t i = 0; i < backoff; i++) {
+        do_pause();
+      }
+      if (backoff < c.max_backoff) backoff <<= 1;
+      return;
+  }
+}
+
+void Waiter::park(volatile uint64_t* word, uint64_t seen, volatile uint64_t* parked) {
+  // The locked increment orders the registration before the futex checks
+  // the word, and writers change the word before they look at parked. So
+  // either the writer sees us parked, or we see the new value.
+  fetch_and_increment(parked);
+  uint64_t timeout_us = WaitStrategy::get_config().park_timeout_us;
+  struct timespec timeout = {
+    (time_t) (timeout_us / 1000000),
+    (long) (timeout_us % 1000000) * 1000
+  };
+  syscall(
+      SYS_futex,
+      futex_word(word),
+      FUTEX_WAIT_PRIVATE,
+      (int) seen,
+      &timeout,
+      nullptr,
+      0);
+  fetch_and_decrement(parked);
+}
+
+void wake_parked_slow(volatile uint64_t* word, volatile uint64_t* parked) {
+  // the store to word must be visible before we read parked.
+  asm volatile("mfence":::"memory");
+  if (*parked == 0) return;
+
+  syscall(
+      SYS_futex,
+      futex_word(word),
+      FUTEX_WAKE_PRIVATE,
+      INT32_MAX,
+      nullptr,
+      nullptr,
+      0);
+}
@@ -9,14 +9,24 @@ ycsb_insert::ycsb_insert(uint64_t start, uint64_t end)
         this->end = end;
 }
 
-void ycsb_insert::gen_rand(char *array)
+/* 
+ * The contents of a record only depend on its key, so that replaying the 
+ * command log re-creates the same records. 
+ */
+void ycsb_insert::gen_rand(uint64_t key, char *array)
 {
         uint32_t num_words, i, *int_array;
+        uint64_t state;
         
         num_words = YCSB_RECORD_SIZE / sizeof(uint32_t);
         int_array = (uint32_t*)array;
-        for (i = 0; i < num_words; ++i) 
-                int_array[i] = (uint32_t)txn_rand();
+        state = key*0x9E3779B97F4A7C15 + 1;
+        for (i = 0; i < num_words; ++i) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                int_array[i] = (uint32_t)state;
+        }
 }
 
 bool ycsb_insert::Run()
@@ -25,7 +35,7 @@ bool ycsb_insert::Run()
         char rand_array[YCSB_RECORD_SIZE], *record_ptr;
 
         for (i = this->start; i < this->end; ++i) {
-                gen_rand(rand_array);
+                gen_rand(i, rand_array);
                 record_ptr = (char*)get_write_ref(i, 0);
                 memcpy(record_ptr, rand_array, YCSB_RECORD_SIZE);
         }
@@ -46,6 +56,17 @@ void ycsb_insert::get_writes(struct big_key *array)
         }
 }
 
+txn_type ycsb_insert::get_type()
+{
+        return YCSB_INSERT_TXN;
+}
+
+void ycsb_insert::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->start);
+        params->push_back(this->end);
+}
+
 ycsb_readonly::ycsb_readonly(vector<uint64_t> reads)
 {
         uint32_t num_reads, i;
@@ -79,6 +100,16 @@ void ycsb_readonly::get_reads(struct big_key *array)
         return;
 }
 
+txn_type ycsb_readonly::get_type()
+{
+        return YCSB_READONLY_TXN;
+}
+
+void ycsb_readonly::get_params(std::vector<uint64_t> *params)
+{
+        params->insert(params->end(), reads.begin(), reads.end());
+}
+
 ycsb_rmw::ycsb_rmw(vector<uint64_t> reads, vector<uint64_t> writes)
 {
         uint32_t num_reads, num_writes, i;
@@ -154,3 +185,16 @@ bool ycsb_rmw::Run()
         }
         return true;
 }
+
+txn_type ycsb_rmw::get_type()
+{
+        return YCSB_RMW_TXN;
+}
+
+/* The number of reads, the reads and then the writes. */
+void ycsb_rmw::get_params(std::vector<uint64_t> *params)
+{
+        params->push_back(this->reads.size());
+        params->insert(params->end(), reads.begin(), reads.end());
+        params->insert(params->end(), writes.begin(), writes.end());
+}
@@ -12,6 +12,8 @@
 #define MAX_CPU 	79
 #define FAKE_ITER_SIZE 1000
 
+struct workload_config;
+
 template<class T>
 SimpleQueue<T>** setup_queues(int num_queues, int queue_size)
 {
@@ -40,6 +42,10 @@ void pin_memory();
 
 Table** setup_hash_tables(uint32_t num_tables, uint32_t *num_records, bool occ);
 
+void bulk_load_hash_tables(Table **tables, uint32_t num_tables,
+                           workload_config conf, bool occ,
+                           uint32_t num_threads);
+
 struct big_key* setup_array(txn *t);
 
 #endif // COMMON_H_
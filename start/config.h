@@ -5,8 +5,10 @@
 #include <iostream>
 #include <getopt.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unordered_map>
 #include <cassert>
+#include <db.h>
 
 using namespace std;
 
@@ -28,7 +30,24 @@ static struct option long_options[] = {
   {"read_pct", required_argument, NULL, 14},
   {"read_txn_size", required_argument, NULL, 15},
   {"hot_position", required_argument, NULL, 16},  
-  {NULL, no_argument, NULL, 17},
+  {"mv_index", required_argument, NULL, 17},
+  {"mv_prefetch_window", required_argument, NULL, 18},
+  {"occ_log_dir", required_argument, NULL, 19},
+  {"occ_loggers", required_argument, NULL, 20},
+  {"mv_command_log", required_argument, NULL, 21},
+  {"mv_replay", required_argument, NULL, 22},
+  {"mv_checkpoint_dir", required_argument, NULL, 23},
+  {"mv_checkpoint_interval", required_argument, NULL, 24},
+  {"mv_checkpoint_load", required_argument, NULL, 25},
+  {"bulk_load", required_argument, NULL, 26},
+  {"bulk_load_dir", required_argument, NULL, 27},
+  {"hek_timestamps", required_argument, NULL, 28},
+  {"occ_continuous", required_argument, NULL, 29},
+  {"occ_window", required_argument, NULL, 30},
+  {"isolation", required_argument, NULL, 31},
+  {"read_isolation", required_argument, NULL, 32},
+  {"occ_recover", required_argument, NULL, 33},
+  {NULL, no_argument, NULL, 34},
 };
 
 enum distribution_t {
@@ -46,6 +65,18 @@ struct workload_config
         uint32_t read_pct;
         uint32_t read_txn_size;
         uint32_t hot_position;
+        /* 
+         * Tables are filled directly rather than by loader transactions, from 
+         * the checkpoint in bulk_load_dir if given. 
+         */
+        bool bulk_load;
+        char *bulk_load_dir;
+        /* 
+         * isolation_levels of txns which write and of read-only txns, see 
+         * db.h. Both default to the level the system was compiled with.
+         */
+        uint32_t isolation;
+        uint32_t read_isolation;
 };
 
 enum ConcurrencyControl {
@@ -69,6 +100,13 @@ struct OCCConfig {
         uint64_t occ_epoch;
         int read_pct;
         int read_txn_size;
+        char *log_dir;
+        uint32_t num_loggers;
+        /* Rebuild the tables from the log in log_dir, see OCCLog::Recover */
+        bool recover;
+        /* Workers run continuously with adaptive retries, see occ_retry.h */
+        bool continuous;
+        uint32_t window;
 };
 
 struct hek_config {
@@ -85,6 +123,8 @@ struct hek_config {
         uint64_t occ_epoch;
         int read_pct;
         int read_txn_size;
+        /* A hek_ts_alloc, see hek.h. */
+        uint32_t timestamps;
 };
 
 
@@ -115,7 +155,14 @@ struct MVConfig {
   double theta;
         int read_pct;
         int read_txn_size;
-        
+        uint32_t *mvIndex;
+        uint32_t numMVIndexes;
+        uint32_t prefetchWindow;
+        char *commandLog;
+        bool replay;
+        char *checkpointDir;
+        uint32_t checkpointInterval;
+        char *checkpointLoad;
 };
 
 class ExperimentConfig {
@@ -138,6 +185,23 @@ class ExperimentConfig {
     READ_PCT,
     READ_TXN_SIZE,
     HOT_POSITION,
+    MV_INDEX,
+    MV_PREFETCH_WINDOW,
+    OCC_LOG_DIR,
+    OCC_LOGGERS,
+    MV_COMMAND_LOG,
+    MV_REPLAY,
+    MV_CHECKPOINT_DIR,
+    MV_CHECKPOINT_INTERVAL,
+    MV_CHECKPOINT_LOAD,
+    BULK_LOAD,
+    BULK_LOAD_DIR,
+    HEK_TIMESTAMPS,
+    OCC_CONTINUOUS,
+    OCC_WINDOW,
+    ISOLATION,
+    READ_ISOLATION,
+    OCC_RECOVER,
   };
   unordered_map<int, char*> argMap;
 
@@ -215,6 +279,68 @@ class ExperimentConfig {
       if (argMap.count(THETA) > 0) {
         mvConfig.theta = (double)atof(argMap[THETA]);
       }
+
+      /* 
+       * Optional, partitions use the chained index unless told otherwise. 
+       * Takes a comma separated index per table, in table order. Tables past
+       * the end of the list use its last index.
+       */
+      mvConfig.mvIndex = NULL;
+      mvConfig.numMVIndexes = 0;
+      if (argMap.count(MV_INDEX) > 0) {
+        ReadIndexList(argMap[MV_INDEX], &mvConfig);
+      }
+
+      /* Optional, schedulers don't prefetch unless given a window. */
+      mvConfig.prefetchWindow = 0;
+      if (argMap.count(MV_PREFETCH_WINDOW) > 0) {
+        mvConfig.prefetchWindow = 
+          (uint32_t)atoi(argMap[MV_PREFETCH_WINDOW]);
+      }
+
+      /* 
+       * Optional, the inputs are command logged to the given file. With 
+       * mv_replay, the file is re-executed instead of running the workload.
+       */
+      mvConfig.commandLog = NULL;
+      if (argMap.count(MV_COMMAND_LOG) > 0) {
+        mvConfig.commandLog = argMap[MV_COMMAND_LOG];
+      }
+      mvConfig.replay = false;
+      if (argMap.count(MV_REPLAY) > 0) {
+        mvConfig.replay = atoi(argMap[MV_REPLAY]) != 0;
+      }
+      if (mvConfig.replay && mvConfig.commandLog == NULL) {
+        std::cerr << "--" << long_options[MV_REPLAY].name << " requires --";
+        std::cerr << long_options[MV_COMMAND_LOG].name << "\n";
+        exit(-1);
+      }
+
+      /* 
+       * Optional, a checkpoint is written to the given directory every 
+       * mv_checkpoint_interval milliseconds. With mv_checkpoint_load, the 
+       * database is loaded from the checkpoint in the given directory, and 
+       * a replay starts from the checkpoint's epoch.
+       */
+      mvConfig.checkpointDir = NULL;
+      if (argMap.count(MV_CHECKPOINT_DIR) > 0) {
+        mvConfig.checkpointDir = argMap[MV_CHECKPOINT_DIR];
+      }
+      mvConfig.checkpointInterval = 1000;
+      if (argMap.count(MV_CHECKPOINT_INTERVAL) > 0) {
+        mvConfig.checkpointInterval = 
+          (uint32_t)atoi(argMap[MV_CHECKPOINT_INTERVAL]);
+      }
+      mvConfig.checkpointLoad = NULL;
+      if (argMap.count(MV_CHECKPOINT_LOAD) > 0) {
+        mvConfig.checkpointLoad = argMap[MV_CHECKPOINT_LOAD];
+      }
+      if (mvConfig.checkpointDir != NULL && mvConfig.checkpointLoad != NULL &&
+          strcmp(mvConfig.checkpointDir, mvConfig.checkpointLoad) == 0) {
+        std::cerr << "--" << long_options[MV_CHECKPOINT_DIR].name;
+        std::cerr << " would overwrite the checkpoint being loaded\n";
+        exit(-1);
+      }
       this->ccType = MULTIVERSION;
     } else if (ccType == LOCKING) {  // ccType == LOCKING
       
@@ -305,6 +431,32 @@ class ExperimentConfig {
         occConfig.theta = (double)atof(argMap[THETA]);
       }
       occConfig.occ_epoch = (uint32_t)atoi(argMap[OCC_EPOCH]);              
+
+      /* Optional, transactions are only logged if given a directory. */
+      occConfig.log_dir = NULL;
+      if (argMap.count(OCC_LOG_DIR) > 0) {
+        occConfig.log_dir = argMap[OCC_LOG_DIR];
+      }
+      occConfig.num_loggers = 1;
+      if (argMap.count(OCC_LOGGERS) > 0) {
+        occConfig.num_loggers = (uint32_t)atoi(argMap[OCC_LOGGERS]);
+      }
+      occConfig.recover = false;
+      if (argMap.count(OCC_RECOVER) > 0) {
+        occConfig.recover = atoi(argMap[OCC_RECOVER]) != 0;
+      }
+      if (occConfig.recover == true && occConfig.log_dir == NULL) {
+        std::cerr << "Recovery needs the log directory, occ_log_dir\n";
+        exit(-1);
+      }
+      occConfig.continuous = false;
+      if (argMap.count(OCC_CONTINUOUS) > 0) {
+        occConfig.continuous = atoi(argMap[OCC_CONTINUOUS]) != 0;
+      }
+      occConfig.window = 0;
+      if (argMap.count(OCC_WINDOW) > 0) {
+        occConfig.window = (uint32_t)atoi(argMap[OCC_WINDOW]);
+      }
       this->ccType = OCC;
     } else if (ccType == HEK) {
 
@@ -343,6 +495,13 @@ class ExperimentConfig {
       if (argMap.count(THETA) > 0) {
         hek_conf.theta = (double)atof(argMap[THETA]);
       }
+
+      /* Optional, defaults to a single global counter. */
+      hek_conf.timestamps = 0;
+      if (argMap.count(HEK_TIMESTAMPS) > 0) {
+        hek_conf.timestamps = (uint32_t)atoi(argMap[HEK_TIMESTAMPS]);
+      }
+      assert(hek_conf.timestamps < 3);
       this->ccType = HEK;
             
     } else {
@@ -371,6 +530,48 @@ class ExperimentConfig {
     assert(w_conf.experiment != 2 || argMap.count(HOT_POSITION) != 0);
     if (w_conf.experiment == 2)
             w_conf.hot_position = (uint32_t)atoi(argMap[HOT_POSITION]);
+
+    /* Optional, a directory to load from implies bulk loading. */
+    w_conf.bulk_load = false;
+    if (argMap.count(BULK_LOAD) > 0)
+            w_conf.bulk_load = atoi(argMap[BULK_LOAD]) != 0;
+    w_conf.bulk_load_dir = NULL;
+    if (argMap.count(BULK_LOAD_DIR) > 0) {
+            w_conf.bulk_load_dir = argMap[BULK_LOAD_DIR];
+            w_conf.bulk_load = true;
+    }
+
+    /* Optional, read-only txns run at the same level as the others. */
+    w_conf.isolation = DEFAULT_ISOLATION;
+    if (argMap.count(ISOLATION) > 0)
+            w_conf.isolation = (uint32_t)atoi(argMap[ISOLATION]);
+    w_conf.read_isolation = w_conf.isolation;
+    if (argMap.count(READ_ISOLATION) > 0)
+            w_conf.read_isolation = (uint32_t)atoi(argMap[READ_ISOLATION]);
+    assert(w_conf.isolation <= ISOLATION_READ_COMMITTED &&
+           w_conf.read_isolation <= ISOLATION_READ_COMMITTED);
+  }
+
+  void ReadIndexList(char *list, MVConfig *config) {
+    char *cur, *end;
+    uint32_t n;
+
+    n = 1;
+    for (cur = list; *cur != '\0'; ++cur)
+      if (*cur == ',')
+        n += 1;
+    config->mvIndex = (uint32_t*)malloc(sizeof(uint32_t)*n);
+    config->numMVIndexes = n;
+    cur = list;
+    for (uint32_t i = 0; i < n; ++i) {
+      config->mvIndex[i] = (uint32_t)strtoul(cur, &end, 10);
+      if (end == cur || (*end != ',' && *end != '\0')) {
+        std::cerr << "Malformed --" << long_options[MV_INDEX].name << " ";
+        std::cerr << list << "\n";
+        exit(-1);
+      }
+      cur = end + 1;
+    }
   }
 
   void ReadArgs(int argc, char **argv) {
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <small_bank.h>
 #include <setup_workload.h>
+#include <bulk_load.h>
 
 /* Total space available for free lists */
 #define TOTAL_SIZE (((uint64_t)1) << 35)
@@ -40,64 +41,51 @@ static uint32_t record_sizes[2];
 // 
 
 /*
- * Insert records into the YCSB table. 
+ * Initialize tables. Worker threads perform actual txns, they are not involved 
+ * in the initialization process. Slots are indexed by key, so loader threads 
+ * can insert disjoint ranges of keys without synchronizing.
  */
-static void init_ycsb(hek_config config, hek_table *table)
+static void init_tables(hek_config config, workload_config w_conf,
+                        hek_table **tables)
 {
-        uint32_t i, record_size;
-        char *records;
-        hek_record *rec_ptr;
-        record_size = 1000 + sizeof(hek_record);
-        records = (char*)alloc_interleaved_all(record_size*config.num_records);
-        memset(records, 0x0, record_size*config.num_records);
-        for (i = 0; i < config.num_records; ++i) {
-                rec_ptr = (hek_record*)(records + i*record_size);
-                rec_ptr->next = NULL;
-                rec_ptr->begin = 0;		/* "Created" at time 0 */
-                rec_ptr->end = HEK_INF;		 
-                rec_ptr->key = i;
-                rec_ptr->size = 1000;
-                GenRandomSmallBank(rec_ptr->value, 1000);
-
-                /* Insert cannot fail */
-                table->force_insert(rec_ptr);	
-        }
-        table->finish_init();
-}
+        BulkLoadSource *source;
+        BulkLoader *loader;
+        BulkLoaderConfig loader_config;
+        uint64_t num_loaded;
+        uint32_t i;
 
-static void init_small_bank(hek_config config, hek_table **tables)
-{
-        uint32_t i, j, record_size;
-        char *records;
-        hek_record *rec_ptr;
-        record_size = sizeof(SmallBankRecord) + sizeof(hek_record);
-        for (j = 0; j < 2; ++j) {
-                records = (char*)alloc_interleaved_all(record_size*config.num_records);
-                memset(records, 0x0, record_size*config.num_records);
-                for (i = 0; i < config.num_records; ++i) {
-                        rec_ptr = (hek_record*)(records + i*record_size);
+        source = create_load_source(w_conf);
+        loader = NULL;
+        loader_config = {
+                0,
+                config.num_threads,
+                source,
+                nullptr,
+                [&](uint32_t thread, uint32_t table_id, uint64_t key,
+                    const char *value, uint64_t size) {
+                        hek_record *rec_ptr;
+                        rec_ptr = (hek_record*)
+                                loader->Alloc(thread, sizeof(hek_record) + 
+                                              record_sizes[table_id]);
                         rec_ptr->next = NULL;
-                        rec_ptr->begin = 0;
+                        rec_ptr->begin = 0;	/* "Created" at time 0 */
                         rec_ptr->end = HEK_INF;
-                        rec_ptr->key = i;
-                        rec_ptr->size = sizeof(SmallBankRecord);
-                        GenRandomSmallBank(rec_ptr->value, 8);
-                        tables[j]->force_insert(rec_ptr);
-                }
-                tables[j]->finish_init();
-        }
-}
-
-/*
- * Initialize tables. Worker threads perform actual txns, they are not involved 
- * in the initialization process.
- */
-static void init_tables(hek_config config, hek_table **tables)
-{
-        if (config.experiment < 3)
-                init_ycsb(config, tables[0]);
-        else
-                init_small_bank(config, tables);
+                        rec_ptr->key = key;
+                        rec_ptr->size = record_sizes[table_id];
+                        rec_ptr->writer = 0;
+                        BulkLoader::CopyValue(rec_ptr->value, rec_ptr->size,
+                                              value, size);
+
+                        /* Insert cannot fail */
+                        tables[table_id]->force_insert(rec_ptr);
+                },
+        };
+        loader = new BulkLoader(loader_config);
+        num_loaded = loader->Load();
+        for (i = 0; i < source->NumTables(); ++i)
+                tables[i]->finish_init();
+        delete source;
+        std::cerr << "Bulk loaded " << num_loaded << " records\n";
 }
 
 /*
@@ -199,14 +187,25 @@ static hek_worker** setup_workers(hek_config config, hek_table **tables,
         hek_worker_config worker_conf;
         int i;
         void *global_time;
+        hek_active_begin *active_begins;
 
         /* Allocate space for global counter */
         global_time = malloc(64);
         assert(global_time != NULL);
         memset(global_time, 0x0, 64);
+
+        /* Txn begin timestamps announced by workers for version GC */
+        active_begins = (hek_active_begin*)
+                alloc_mem(sizeof(hek_active_begin)*config.num_threads, 0);
+        assert(active_begins != NULL);
+        for (i = 0; i < config.num_threads; ++i)
+                active_begins[i].begin = HEK_INF;
         
         /* Common worker_conf data */
         worker_conf.global_time = (volatile uint64_t*)global_time;
+        worker_conf.ts_alloc = (hek_ts_alloc)config.timestamps;
+        worker_conf.clock_base = rdtsc();
+        worker_conf.active_begins = active_begins;
         assert(*worker_conf.global_time == 0);
         worker_conf.num_tables = num_tables(config);
         worker_conf.num_threads = config.num_threads;
@@ -654,7 +653,8 @@ static struct hek_result run_experiment(hek_config config,
 }
 
 /* Write results to an output file. */
-static void write_results(struct hek_result result, hek_config config)
+static void write_results(struct hek_result result, hek_config config,
+                          workload_config w_conf)
 {
         double elapsed_milli;
         timespec elapsed_time;
@@ -668,6 +668,9 @@ static void write_results(struct hek_result result, hek_config config)
         result_file << " threads:" << config.num_threads << " hek ";
         result_file << "records:" << config.num_records << " ";
         result_file << "read_pct:" << config.read_pct << " ";
+        result_file << "timestamps:" << config.timestamps << " ";
+        result_file << "isolation:" << w_conf.isolation << " ";
+        result_file << "read_isolation:" << w_conf.read_isolation << " ";
         if (config.experiment == 0) 
                 result_file << "10rmw" << " ";
         else if (config.experiment == 1)
@@ -697,7 +700,7 @@ void do_hekaton_experiment(hek_config config, workload_config w_conf)
         compute_record_sizes(config);
         tables = setup_tables(config);
         std::cerr << "Done setting up tables!\n";
-        init_tables(config, tables);
+        init_tables(config, w_conf, tables);
         std::cerr << "Done initializing tables!\n";
         workers = setup_workers(config, tables, &input_queues, &output_queues);
         std::cerr << "Done setting up workers!\n";
@@ -706,6 +709,6 @@ void do_hekaton_experiment(hek_config config, workload_config w_conf)
         pin_memory();        
         result = run_experiment(config, inputs, workers, input_queues,
                                 output_queues);
-        write_results(result, config);
+        write_results(result, config, w_conf);
 }
 
@@ -241,9 +241,11 @@ static struct locking_result do_measurement(locking_config conf,
                 workers[i]->WaitInit();
         }
 
-        /* Setup the database. */
-        inputs[0]->EnqueueBlocking(setup);
-        outputs[0]->DequeueBlocking();
+        /* Setup the database, unless it was bulk loaded. */
+        if (setup.batchSize > 0) {
+                inputs[0]->EnqueueBlocking(setup);
+                outputs[0]->DequeueBlocking();
+        }
         for (i = 0; i < num_tables; ++i)
                 tables[i]->SetInit();
 
@@ -291,7 +293,10 @@ void locking_experiment(locking_config conf, workload_config w_conf)
         
         inputs = setup_queues<locking_action_batch>(conf.num_threads, 1024);
         outputs = setup_queues<locking_action_batch>(conf.num_threads, 1024);
-        setup_txns = setup_db(w_conf);
+        if (w_conf.bulk_load)
+                setup_txns = {0, NULL};
+        else
+                setup_txns = setup_db(w_conf);
         experiment_txns = setup_input(conf, w_conf, EXTRA_BATCHES);
         
         if (w_conf.experiment < 3) {
@@ -313,6 +318,9 @@ void locking_experiment(locking_config conf, workload_config w_conf)
                 (int)conf.num_threads - 1,
         };
         tables = setup_hash_tables(num_tables, num_records, false);
+        if (w_conf.bulk_load)
+                bulk_load_hash_tables(tables, num_tables, w_conf, false,
+                                      conf.num_threads);
         lock_manager = new LockManager(mgr_config);        
         workers = setup_workers(inputs, outputs, lock_manager,
                                 conf.num_threads, 50, tables, num_tables);
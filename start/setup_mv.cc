@@ -4,6 +4,9 @@
 #include <concurrent_queue.h>
 #include <preprocessor.h>
 #include <executor.h>
+#include <command_log.h>
+#include <mv_checkpoint.h>
+#include <bulk_load.h>
 #include <iostream>
 #include <fstream>
 #include <setup_workload.h>
@@ -15,7 +18,12 @@
 
 #define MV_DRY_RUNS 5
 
-static uint64_t dbSize = ((uint64_t)1<<36);
+/* Epochs the command logger commits with a single fsync at most. */
+#define MV_LOG_GROUP 16
+
+/* Epochs worth of writes an executor's payload pools are sized to absorb. */
+#define MV_PAYLOAD_EPOCHS 4
+
 extern uint32_t GLOBAL_RECORD_SIZE;
 
 Table** mv_tables;
@@ -74,6 +82,8 @@ static MVSchedulerConfig SetupSched(int cpuNumber,
                                     size_t alloc, 
                                     uint32_t numTables,
                                     size_t *partSizes, 
+                                    MVIndexType *indexTypes,
+                                    uint32_t prefetchWindow,
                                     uint32_t numRecycles,
                                     SimpleQueue<ActionBatch> *inputQueue,
                                     uint32_t numOutputs,
@@ -138,6 +148,8 @@ static MVSchedulerConfig SetupSched(int cpuNumber,
                 alloc,
                 numTables,
                 partSizes,
+                indexTypes,
+                prefetchWindow,
                 numOutputs,
                 subCount,
                 numRecycles,
@@ -224,6 +236,7 @@ static ExecutorConfig SetupExec(uint32_t cpuNumber, uint32_t threadId,
                                 uint32_t numWorkerThreads, 
                                 volatile uint32_t *epoch, 
                                 volatile uint32_t *GClowWaterMarkPtr,
+                                volatile uint32_t *checkpointPtr,
                                 uint64_t *recordSizes, 
                                 uint64_t *allocSizes,
                                 SimpleQueue<ActionBatch> *inputQueue, 
@@ -248,12 +261,13 @@ static ExecutorConfig SetupExec(uint32_t cpuNumber, uint32_t threadId,
     (int)cpuNumber,
     epoch,
     GClowWaterMarkPtr,
+    checkpointPtr,
     inputQueue,
     outputQueue,
-    1,
+    numTables,
     recordSizes,
     allocSizes,
-    1,
+    queuesPerTable,
     gcQueues,
     gcConfig,
   };
@@ -267,22 +281,20 @@ static Executor** SetupExecutors(uint32_t cpuStart,
                                  SimpleQueue<ActionBatch> *inputQueue,
                                  SimpleQueue<ActionBatch> *outputQueue,
                                  uint32_t queuesPerCCThread,
-                                 SimpleQueue<MVRecordList> ***ccQueues) {  
+                                 SimpleQueue<MVRecordList> ***ccQueues,
+                                 uint32_t numTables,
+                                 uint64_t *recordSizes,
+                                 uint64_t *allocatorSizes,
+                                 volatile uint32_t *checkpointPtr,
+                                 volatile uint32_t **lowWaterMark_OUT) {  
   assert(queuesPerCCThread == numWorkers);
   assert(queuesPerTable == numWorkers);
 
-  uint64_t threadDbSz = dbSize / numWorkers;
   Executor **execs = (Executor**)malloc(sizeof(Executor*)*numWorkers);
   volatile uint32_t *epochArray = 
     (volatile uint32_t*)malloc(sizeof(uint32_t)*(numWorkers+1));  
   memset((void*)epochArray, 0x0, sizeof(uint32_t)*(numWorkers+1));
 
-  uint32_t numTables = 1;
-
-  uint64_t *sizeData = (uint64_t*)malloc(sizeof(uint32_t)*2);
-  sizeData[0] = GLOBAL_RECORD_SIZE;
-  sizeData[1] = threadDbSz/recordSize;
-
   // First pass, create configs. Each config contains a reference to each 
   // worker's local GC queue.
   ExecutorConfig configs[numWorkers];  
@@ -293,12 +305,13 @@ static Executor** SetupExecutors(uint32_t cpuStart,
           //    }
     configs[i] = SetupExec(cpuStart+i, i, numWorkers, &epochArray[i], 
                            &epochArray[numWorkers],
-                           &sizeData[0],
-                           &sizeData[1],
+                           checkpointPtr,
+                           recordSizes,
+                           allocatorSizes,
                            &inputQueue[i],
                            curOutput,
                            numCCThreads,
-                           1,
+                           numTables,
                            queuesPerTable);
   }
   
@@ -314,13 +327,14 @@ static Executor** SetupExecutors(uint32_t cpuStart,
     // Connect to every workers gc queue
     for (uint32_t j = 0; j < numWorkers; ++j) {
       for (uint32_t k = 0; k < numTables; ++k) {
-        configs[i].garbageConfig.workerChannels[j] = 
+        configs[i].garbageConfig.workerChannels[j*numTables+k] = 
           &configs[j].recycleQueues[k*queuesPerTable+(i%queuesPerTable)];
+        assert(configs[i].garbageConfig.workerChannels[j*numTables+k] != NULL);
       }
-      assert(configs[i].garbageConfig.workerChannels[j] != NULL);
-      execs[i] = new ((int)(cpuStart+i)) Executor(configs[i]);
     }
+    execs[i] = new ((int)(cpuStart+i)) Executor(configs[i]);
   }
+  *lowWaterMark_OUT = &epochArray[numWorkers];
   return execs;
 }
 
@@ -352,6 +366,8 @@ static MVScheduler** SetupSchedulers(int numProcs,
                                      size_t allocatorSize, 
                                      uint32_t numTables,
                                      size_t tableSize, 
+                                     MVIndexType *tblIndexTypes,
+                                     uint32_t prefetchWindow,
                                      SimpleQueue<MVRecordList> ***gcRefs_OUT,
                                      int worker_start, int worker_end) {  
         
@@ -376,6 +392,8 @@ static MVScheduler** SetupSchedulers(int numProcs,
                                                     allocatorSize,
                                                     numTables,
                                                     tblPartitionSizes, 
+                                                    tblIndexTypes,
+                                                    prefetchWindow,
                                                     numOutputs,
                                                     leaderInputQueue,
                                                     numOutputs,
@@ -396,6 +414,8 @@ static MVScheduler** SetupSchedulers(int numProcs,
       MVSchedulerConfig config = SetupSched(i, i, numProcs, allocatorSize, 
                                             numTables,
                                             tblPartitionSizes, 
+                                            tblIndexTypes,
+                                            prefetchWindow,
                                             numOutputs,
                                             inputQueue, 
                                             1,
@@ -412,6 +432,8 @@ static MVScheduler** SetupSchedulers(int numProcs,
       MVSchedulerConfig subConfig = SetupSched(i, i, numProcs, allocatorSize, 
                                                numTables,
                                                tblPartitionSizes, 
+                                               tblIndexTypes,
+                                               prefetchWindow,
                                                numOutputs,
                                                inputQueue, 
                                                1,
@@ -616,6 +638,28 @@ static void write_results(MVConfig config, timespec elapsed_time)
         
 }
 
+/* 
+ * Report how much garbage the executors have reclaimed. Executors keep running 
+ * after the experiment, so the counts are a lower bound. 
+ */
+static void write_gc_stats(MVConfig config, Executor **exec_threads)
+{
+        GarbageBinStats stats, total;
+        uint32_t i;
+
+        memset(&total, 0x0, sizeof(GarbageBinStats));
+        for (i = 0; i < config.numWorkerThreads; ++i) {
+                stats = exec_threads[i]->GetGCStats();
+                total.collectedVersions += stats.collectedVersions;
+                total.reclaimedVersions += stats.reclaimedVersions;
+                total.reclaimedPayloads += stats.reclaimedPayloads;
+        }
+        std::cerr << "Reclaimed versions: " << total.reclaimedVersions << "\n";
+        std::cerr << "Reclaimed payloads: " << total.reclaimedPayloads << "\n";
+        std::cerr << "Outstanding versions: ";
+        std::cerr << total.collectedVersions - total.reclaimedVersions << "\n";
+}
+
 static timespec run_experiment(SimpleQueue<ActionBatch> *input_queue,
                                SimpleQueue<ActionBatch> *output_queue,
                                std::vector<ActionBatch> inputs,
@@ -652,6 +696,76 @@ static timespec run_experiment(SimpleQueue<ActionBatch> *input_queue,
         return elapsed_time;
 }
 
+static void start_threads(MVConfig config, MVScheduler **sched_threads,
+                          Executor **exec_threads)
+{
+        uint32_t i;
+        for (i = 0; i < config.numCCThreads; ++i) {
+                sched_threads[i]->Run();        
+                sched_threads[i]->WaitInit();
+        }
+        for (i = 0; i < config.numWorkerThreads; ++i) {
+                exec_threads[i]->Run();
+                exec_threads[i]->WaitInit();                
+        }
+}
+
+/* 
+ * Install records as versions of epoch 1, in place of the batch which loads 
+ * the database. Loader threads run on the schedulers' cpus, and each only 
+ * writes to the partitions of the scheduler on its cpu. Payloads are handed 
+ * to the executors' pools evenly once garbage collected.
+ */
+static void bulk_load_database(MVConfig config, BulkLoadSource *source,
+                               MVScheduler **sched_threads)
+{
+        BulkLoader *loader;
+        BulkLoaderConfig loader_config;
+        uint64_t num_loaded;
+
+        loader = NULL;
+        loader_config = {
+                0,
+                config.numCCThreads,
+                source,
+                [&](uint32_t table_id, uint64_t key) {
+                        CompositeKey pkey(false, table_id, key);
+                        return (uint32_t)(CompositeKey::HashKey(&pkey) % 
+                                          MVScheduler::NUM_CC_THREADS);
+                },
+                [&](uint32_t thread, uint32_t table_id, uint64_t key,
+                    const char *value, uint64_t size) {
+                        CompositeKey pkey(false, table_id, key);
+                        Record *payload;
+                        sched_threads[thread]->GetPartition(table_id)->
+                                WriteNewVersion(pkey, NULL, 
+                                                CREATE_MV_TIMESTAMP(1, 0));
+                        payload = (Record*)loader->Alloc(thread, 
+                                                         sizeof(Record) + 
+                                                         recordSize);
+                        payload->next = NULL;
+                        BulkLoader::CopyValue(payload->value, recordSize, 
+                                              value, size);
+                        pkey.value->value = payload;
+                        pkey.value->writingThread = 
+                                key % config.numWorkerThreads;
+                },
+        };
+        loader = new BulkLoader(loader_config);
+        num_loaded = loader->Load();
+        std::cerr << "Bulk loaded " << num_loaded << " records\n";
+}
+
+/* Returns the checkpoint's epoch. */
+static uint32_t load_checkpoint(MVConfig config, MVScheduler **sched_threads)
+{
+        FileLoadSource source(config.checkpointLoad);
+
+        bulk_load_database(config, &source, sched_threads);
+        std::cerr << "Loaded checkpoint " << source.Epoch() << "\n";
+        return source.Epoch();
+}
+
 static void init_database(MVConfig config,
                           workload_config w_conf,
                           SimpleQueue<ActionBatch> *input_queue,
@@ -662,18 +776,24 @@ static void init_database(MVConfig config,
 {
         uint32_t i;
         ActionBatch init_batch;
+        BulkLoadSource *source;
         int pin_success;
         pin_success = pin_thread(79);
         assert(pin_success == 0);
-        init_batch = generate_db(w_conf);
-        for (i = 0; i < config.numCCThreads; ++i) {
-                sched_threads[i]->Run();        
-                sched_threads[i]->WaitInit();
-        }
-        for (i = 0; i < config.numWorkerThreads; ++i) {
-                exec_threads[i]->Run();
-                exec_threads[i]->WaitInit();                
+
+        /* An empty batch keeps the executors' epochs in step. */
+        if (config.checkpointLoad != NULL) {
+                load_checkpoint(config, sched_threads);
+                init_batch = {NULL, 0};
+        } else if (w_conf.bulk_load) {
+                source = create_load_source(w_conf);
+                bulk_load_database(config, source, sched_threads);
+                delete source;
+                init_batch = {NULL, 0};
+        } else {
+                init_batch = generate_db(w_conf);
         }
+        start_threads(config, sched_threads, exec_threads);
 
         input_queue->EnqueueBlocking(init_batch);
         for (i = 0; i < config.numWorkerThreads; ++i) 
@@ -689,7 +809,8 @@ static MVScheduler** setup_scheduler_threads(MVConfig config,
                                              SimpleQueue<MVRecordList> ***gc_queues)
 {
         uint64_t stickies_per_thread;
-        uint32_t num_tables;
+        uint32_t num_tables, i;
+        MVIndexType *index_types;
         MVScheduler **schedulers;
         int worker_start, worker_end;
         
@@ -704,10 +825,37 @@ static MVScheduler** setup_scheduler_threads(MVConfig config,
         } else {
                 assert(false);
         }
+
+        /* 
+         * Table i uses the i-th index picked on the command line, and tables 
+         * past the end of the list the last one.
+         */
+        if (config.numMVIndexes > num_tables) {
+                std::cerr << "Got " << config.numMVIndexes << " indexes for ";
+                std::cerr << num_tables << " tables\n";
+                exit(-1);
+        }
+        index_types = (MVIndexType*)malloc(sizeof(MVIndexType)*num_tables);
+        for (i = 0; i < num_tables; ++i) {
+                if (config.numMVIndexes == 0)
+                        index_types[i] = MV_CHAINED_INDEX;
+                else if (i < config.numMVIndexes)
+                        index_types[i] = (MVIndexType)config.mvIndex[i];
+                else
+                        index_types[i] = 
+                                (MVIndexType)config.mvIndex[config.numMVIndexes-1];
+                if (index_types[i] != MV_CHAINED_INDEX &&
+                    index_types[i] != MV_BUCKETED_INDEX) {
+                        std::cerr << "Unknown index type " << index_types[i];
+                        std::cerr << " for table " << i << "\n";
+                        exit(-1);
+                }
+        }
         schedulers = SetupSchedulers(config.numCCThreads, sched_input,
                                      sched_output, config.numWorkerThreads+1,
                                      stickies_per_thread, num_tables,
-                                     config.numRecords, gc_queues,
+                                     config.numRecords, index_types,
+                                     config.prefetchWindow, gc_queues,
                                      worker_start,
                                      worker_end);
         assert(schedulers != NULL);
@@ -722,21 +870,216 @@ static MVScheduler** setup_scheduler_threads(MVConfig config,
 static Executor** setup_executors(MVConfig config,
                                   SimpleQueue<ActionBatch> *sched_outputs,
                                   SimpleQueue<ActionBatch> *output_queue,
-                                  SimpleQueue<MVRecordList> ***gc_queues)
+                                  SimpleQueue<MVRecordList> ***gc_queues,
+                                  volatile uint32_t *checkpoint_ptr,
+                                  volatile uint32_t **low_water_mark)
 {
-        uint32_t start_cpu, queues_per_table, queues_per_cc_thread;
+        uint32_t start_cpu, queues_per_table, queues_per_cc_thread, num_tables;
+        uint32_t i;
+        uint64_t *record_sizes, *payloads_per_thread;
         Executor **execs;
         start_cpu = config.numCCThreads;
         queues_per_table = config.numWorkerThreads;
         queues_per_cc_thread = config.numWorkerThreads;
+        if (config.experiment < 3) 
+                num_tables = 1;
+        else if (config.experiment < 5) 
+                num_tables = 2;
+        else 
+                assert(false);
+
+        /* 
+         * Executors own the payloads of the versions they write. Each needs 
+         * room for its share of the database, plus the versions written over 
+         * the few epochs it takes for garbage to make its way back.
+         */
+        record_sizes = (uint64_t*)malloc(sizeof(uint64_t)*num_tables);
+        payloads_per_thread = (uint64_t*)malloc(sizeof(uint64_t)*num_tables);
+        for (i = 0; i < num_tables; ++i) {
+                record_sizes[i] = recordSize;
+                payloads_per_thread[i] = 
+                        2*(config.numRecords/config.numWorkerThreads + 1000) + 
+                        (uint64_t)MV_PAYLOAD_EPOCHS*config.epochSize*
+                        config.txnSize/config.numWorkerThreads;
+        }
         execs = SetupExecutors(start_cpu, config.numWorkerThreads,
                                config.numCCThreads, queues_per_table,
                                sched_outputs, output_queue,
-                               queues_per_cc_thread, gc_queues);
+                               queues_per_cc_thread, gc_queues, num_tables,
+                               record_sizes, payloads_per_thread,
+                               checkpoint_ptr, low_water_mark);
         std::cerr << "Done setting up executors!\n";
         return execs;
 }
 
+/* 
+ * The command logger runs on the cpu after the executors and sits between 
+ * the input and the schedulers. Returns its input queue.
+ */
+static SimpleQueue<ActionBatch>* setup_command_logger(MVConfig config,
+                                                      SimpleQueue<ActionBatch> *sched_input)
+{
+        MVCommandLoggerConfig log_config;
+        MVCommandLogger *logger;
+        SimpleQueue<ActionBatch> *log_input;
+        char *queue_data;
+        int cpu;
+
+        cpu = (int)(config.numCCThreads + config.numWorkerThreads);
+        queue_data = (char*)alloc_mem(CACHE_LINE*INPUT_SIZE, cpu);
+        assert(queue_data != NULL);
+        log_input = new SimpleQueue<ActionBatch>(queue_data, INPUT_SIZE);
+        log_config = {
+                cpu,
+                config.commandLog,
+                MV_LOG_GROUP,
+                log_input,
+                sched_input,
+        };
+        logger = new(cpu) MVCommandLogger(log_config);
+        logger->Run();
+        logger->WaitInit();
+        std::cerr << "Done setting up the command logger!\n";
+        return log_input;
+}
+
+/* 
+ * The checkpointer runs on the cpu after the command logger, and reads the 
+ * schedulers' partitions. 
+ */
+static void setup_checkpointer(MVConfig config, MVScheduler **sched_threads,
+                               volatile uint32_t *checkpoint_ptr,
+                               volatile uint32_t *low_water_mark)
+{
+        MVCheckpointerConfig ckpt_config;
+        MVCheckpointer *checkpointer;
+        MVTablePartition **partitions;
+        uint64_t *record_sizes;
+        uint32_t num_tables, i, j;
+        int cpu;
+
+        cpu = (int)(config.numCCThreads + config.numWorkerThreads + 1);
+        if (config.experiment < 3) 
+                num_tables = 1;
+        else if (config.experiment < 5) 
+                num_tables = 2;
+        else 
+                assert(false);
+        record_sizes = (uint64_t*)malloc(sizeof(uint64_t)*num_tables);
+        partitions = (MVTablePartition**)malloc(sizeof(MVTablePartition*)*
+                                                num_tables*config.numCCThreads);
+        for (i = 0; i < num_tables; ++i) {
+                record_sizes[i] = recordSize;
+                for (j = 0; j < config.numCCThreads; ++j)
+                        partitions[i*config.numCCThreads + j] = 
+                                sched_threads[j]->GetPartition(i);
+        }
+        ckpt_config = {
+                cpu,
+                config.checkpointDir,
+                config.checkpointInterval,
+                num_tables,
+                record_sizes,
+                config.numCCThreads,
+                partitions,
+                checkpoint_ptr,
+                low_water_mark,
+        };
+        checkpointer = new(cpu) MVCheckpointer(ckpt_config);
+        checkpointer->Run();
+        checkpointer->WaitInit();
+        std::cerr << "Done setting up the checkpointer!\n";
+}
+
+/* 
+ * Re-executes the command log, including the batch which loaded the 
+ * database, epoch by epoch in the original order. When starting from a 
+ * checkpoint, the epochs the checkpoint includes are skipped. A bulk loaded 
+ * database is bulk loaded again, the empty batch which stood in for the 
+ * loaders is logged without an epoch and skipped.
+ */
+static void replay_command_log(MVConfig config,
+                               workload_config w_conf,
+                               SimpleQueue<ActionBatch> *input_queue,
+                               SimpleQueue<ActionBatch> *output_queue,
+                               MVScheduler **sched_threads,
+                               Executor **exec_threads)
+{
+        std::vector<ActionBatch> batches;
+        BulkLoadSource *source;
+        uint64_t num_txns;
+        uint32_t i, j, outstanding, ckpt_epoch;
+        timespec start_time, end_time, elapsed_time;
+        int pin_success;
+
+        pin_success = pin_thread(79);
+        assert(pin_success == 0);
+
+        /* 
+         * Batches are numbered by their place in the pipeline, the checkpoint 
+         * (or an empty batch) stands in for epoch 1. 
+         */
+        ckpt_epoch = 0;
+        if (config.checkpointLoad != NULL) {
+                ckpt_epoch = load_checkpoint(config, sched_threads);
+                batches.push_back({NULL, 0});
+        } else if (w_conf.bulk_load) {
+                source = create_load_source(w_conf);
+                bulk_load_database(config, source, sched_threads);
+                delete source;
+                batches.push_back({NULL, 0});
+        }
+        num_txns = 0;
+        CommandLog::Read(config.commandLog,
+                         [&](uint64_t batch_id, std::vector<logged_txn> &txns) {
+                ActionBatch batch;
+                uint32_t k, epoch;
+                if (batch_id <= ckpt_epoch)
+                        return;
+                epoch = batches.size() + 1;
+                num_txns += txns.size();
+                batch.numActions = txns.size();
+                batch.actionBuf = 
+                        (mv_action**)malloc(sizeof(mv_action*)*txns.size());
+                assert(batch.actionBuf != NULL);
+                for (k = 0; k < txns.size(); ++k) {
+                        batch.actionBuf[k] = 
+                                generate_mv_action(CommandLog::CreateTxn(txns[k]));
+                        batch.actionBuf[k]->__version = 
+                                CREATE_MV_TIMESTAMP(epoch, k);
+                }
+                batches.push_back(batch);
+        });
+        start_threads(config, sched_threads, exec_threads);
+
+        barrier();
+        clock_gettime(CLOCK_REALTIME, &start_time);
+        barrier();
+
+        /* Don't let more batches in than the output queues hold. */
+        outstanding = 0;
+        for (i = 0; i < batches.size(); ++i) {
+                input_queue->EnqueueBlocking(batches[i]);
+                outstanding += 1;
+                if (outstanding == INPUT_SIZE/2) {
+                        for (j = 0; j < config.numWorkerThreads; ++j)
+                                (&output_queue[j])->DequeueBlocking();
+                        outstanding -= 1;
+                }
+        }
+        for (; outstanding > 0; --outstanding) 
+                for (j = 0; j < config.numWorkerThreads; ++j)
+                        (&output_queue[j])->DequeueBlocking();
+        barrier();
+        clock_gettime(CLOCK_REALTIME, &end_time);
+        barrier();
+        elapsed_time = diff_time(end_time, start_time);
+        std::cerr << "Replayed txns: " << num_txns << "\n";
+        std::cerr << "Replayed epochs: " << batches.size() << "\n";
+        std::cerr << "Replay time: " << 1000.0*elapsed_time.tv_sec + 
+                elapsed_time.tv_nsec/1000000.0 << "\n";
+}
+
 void do_mv_experiment(MVConfig mv_config, workload_config w_config)
 {
         MVScheduler **schedThreads;
@@ -744,20 +1087,11 @@ void do_mv_experiment(MVConfig mv_config, workload_config w_config)
         SimpleQueue<ActionBatch> *schedInputQueue;
         SimpleQueue<ActionBatch> *schedOutputQueues;
         SimpleQueue<MVRecordList> **schedGCQueues[mv_config.numCCThreads];
-        SimpleQueue<ActionBatch> *outputQueue;
+        SimpleQueue<ActionBatch> *outputQueue, *inputQueue;
         std::vector<ActionBatch> input_placeholder;
         timespec elapsed_time;
+        volatile uint32_t *checkpointPtr, *lowWaterMark;
 
-        /* 
-         * XXX Need this for copying old versions of records if a txn performs 
-         * an RMW. Ideally, we need to separate record allocation from version 
-         * allocation to make it work properly. "Engineering effort". See 
-         * src/executor.cc.
-         */
-        if (w_config.experiment < 3)
-                GLOBAL_RECORD_SIZE = 1000;
-        else
-                GLOBAL_RECORD_SIZE = 8;
         MVScheduler::NUM_CC_THREADS = (uint32_t)mv_config.numCCThreads;
         NUM_CC_THREADS = (uint32_t)mv_config.numCCThreads;
         assert(mv_config.distribution < 2);
@@ -767,15 +1101,34 @@ void do_mv_experiment(MVConfig mv_config, workload_config w_config)
         schedThreads = setup_scheduler_threads(mv_config, &schedInputQueue,
                                                &schedOutputQueues,
                                                schedGCQueues);
-        mv_setup_input_array(&input_placeholder, mv_config, w_config);
+        checkpointPtr = NULL;
+        if (mv_config.checkpointDir != NULL) {
+                checkpointPtr = (volatile uint32_t*)alloc_mem(CACHE_LINE, 0);
+                assert(checkpointPtr != NULL);
+                *checkpointPtr = MV_CKPT_IDLE;
+        }
         execThreads = setup_executors(mv_config, schedOutputQueues, outputQueue,
-                                      schedGCQueues);
-        init_database(mv_config, w_config, schedInputQueue, outputQueue,
+                                      schedGCQueues, checkpointPtr, 
+                                      &lowWaterMark);
+        if (mv_config.checkpointDir != NULL)
+                setup_checkpointer(mv_config, schedThreads, checkpointPtr,
+                                   lowWaterMark);
+        if (mv_config.replay) {
+                replay_command_log(mv_config, w_config, schedInputQueue,
+                                   outputQueue, schedThreads, execThreads);
+                return;
+        }
+        mv_setup_input_array(&input_placeholder, mv_config, w_config);
+        inputQueue = schedInputQueue;
+        if (mv_config.commandLog != NULL)
+                inputQueue = setup_command_logger(mv_config, schedInputQueue);
+        init_database(mv_config, w_config, inputQueue, outputQueue,
                       schedThreads, execThreads);
         pin_memory();
-        elapsed_time = run_experiment(schedInputQueue,  //&schedOutputQueues[config.numWorkerThreads],
+        elapsed_time = run_experiment(inputQueue,  //&schedOutputQueues[config.numWorkerThreads],
                                       outputQueue,
                                       input_placeholder,// 1);
                                       mv_config.numWorkerThreads);
         write_results(mv_config, elapsed_time);
+        write_gc_stats(mv_config, execThreads);
 }
@@ -5,37 +5,45 @@
 #include <small_bank.h>
 #include <fstream>
 #include <setup_workload.h>
+#include <bulk_load.h>
 #include <unistd.h>
 #include <common_constants.h>
 
 extern uint32_t GLOBAL_RECORD_SIZE;
 
 
-Table** setup_occ_lock_tables(int start_cpu, int end_cpu, uint32_t table_sz)
+/* 
+ * Read committed txns lock their writes in a table of their own, one for each 
+ * table in the database. Any txn may run at read committed, so the tables are 
+ * always created.
+ */
+Table** setup_occ_lock_tables(int start_cpu, int end_cpu, uint32_t table_sz,
+                              uint32_t num_tables)
 {
-        assert(READ_COMMITTED);
         uint64_t val;
-        uint32_t i;
+        uint32_t i, j;
         TableConfig conf;
         Table **ret;
 
-        /* First create a table */
-        conf = {
-                0,
-                2*table_sz,
-                start_cpu,
-                end_cpu,
-                2*table_sz,
-                sizeof(uint64_t),
-                sizeof(uint64_t),
-        };
-        ret = (Table**)malloc(sizeof(Table*));
-        ret[0] = new (0) Table(conf);
+        ret = (Table**)malloc(sizeof(Table*)*num_tables);
+        for (j = 0; j < num_tables; ++j) {
+                /* First create a table */
+                conf = {
+                        j,
+                        2*table_sz,
+                        start_cpu,
+                        end_cpu,
+                        2*table_sz,
+                        sizeof(uint64_t),
+                        sizeof(uint64_t),
+                };
+                ret[j] = new (0) Table(conf);
         
-        /* Initialize the table */
-        val = 0;
-        for (i = 0; i < table_sz; ++i) 
-                ret[0]->Put(i, &val);
+                /* Initialize the table */
+                val = 0;
+                for (i = 0; i < table_sz; ++i) 
+                        ret[j]->Put(i, &val);
+        }
         return ret;
 }
 
@@ -138,7 +146,9 @@ OCCWorker** setup_occ_workers(SimpleQueue<OCCActionBatch> **inputQueue,
                               SimpleQueue<OCCActionBatch> **outputQueue,
                               Table **tables, int numThreads,
                               uint64_t epoch_threshold, uint32_t numTables, 
-                              uint32_t num_records)
+                              uint32_t num_records, OCCLog *log,
+                              uint32_t first_epoch, bool continuous,
+                              uint32_t window)
 {
         uint32_t recordSizes[2];
         OCCWorker **workers;
@@ -146,9 +156,19 @@ OCCWorker** setup_occ_workers(SimpleQueue<OCCActionBatch> **inputQueue,
         int i;
         bool is_leader;
         Table **tables_copy, **lock_tables, **lock_tables_copy;
+        OCCLogBuffer *log_buffer;
 
         struct OCCWorkerConfig worker_config;
         struct RecordBuffersConfig buf_config;
+        OCCRetryConfig retry_config;
+
+        if (window == 0)
+                window = OCC_RETRY_WINDOW;
+        retry_config = {
+                window,
+                OCC_RETRY_BASE_DELAY,
+                OCC_RETRY_MAX_DELAY,
+        };
         recordSizes[0] = GLOBAL_RECORD_SIZE;
         recordSizes[1] = GLOBAL_RECORD_SIZE;
         workers = (OCCWorker**)malloc(sizeof(OCCWorker*)*numThreads);
@@ -156,29 +176,30 @@ OCCWorker** setup_occ_workers(SimpleQueue<OCCActionBatch> **inputQueue,
         epoch_ptr = (volatile uint32_t*)alloc_mem(sizeof(uint32_t), 0);
         assert(epoch_ptr != NULL);
         barrier();
-        *epoch_ptr = 0;
+        *epoch_ptr = first_epoch;
         barrier();
 
-        if (READ_COMMITTED)
-                lock_tables = setup_occ_lock_tables(0, numThreads, num_records);
-        else
-                lock_tables = NULL;
-        lock_tables_copy = NULL;
+        lock_tables = setup_occ_lock_tables(0, numThreads, num_records,
+                                            numTables);
 
         /* Copy tables */
         for (i = 0; i < numThreads; ++i) {
                 tables_copy = (Table**)alloc_mem(sizeof(Table*)*numTables, i);
                 memcpy(tables_copy, tables, sizeof(Table*)*numTables);
                 
-                if (READ_COMMITTED) {
-                        lock_tables_copy = (Table**)alloc_mem(sizeof(Table*), i);
-                        memcpy(lock_tables_copy, lock_tables, sizeof(Table*));
-                }
+                lock_tables_copy = (Table**)alloc_mem(sizeof(Table*)*numTables,
+                                                      i);
+                memcpy(lock_tables_copy, lock_tables, sizeof(Table*)*numTables);
                 //                for (i = 0; i < numTables; ++i) {
                 //                        tables_copy[i] = Table::copy_table(tables[i], i);
                 //                }
 
                 is_leader = (i == 0);
+                /* Worker 0 only advances the epoch. */
+                if (log != NULL && i > 0)
+                        log_buffer = log->GetBuffer(i-1);
+                else
+                        log_buffer = NULL;
                 worker_config = {
                         inputQueue[i],
                         outputQueue[i],
@@ -192,6 +213,9 @@ OCCWorker** setup_occ_workers(SimpleQueue<OCCActionBatch> **inputQueue,
                         OCC_LOG_SIZE,
                         false,
                         numTables,
+                        log_buffer,
+                        continuous,
+                        retry_config,
                 };
                 buf_config = {
                         numTables,
@@ -228,6 +252,57 @@ Table** setup_hash_tables(uint32_t num_tables, uint32_t *num_records, bool occ)
         return tables;
 }
 
+/* 
+ * Fill the tables without loader transactions. Each loader thread owns a range 
+ * of every table's buckets. OCC records start with a TID of 0.
+ */
+void bulk_load_hash_tables(Table **tables, uint32_t num_tables,
+                           workload_config conf, bool occ,
+                           uint32_t num_threads)
+{
+        BulkLoadSource *source;
+        BulkLoader *loader;
+        BulkLoaderConfig loader_config;
+        uint64_t value_offset, num_loaded;
+
+        source = create_load_source(conf);
+        assert(source->NumTables() == num_tables);
+        value_offset = 0;
+        if (occ)
+                value_offset = sizeof(uint64_t);
+        loader = NULL;
+        loader_config = {
+                0,
+                num_threads,
+                source,
+                [&](uint32_t table_id, uint64_t key) {
+                        return (uint32_t)(tables[table_id]->BucketOf(key)*
+                                          num_threads/
+                                          tables[table_id]->NumBuckets());
+                },
+                [&](uint32_t thread, uint32_t table_id, uint64_t key,
+                    const char *value, uint64_t size) {
+                        TableRecord *rec;
+                        uint64_t value_sz;
+                        value_sz = tables[table_id]->RecordSize();
+                        rec = (TableRecord*)
+                                loader->Alloc(thread,
+                                              sizeof(TableRecord) + value_sz);
+                        rec->key = key;
+                        if (occ)
+                                *RECORD_TID_PTR(rec->value) = 0;
+                        BulkLoader::CopyValue(&rec->value[value_offset],
+                                              value_sz - value_offset, value,
+                                              size);
+                        tables[table_id]->Insert(rec);
+                },
+        };
+        loader = new BulkLoader(loader_config);
+        num_loaded = loader->Load();
+        delete source;
+        std::cerr << "Bulk loaded " << num_loaded << " records\n";
+}
+
 static OCCActionBatch setup_db(workload_config conf)
 {
         txn **loader_txns;
@@ -260,6 +335,9 @@ void write_occ_output(struct occ_result result, OCCConfig config,
         result_file << " threads:" << config.numThreads << " occ ";
         result_file << "records:" << config.numRecords << " ";
         result_file << "read_pct:" << config.read_pct << " ";
+        result_file << "continuous:" << config.continuous << " ";
+        result_file << "isolation:" << w_conf.isolation << " ";
+        result_file << "read_isolation:" << w_conf.read_isolation << " ";
 
         if (config.experiment == 2)
                 result_file << "hot_position:" << w_conf.hot_position << " ";
@@ -300,6 +378,20 @@ uint64_t get_completed_count(OCCWorker **workers, uint32_t num_workers,
         return total_completed;
 }
 
+/* 
+ * Continuously running workers hand back every batch, so the whole run is 
+ * timed. 
+ */
+static void wait_for_batches(SimpleQueue<OCCActionBatch> **output_queues,
+                             uint32_t num_workers, uint32_t num_batches)
+{
+        uint32_t i, j;
+
+        for (i = 1; i < num_workers; ++i)
+                for (j = 0; j < num_batches; ++j)
+                        output_queues[i]->DequeueBlocking();
+}
+
 uint64_t wait_to_completion(__attribute__((unused)) SimpleQueue<OCCActionBatch> **output_queues,
                             uint32_t num_workers, OCCWorker **workers)
 {        
@@ -323,9 +415,12 @@ void populate_tables(SimpleQueue<OCCActionBatch> *input_queue,
 {
         uint32_t i;
         
-        input_queue->EnqueueBlocking(input);
-        barrier();
-        output_queue->DequeueBlocking();
+        /* Bulk loaded tables come without loader transactions. */
+        if (input.batchSize > 0) {
+                input_queue->EnqueueBlocking(input);
+                barrier();
+                output_queue->DequeueBlocking();
+        }
         for (i = 0; i < num_tables; ++i)
                 tables[i]->SetInit();
         
@@ -356,6 +451,7 @@ struct occ_result do_measurement(SimpleQueue<OCCActionBatch> **inputQueues,
 {
         timespec start_time, end_time;
         uint32_t i, j;
+        uint64_t dry_run_txns;
         struct occ_result result;
                 std::cerr << "Num batches " << num_batches << "\n";
         for (i = 0; i < config.numThreads; ++i) {
@@ -368,6 +464,11 @@ struct occ_result do_measurement(SimpleQueue<OCCActionBatch> **inputQueues,
         dry_run(inputQueues, outputQueues, inputBatches[0], config.numThreads);
 
         std::cerr << "Done dry run\n";
+
+        /* Continuously running workers also counted the loader txns. */
+        dry_run_txns = 0;
+        for (i = 1; i < config.numThreads; ++i)
+                dry_run_txns += workers[i]->NumCompleted();
         barrier();
         clock_gettime(CLOCK_REALTIME, &start_time);
         barrier();
@@ -375,14 +476,23 @@ struct occ_result do_measurement(SimpleQueue<OCCActionBatch> **inputQueues,
                 for (j = 0; j < config.numThreads-1; ++j) 
                         inputQueues[j+1]->EnqueueBlocking(inputBatches[i+1][j]);
         barrier();
-        result.num_txns = wait_to_completion(outputQueues, config.numThreads, 
-                                             workers);
+        if (config.continuous) {
+                wait_for_batches(outputQueues, config.numThreads, num_batches);
+                result.num_txns = 0;
+                for (i = 1; i < config.numThreads; ++i)
+                        result.num_txns += workers[i]->NumCompleted();
+                result.num_txns -= dry_run_txns;
+        } else {
+                result.num_txns = wait_to_completion(outputQueues,
+                                                     config.numThreads, 
+                                                     workers);
+                for (i = 0; i < config.numThreads-1; ++i)
+                        result.num_txns -= inputBatches[0][i].batchSize;
+        }
         barrier();
         clock_gettime(CLOCK_REALTIME, &end_time);
         barrier();
         result.time_elapsed = diff_time(end_time, start_time);
-        for (i = 0; i < config.numThreads-1; ++i)
-                result.num_txns -= inputBatches[0][i].batchSize;
         //        result.num_txns = config.numTxns;
         std::cout << "Num completed: " << result.num_txns << "\n";
         return result;
@@ -415,17 +525,24 @@ void occ_experiment(OCCConfig occ_config, workload_config w_conf)
         OCCWorker **workers;
         OCCActionBatch **inputs;
         OCCActionBatch setup_txns;
+        OCCLog *log;
+        OCCLogConfig log_config;
         
         struct occ_result result;
         uint32_t num_records[2];
-        uint32_t num_tables;
+        uint32_t num_tables, recovered_epoch;
+        uint64_t recovered;
         
 	occ_config.occ_epoch = OCC_EPOCH_SIZE;
         input_queues = setup_queues<OCCActionBatch>(occ_config.numThreads,
                                                     1024);
         output_queues = setup_queues<OCCActionBatch>(occ_config.numThreads,
                                                      1024);
-        setup_txns = setup_db(w_conf);
+        /* Recovery replays the loader txns from the log. */
+        if (w_conf.bulk_load || occ_config.recover)
+                setup_txns = {0, NULL};
+        else
+                setup_txns = setup_db(w_conf);
         if (occ_config.experiment < 3) {
                 num_tables = 1;
                 num_records[0] = occ_config.numRecords;
@@ -439,14 +556,49 @@ void occ_experiment(OCCConfig occ_config, workload_config w_conf)
                 num_tables = 0;
         }
         tables = setup_hash_tables(num_tables, num_records, true);
+        if (w_conf.bulk_load)
+                bulk_load_hash_tables(tables, num_tables, w_conf, true,
+                                      occ_config.numThreads);
+
+        /* 
+         * Recover before the log is opened, which keeps only the durable 
+         * part. Commits continue in the epoch that was durable.
+         */
+        recovered_epoch = 0;
+        if (occ_config.recover) {
+                recovered = OCCLog::Recover(occ_config.log_dir,
+                                            occ_config.num_loggers, tables,
+                                            num_tables, &recovered_epoch);
+                std::cerr << "Recovered " << recovered << " records up to ";
+                std::cerr << "epoch " << recovered_epoch << "\n";
+        }
+
+        /* Loggers run on the cpus after the workers. */
+        log = NULL;
+        if (occ_config.log_dir != NULL) {
+                log_config = {
+                        occ_config.log_dir,
+                        occ_config.numThreads - 1,
+                        occ_config.num_loggers,
+                        OCC_LOG_SIZE,
+                        16,
+                        (int)occ_config.numThreads,
+                        recovered_epoch,
+                };
+                log = new OCCLog(log_config);
+                log->Run();
+        }
         workers = setup_occ_workers(input_queues, output_queues, tables,
                                     occ_config.numThreads, occ_config.occ_epoch,
-                                    2, num_records[0]);
+                                    2, num_records[0], log, recovered_epoch,
+                                    occ_config.continuous, occ_config.window);
 
         inputs = setup_occ_input(occ_config, w_conf, 1);
         pin_memory();
         result = run_occ_workers(input_queues, output_queues, workers,
                                  inputs, 1+1, occ_config,
                                  setup_txns, tables, num_tables);
+        if (log != NULL)
+                log->Stop();
         write_occ_output(result, occ_config, w_conf);
 }
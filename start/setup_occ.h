@@ -6,6 +6,11 @@
 #define OCC_LOG_SIZE (((uint64_t)1)<<28)
 #define OCC_EPOCH_SIZE 7984000
 
+/* Contention management of continuous runs, in cycles. See occ_retry.h */
+#define OCC_RETRY_WINDOW 50
+#define OCC_RETRY_BASE_DELAY 1000
+#define OCC_RETRY_MAX_DELAY (((uint64_t)1)<<20)
+
 #include <occ_action.h>
 #include <config.h>
 #include <table.h>
@@ -33,7 +38,10 @@ OCCActionBatch* setup_occ_single_input(OCCConfig occ_config,
 OCCWorker** setup_occ_workers(SimpleQueue<OCCActionBatch> **inputQueue,
                               SimpleQueue<OCCActionBatch> **outputQueue,
                               Table **tables, int numThreads,
-                              uint64_t epoch_threshold, uint32_t numTables);
+                              uint64_t epoch_threshold, uint32_t numTables,
+                              uint32_t num_records, OCCLog *log,
+                              uint32_t first_epoch, bool continuous,
+                              uint32_t window);
 
 void validate_ycsb_occ_tables(Table *table, uint64_t num_records);
 
@@ -6,6 +6,7 @@
 #include <zipf_generator.h>
 #include <ycsb.h>
 #include <small_bank.h>
+#include <bulk_load.h>
 #include <set>
 #include <common.h>
 
@@ -291,6 +292,18 @@ uint32_t generate_input(workload_config conf, txn ***loaders)
         }
 }
 
+/* 
+ * The records bulk loading fills the tables with, in place of the loader 
+ * transactions of generate_input. 
+ */
+BulkLoadSource* create_load_source(workload_config conf)
+{
+        if (conf.bulk_load_dir != NULL)
+                return new FileLoadSource(conf.bulk_load_dir);
+        assert(conf.experiment < 5);
+        return new WorkloadLoadSource(conf.experiment >= 3, conf.num_records);
+}
+
 txn* generate_transaction(workload_config config)
 {
         txn *txn = NULL;
@@ -312,5 +325,9 @@ txn* generate_transaction(workload_config config)
                 assert(false);
         }
         assert(txn != NULL);
+        if (txn->num_writes() == 0 && txn->num_rmws() == 0)
+                txn->set_isolation((isolation_level)config.read_isolation);
+        else
+                txn->set_isolation((isolation_level)config.isolation);
         return txn;
 }
@@ -4,8 +4,10 @@
 #include <db.h>
 
 struct workload_config;
+class BulkLoadSource;
 
 txn* generate_transaction(workload_config conf);
 uint32_t generate_input(workload_config conf, txn ***loaders);
+BulkLoadSource* create_load_source(workload_config conf);
 
 #endif // SETUP_WORKLOAD_H_
@@ -22,7 +22,17 @@ static struct option long_options[] = {
   {"std_dev_excl_locks", required_argument, 0, 8},
   {"output_dir", required_argument, 0, 9},
   {"num_table_merging_shard", required_argument, 0, 10},
-  {0, no_argument, 0, 11}
+  {"record_size", required_argument, 0, 11},
+  {"num_packing_threads", required_argument, 0, 12},
+  {"wait_strategy", required_argument, 0, 13},
+  {"arrival_rate", required_argument, 0, 14},
+  {"arrival_process", required_argument, 0, 15},
+  {"batch_timeout_us", required_argument, 0, 16},
+  {"command_log", required_argument, 0, 17},
+  {"replay_command_log", required_argument, 0, 18},
+  {"dense_keys", required_argument, 0, 19},
+  {"mv_checkpoint_load", required_argument, 0, 20},
+  {0, no_argument, 0, 21}
 };
 
 class ArgParse {
@@ -39,6 +49,16 @@ private:
     std_dev_excl_locks,
     output_dir,
     num_table_merging_shard,
+    record_size,
+    num_packing_threads,
+    wait_strategy,
+    arrival_rate,
+    arrival_process,
+    batch_timeout_us,
+    command_log,
+    replay_command_log,
+    dense_keys,
+    mv_checkpoint_load,
     count
   };
 
@@ -98,6 +118,45 @@ private:
     exit(-1);
   };
 
+  // packing threads are optional and default to the scheduling thread only.
+  static uint32_t get_packing_threads_count(ArgMap m) {
+    if (m.count(static_cast<int>(OptionCode::num_packing_threads)) == 0) {
+      return 1;
+    }
+
+    return (uint32_t) strtoul(
+        m[static_cast<int>(OptionCode::num_packing_threads)], nullptr, 10);
+  };
+
+  // the batch timeout is optional. Without it batches are only cut when full.
+  static uint32_t get_batch_timeout_us(ArgMap m) {
+    if (m.count(static_cast<int>(OptionCode::batch_timeout_us)) == 0) {
+      return 0;
+    }
+
+    return (uint32_t) strtoul(
+        m[static_cast<int>(OptionCode::batch_timeout_us)], nullptr, 10);
+  };
+
+  // both are optional. The log being replayed is not logged again.
+  static std::string get_file(ArgMap m, OptionCode code) {
+    if (m.count(static_cast<int>(code)) == 0) {
+      return "";
+    }
+
+    return std::string(m[static_cast<int>(code)]);
+  };
+
+  static std::string get_command_log_file(ArgMap m) {
+    if (m.count(static_cast<int>(OptionCode::command_log)) != 0 &&
+        m.count(static_cast<int>(OptionCode::replay_command_log)) != 0) {
+      std::cerr << "arg_parse.h: Cannot log while replaying a log.\n";
+      exit(-1);
+    }
+
+    return get_file(m, OptionCode::command_log);
+  };
+
   static SchedulingSystemConfig get_sched_conf(ArgMap m) {
     check_presence(
         m, "scheduling system", 
@@ -114,11 +173,13 @@ private:
       .batch_size_act = 
         (uint32_t) strtoul(
             m[static_cast<int>(OptionCode::batch_size)], nullptr, 10),
-      .batch_length_sec = 0,
+      .batch_timeout_us = get_batch_timeout_us(m),
       .first_pin_cpu_id = 1,
       .num_table_merging_shard = 
         (uint32_t) strtoul(
             m[static_cast<int>(OptionCode::num_table_merging_shard)], nullptr, 10),
+      .packing_threads_count = get_packing_threads_count(m),
+      .command_log_file = get_command_log_file(m)
     };
 
     return conf;
@@ -135,12 +196,60 @@ private:
             m[static_cast<int>(OptionCode::num_exec_threads)], nullptr, 10),
       .first_pin_cpu_id = 
         (uint32_t) strtoul(
-            m[static_cast<int>(OptionCode::num_sched_threads)], nullptr, 10) + 1
+            m[static_cast<int>(OptionCode::num_sched_threads)], nullptr, 10) *
+          get_packing_threads_count(m) + 1
     };
 
     return conf;
   };
 
+  // the wait strategy is optional and defaults to the one chosen at build
+  // time. One of "spin", "backoff" or "park".
+  static WaitStrategyConfig get_wait_conf(ArgMap m) {
+    WaitStrategyConfig conf = WaitStrategy::get_config();
+    if (m.count(static_cast<int>(OptionCode::wait_strategy)) == 0) {
+      return conf;
+    }
+
+    std::string name(m[static_cast<int>(OptionCode::wait_strategy)]);
+    for (uint32_t s : {WAIT_SPIN, WAIT_BACKOFF, WAIT_PARK}) {
+      if (name == WaitStrategy::get_name(s)) {
+        conf.strategy = s;
+        return conf;
+      }
+    }
+
+    std::cerr << "arg_parse.h: Unknown wait strategy " << name << ".\n";
+    exit(-1);
+  };
+
+  // arrivals are optional. Without a rate the whole workload is preloaded.
+  // The process is one of "fixed" (default) or "poisson".
+  static ArrivalConfig get_arrival_conf(ArgMap m) {
+    ArrivalConfig conf = {
+      .rate_txns_per_sec = 0,
+      .poisson = false
+    };
+
+    if (m.count(static_cast<int>(OptionCode::arrival_rate)) != 0) {
+      conf.rate_txns_per_sec = 
+        strtod(m[static_cast<int>(OptionCode::arrival_rate)], nullptr);
+    }
+
+    if (m.count(static_cast<int>(OptionCode::arrival_process)) == 0) {
+      return conf;
+    }
+
+    std::string name(m[static_cast<int>(OptionCode::arrival_process)]);
+    if (name != "fixed" && name != "poisson") {
+      std::cerr << "arg_parse.h: Unknown arrival process " << name << ".\n";
+      exit(-1);
+    }
+
+    conf.poisson = (name == "poisson");
+    return conf;
+  };
+
   static DBStorageConfig get_db_conf(ArgMap m) {
     check_presence(
         m, "storage",
@@ -152,6 +261,19 @@ private:
         (uint64_t) strtoul(m[static_cast<int>(OptionCode::num_records)], nullptr, 10)
     }}};
 
+    // record size is optional and defaults to a single counter.
+    if (m.count(static_cast<int>(OptionCode::record_size)) != 0) {
+      conf.tables_definitions[0].record_size = 
+        (uint64_t) strtoul(m[static_cast<int>(OptionCode::record_size)], nullptr, 10);
+    }
+
+    // keys are dense unless disabled with 0. The workload keys then live
+    // behind the hash index instead.
+    if (m.count(static_cast<int>(OptionCode::dense_keys)) != 0) {
+      conf.tables_definitions[0].dense_keys = 
+        strtoul(m[static_cast<int>(OptionCode::dense_keys)], nullptr, 10) != 0;
+    }
+
     return conf;
   };
 
@@ -215,7 +337,11 @@ public:
         (unsigned int) strtoul(
             arg_map[static_cast<int>(OptionCode::num_txns)], nullptr, 10),
       .output_dir = 
-        std::string(arg_map[static_cast<int>(OptionCode::output_dir)])
+        std::string(arg_map[static_cast<int>(OptionCode::output_dir)]),
+      .wait_conf = get_wait_conf(arg_map),
+      .arrival_conf = get_arrival_conf(arg_map),
+      .replay_file = get_file(arg_map, OptionCode::replay_command_log),
+      .load_dir = get_file(arg_map, OptionCode::mv_checkpoint_load)
     };
 
     return exp_conf;
@@ -1,6 +1,8 @@
 #ifndef DATA_OUT_H_
 #define DATA_OUT_H_
 
+#include "batch/latency_histogram.h"
+
 #include <iostream>
 #include <fstream>
 
@@ -36,6 +38,17 @@ private:
     ofs << "time_period,txn_completed" << std::endl;
   }
 
+  void write_header_latency(std::ofstream& ofs) {
+    config.print_experiment_header(ofs) << ",";
+    ofs << "arrival_rate,poisson,txn_completed,mean_us,p50_us,p99_us," <<
+      "p99.9_us,max_us" << std::endl;
+  }
+
+  void write_header_latency_distribution(std::ofstream& ofs) {
+    config.print_experiment_header(ofs) << ",";
+    ofs << "arrival_rate,poisson,latency_us,txn_completed" << std::endl;
+  }
+
   void write_result_common(std::ofstream& ofs) {
     ofs <<
       config.num_txns << "," <<
@@ -115,6 +128,58 @@ public:
     file_handle.close();
   };
 
+  // latencies are recorded in ns and written in us.
+  void write_latency_results(const LatencyHistogram& h) {
+    std::string file_path = write_dir + "/latency_data";
+    bool file_existed = file_exists(file_path);
+    auto file_handle = open_file(file_path);
+
+    if (file_existed) {
+      std::cerr << "Appending results to existing file: " <<
+        file_path << std::endl;
+    } else {
+      write_header_latency(file_handle);
+    }
+
+    write_result(file_handle, {
+      config.arrival_conf.rate_txns_per_sec,
+      (double) config.arrival_conf.poisson,
+      (double) h.get_count(),
+      h.get_mean() / 1000,
+      h.get_value_at_percentile(50) / 1000.0,
+      h.get_value_at_percentile(99) / 1000.0,
+      h.get_value_at_percentile(99.9) / 1000.0,
+      h.get_max() / 1000.0
+    });
+
+    file_handle.close();
+  };
+
+  // the whole histogram, one row per non-empty bucket.
+  void write_latency_distribution(const LatencyHistogram& h) {
+    std::string file_path = write_dir + "/latency_distribution";
+    bool file_existed = file_exists(file_path);
+    auto file_handle = open_file(file_path);
+
+    if (file_existed) {
+      std::cerr << "Appending results to existing file: " <<
+        file_path << std::endl;
+    } else {
+      write_header_latency_distribution(file_handle);
+    }
+
+    for (auto& bucket : h.get_buckets()) {
+      write_result(file_handle, {
+        config.arrival_conf.rate_txns_per_sec,
+        (double) config.arrival_conf.poisson,
+        bucket.first / 1000.0,
+        (double) bucket.second
+      });
+    }
+
+    file_handle.close();
+  };
+
   void write_exp_description() {
     std::string file_path = write_dir + "/description"; 
     unsigned int file_path_num = 0;
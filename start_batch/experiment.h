@@ -4,9 +4,13 @@
 #include "experiment_config.h"
 #include "batch/txn_factory.h"
 #include "batch/time_util.h"
+#include "batch/latency_histogram.h"
+#include "batch/batch_command_log.h"
+#include "bulk_load.h"
 
 #include <cassert>
 #include <chrono>
+#include <random>
 #include <thread>
 
 // Experiment
@@ -21,6 +25,8 @@ private:
   std::vector<std::unique_ptr<IBatchAction>> workload;
   std::vector<std::unique_ptr<IBatchAction>> warm_up_workload;
   Supervisor s;
+  // latencies of the open-loop experiment in ns.
+  LatencyHistogram latencies;
   uint64_t txns_completed;
   unsigned int expected_output_elts;
   bool print_debug;
@@ -91,6 +97,42 @@ private:
     s.reset_system();
   };
 
+  // Hand the workload to the system one action at a time, at the times
+  // given by the arrival process. 
+  void submit_open_loop() {
+    ArrivalConfig& arrivals = conf.arrival_conf;
+    assert(arrivals.is_open_loop());
+
+    std::mt19937_64 gen(0);
+    std::exponential_distribution<double> interarrival_sec(
+        arrivals.rate_txns_per_sec);
+    double period_ns = 1000000000 / arrivals.rate_txns_per_sec;
+
+    uint64_t start = TimeUtilities::now_ns();
+    double next_arrival_ns = 0;
+    for (auto& act : workload) {
+      uint64_t arrival = start + (uint64_t) next_arrival_ns;
+      while (TimeUtilities::now_ns() < arrival) do_pause();
+
+      // latency is measured from the scheduled arrival, so that a late
+      // submission does not hide the queueing delay.
+      act->submit_time_ns = arrival;
+      s.add_action(std::move(act));
+
+      next_arrival_ns += 
+        arrivals.poisson ? interarrival_sec(gen) * 1000000000 : period_ns;
+    }
+
+    s.flush_actions();
+  };
+
+  void record_latencies(std::vector<std::shared_ptr<IBatchAction>>& batch) {
+    uint64_t completed = TimeUtilities::now_ns();
+    for (auto& act : batch) {
+      latencies.record(completed - act->submit_time_ns);
+    }
+  };
+
   std::vector<std::pair<double, unsigned int>> do_measurements() {
     assert(workload.size() == conf.num_txns);
 
@@ -120,7 +162,11 @@ private:
     
     auto put_input = [&]() {
       pin_thread(77);
-      s.set_simulation_workload(std::move(workload));
+      if (conf.arrival_conf.is_open_loop()) {
+        submit_open_loop();
+      } else {
+        s.set_simulation_workload(std::move(workload));
+      }
       input_stop = TimeUtilities::now();
     };
 
@@ -135,6 +181,7 @@ private:
         auto o = s.get_output();
         if (o == nullptr) continue;
 
+        if (conf.arrival_conf.is_open_loop()) record_latencies(*o);
         cur_txns_completed = txns_completed;
         bool res = cmp_and_swap(&txns_completed, cur_txns_completed, txns_completed + o->size());  
         assert(res);
@@ -166,6 +213,17 @@ private:
       std::to_string(TimeUtilities::time_difference_ms(all_start, measure_stop)) + "ms\n"
     });
 
+    if (conf.arrival_conf.is_open_loop()) {
+      print_debug_info({
+        "p50 latency",
+        "p99 latency",
+        "p99.9 latency\n",
+        std::to_string(latencies.get_value_at_percentile(50) / 1000) + "us",
+        std::to_string(latencies.get_value_at_percentile(99) / 1000) + "us",
+        std::to_string(latencies.get_value_at_percentile(99.9) / 1000) + "us\n"
+      });
+    }
+
     return results;
   };
 
@@ -246,6 +304,87 @@ private:
         conf.exec_conf.executing_threads_count;
   };
 
+  // Fill the tables from a checkpoint directly, on the executing threads' 
+  // cpus. Every checkpointed record must be one of the table's keys.
+  void load_tables() {
+    if (conf.load_dir.empty()) return;
+
+    print_debug_info("Bulk loading tables ... ");
+    TimePoint time_start = TimeUtilities::now();
+    FileLoadSource source(conf.load_dir.c_str());
+    for (uint32_t table_id = 0; table_id < source.NumTables(); table_id++) {
+      bool fits = false;
+      for (auto& table : conf.db_conf.tables_definitions) {
+        fits |= (table.table_id == table_id && 
+            source.NumRecords(table_id) <= table.num_records);
+      }
+
+      if (!fits) {
+        std::cerr << "experiment.h: Checkpoint table " << table_id << 
+          " does not fit the storage.\n";
+        exit(-1);
+      }
+    }
+
+    uint64_t loaded = s.db.bulk_load(
+        &source, 
+        conf.exec_conf.first_pin_cpu_id, 
+        conf.exec_conf.executing_threads_count);
+    TimePoint time_end = TimeUtilities::now();
+    print_debug_info(
+        "[ O K ] (" + std::to_string(loaded) + " records, " + 
+        std::to_string(
+          TimeUtilities::time_difference_ms(time_start, time_end)) + 
+        ")\n");
+  };
+
+  // Re-execute the command log in its original batches and order. 
+  void do_replay() {
+    print_debug_info("Reading command log ... ");
+    auto batches = BatchCommandLog::read_batches(conf.replay_file);
+    uint64_t txns_num = 0;
+    for (auto& batch : batches) {
+      txns_num += batch.size();
+    }
+    print_debug_info(
+        "[ O K ] (" + std::to_string(batches.size()) + " batches)\n");
+
+    s.init_system();
+    TimePoint time_start = TimeUtilities::now();
+    s.start_system();
+
+    auto put_input = [&]() {
+      for (auto& batch : batches) {
+        for (auto& act : batch) {
+          s.add_action(std::move(act));
+        }
+
+        s.flush_actions();
+      }
+    };
+
+    std::thread input(put_input);
+    std::vector<std::unique_ptr<std::vector<std::shared_ptr<IBatchAction>>>> output;
+    while (txns_completed < txns_num) {
+      auto o = s.get_output();
+      if (o == nullptr) continue;
+
+      txns_completed += o->size();
+      output.push_back(std::move(o));
+    }
+
+    input.join();
+    s.stop_system();
+    print_debug_info({
+        "Replayed actions: ",
+        std::to_string(txns_completed) + "\n",
+        "Replay time: ",
+        std::to_string(
+          TimeUtilities::time_difference_ms(
+            time_start, TimeUtilities::now())) + "ms\n"
+    });
+  };
+
 public:
   Experiment(ExperimentConfig conf, bool print): 
     conf(conf), 
@@ -255,6 +394,12 @@ public:
   {};
 
   void do_experiment() {
+    load_tables();
+    if (conf.replay_file.empty() == false) {
+      do_replay();
+      return;
+    }
+
     initialize();
     do_warm_up_run();
     auto results = do_measurements();
@@ -262,6 +407,10 @@ public:
     Out printer(conf);
     printer.write_exp_description();
     printer.write_interim_completion_time_results(results);
+    if (conf.arrival_conf.is_open_loop()) {
+      printer.write_latency_results(latencies);
+      printer.write_latency_distribution(latencies);
+    }
   };
 };
 
@@ -5,6 +5,23 @@
 #include "batch/scheduler_system.h"
 #include "batch/db_storage_interface.h"
 #include "batch/txn_factory.h"
+#include "wait_strategy.h"
+
+// Arrivals of actions within the open-loop experiment. Actions arrive 
+// at a fixed rate or as a Poisson process of the same mean rate. A rate of 0 
+// preloads the whole workload at once instead.
+struct ArrivalConfig {
+  double rate_txns_per_sec;
+  bool poisson;
+
+  bool is_open_loop() const {
+    return rate_txns_per_sec > 0;
+  };
+
+  std::string get_process_name() const {
+    return poisson ? "poisson" : "fixed";
+  };
+};
 
 struct ExperimentConfig {
   SchedulingSystemConfig sched_conf;
@@ -13,6 +30,14 @@ struct ExperimentConfig {
   ActionSpecification act_conf;
   unsigned int num_txns;
   std::string output_dir;
+  WaitStrategyConfig wait_conf;
+  ArrivalConfig arrival_conf;
+  // if set, the command log in this file is re-executed instead of 
+  // running the workload.
+  std::string replay_file;
+  // if set, the tables are bulk loaded from the multiversion checkpoint in 
+  // this directory before anything runs.
+  std::string load_dir;
 
   std::ofstream& print_experiment_header(std::ofstream& ofs) {
     ofs << "num_txns,batch_size,num_sched_threads,num_table_merging_shard," <<
@@ -55,24 +80,34 @@ struct ExperimentConfig {
 
     ofs << "GENERAL INFORMATION" << std::endl;
     write_desc_row("Transaction number:", num_txns);
+    if (arrival_conf.is_open_loop()) {
+      write_desc_row("Arrival rate (txns/sec):", arrival_conf.rate_txns_per_sec);
+      write_desc_of_a_row("Arrival process:") << 
+        arrival_conf.get_process_name() << "\n";
+    }
     
     ofs << "SCHEDULING SYSTEM" << std::endl;
     write_desc_row("Scheduling threads:", sched_conf.scheduling_threads_count);
     write_desc_row("Batch size (act):", sched_conf.batch_size_act);
-    write_desc_row("Batch length (sec):", sched_conf.batch_length_sec);
+    write_desc_row("Batch timeout (us):", sched_conf.batch_timeout_us);
     write_desc_row("First pin cpu id:", sched_conf.first_pin_cpu_id);
     write_desc_row("Number of shards for table merge:", sched_conf.num_table_merging_shard);
+    write_desc_row("Packing threads per batch:", sched_conf.packing_threads_count);
     ofs << std::endl; 
 
     ofs << "EXECUTING SYSTEM" << std::endl;
     write_desc_row("Executing threads:", exec_conf.executing_threads_count);
     write_desc_row("First pin cpu id:", exec_conf.first_pin_cpu_id);
+    write_desc_of_a_row("Wait strategy:") << 
+      WaitStrategy::get_name(wait_conf.strategy) << "\n";
     ofs << std::endl;
 
     auto tables = db_conf.tables_definitions;
     ofs << "DATABASE STORAGE" << std::endl;
     write_desc_row("Tables number:", tables.size());
     write_desc_row("Records in table:", tables[0].num_records);
+    write_desc_row("Record size (bytes):", tables[0].record_size);
+    write_desc_row("Dense keys:", tables[0].dense_keys);
     ofs << std::endl;
 
     auto reads = act_conf.reads;
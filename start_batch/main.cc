@@ -12,6 +12,8 @@
 
 int main(int argc, char** argv) {
   ExperimentConfig exp_conf = ArgParse::parse_args(argc, argv);
+  // must happen before any of the threads start waiting.
+  WaitStrategy::configure(exp_conf.wait_conf);
   Experiment exp(exp_conf, true);
   exp.do_experiment();
 
@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "batch/SPSC_ring.h"
+
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+typedef std::unique_ptr<int> Ptr;
+
+class SPSCRingTest : public testing::Test {
+};
+
+TEST_F(SPSCRingTest, constructorTest) {
+  SPSCRing<int> r;
+  ASSERT_TRUE(r.is_empty());
+  ASSERT_EQ(0, r.get_size());
+}
+
+TEST_F(SPSCRingTest, fifoTest) {
+  SPSCRing<Ptr> r(4);
+  // wrap around the ring a few times.
+  for (int i = 0; i < 10; i++) {
+    r.push_tail(std::make_unique<int>(i));
+    r.push_tail(std::make_unique<int>(i + 100));
+    ASSERT_EQ(2, r.get_size());
+
+    ASSERT_EQ(i, *r.peek_head());
+    r.pop_head();
+    ASSERT_EQ(i + 100, *r.peek_head());
+    r.pop_head();
+    ASSERT_TRUE(r.is_empty());
+  }
+}
+
+TEST_F(SPSCRingTest, boundedTest) {
+  SPSCRing<int> r(4, false);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(r.try_push_tail(std::move(i)));
+  }
+
+  int elt = 4;
+  ASSERT_FALSE(r.try_push_tail(std::move(elt)));
+  r.pop_head();
+  ASSERT_TRUE(r.try_push_tail(std::move(elt)));
+
+  for (int i = 1; i <= 4; i++) {
+    ASSERT_EQ(i, r.peek_head());
+    r.pop_head();
+  }
+}
+
+TEST_F(SPSCRingTest, overflowTest) {
+  SPSCRing<Ptr> r(2);
+  // interleave pops so that overflow happens with a wrapped ring.
+  r.push_tail(std::make_unique<int>(-1));
+  r.pop_head();
+  for (int i = 0; i < 100; i++) {
+    r.push_tail(std::make_unique<int>(i));
+  }
+
+  ASSERT_EQ(100, r.get_size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i, *r.peek_head());
+    r.pop_head();
+  }
+  ASSERT_TRUE(r.is_empty());
+}
+
+TEST_F(SPSCRingTest, batchTest) {
+  SPSCRing<Ptr> r(8);
+  std::vector<Ptr> in;
+  for (int i = 0; i < 20; i++) {
+    in.push_back(std::make_unique<int>(i));
+  }
+
+  r.push_tail_batch(in.begin(), in.end());
+  ASSERT_EQ(20, r.get_size());
+
+  std::vector<Ptr> out;
+  ASSERT_EQ(5, r.pop_head_batch(std::back_inserter(out), 5));
+  ASSERT_EQ(15, r.pop_head_batch(std::back_inserter(out), 100));
+  ASSERT_EQ(0, r.pop_head_batch(std::back_inserter(out), 100));
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(i, *out[i]);
+  }
+}
+
+TEST_F(SPSCRingTest, destructorTest) {
+  auto elt = std::make_shared<int>(0);
+  {
+    SPSCRing<std::shared_ptr<int>> r(2);
+    for (int i = 0; i < 5; i++) {
+      r.push_tail(elt);
+    }
+    ASSERT_EQ(6, elt.use_count());
+  }
+  ASSERT_EQ(1, elt.use_count());
+}
+
+TEST_F(SPSCRingTest, moveConstructorTest) {
+  SPSCRing<int> r;
+  r.push_tail(1);
+
+  SPSCRing<int> moved(std::move(r));
+  ASSERT_EQ(1, moved.peek_head());
+  moved.pop_head();
+  ASSERT_TRUE(moved.is_empty());
+}
+
+void concurrent_transfer(bool unbounded, bool batched) {
+  const int elts = 10000;
+  SPSCRing<Ptr> r(64, unbounded);
+
+  std::thread producer([&r, batched]() {
+    std::vector<Ptr> batch;
+    for (int i = 0; i < elts; i++) {
+      if (batched == false) {
+        r.push_tail(std::make_unique<int>(i));
+        continue;
+      }
+
+      batch.push_back(std::make_unique<int>(i));
+      if (batch.size() == 7 || i == elts - 1) {
+        r.push_tail_batch(batch.begin(), batch.end());
+        batch.clear();
+      }
+    }
+  });
+
+  int expected = 0;
+  std::vector<Ptr> out;
+  while (expected < elts) {
+    out.clear();
+    if (batched) {
+      r.pop_head_batch(std::back_inserter(out), 5);
+    } else if (r.is_empty() == false) {
+      out.push_back(std::move(r.peek_head()));
+      r.pop_head();
+    }
+
+    for (auto& e : out) {
+      ASSERT_EQ(expected++, *e);
+    }
+  }
+
+  producer.join();
+  ASSERT_TRUE(r.is_empty());
+}
+
+TEST_F(SPSCRingTest, concurrentBoundedTest) {
+  concurrent_transfer(false, false);
+  concurrent_transfer(false, true);
+}
+
+TEST_F(SPSCRingTest, concurrentUnboundedTest) {
+  concurrent_transfer(true, false);
+  concurrent_transfer(true, true);
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include <batch/batch_action.h>
+#include <batch/RMW_batch_action.h>
+#include <batch/db_storage.h>
 #include <test/test_txn.h>
 
+#include <cstring>
+
 class BatchActionTest : public ::testing::Test {
 protected:
   BatchAction* create_action_with_records(
@@ -70,21 +74,39 @@ TEST_F(BatchActionTest, ComparingActions) {
   delete c;
 }
 
-// TODO:
-//    When we figure out if we need the read/write refs, this will come back
-//    or get deleted.
-//// create record keys with specific pointers and fetch them
-//TEST_F(BatchActionTest, CheckingRefs) {
-//  BatchRecord x = 10;
-//  BatchRecord y = 11;
-//
-//  RecordKey r1(1, 0); 
-//  RecordKey r2(1, 1); 
-//  r1.record = &x;
-//  r2.record = &y;
-//
-//  BatchAction* action = create_action_with_records({r1}, {r2}); 
-//  
-//  ASSERT_EQ(*((BatchRecord*) action->read(1, 0)), 10);
-//  ASSERT_EQ(*((BatchRecord*) action->write_ref(1, 1)), 11);
-//}
+// read and write_ref hand out the records of the storage the action runs on.
+TEST_F(BatchActionTest, CheckingRefs) {
+  DBStorage db({{{.table_id = 0, .num_records = 10, .record_size = 1000}}});
+  BatchAction* action = create_action_with_records({{1, 0}}, {{2, 0}}); 
+  action->Run(&db);
+
+  ASSERT_EQ(db.read_ref({1, 0}), action->read(1, 0));
+  ASSERT_EQ(db.read_ref({2, 0}), action->read(2, 0));
+  ASSERT_EQ(db.write_ref({2, 0}), action->write_ref(2, 0));
+  delete action;
+}
+
+// RMW actions increment the leading value of the records they write and 
+// keep the rest of them.
+TEST(RMWBatchActionTest, LargeRecords) {
+  const uint64_t RECORD_SIZE = 1000;
+  DBStorage db({{{.table_id = 0, .num_records = 10, .record_size = RECORD_SIZE}}});
+  for (uint64_t i = 0; i < 10; i++) {
+    memset(db.write_ref({i, 0}), (int) i, RECORD_SIZE);
+    db.write_record_value({i, 0}, 10 * i);
+  }
+
+  RMWBatchAction action(new TestTxn());
+  action.add_read_key({1, 0});
+  action.add_write_key({2, 0});
+  action.add_write_key({3, 0});
+  action.Run(&db);
+
+  for (uint64_t i = 1; i < 4; i++) {
+    ASSERT_EQ(10 * i + (i == 1 ? 0 : 1), db.read_record_value({i, 0}));
+    const char* rec = (const char*) db.read_ref({i, 0});
+    for (uint64_t j = sizeof(IDBStorage::RecordValue); j < RECORD_SIZE; j++) {
+      ASSERT_EQ((char) i, rec[j]);
+    }
+  }
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <bulk_load.h>
+#include <mv_checkpoint.h>
+#include <table.h>
+#include <small_bank.h>
+#include <ycsb.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+class BulkLoadTest : public testing::Test {
+protected:
+  const uint32_t THREADS = 3;
+  const uint64_t RECORDS = 1000;
+
+  // Loads source, and records every insert a thread makes. Inserts of
+  // different threads are serialized by the test, not the loader.
+  std::vector<std::set<std::pair<uint32_t, uint64_t>>> load(
+      BulkLoadSource* source, bulk_owner_fn owner) {
+    std::vector<std::set<std::pair<uint32_t, uint64_t>>> inserted(THREADS);
+    std::mutex lock;
+    BulkLoaderConfig conf = {
+      0, THREADS, source, owner,
+      [&](uint32_t thread, uint32_t table_id, uint64_t key, const char*,
+          uint64_t) {
+        std::lock_guard<std::mutex> guard(lock);
+        EXPECT_TRUE(inserted[thread].insert({table_id, key}).second);
+      }
+    };
+    BulkLoader loader(conf);
+    EXPECT_EQ(source->NumTables() * RECORDS, loader.Load());
+    return inserted;
+  }
+};
+
+// Without an owner, threads load disjoint ranges which cover every record.
+TEST_F(BulkLoadTest, rangesTest) {
+  WorkloadLoadSource source(true, RECORDS);
+  auto inserted = load(&source, nullptr);
+
+  std::set<std::pair<uint32_t, uint64_t>> all;
+  for (auto& thread : inserted) {
+    ASSERT_LT(0u, thread.size());
+    all.insert(thread.begin(), thread.end());
+  }
+  ASSERT_EQ(2 * RECORDS, all.size());
+}
+
+// Every record is inserted by its owner, and only by its owner. Owners are
+// looked up once per record, not once per record and thread.
+TEST_F(BulkLoadTest, ownerTest) {
+  WorkloadLoadSource source(false, RECORDS);
+  std::atomic<uint64_t> lookups(0);
+  auto owner = [this](uint32_t, uint64_t key) {
+    return (uint32_t) (key % THREADS);
+  };
+  auto inserted = load(&source, [&](uint32_t table_id, uint64_t key) {
+    lookups++;
+    return owner(table_id, key);
+  });
+  ASSERT_EQ(RECORDS, lookups);
+
+  uint64_t total = 0;
+  for (uint32_t thread = 0; thread < THREADS; thread++) {
+    for (auto& rec : inserted[thread])
+      ASSERT_EQ(thread, owner(rec.first, rec.second));
+    total += inserted[thread].size();
+  }
+  ASSERT_EQ(RECORDS, total);
+}
+
+// Generated values only depend on the record, and balances are those
+// LoadCustomerRange would draw.
+TEST_F(BulkLoadTest, workloadValuesTest) {
+  WorkloadLoadSource source(true, RECORDS);
+  SmallBankRecord a, b;
+
+  ASSERT_EQ(sizeof(SmallBankRecord), source.RecordSize(1));
+  for (uint64_t i = 0; i < RECORDS; i++) {
+    for (uint32_t table = 0; table < 2; table++) {
+      ASSERT_EQ(i, source.GetKey(table, i));
+      memcpy(&a, source.GetValue(table, i, (char*) &b), sizeof(a));
+      memset(&b, 0xFF, sizeof(b));
+      source.GetValue(table, i, (char*) &b);
+      ASSERT_EQ(0, memcmp(&a, &b, sizeof(a)));
+      ASSERT_LE(0, a.amount);
+      ASSERT_GT(100, a.amount);
+    }
+  }
+}
+
+// Records inserted through Table::Insert are found by Get.
+TEST_F(BulkLoadTest, tableTest) {
+  WorkloadLoadSource source(false, RECORDS);
+  TableConfig table_conf = {0, RECORDS, 0, 0, 1, YCSB_RECORD_SIZE, 0};
+  Table* table = new (0) Table(table_conf);
+  BulkLoader* loader = nullptr;
+  BulkLoaderConfig conf = {
+    0, THREADS, &source,
+    [&](uint32_t, uint64_t key) {
+      return (uint32_t) (table->BucketOf(key) * THREADS / table->NumBuckets());
+    },
+    [&](uint32_t thread, uint32_t, uint64_t key, const char* value,
+        uint64_t size) {
+      TableRecord* rec = (TableRecord*) loader->Alloc(
+          thread, sizeof(TableRecord) + YCSB_RECORD_SIZE);
+      rec->key = key;
+      BulkLoader::CopyValue(rec->value, YCSB_RECORD_SIZE, value, size);
+      table->Insert(rec);
+    }
+  };
+  loader = new BulkLoader(conf);
+  ASSERT_EQ(RECORDS, loader->Load());
+
+  char expected[YCSB_RECORD_SIZE];
+  for (uint64_t key = 0; key < RECORDS; key++) {
+    ycsb_insert::gen_rand(key, expected);
+    ASSERT_EQ(0, memcmp(expected, table->Get(key), YCSB_RECORD_SIZE));
+  }
+  delete loader;
+}
+
+// A file source maps the records of a checkpoint.
+TEST_F(BulkLoadTest, fileTest) {
+  char dir[64];
+  strcpy(dir, "/tmp/bulk_load_test_XXXXXX");
+  ASSERT_TRUE(mkdtemp(dir) != NULL);
+
+  uint64_t record_size = sizeof(uint64_t);
+  MVRecordAllocator* alloc =
+    new (0) MVRecordAllocator(sizeof(MVRecord) * RECORDS, 0, 0, 0);
+  MVTablePartition* partition =
+    MVTablePartition::Create(MV_CHAINED_INDEX, RECORDS, 0, alloc);
+  for (uint64_t key = 0; key < RECORDS; key++) {
+    CompositeKey pkey(false, 0, key);
+    partition->WriteNewVersion(pkey, nullptr, CREATE_MV_TIMESTAMP(1, key));
+    Record* rec = (Record*) malloc(sizeof(Record) + record_size);
+    *(uint64_t*) rec->value = 3 * key;
+    pkey.value->value = rec;
+  }
+  volatile uint32_t checkpoint_word = MV_CKPT_IDLE;
+  volatile uint32_t low_water_mark = 0;
+  MVCheckpointerConfig ckpt_conf = {0, dir, 0, 1, &record_size, 1,
+                                    &partition, &checkpoint_word,
+                                    &low_water_mark};
+  MVCheckpointer* checkpointer = new (0) MVCheckpointer(ckpt_conf);
+  checkpointer->Write(1);
+
+  {
+    FileLoadSource source(dir);
+    ASSERT_EQ(1u, source.Epoch());
+    ASSERT_EQ(1u, source.NumTables());
+    ASSERT_EQ(RECORDS, source.NumRecords(0));
+    ASSERT_EQ(record_size, source.RecordSize(0));
+
+    std::set<uint64_t> keys;
+    for (uint64_t i = 0; i < RECORDS; i++) {
+      uint64_t key = source.GetKey(0, i);
+      ASSERT_TRUE(keys.insert(key).second);
+      ASSERT_EQ(3 * key, *(const uint64_t*) source.GetValue(0, i, nullptr));
+    }
+  }
+
+  unlink(MVCheckpointer::TableFile(dir, 1, 0).c_str());
+  unlink((std::string(dir) + "/mv_checkpoint").c_str());
+  rmdir(dir);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <command_log.h>
+#include <ycsb.h>
+#include <small_bank.h>
+#include <batch/batch_command_log.h>
+#include <batch/RMW_batch_action.h>
+#include <test/test_txn.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+class CommandLogTest : public testing::Test {
+protected:
+  char file_name[64];
+
+  virtual void SetUp() {
+    strcpy(file_name, "/tmp/command_log_test_XXXXXX");
+    int fd = mkstemp(file_name);
+    ASSERT_NE(-1, fd);
+    close(fd);
+  }
+
+  virtual void TearDown() {
+    unlink(file_name);
+  }
+
+  std::vector<std::vector<logged_txn>> read_all(uint64_t* txns_read) {
+    std::vector<std::vector<logged_txn>> batches;
+    *txns_read = CommandLog::Read(
+        file_name,
+        [&batches](uint64_t batch_id, std::vector<logged_txn>& txns) {
+          EXPECT_EQ(batches.size() + 1, batch_id);
+          batches.push_back(txns);
+        });
+    return batches;
+  }
+
+  void expect_same_params(txn* t) {
+    std::vector<uint64_t> params;
+    t->get_params(&params);
+    txn* copy = CommandLog::CreateTxn({t->get_type(), params});
+    std::vector<uint64_t> copy_params;
+    copy->get_params(&copy_params);
+    EXPECT_EQ(t->get_type(), copy->get_type());
+    EXPECT_EQ(params, copy_params);
+    delete copy;
+    delete t;
+  }
+};
+
+// Batches are only written out on Sync and a torn batch at the end of 
+// the log is ignored.
+TEST_F(CommandLogTest, groupSyncTest) {
+  uint64_t txns_read;
+  {
+    CommandLog log(file_name);
+    log.AppendTxn(YCSB_INSERT_TXN, {0, 10});
+    log.EndBatch(1);
+    log.AppendTxn(YCSB_READONLY_TXN, {1, 2, 3});
+    log.AppendTxn(YCSB_READONLY_TXN, {});
+    log.EndBatch(2);
+    ASSERT_EQ(0, read_all(&txns_read).size());
+    log.Sync();
+  }
+
+  std::ofstream torn(file_name, std::ios::app | std::ios::binary);
+  command_log_batch_header header = {3, 1, 1000};
+  torn.write((char*)&header, sizeof(header));
+  torn.close();
+
+  auto batches = read_all(&txns_read);
+  ASSERT_EQ(3, txns_read);
+  ASSERT_EQ(2, batches.size());
+  ASSERT_EQ(1, batches[0].size());
+  ASSERT_EQ(YCSB_INSERT_TXN, batches[0][0].type);
+  ASSERT_EQ(std::vector<uint64_t>({0, 10}), batches[0][0].params);
+  ASSERT_EQ(2, batches[1].size());
+  ASSERT_EQ(std::vector<uint64_t>({1, 2, 3}), batches[1][0].params);
+  ASSERT_EQ(0, batches[1][1].params.size());
+}
+
+// A batch that is complete but whose transactions don't fit inside its 
+// length is treated as torn rather than read past.
+TEST_F(CommandLogTest, corruptBatchTest) {
+  uint64_t txns_read;
+  {
+    CommandLog log(file_name);
+    log.AppendTxn(YCSB_INSERT_TXN, {0, 10});
+    log.EndBatch(1);
+    log.Sync();
+  }
+
+  std::ofstream corrupt(file_name, std::ios::app | std::ios::binary);
+  command_log_txn_header txn_header = {YCSB_READONLY_TXN, 1000};
+  uint64_t param = 7;
+  command_log_batch_header header = {
+    2, 1, sizeof(txn_header) + sizeof(param)
+  };
+  corrupt.write((char*)&header, sizeof(header));
+  corrupt.write((char*)&txn_header, sizeof(txn_header));
+  corrupt.write((char*)&param, sizeof(param));
+
+  // Too many transactions for the batch length.
+  header = {3, 1000, sizeof(txn_header)};
+  txn_header = {YCSB_READONLY_TXN, 0};
+  corrupt.write((char*)&header, sizeof(header));
+  corrupt.write((char*)&txn_header, sizeof(txn_header));
+  corrupt.close();
+
+  auto batches = read_all(&txns_read);
+  ASSERT_EQ(1, txns_read);
+  ASSERT_EQ(1, batches.size());
+  ASSERT_EQ(std::vector<uint64_t>({0, 10}), batches[0][0].params);
+}
+
+TEST_F(CommandLogTest, createTxnTest) {
+  expect_same_params(new ycsb_insert(5, 10));
+  expect_same_params(new ycsb_readonly({1, 7, 3}));
+  expect_same_params(new ycsb_rmw({1, 2}, {3, 4, 5}));
+  expect_same_params(new ycsb_rmw({}, {3}));
+  expect_same_params(new SmallBank::LoadCustomerRange(3, 6));
+  expect_same_params(new SmallBank::Balance(4));
+  expect_same_params(new SmallBank::DepositChecking(4, -5));
+  expect_same_params(new SmallBank::TransactSaving(4, 5));
+  expect_same_params(new SmallBank::Amalgamate(4, 2));
+  expect_same_params(new SmallBank::WriteCheck(4, 5));
+}
+
+TEST_F(CommandLogTest, batchActionTest) {
+  BatchCommandLog::Batch batch;
+  batch.push_back(std::make_unique<RMWBatchAction>(new TestTxn()));
+  batch[0]->add_read_key(RecordKey(1));
+  batch[0]->add_read_key(RecordKey(2));
+  batch[0]->add_write_key(RecordKey(3));
+  batch.push_back(std::make_unique<RMWBatchAction>(new TestTxn()));
+  batch[1]->add_write_key(RecordKey(4));
+  {
+    CommandLog log(file_name);
+    BatchCommandLog::append_batch(&log, batch, 1);
+  }
+
+  auto batches = BatchCommandLog::read_batches(file_name);
+  ASSERT_EQ(1, batches.size());
+  ASSERT_EQ(2, batches[0].size());
+  for (unsigned int i = 0; i < 2; i++) {
+    ASSERT_EQ(*batch[i]->get_readset_handle(), 
+        *batches[0][i]->get_readset_handle());
+    ASSERT_EQ(*batch[i]->get_writeset_handle(), 
+        *batches[0][i]->get_writeset_handle());
+  }
+}
@@ -62,3 +62,63 @@ TEST(ConsistencyTest, TwoSchedTwoExec) {
 
   hp.runTest(get_assertion());
 }
+
+TEST(ConsistencyTest, SingleSchedTwoPackingTwoExec) {
+  DBTestHelper<Supervisor> hp;
+  hp.set_table_info(1, 100)
+    .set_exec_thread_num(2)
+    .set_sched_thread_num(1)
+    .set_packing_thread_num(2)
+    .set_batch_size(100)
+    .set_workload(std::move(getWorkload()));
+
+  hp.runTest(get_assertion());
+}
+
+TEST(ConsistencyTest, TwoSchedTwoExecBatchTimeout) {
+  DBTestHelper<Supervisor> hp;
+  hp.set_table_info(1, 100)
+    .set_exec_thread_num(2)
+    .set_sched_thread_num(2)
+    .set_batch_size(100)
+    .set_batch_timeout(100)
+    .set_workload(std::move(getWorkload()));
+
+  hp.runTest(get_assertion());
+}
+
+// Keys of a sparse second table are scheduled and executed like the dense 
+// ones of the first.
+TEST(ConsistencyTest, SparseSecondTable) {
+  const uint64_t record_num = 100;
+  DBStorageConfig db_conf;
+  db_conf.tables_definitions = {
+    {.table_id = 0, .num_records = record_num},
+    {.table_id = 1, .num_records = record_num, .record_size = 1000, 
+      .dense_keys = false}
+  };
+  for (uint64_t i = 0; i < record_num; i++) {
+    db_conf.tables_definitions[1].keys.push_back((i + 1) << 32);
+  }
+
+  auto workload = getWorkload();
+  for (unsigned int i = 0; i < workload.size(); i++) {
+    for (unsigned int j = 0; j < 10; j++) {
+      workload[i]->add_write_key({((i + j) % record_num + 1) << 32, 1});
+    }
+  }
+
+  DBTestHelper<Supervisor> hp;
+  hp.set_db_conf(db_conf)
+    .set_exec_thread_num(2)
+    .set_sched_thread_num(2)
+    .set_batch_size(100)
+    .set_workload(std::move(workload));
+
+  hp.runTest([record_num](IDBStorage* db) {
+    for (uint64_t i = 0; i < record_num; i++) {
+      ASSERT_EQ(100, db->read_record_value({i, 0}));
+      ASSERT_EQ(100, db->read_record_value({(i + 1) << 32, 1}));
+    }
+  });
+}
@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include "batch/db_storage.h"
+#include "machine.h"
+#include "bulk_load.h"
+#include "small_bank.h"
+
+#include <cstring>
+#include <unordered_set>
+
+class DBStorageTest : public testing::Test {
+protected:
+  const uint64_t RECORDS = 100;
+  const uint64_t LARGE_RECORD = 1000;
+
+  DBStorageConfig get_config() {
+    DBStorageConfig conf;
+    conf.tables_definitions = {
+      {.table_id = 0, .num_records = RECORDS},
+      {.table_id = 1, .num_records = RECORDS, .record_size = LARGE_RECORD},
+      {.table_id = 2, .num_records = RECORDS, .record_size = LARGE_RECORD,
+        .dense_keys = false}
+    };
+
+    return conf;
+  }
+};
+
+TEST_F(DBStorageTest, recordsStartZeroedTest) {
+  DBStorage db(get_config());
+  for (uint64_t table = 0; table < 3; table++) {
+    for (uint64_t i = 0; i < RECORDS; i++) {
+      ASSERT_EQ(0, db.read_record_value({i, table}));
+    }
+  }
+}
+
+TEST_F(DBStorageTest, recordSizesTest) {
+  DBStorage db(get_config());
+  ASSERT_EQ(sizeof(uint64_t), db.get_record_size(0));
+  ASSERT_EQ(LARGE_RECORD, db.get_record_size(1));
+  ASSERT_EQ(LARGE_RECORD, db.get_record_size(2));
+}
+
+TEST_F(DBStorageTest, cacheLineAlignedTest) {
+  DBStorage db(get_config());
+  for (uint64_t table = 0; table < 3; table++) {
+    for (uint64_t i = 0; i < RECORDS; i++) {
+      ASSERT_EQ(0, (uintptr_t) db.read_ref({i, table}) % CACHE_LINE);
+    }
+  }
+}
+
+TEST_F(DBStorageTest, refsDoNotOverlapTest) {
+  DBStorage db(get_config());
+  for (uint64_t table = 0; table < 3; table++) {
+    uint64_t size = db.get_record_size(table);
+    for (uint64_t i = 0; i < RECORDS; i++) {
+      memset(db.write_ref({i, table}), (int) i, size);
+    }
+
+    for (uint64_t i = 0; i < RECORDS; i++) {
+      const char* rec = (const char*) db.read_ref({i, table});
+      for (uint64_t j = 0; j < size; j++) {
+        ASSERT_EQ((char) i, rec[j]);
+      }
+    }
+  }
+}
+
+TEST_F(DBStorageTest, valueAccessorsTest) {
+  DBStorage db(get_config());
+  for (uint64_t table = 0; table < 3; table++) {
+    db.write_record_value({5, table}, 42 + table);
+    ASSERT_EQ(42 + table, db.read_record_value({5, table}));
+    ASSERT_EQ(
+        42 + table, *(const IDBStorage::RecordValue*) db.read_ref({5, table}));
+  }
+}
+
+// Bulk loading truncates values longer than a record, and zero pads those
+// which are shorter.
+TEST_F(DBStorageTest, bulkLoadTest) {
+  DBStorage db(get_config());
+  WorkloadLoadSource source(true, RECORDS);
+  for (uint64_t i = 0; i < RECORDS; i++) {
+    memset(db.write_ref({i, 1}), 0xFF, LARGE_RECORD);
+  }
+
+  ASSERT_EQ(2 * RECORDS, db.bulk_load(&source, 0, 2));
+  SmallBankRecord value;
+  for (uint64_t i = 0; i < RECORDS; i++) {
+    source.GetValue(0, i, (char*) &value);
+    ASSERT_EQ(0, memcmp(&value, db.read_ref({i, 0}), sizeof(uint64_t)));
+
+    source.GetValue(1, i, (char*) &value);
+    const char* rec = (const char*) db.read_ref({i, 1});
+    ASSERT_EQ(0, memcmp(&value, rec, sizeof(value)));
+    for (uint64_t j = sizeof(value); j < LARGE_RECORD; j++) {
+      ASSERT_EQ(0, rec[j]);
+    }
+  }
+}
+
+// Tables without dense keys hold exactly the keys they declare.
+TEST_F(DBStorageTest, sparseKeysTest) {
+  DBStorageConfig conf;
+  conf.tables_definitions = {
+    {.table_id = 0, .num_records = RECORDS, .record_size = LARGE_RECORD,
+      .dense_keys = false}
+  };
+  for (uint64_t i = 0; i < RECORDS; i++) {
+    conf.tables_definitions[0].keys.push_back((RECORDS - i) << 32);
+  }
+
+  DBStorage db(conf);
+  std::unordered_set<const void*> records;
+  for (uint64_t i = 1; i <= RECORDS; i++) {
+    const void* rec = db.read_ref({i << 32, 0});
+    ASSERT_EQ(0, (uintptr_t) rec % CACHE_LINE);
+    ASSERT_TRUE(records.insert(rec).second);
+
+    db.write_record_value({i << 32, 0}, i);
+  }
+
+  for (uint64_t i = 1; i <= RECORDS; i++) {
+    ASSERT_EQ(i, db.read_record_value({i << 32, 0}));
+  }
+}
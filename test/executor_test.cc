@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <executor.h>
+
+#include <cstring>
+#include <vector>
+
+// Exposes the payload handling of an executor which never runs.
+class TestExecutor : public Executor {
+public:
+  TestExecutor(ExecutorConfig config) : Executor(config) {}
+
+  using Executor::attach_payload;
+};
+
+class ExecutorTest : public testing::Test {
+protected:
+  static const unsigned int QUEUE_SIZE = 16;
+  static const unsigned int RECORD_SIZE = 100;
+  static const unsigned int POOL_SIZE = 16;
+
+  volatile uint32_t epoch;
+  volatile uint32_t lowWatermark;
+  std::vector<char> stickyData;
+  std::vector<char> recordData;
+  SimpleQueue<MVRecordList> *ccChannels[1];
+  SimpleQueue<RecordList> *workerChannels[1];
+  uint64_t recordSizes[1];
+  uint64_t allocatorSizes[1];
+  MVRecord prev;
+  MVRecord version;
+  Record *prevPayload;
+  TestExecutor *executor;
+
+  virtual void SetUp() {
+    epoch = 0;
+    lowWatermark = 0;
+    stickyData.resize(CACHE_LINE * QUEUE_SIZE);
+    recordData.resize(CACHE_LINE * QUEUE_SIZE);
+    ccChannels[0] =
+      new SimpleQueue<MVRecordList>(stickyData.data(), QUEUE_SIZE);
+    workerChannels[0] =
+      new SimpleQueue<RecordList>(recordData.data(), QUEUE_SIZE);
+    recordSizes[0] = RECORD_SIZE;
+    allocatorSizes[0] = POOL_SIZE;
+
+    GarbageBinConfig gcConfig = {
+      1,
+      1,
+      1,
+      0,
+      &lowWatermark,
+      ccChannels,
+      workerChannels,
+    };
+    ExecutorConfig config = {
+      0,
+      1,
+      0,
+      &epoch,
+      &lowWatermark,
+      NULL,
+      NULL,
+      NULL,
+      1,
+      recordSizes,
+      allocatorSizes,
+      1,
+      workerChannels[0],
+      gcConfig,
+    };
+    executor = new (0) TestExecutor(config);
+
+    // The previous version, written by another executor.
+    prevPayload = (Record*)malloc(sizeof(Record) + RECORD_SIZE);
+    memset(prevPayload->value, 0xA5, RECORD_SIZE);
+    memset(&prev, 0x0, sizeof(prev));
+    prev.value = prevPayload;
+    prev.writingThread = 1;
+    memset(&version, 0x0, sizeof(version));
+    version.recordLink = &prev;
+  }
+
+  virtual void TearDown() {
+    free(prevPayload);
+  }
+
+  CompositeKey write(bool is_rmw) {
+    CompositeKey key(is_rmw, 0, 0);
+    key.value = &version;
+    return key;
+  }
+};
+
+// Once every reader of the previous version is done, an RMW takes over its
+// payload.
+TEST_F(ExecutorTest, takeoverTest) {
+  prev.numReaders = 2;
+  prev.doneReaders = 2;
+  CompositeKey key = write(true);
+  executor->attach_payload(&key);
+
+  ASSERT_EQ(prevPayload, version.value);
+  ASSERT_EQ(1u, version.writingThread);
+  ASSERT_EQ(nullptr, prev.value);
+}
+
+// While readers of the previous version are outstanding, an RMW copies its
+// payload into one from the executor's own pool.
+TEST_F(ExecutorTest, copyTest) {
+  prev.numReaders = 2;
+  prev.doneReaders = 1;
+  CompositeKey key = write(true);
+  executor->attach_payload(&key);
+
+  ASSERT_NE(nullptr, version.value);
+  ASSERT_NE(prevPayload, version.value);
+  ASSERT_EQ(0u, version.writingThread);
+  ASSERT_EQ(prevPayload, prev.value);
+  ASSERT_EQ(0, memcmp(prevPayload->value, version.value->value, RECORD_SIZE));
+}
+
+// Blind writes always get a payload of their own.
+TEST_F(ExecutorTest, writeTest) {
+  CompositeKey key = write(false);
+  executor->attach_payload(&key);
+
+  ASSERT_NE(nullptr, version.value);
+  ASSERT_NE(prevPayload, version.value);
+  ASSERT_EQ(0u, version.writingThread);
+  ASSERT_EQ(prevPayload, prev.value);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <executor.h>
+
+#include <vector>
+
+class GarbageBinTest : public testing::Test {
+protected:
+  static const unsigned int QUEUE_SIZE = 16;
+  static const unsigned int VERSIONS = 10;
+
+  volatile uint32_t lowWatermark;
+  std::vector<char> stickyData;
+  std::vector<char> recordData;
+  SimpleQueue<MVRecordList> *stickyQueue;
+  SimpleQueue<RecordList> *recordQueue;
+  SimpleQueue<MVRecordList> *ccChannels[1];
+  SimpleQueue<RecordList> *workerChannels[1];
+  MVRecord versions[VERSIONS];
+  Record payloads[VERSIONS];
+  GarbageBin *bin;
+
+  virtual void SetUp() {
+    lowWatermark = 0;
+    stickyData.resize(CACHE_LINE * QUEUE_SIZE);
+    recordData.resize(CACHE_LINE * QUEUE_SIZE);
+    stickyQueue = new SimpleQueue<MVRecordList>(stickyData.data(), QUEUE_SIZE);
+    recordQueue = new SimpleQueue<RecordList>(recordData.data(), QUEUE_SIZE);
+    ccChannels[0] = stickyQueue;
+    workerChannels[0] = recordQueue;
+
+    GarbageBinConfig config = {
+      1,
+      1,
+      1,
+      0,
+      &lowWatermark,
+      ccChannels,
+      workerChannels,
+    };
+    bin = new (0) GarbageBin(config);
+
+    memset(versions, 0x0, sizeof(versions));
+    for (unsigned int i = 0; i < VERSIONS; i++) {
+      versions[i].value = &payloads[i];
+    }
+  }
+
+  // Kill a single version during epoch.
+  void kill_version(unsigned int i, uint32_t epoch) {
+    bin->AddMVRecord(0, &versions[i]);
+    bin->FinishEpoch(epoch);
+  }
+};
+
+TEST_F(GarbageBinTest, waitsForLowWatermarkTest) {
+  kill_version(0, 1);
+  bin->Poll();
+
+  MVRecordList stickies;
+  ASSERT_FALSE(stickyQueue->Dequeue(&stickies));
+  ASSERT_EQ(1, bin->GetStats().collectedVersions);
+  ASSERT_EQ(0, bin->GetStats().reclaimedVersions);
+}
+
+TEST_F(GarbageBinTest, reclaimsPassedEpochsTest) {
+  kill_version(0, 1);
+  kill_version(1, 2);
+  kill_version(2, 3);
+
+  // Only the first two epochs have been finished by every executor.
+  lowWatermark = 2;
+  bin->Poll();
+
+  MVRecordList stickies;
+  ASSERT_TRUE(stickyQueue->Dequeue(&stickies));
+  ASSERT_EQ(2, stickies.count);
+  ASSERT_EQ(&versions[0], stickies.head);
+  ASSERT_EQ(&versions[1], versions[0].allocLink);
+
+  RecordList records;
+  ASSERT_TRUE(recordQueue->Dequeue(&records));
+  ASSERT_EQ(2, records.count);
+  ASSERT_EQ(&payloads[0], records.head);
+  ASSERT_EQ(nullptr, versions[0].value);
+
+  ASSERT_EQ(3, bin->GetStats().collectedVersions);
+  ASSERT_EQ(2, bin->GetStats().reclaimedVersions);
+  ASSERT_EQ(2, bin->GetStats().reclaimedPayloads);
+}
+
+TEST_F(GarbageBinTest, skipsTakenOverPayloadsTest) {
+  versions[0].value = NULL;
+  kill_version(0, 1);
+  lowWatermark = 1;
+  bin->Poll();
+
+  MVRecordList stickies;
+  ASSERT_TRUE(stickyQueue->Dequeue(&stickies));
+  ASSERT_EQ(1, stickies.count);
+
+  RecordList records;
+  ASSERT_FALSE(recordQueue->Dequeue(&records));
+  ASSERT_EQ(0, bin->GetStats().reclaimedPayloads);
+}
+
+TEST_F(GarbageBinTest, mergesGenerationsTest) {
+  // More outstanding epochs than generations. The newest are merged, so
+  // nothing may be reclaimed before the last of them has been passed.
+  for (unsigned int i = 0; i < VERSIONS; i++) {
+    kill_version(i, i + 1);
+  }
+
+  lowWatermark = VERSIONS - 1;
+  bin->Poll();
+  ASSERT_EQ(GC_GENERATIONS - 1, bin->GetStats().reclaimedVersions);
+
+  lowWatermark = VERSIONS;
+  bin->Poll();
+  ASSERT_EQ(VERSIONS, bin->GetStats().reclaimedVersions);
+}
+
+TEST_F(GarbageBinTest, batchesWhileBusyTest) {
+  kill_version(0, 1);
+  lowWatermark = 1;
+
+  // A busy executor holds on to small batches...
+  bin->FinishEpoch(2);
+  MVRecordList stickies;
+  ASSERT_FALSE(stickyQueue->Dequeue(&stickies));
+  ASSERT_EQ(1, bin->GetStats().reclaimedVersions);
+
+  // ...and hands them back once it goes idle.
+  bin->Poll();
+  ASSERT_TRUE(stickyQueue->Dequeue(&stickies));
+  ASSERT_EQ(1, stickies.count);
+}
+
+TEST_F(GarbageBinTest, unlinksReclaimedVersionsTest) {
+  // versions[1] killed versions[0], which was the epoch ancestor of both.
+  versions[1].recordLink = &versions[0];
+  versions[1].epoch_ancestor = &versions[0];
+  versions[2].recordLink = &versions[1];
+  versions[2].epoch_ancestor = &versions[0];
+  versions[2].link = &versions[3];
+  kill_version(0, 1);
+  kill_version(1, 2);
+  kill_version(2, 3);
+
+  lowWatermark = 2;
+  bin->Poll();
+
+  // Reclaimed versions go back to the pool without links into the chain...
+  for (unsigned int i = 0; i < 2; i++) {
+    ASSERT_EQ(nullptr, versions[i].recordLink);
+    ASSERT_EQ(nullptr, versions[i].epoch_ancestor);
+  }
+
+  // ...while versions the low-water mark has not passed keep theirs.
+  ASSERT_EQ(&versions[1], versions[2].recordLink);
+  ASSERT_EQ(&versions[0], versions[2].epoch_ancestor);
+  ASSERT_EQ(&versions[3], versions[2].link);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <hek_table.h>
+#include <hek_action.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+class HekTableTest : public testing::Test {
+protected:
+  const uint64_t KEY = 3;
+  const uint32_t VERSIONS = 4;
+
+  // Stands in for the writing txn, which the table never dereferences on
+  // insert, commit or abort.
+  alignas(256) char txn[256];
+  hek_table* table;
+  std::vector<hek_record*> versions;
+
+  virtual void SetUp() {
+    table = new hek_table(KEY + 1, 0, 0);
+    hek_record* rec = new_record();
+    rec->begin = 0;
+    table->force_insert(rec);
+    table->finish_init();
+    versions.push_back(rec);
+  }
+
+  hek_record* new_record() {
+    hek_record* rec = (hek_record*)malloc(sizeof(hek_record));
+    rec->next = NULL;
+    rec->begin = (uint64_t)txn | PREPARING;
+    rec->end = HEK_INF;
+    rec->key = KEY;
+    return rec;
+  }
+
+  hek_record* insert(uint64_t watermark) {
+    hek_record* garbage;
+    hek_record* rec = new_record();
+    uint64_t end = CREATE_PREP_TIMESTAMP((uint64_t)versions.size());
+    EXPECT_TRUE(table->insert_version<ISOLATION_SERIALIZABLE>(
+        rec, 0, end, watermark, &garbage));
+    versions.push_back(rec);
+    return garbage;
+  }
+
+  // Version i commits at time i*256.
+  void write_versions() {
+    for (uint32_t i = 1; i < VERSIONS; i++) {
+      ASSERT_EQ(NULL, insert(0));
+      table->finalize_version(versions[i], CREATE_EXEC_TIMESTAMP(i));
+    }
+  }
+
+  uint64_t visible_at(uint64_t ts) {
+    uint64_t begin, txn_ts;
+    hek_record* rec = table->get_version(KEY, ts, &begin, &txn_ts);
+    for (uint32_t i = 0; i < versions.size(); i++)
+      if (versions[i] == rec)
+        return i;
+    return versions.size();
+  }
+};
+
+// Versions which ended before the watermark are unlinked on the next write,
+// those still readable at the watermark stay.
+TEST_F(HekTableTest, unlinkTest) {
+  write_versions();
+  hek_record* garbage = insert(CREATE_EXEC_TIMESTAMP(2) + 16);
+  ASSERT_EQ(versions[1], garbage);
+  ASSERT_EQ(versions[0], garbage->next);
+  ASSERT_EQ(NULL, versions[0]->next);
+  ASSERT_EQ(NULL, versions[2]->next);
+
+  table->finalize_version(versions[VERSIONS], CREATE_EXEC_TIMESTAMP(VERSIONS));
+  ASSERT_EQ(2u, visible_at(CREATE_EXEC_TIMESTAMP(2) + 16));
+  ASSERT_EQ(3u, visible_at(CREATE_EXEC_TIMESTAMP(3) + 16));
+  ASSERT_EQ(VERSIONS, visible_at(CREATE_EXEC_TIMESTAMP(VERSIONS) + 16));
+}
+
+// A version ending exactly at the watermark is still visible to the oldest
+// txn, and the newest committed version is never garbage.
+TEST_F(HekTableTest, boundaryTest) {
+  write_versions();
+  ASSERT_EQ(versions[0], insert(CREATE_EXEC_TIMESTAMP(2)));
+  ASSERT_EQ(NULL, versions[1]->next);
+  table->remove_version(versions[VERSIONS]);
+  versions.pop_back();
+
+  ASSERT_EQ(versions[2], insert(HEK_INF));
+  ASSERT_EQ(NULL, versions[VERSIONS - 1]->next);
+}
+
+// Aborting a write restores the previous version, but not the unlinked ones.
+TEST_F(HekTableTest, abortTest) {
+  write_versions();
+  ASSERT_EQ(versions[0], insert(CREATE_EXEC_TIMESTAMP(1) + 16));
+  table->remove_version(versions[VERSIONS]);
+  versions.pop_back();
+
+  ASSERT_EQ(HEK_INF, versions[VERSIONS - 1]->end);
+  ASSERT_EQ(1u, visible_at(CREATE_EXEC_TIMESTAMP(1) + 16));
+  ASSERT_EQ(VERSIONS - 1, visible_at(HEK_INF));
+}
+
+// A txn which ends before the latest committed version began cannot write
+// over it.
+TEST_F(HekTableTest, orderTest) {
+  hek_record* garbage;
+  write_versions();
+  hek_record* rec = new_record();
+  uint64_t latest = VERSIONS - 1;
+  uint64_t end = CREATE_PREP_TIMESTAMP(latest);
+  ASSERT_FALSE(table->insert_version<ISOLATION_SERIALIZABLE>(
+      rec, 0, end, HEK_INF, &garbage));
+  ASSERT_EQ(NULL, garbage);
+  ASSERT_EQ(HEK_INF, versions[VERSIONS - 1]->end);
+  ASSERT_EQ(VERSIONS - 1, visible_at(HEK_INF));
+  free(rec);
+
+  ASSERT_EQ(versions[2], insert(HEK_INF));
+}
+
+// Under snapshot isolation, a txn cannot overwrite a version committed since
+// it began, even if it would serialize after it.
+TEST_F(HekTableTest, snapshotTest) {
+  hek_record* garbage;
+  write_versions();
+  hek_record* rec = new_record();
+  uint64_t before = VERSIONS - 2;
+  uint64_t after = VERSIONS - 1;
+  uint64_t next = VERSIONS;
+  uint64_t end = CREATE_PREP_TIMESTAMP(next);
+  ASSERT_FALSE(table->insert_version<ISOLATION_SNAPSHOT>(
+      rec, CREATE_EXEC_TIMESTAMP(before) + 16, end, 0, &garbage));
+  ASSERT_EQ(VERSIONS - 1, visible_at(HEK_INF));
+
+  ASSERT_TRUE(table->insert_version<ISOLATION_SERIALIZABLE>(
+      rec, CREATE_EXEC_TIMESTAMP(before) + 16, end, 0, &garbage));
+  table->remove_version(rec);
+  ASSERT_TRUE(table->insert_version<ISOLATION_SNAPSHOT>(
+      rec, CREATE_EXEC_TIMESTAMP(after) + 16, end, 0, &garbage));
+}
+
+// A key has a single writer at a time. The next one may write once the
+// write aborts, or overwrite it once it commits.
+TEST_F(HekTableTest, conflictTest) {
+  hek_record* garbage;
+  alignas(256) char other_txn[256];
+  write_versions();
+  ASSERT_EQ(NULL, insert(0));
+  hek_record* rec = new_record();
+  rec->begin = (uint64_t)other_txn | PREPARING;
+  uint64_t next = VERSIONS + 1;
+  uint64_t end = CREATE_PREP_TIMESTAMP(next);
+  ASSERT_FALSE(table->insert_version<ISOLATION_SERIALIZABLE>(
+      rec, 0, end, 0, &garbage));
+
+  table->remove_version(versions[VERSIONS]);
+  versions.pop_back();
+  ASSERT_TRUE(table->insert_version<ISOLATION_SERIALIZABLE>(
+      rec, 0, end, 0, &garbage));
+  versions.push_back(rec);
+  table->finalize_version(rec, CREATE_EXEC_TIMESTAMP(next));
+  ASSERT_EQ(VERSIONS, visible_at(HEK_INF));
+  ASSERT_EQ(VERSIONS - 1, visible_at(CREATE_EXEC_TIMESTAMP(next)));
+
+  rec = new_record();
+  next++;
+  end = CREATE_PREP_TIMESTAMP(next);
+  ASSERT_TRUE(table->insert_version<ISOLATION_SERIALIZABLE>(
+      rec, 0, end, 0, &garbage));
+}
+
+// Writers racing on a key commit one at a time, and leave a chain of versions
+// in timestamp order.
+TEST_F(HekTableTest, concurrentTest) {
+  const uint32_t THREADS = 4;
+  const uint32_t WRITES = 1000;
+  std::atomic<uint64_t> time(1);
+  std::vector<std::thread> threads;
+
+  for (uint32_t i = 0; i < THREADS; i++) {
+    threads.emplace_back([&]() {
+      alignas(256) char writer[256];
+      hek_record* garbage;
+      hek_record* rec = NULL;
+      for (uint32_t j = 0; j < WRITES; j++) {
+        if (rec == NULL) {
+          rec = new_record();
+          rec->begin = (uint64_t)writer | PREPARING;
+        }
+        uint64_t ts = time++;
+        uint64_t end = CREATE_PREP_TIMESTAMP(ts);
+        if (table->insert_version<ISOLATION_SERIALIZABLE>(
+                rec, 0, end, 0, &garbage)) {
+          table->finalize_version(rec, CREATE_EXEC_TIMESTAMP(ts));
+          rec = NULL;
+        }
+      }
+      free(rec);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  uint64_t begin, txn_ts;
+  hek_record* newer = table->get_version(KEY, HEK_INF, &begin, &txn_ts);
+  ASSERT_EQ(HEK_INF, newer->end);
+  uint32_t num_versions = 1;
+  for (hek_record* rec = newer->next; rec != NULL; rec = rec->next) {
+    ASSERT_EQ(newer->begin, rec->end);
+    ASSERT_LT(rec->begin, newer->begin);
+    newer = rec;
+    num_versions++;
+  }
+  ASSERT_EQ(versions[0], newer);
+  ASSERT_LT(1u, num_versions);
+}
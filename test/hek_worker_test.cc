@@ -0,0 +1,378 @@
+#include <gtest/gtest.h>
+#include <hek.h>
+#include <hek_table.h>
+#include <test/test_txn.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+class HekWorkerTest : public testing::Test {
+protected:
+  static const uint32_t THREADS = 2;
+  static const uint32_t QUEUE_SIZE = 16;
+  static const uint32_t RECORDS = 16;
+  static const uint32_t RECORD_SIZE = 8;
+  static const uint64_t KEYS = 4;
+
+  volatile uint64_t global_time;
+  hek_active_begin* active_begins;
+  hek_table* tables[1];
+  uint64_t free_list_sizes[1];
+  uint32_t record_sizes[1];
+  std::vector<char*> queue_data;
+  hek_worker* workers[THREADS];
+  hek_record* initial[KEYS];
+
+  virtual void SetUp() {
+    global_time = 1;
+    active_begins = (hek_active_begin*)
+      alloc_mem(sizeof(hek_active_begin) * THREADS, 0);
+    for (uint32_t i = 0; i < THREADS; i++)
+      active_begins[i].begin = HEK_INF;
+    tables[0] = new hek_table(KEYS, 0, 0);
+    for (uint64_t key = 0; key < KEYS; key++) {
+      hek_record* rec = (hek_record*)malloc(sizeof(hek_record) + RECORD_SIZE);
+      rec->next = NULL;
+      rec->begin = 0;
+      rec->end = HEK_INF;
+      rec->key = key;
+      tables[0]->force_insert(rec);
+      initial[key] = rec;
+    }
+    tables[0]->finish_init();
+    free_list_sizes[0] = RECORDS * (sizeof(hek_record) + RECORD_SIZE);
+    record_sizes[0] = RECORD_SIZE;
+  }
+
+  virtual void TearDown() {
+    for (char* data : queue_data)
+      free(data);
+  }
+
+  SimpleQueue<hek_action*>** new_queues() {
+    SimpleQueue<hek_action*>** queues = 
+      (SimpleQueue<hek_action*>**)malloc(sizeof(void*) * THREADS);
+    for (uint32_t i = 0; i < THREADS; i++) {
+      char* data = (char*)malloc(CACHE_LINE * QUEUE_SIZE);
+      queue_data.push_back(data);
+      queues[i] = new SimpleQueue<hek_action*>(data, QUEUE_SIZE);
+    }
+    return queues;
+  }
+
+  void make_workers(hek_ts_alloc ts_alloc) {
+    hek_worker_config conf;
+    conf.global_time = &global_time;
+    conf.ts_alloc = ts_alloc;
+    conf.clock_base = rdtsc();
+    conf.active_begins = active_begins;
+    conf.num_tables = 1;
+    conf.num_threads = THREADS;
+    conf.tables = tables;
+    conf.input_queue = NULL;
+    conf.output_queue = NULL;
+    conf.free_list_sizes = free_list_sizes;
+    conf.record_sizes = record_sizes;
+    for (uint32_t i = 0; i < THREADS; i++) {
+      conf.cpu = i;
+      conf.commit_queues = new_queues();
+      conf.abort_queues = new_queues();
+      workers[i] = new (0) hek_worker(conf);
+    }
+  }
+
+  // Stand-ins for a worker beginning a txn and finishing its batch.
+  uint64_t begin_txn(uint32_t i) {
+    uint64_t begin = CREATE_EXEC_TIMESTAMP(workers[i]->get_timestamp());
+    xchgq(&active_begins[i].begin, begin);
+    return begin;
+  }
+
+  void announce_idle(uint32_t i) {
+    workers[i]->announce_idle();
+  }
+
+  uint64_t get_timestamp(uint32_t i) {
+    return workers[i]->get_timestamp();
+  }
+
+  std::vector<std::vector<uint64_t>> take_timestamps(uint32_t count) {
+    std::vector<std::vector<uint64_t>> taken(THREADS);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < THREADS; i++)
+      threads.emplace_back([this, i, count, &taken] {
+        for (uint32_t j = 0; j < count; j++)
+          taken[i].push_back(get_timestamp(i));
+      });
+    for (auto& thread : threads)
+      thread.join();
+    return taken;
+  }
+
+  uint64_t compute_watermark(uint32_t i) {
+    return workers[i]->compute_watermark();
+  }
+
+  // Hands a fresh version to worker i's GC as if it had been unlinked.
+  hek_record* add_garbage(uint32_t i) {
+    hek_record* rec = workers[i]->get_new_record(0);
+    workers[i]->add_garbage(0, rec);
+    return rec;
+  }
+
+  void collect_garbage(uint32_t i) {
+    workers[i]->collect_garbage();
+  }
+
+  bool reclaimed(uint32_t i, hek_record* rec) {
+    return workers[i]->records[0] == rec;
+  }
+
+  hek_action* new_txn() {
+    void* mem;
+    EXPECT_EQ(0, posix_memalign(&mem, 256, sizeof(hek_action)));
+    hek_action* txn = new (mem) hek_action(new TestTxn());
+    txn->latch = 0;
+    txn->dependents = NULL;
+    return txn;
+  }
+
+  hek_action* readonly_txn(std::vector<uint64_t> keys) {
+    hek_action* txn = new_txn();
+    txn->readonly = true;
+    for (uint64_t key : keys) {
+      hek_key read = {};
+      read.key = key;
+      read.table_id = 0;
+      txn->readset.push_back(read);
+    }
+    return txn;
+  }
+
+  // A writer which has taken its end timestamp, but hasn't inserted any 
+  // versions yet. Timestamps taken later by workers are after it.
+  hek_action* preparing_writer() {
+    hek_action* txn = new_txn();
+    txn->begin = CREATE_EXEC_TIMESTAMP(global_time);
+    global_time += 1;
+    txn->end = CREATE_PREP_TIMESTAMP(global_time);
+    global_time += 1;
+    return txn;
+  }
+
+  hek_record* insert(hek_action* writer, uint64_t key) {
+    hek_record* garbage;
+    hek_record* rec = (hek_record*)malloc(sizeof(hek_record) + RECORD_SIZE);
+    rec->next = NULL;
+    rec->begin = (uint64_t)writer | PREPARING;
+    rec->end = HEK_INF;
+    rec->key = key;
+    EXPECT_TRUE(tables[0]->insert_version<ISOLATION_SERIALIZABLE>(
+        rec, writer->begin, writer->end, 0, &garbage));
+    return rec;
+  }
+
+  void commit(hek_action* writer, std::vector<hek_record*> recs) {
+    uint64_t ts = HEK_TIME(writer->end);
+    xchgq(&writer->end, ts | COMMIT);
+    for (hek_record* rec : recs)
+      tables[0]->finalize_version(rec, ts);
+  }
+
+  void abort(hek_action* writer, std::vector<hek_record*> recs) {
+    xchgq(&writer->end, HEK_TIME(writer->end) | ABORT);
+    for (hek_record* rec : recs)
+      tables[0]->remove_version(rec);
+  }
+
+  void run_readonly(uint32_t i, hek_action* txn) {
+    workers[i]->run_readonly(txn);
+  }
+
+  // A serializable update txn which reads and writes the given keys.
+  hek_action* update_txn(std::vector<uint64_t> reads, 
+                         std::vector<uint64_t> writes) {
+    hek_action* txn = readonly_txn(reads);
+    txn->readonly = false;
+    txn->get_txn()->set_isolation(ISOLATION_SERIALIZABLE);
+    for (uint64_t key : writes) {
+      hek_key write = {};
+      write.key = key;
+      write.table_id = 0;
+      txn->writeset.push_back(write);
+    }
+    return txn;
+  }
+
+  void run_txn(uint32_t i, hek_action* txn) {
+    workers[i]->run_txn(txn);
+  }
+};
+
+// Every worker takes timestamps concurrently. Each worker's timestamps must 
+// increase, and no two workers may take the same one.
+static void check_timestamps(std::vector<std::vector<uint64_t>>& taken) {
+  std::vector<uint64_t> all;
+  for (auto& timestamps : taken) {
+    for (uint32_t i = 1; i < timestamps.size(); i++)
+      ASSERT_LT(timestamps[i - 1], timestamps[i]);
+    all.insert(all.end(), timestamps.begin(), timestamps.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+}
+
+// Gives a read-only txn time to read and start waiting on a writer.
+static void let_reader_wait() {
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+// A worker waiting for input doesn't hold back the watermark.
+TEST_F(HekWorkerTest, idleWatermarkTest) {
+  make_workers(HEK_TS_GLOBAL);
+  uint64_t first = begin_txn(1);
+  uint64_t second = begin_txn(0);
+  ASSERT_EQ(first, compute_watermark(0));
+
+  announce_idle(1);
+  ASSERT_EQ(HEK_INF, active_begins[1].begin);
+  ASSERT_EQ(second, compute_watermark(0));
+}
+
+// Versions unlinked while another worker was running a txn are reclaimed 
+// once that worker has gone idle, or right away if it already was.
+TEST_F(HekWorkerTest, idleReclaimTest) {
+  make_workers(HEK_TS_GLOBAL);
+  begin_txn(1);
+  begin_txn(0);
+  hek_record* rec = add_garbage(0);
+  collect_garbage(0);
+  collect_garbage(0);
+  ASSERT_FALSE(reclaimed(0, rec));
+
+  announce_idle(1);
+  collect_garbage(0);
+  ASSERT_TRUE(reclaimed(0, rec));
+
+  rec = add_garbage(0);
+  collect_garbage(0);
+  collect_garbage(0);
+  ASSERT_TRUE(reclaimed(0, rec));
+}
+
+// A worker gives up its lease when it goes idle, so its next timestamp is 
+// later than those handed out by other workers in the meantime.
+TEST_F(HekWorkerTest, idleLeaseTest) {
+  make_workers(HEK_TS_LEASE);
+  uint64_t first = get_timestamp(1);
+  uint64_t second = get_timestamp(0);
+  ASSERT_LT(first + 1, second);
+  ASSERT_EQ(first + 1, get_timestamp(1));
+
+  announce_idle(1);
+  ASSERT_LT(second, get_timestamp(1));
+}
+
+// A worker whose lease lags behind a committed txn must not end below it. 
+// Otherwise a txn which read x before the other wrote it, and writes the y the
+// other read, would validate at its stale end timestamp, and both would 
+// commit (write skew).
+TEST_F(HekWorkerTest, leaseWriteSkewTest) {
+  make_workers(HEK_TS_LEASE);
+  get_timestamp(0);
+
+  hek_action* first = update_txn({1}, {0});
+  run_txn(1, first);
+  ASSERT_EQ(COMMIT, HEK_STATE(first->end));
+
+  hek_action* second = update_txn({0}, {1});
+  run_txn(0, second);
+  ASSERT_EQ(COMMIT, HEK_STATE(second->end));
+  ASSERT_LT(HEK_TIME(first->end), HEK_TIME(second->end));
+  ASSERT_EQ(first->writeset[0].value, second->readset[0].value);
+}
+
+// Leased timestamps are unique across workers, including across the leases 
+// workers take when theirs run out.
+TEST_F(HekWorkerTest, leaseTimestampTest) {
+  make_workers(HEK_TS_LEASE);
+  auto taken = take_timestamps(10 * HEK_TS_LEASE_SIZE);
+  check_timestamps(taken);
+}
+
+// Clock timestamps carry the worker's index in the low order bits, and 
+// still fit a hek timestamp.
+TEST_F(HekWorkerTest, clockTimestampTest) {
+  make_workers(HEK_TS_CLOCK);
+  auto taken = take_timestamps(10000);
+  check_timestamps(taken);
+  for (uint32_t i = 0; i < THREADS; i++)
+    for (uint64_t ts : taken[i]) {
+      ASSERT_EQ(i, ts & (THREADS - 1));
+      ASSERT_EQ(ts, CREATE_EXEC_TIMESTAMP(ts) >> 8);
+    }
+}
+
+// A read-only txn which read a version of a preparing writer waits for the 
+// writer to commit.
+TEST_F(HekWorkerTest, readonlyWaitTest) {
+  make_workers(HEK_TS_GLOBAL);
+  hek_action* writer = preparing_writer();
+  hek_record* rec = insert(writer, 0);
+  std::atomic<bool> committed(false);
+  std::thread other([&] {
+    let_reader_wait();
+    committed = true;
+    commit(writer, {rec});
+  });
+
+  hek_action* reader = readonly_txn({0, 1});
+  run_readonly(0, reader);
+  ASSERT_TRUE(committed);
+  ASSERT_EQ(rec, reader->readset[0].value);
+  ASSERT_EQ(initial[1], reader->readset[1].value);
+  other.join();
+}
+
+// If the writer aborts instead, the read-only txn is rerun and reads the 
+// previous version.
+TEST_F(HekWorkerTest, readonlyAbortTest) {
+  make_workers(HEK_TS_GLOBAL);
+  hek_action* writer = preparing_writer();
+  hek_record* rec = insert(writer, 0);
+  std::thread other([&] {
+    let_reader_wait();
+    abort(writer, {rec});
+  });
+
+  hek_action* reader = readonly_txn({0, 1});
+  run_readonly(0, reader);
+  ASSERT_EQ(initial[0], reader->readset[0].value);
+  ASSERT_EQ(initial[1], reader->readset[1].value);
+  other.join();
+}
+
+// A read-only txn which began after a writer's end timestamp sees all of its 
+// writes, even if it first read some of them before the others were 
+// inserted.
+TEST_F(HekWorkerTest, readonlySnapshotTest) {
+  make_workers(HEK_TS_GLOBAL);
+  hek_action* writer = preparing_writer();
+  hek_record* first = insert(writer, 0);
+  hek_record* second = NULL;
+  std::thread other([&] {
+    let_reader_wait();
+    second = insert(writer, 1);
+    commit(writer, {first, second});
+  });
+
+  hek_action* reader = readonly_txn({0, 1});
+  run_readonly(0, reader);
+  other.join();
+  ASSERT_EQ(first, reader->readset[0].value);
+  ASSERT_EQ(second, reader->readset[1].value);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <batch/batched_input_queue.h>
+#include <batch/per_action_input_queue.h>
+#include <batch/time_util.h>
+#include <test/test_action.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+class InputQueueTest : public testing::Test {
+protected:
+  const uint32_t batch_size = 10;
+
+  void add_actions(InputQueue& iq, unsigned int from, unsigned int to) {
+    for (unsigned int i = from; i < to; i++) {
+      iq.add_action(
+          std::unique_ptr<IBatchAction>(
+            TestAction::make_test_action_with_test_txn({}, {}, i)));
+    }
+  }
+
+  void assert_batch(
+      InputQueue::BatchActions&& batch,
+      unsigned int from,
+      unsigned int to) {
+    ASSERT_EQ(to - from, batch.size());
+    for (unsigned int i = from; i < to; i++) {
+      ASSERT_EQ(i, static_cast<TestAction*>(batch[i - from].get())->get_id());
+    }
+  }
+};
+
+TEST_F(InputQueueTest, batchedFlushTest) {
+  BatchedInputQueue iq(batch_size);
+  add_actions(iq, 0, 15);
+  assert_batch(iq.try_get_action_batch(), 0, 10);
+  ASSERT_TRUE(iq.is_empty());
+
+  iq.flush();
+  assert_batch(iq.try_get_action_batch(), 10, 15);
+  ASSERT_TRUE(iq.try_get_action_batch().empty());
+}
+
+TEST_F(InputQueueTest, perActionFullBatchesTest) {
+  PerActionInputQueue iq(batch_size);
+  ASSERT_TRUE(iq.try_get_action_batch().empty());
+
+  add_actions(iq, 0, 20);
+  assert_batch(iq.try_get_action_batch(), 0, 10);
+  assert_batch(iq.try_get_action_batch(), 10, 20);
+  ASSERT_TRUE(iq.try_get_action_batch().empty());
+}
+
+TEST_F(InputQueueTest, perActionFlushTest) {
+  PerActionInputQueue iq(batch_size);
+  add_actions(iq, 0, 15);
+  iq.flush();
+  assert_batch(iq.try_get_action_batch(), 0, 10);
+  assert_batch(iq.try_get_action_batch(), 10, 15);
+
+  // actions added after the flush are waited for.
+  add_actions(iq, 15, 20);
+  std::thread producer([this, &iq]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    add_actions(iq, 20, 25);
+  });
+  assert_batch(iq.try_get_action_batch(), 15, 25);
+  producer.join();
+}
+
+TEST_F(InputQueueTest, perActionTimeoutTest) {
+  const uint32_t timeout_us = 1000;
+  PerActionInputQueue iq(batch_size, timeout_us);
+
+  // with no idea of the arrival rate, nothing is waited for.
+  add_actions(iq, 0, 3);
+  assert_batch(iq.try_get_action_batch(), 0, 3);
+
+  // a backlog is taken whole.
+  add_actions(iq, 3, 30);
+  assert_batch(iq.try_get_action_batch(), 3, 13);
+  assert_batch(iq.try_get_action_batch(), 13, 23);
+  assert_batch(iq.try_get_action_batch(), 23, 30);
+  ASSERT_TRUE(iq.try_get_action_batch().empty());
+}
+
+TEST_F(InputQueueTest, perActionAdaptiveTest) {
+  const uint32_t timeout_us = 1000;
+  PerActionInputQueue iq(batch_size, timeout_us);
+
+  // a quick burst makes the rate high, so the next batch waits for more 
+  // actions, but never longer than the timeout.
+  add_actions(iq, 0, 1);
+  assert_batch(iq.try_get_action_batch(), 0, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  add_actions(iq, 1, 1001);
+  for (unsigned int i = 1; i < 1001; i += batch_size) {
+    assert_batch(iq.try_get_action_batch(), i, i + batch_size);
+  }
+
+  ASSERT_GT(iq.get_arrival_rate_per_us(), 0);
+  add_actions(iq, 1001, 1002);
+  uint64_t start = TimeUtilities::now_ns();
+  assert_batch(iq.try_get_action_batch(), 1001, 1002);
+  ASSERT_GE(TimeUtilities::now_ns() - start, timeout_us * 1000);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <batch/latency_histogram.h>
+
+TEST(LatencyHistogramTest, emptyTest) {
+  LatencyHistogram h;
+  ASSERT_EQ(0, h.get_count());
+  ASSERT_EQ(0, h.get_min());
+  ASSERT_EQ(0, h.get_max());
+  ASSERT_EQ(0, h.get_value_at_percentile(50));
+  ASSERT_TRUE(h.get_buckets().empty());
+}
+
+TEST(LatencyHistogramTest, smallValuesExactTest) {
+  LatencyHistogram h(7);
+  for (uint64_t i = 1; i <= 100; i++) {
+    h.record(i);
+  }
+
+  ASSERT_EQ(100, h.get_count());
+  ASSERT_EQ(1, h.get_min());
+  ASSERT_EQ(100, h.get_max());
+  ASSERT_EQ(50.5, h.get_mean());
+  ASSERT_EQ(50, h.get_value_at_percentile(50));
+  ASSERT_EQ(99, h.get_value_at_percentile(99));
+  ASSERT_EQ(100, h.get_value_at_percentile(100));
+  ASSERT_EQ(1, h.get_value_at_percentile(0));
+  ASSERT_EQ(100, h.get_buckets().size());
+}
+
+TEST(LatencyHistogramTest, relativeErrorTest) {
+  LatencyHistogram h(7);
+  const uint64_t max = 1000000;
+  for (uint64_t i = 1; i <= max; i++) {
+    h.record(i * 1000);
+  }
+
+  // 7 bits of precision guarantee an error below 2^-6.
+  for (double p : {50.0, 90.0, 99.0, 99.9}) {
+    double expected = p / 100 * max * 1000;
+    double actual = h.get_value_at_percentile(p);
+    ASSERT_GE(actual, expected);
+    ASSERT_LE(actual, expected * (1 + 1.0 / 64));
+  }
+
+  ASSERT_EQ(max * 1000, h.get_value_at_percentile(100));
+  ASSERT_EQ(max * 1000, h.get_max());
+}
+
+TEST(LatencyHistogramTest, hugeValuesTest) {
+  LatencyHistogram h;
+  h.record(UINT64_MAX);
+  h.record(1ull << 63);
+
+  ASSERT_EQ(2, h.get_buckets().size());
+  ASSERT_EQ(UINT64_MAX, h.get_value_at_percentile(100));
+  ASSERT_LE(1ull << 63, h.get_value_at_percentile(50));
+}
+
+TEST(LatencyHistogramTest, mergeTest) {
+  LatencyHistogram a, b, all;
+  for (uint64_t i = 0; i < 10000; i++) {
+    uint64_t value = i * i;
+    (i % 2 ? a : b).record(value);
+    all.record(value);
+  }
+
+  a.merge(b);
+  ASSERT_EQ(all.get_count(), a.get_count());
+  ASSERT_EQ(all.get_min(), a.get_min());
+  ASSERT_EQ(all.get_max(), a.get_max());
+  ASSERT_EQ(all.get_mean(), a.get_mean());
+  ASSERT_EQ(all.get_buckets(), a.get_buckets());
+
+  a.reset();
+  ASSERT_EQ(0, a.get_count());
+  ASSERT_TRUE(a.get_buckets().empty());
+}
@@ -3,15 +3,12 @@
 #include "test/test_lock_stage.h"
 #include "util.h"
 
+#include <vector>
+
 class LockQueueTest : public testing::Test {
 protected:
-  std::vector<std::shared_ptr<TestLockStage>> get_test_lock_stages(unsigned int num) {
-    std::vector<std::shared_ptr<TestLockStage>> tlss; 
-    for (unsigned int i = 0; i < num; i++) {
-      tlss.push_back(std::make_shared<TestLockStage>());
-    }
-
-    return tlss;
+  std::vector<TestLockStage> get_test_lock_stages(unsigned int num) {
+    return std::vector<TestLockStage>(num);
   }
 };
 
@@ -19,20 +16,42 @@ TEST_F(LockQueueTest, BatchLockQueue_non_concurrent_push_tailTest) {
   BatchLockQueue blq;
   auto testLockStages = get_test_lock_stages(100);
   for (unsigned int i = 0; i < 100; i ++) {
-    blq.non_concurrent_push_tail(testLockStages[i]);
+    blq.non_concurrent_push_tail(&testLockStages[i]);
 
     // the tail moves while the head remains.
-    ASSERT_EQ(testLockStages[i], *blq.peek_tail());
-    ASSERT_EQ(testLockStages[0], *blq.peek_head());
+    ASSERT_EQ(&testLockStages[i], blq.peek_tail());
+    ASSERT_EQ(&testLockStages[0], blq.peek_head());
   }
 
   // the queue is well formed
-  std::shared_ptr<BatchLockQueue::QueueElt> curr = blq.peek_head_elt();
+  LockStage* curr = blq.peek_head();
   for (unsigned int i = 0; i < 100; i++) {
-    if (i != 99) ASSERT_EQ(testLockStages[i], *curr->get_contents());
+    ASSERT_EQ(&testLockStages[i], curr);
 
-    curr = curr->get_next_elt();
+    curr = curr->get_next_stage();
   }
 
-  ASSERT_EQ(nullptr, blq.peek_tail_elt()->get_next_elt());
+  ASSERT_EQ(nullptr, blq.peek_tail()->get_next_stage());
 } 
+
+TEST_F(LockQueueTest, LockQueue_merge_and_popTest) {
+  auto testLockStages = get_test_lock_stages(20);
+  BatchLockQueue blqs[2];
+  for (unsigned int i = 0; i < 20; i++) {
+    blqs[i / 10].non_concurrent_push_tail(&testLockStages[i]);
+  }
+
+  LockQueue lq;
+  ASSERT_TRUE(lq.is_empty());
+  lq.merge_queue(&blqs[0]);
+  lq.merge_queue(&blqs[1]);
+  ASSERT_EQ(&testLockStages[19], lq.peek_tail());
+
+  for (unsigned int i = 0; i < 20; i++) {
+    ASSERT_EQ(&testLockStages[i], lq.peek_head());
+    lq.pop_head();
+  }
+
+  ASSERT_TRUE(lq.is_empty());
+  ASSERT_EQ(nullptr, lq.peek_tail());
+}
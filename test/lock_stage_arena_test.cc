@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include "batch/lock_stage_arena.h"
+#include "test/test_action.h"
+
+#include <memory>
+
+class LockStageArenaTest : public testing::Test {
+protected:
+  LockStageArena arena;
+
+  // allocate enough stages for batch to span two chunks.
+  std::weak_ptr<IBatchAction> fill_batch(uint64_t batch) {
+    std::shared_ptr<IBatchAction> act = 
+      std::make_shared<TestAction>(new TestTxn());
+    std::weak_ptr<IBatchAction> weak_act = act;
+
+    arena.start_batch(batch);
+    for (unsigned int i = 0; i < LOCK_STAGES_PER_CHUNK + 1; i++) {
+      LockStage* ls = arena.new_stage(act.get(), LockType::exclusive);
+      EXPECT_EQ(1, ls->get_holders());
+      EXPECT_EQ(nullptr, ls->get_next_stage());
+    }
+    arena.retain_action(std::move(act));
+
+    return weak_act;
+  }
+};
+
+TEST_F(LockStageArenaTest, keepsActionsAliveTest) {
+  auto act = fill_batch(0);
+  ASSERT_FALSE(act.expired());
+  ASSERT_EQ(2, arena.get_live_chunks_count());
+}
+
+// Stages may not be reclaimed until every executor finished the batch 
+// and every batch started at that point.
+TEST_F(LockStageArenaTest, waitsForGracePeriodTest) {
+  auto act = fill_batch(0);
+  fill_batch(1);
+  arena.start_batch(2);
+
+  // batch 0 is not finished by every executor.
+  arena.reclaim(0, 2);
+  ASSERT_EQ(4, arena.get_live_chunks_count());
+
+  // batch 0 is finished, but batches up to 3 may still refer to it.
+  arena.reclaim(1, 3);
+  ASSERT_EQ(4, arena.get_live_chunks_count());
+  arena.reclaim(2, 3);
+  ASSERT_EQ(4, arena.get_live_chunks_count());
+  ASSERT_FALSE(act.expired());
+
+  arena.reclaim(3, 3);
+  ASSERT_EQ(0, arena.get_live_chunks_count());
+  ASSERT_TRUE(act.expired());
+}
+
+TEST_F(LockStageArenaTest, reusesChunksTest) {
+  fill_batch(0);
+  arena.start_batch(1);
+  arena.reclaim(1, 1);
+  ASSERT_EQ(0, arena.get_live_chunks_count());
+
+  fill_batch(1);
+  ASSERT_EQ(2, arena.get_live_chunks_count());
+}
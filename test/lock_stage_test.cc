@@ -29,8 +29,12 @@ protected:
     ASSERT_EQ(TestLockStage(ls1), TestLockStage(ls2));
   }
 
-  std::shared_ptr<TestAction> get_action() {
-    return std::make_shared<TestAction>(new TestTxn());
+  // lock stages do not own actions. Keep them alive for the test.
+  std::vector<std::shared_ptr<TestAction>> actions;
+
+  TestAction* get_action() {
+    actions.push_back(std::make_shared<TestAction>(new TestTxn()));
+    return actions.back().get();
   };
 };
 
@@ -40,7 +44,7 @@ TEST_F(LockStageTest, constructorTests) {
   expect_requesting_actions_to_be(ls1, LockStage::RequestingActions({}));
   expect_lock_type_to_be(ls1, LockType::shared);
 
-  std::shared_ptr<TestAction> requester = get_action(); 
+  TestAction* requester = get_action(); 
   LockStage ls2(
       {requester},
       LockType::exclusive);
@@ -124,7 +128,7 @@ TEST_F(LockStageTest, decrement_holdersTest) {
 
 TEST_F(LockStageTest, notify_lock_obtainedTest) {
   LockStage ls;
-  std::vector<std::shared_ptr<TestAction>> acts;
+  std::vector<TestAction*> acts;
   for (unsigned int i = 0; i < 3; i++) {
     auto act = get_action();
     act->add_write_key({i});
@@ -141,7 +145,7 @@ TEST_F(LockStageTest, notify_lock_obtainedTest) {
 
 TEST_F(LockStageTest, finalize_actionTest) {
   LockStage ls;
-  std::vector<std::shared_ptr<TestAction>> acts;
+  std::vector<TestAction*> acts;
   for (unsigned int i = 0; i < 3; i++) {
     auto act = get_action();
     act->add_write_key({i});
@@ -156,3 +160,23 @@ TEST_F(LockStageTest, finalize_actionTest) {
 
   ASSERT_TRUE(ls.finalize_action(acts[2]));
 };
+
+// Shared stages with more requesters than fit inline remain well formed.
+TEST_F(LockStageTest, manyRequestersTest) {
+  LockStage ls;
+  std::vector<TestAction*> acts;
+  for (unsigned int i = 0; i < 4 * INLINE_REQUESTERS; i++) {
+    acts.push_back(get_action());
+    ASSERT_TRUE(ls.add_to_stage(acts[i], LockType::shared));
+  }
+
+  const LockStage::RequestingActions& r = ls.get_requesters();
+  ASSERT_EQ(acts.size(), r.size());
+  for (auto act : acts) {
+    ASSERT_TRUE(r.find(act) != r.end());
+  }
+  ASSERT_TRUE(r.find(get_action()) == r.end());
+
+  LockStage copy(ls);
+  expect_lock_stages_to_equal(ls, copy);
+};
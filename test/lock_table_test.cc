@@ -4,6 +4,7 @@
 #include "test/test_lock_table.h"
 
 #include <memory>
+#include <unordered_set>
 #include <thread>
 
 TEST(BatchLockTable, constructorTest) {
@@ -18,6 +19,64 @@ TEST(BatchLockTable, insert_lock_requestTest) {
   ASSERT_EQ(1, blt.get_lock_table_data().size());
 }
 
+// Queues are sorted on key and the stages within a queue follow the
+// order in which the requests were inserted.
+TEST(BatchLockTable, buildTest) {
+  // keys large enough for the sort to take several passes.
+  std::vector<RecordKey> keys = {
+    {1 << 30, 0}, {3, 1}, {7, 0}, {1 << 20, 1}, {0, 0}, {1 << 12, 2}
+  };
+  std::vector<std::shared_ptr<TestAction>> acts;
+  BatchLockTable blt;
+  for (unsigned int i = 0; i < 3 * keys.size(); i++) {
+    acts.push_back(std::shared_ptr<TestAction>(
+          TestAction::make_test_action_with_test_txn(
+            {keys[i % keys.size()], keys[(i + 1) % keys.size()]}, {}, i)));
+    blt.insert_lock_request(acts.back());
+  }
+
+  const auto& data = blt.get_lock_table_data();
+  ASSERT_TRUE(blt.is_built());
+  ASSERT_EQ(keys.size(), data.size());
+  for (unsigned int i = 1; i < data.size(); i++) {
+    ASSERT_TRUE(data[i - 1].first < data[i].first);
+  }
+
+  for (auto& elt : data) {
+    uint64_t last_id = 0;
+    unsigned int stages = 0;
+    for (LockStage* ls = elt.second.peek_head(); 
+        ls != nullptr; 
+        ls = ls->get_next_stage()) {
+      ASSERT_EQ(1, ls->get_requesters().size());
+      uint64_t id = static_cast<TestAction*>(
+          *ls->get_requesters().begin())->get_id();
+      ASSERT_TRUE(stages == 0 || last_id < id);
+      last_id = id;
+      stages ++;
+    }
+
+    ASSERT_EQ(6, stages);
+  }
+}
+
+TEST(LockTable, merge_batch_table_forTest) {
+  BatchLockTable blt;
+  for (uint64_t i = 0; i < 10; i++) {
+    blt.insert_lock_request(
+        std::shared_ptr<TestAction>(
+          TestAction::make_test_action_with_test_txn({i},{})));
+  }
+  blt.build();
+
+  TestLockTable lt;
+  lt.merge_batch_table_for(blt, 3, 5);
+  ASSERT_EQ(3, lt.get_lock_table_data().size());
+  for (uint64_t i = 0; i < 10; i++) {
+    ASSERT_EQ(i >= 3 && i <= 5, lt.get_lock_queue(i) != nullptr);
+  }
+}
+
 TEST(LockTable, merge_batch_tableTest) {
   BatchLockTable blt;
   blt.insert_lock_request(
@@ -30,6 +89,83 @@ TEST(LockTable, merge_batch_tableTest) {
   ASSERT_EQ(6, lt.get_lock_table_data().size());
 }
 
+DBStorageConfig get_dense_and_sparse_config() {
+  DBStorageConfig conf;
+  conf.tables_definitions = {
+    {.table_id = 0, .num_records = 10},
+    {.table_id = 1, .num_records = 10, .record_size = sizeof(uint64_t),
+      .dense_keys = false},
+    {.table_id = 2, .num_records = 10}
+  };
+
+  return conf;
+}
+
+TEST(LockTable, dense_queuesTest) {
+  TestLockTable lt(get_dense_and_sparse_config());
+  // only the sparse table is hashed.
+  ASSERT_EQ(10, lt.get_lock_table_data().size());
+
+  std::unordered_set<LockQueue*> queues;
+  for (uint64_t table = 0; table < 3; table++) {
+    for (uint64_t i = 0; i < 10; i++) {
+      LockQueue* lq = lt.get_lock_queue({i, table});
+      ASSERT_TRUE(lq != nullptr);
+      ASSERT_TRUE(lq->is_empty());
+      ASSERT_TRUE(queues.insert(lq).second);
+      if (table != 1) {
+        ASSERT_EQ(0, (uintptr_t) lq % CACHE_LINE);
+      }
+    }
+  }
+}
+
+TEST(LockTable, sparse_keysTest) {
+  DBStorageConfig conf;
+  conf.tables_definitions = {
+    {.table_id = 0, .num_records = 3, .record_size = sizeof(uint64_t),
+      .dense_keys = false, .keys = {7, 1000, 1ull << 40}}
+  };
+
+  TestLockTable lt(conf);
+  ASSERT_EQ(3, lt.get_lock_table_data().size());
+  for (uint64_t key : {7ull, 1000ull, 1ull << 40}) {
+    ASSERT_TRUE(lt.get_lock_queue({key, 0}) != nullptr);
+  }
+  ASSERT_TRUE(lt.get_lock_queue({0, 0}) == nullptr);
+}
+
+TEST(LockTable, merge_into_dense_queuesTest) {
+  auto first = std::shared_ptr<TestAction>(
+      TestAction::make_test_action_with_test_txn({{1, 0}, {1, 1}, {1, 2}},{}));
+  auto second = std::shared_ptr<TestAction>(
+      TestAction::make_test_action_with_test_txn({{1, 0}, {1, 1}, {1, 2}},{}));
+  BatchLockTable blt;
+  blt.insert_lock_request(first);
+  blt.insert_lock_request(second);
+
+  TestLockTable lt(get_dense_and_sparse_config());
+  lt.merge_batch_table(blt);
+  for (uint64_t table = 0; table < 3; table++) {
+    RecordKey key(1, table);
+    LockStage* head = lt.get_head_for_record(key);
+    ASSERT_TRUE(head != nullptr);
+    ASSERT_TRUE(head->has_lock());
+    ASSERT_TRUE(head->get_requesters().find(first.get()) != 
+        head->get_requesters().end());
+
+    lt.pass_lock_to_next_stage_for(key);
+    head = lt.get_head_for_record(key);
+    ASSERT_TRUE(head != nullptr);
+    ASSERT_TRUE(head->has_lock());
+    ASSERT_TRUE(head->get_requesters().find(second.get()) != 
+        head->get_requesters().end());
+
+    lt.pass_lock_to_next_stage_for(key);
+    ASSERT_EQ(nullptr, lt.get_head_for_record(key));
+  }
+}
+
 // NOTE:
 //    The test below has been commented out since we are no longer ensuring on
 //    this level that only one thread may do the merging. More may be allowed
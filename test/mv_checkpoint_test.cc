@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <mv_checkpoint.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Exposes the low-water mark of a leader executor which never runs.
+class CheckpointTestExecutor : public Executor {
+public:
+  CheckpointTestExecutor(ExecutorConfig config) : Executor(config) {}
+
+  using Executor::adjust_lowwatermark;
+};
+
+class MVCheckpointTest : public testing::TestWithParam<MVIndexType> {
+protected:
+  static const uint32_t PARTITIONS = 2;
+  const uint32_t RECORDS = 64;
+  const uint32_t VERSIONS = 3;
+
+  char dir[64];
+  uint64_t record_size = sizeof(uint64_t);
+  MVTablePartition* partitions[PARTITIONS];
+  MVCheckpointer* checkpointer;
+  volatile uint32_t checkpoint_word = MV_CKPT_IDLE;
+  volatile uint32_t low_water_mark = 0;
+
+  virtual void SetUp() {
+    strcpy(dir, "/tmp/mv_checkpoint_test_XXXXXX");
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    for (uint32_t i = 0; i < PARTITIONS; i++) {
+      MVRecordAllocator* alloc = new (0) MVRecordAllocator(
+          sizeof(MVRecord) * RECORDS * VERSIONS, 0, 0, 0);
+      partitions[i] = MVTablePartition::Create(GetParam(), RECORDS, 0, alloc);
+    }
+
+    MVCheckpointerConfig conf = {0, dir, 0, 1, &record_size, PARTITIONS,
+                                 partitions, &checkpoint_word,
+                                 &low_water_mark};
+    checkpointer = new (0) MVCheckpointer(conf);
+  }
+
+  virtual void TearDown() {
+    std::string d(dir);
+    for (uint32_t epoch = 1; epoch <= VERSIONS + 1; epoch++)
+      unlink((d + "/mv_checkpoint_" + std::to_string(epoch) + "_0").c_str());
+    unlink((d + "/mv_checkpoint").c_str());
+    rmdir(dir);
+  }
+
+  // Every key's value in an epoch is key*epoch. Keys are spread across the
+  // partitions, and each epoch after the first inserts a new key.
+  void write_versions() {
+    for (uint32_t epoch = 1; epoch <= VERSIONS; epoch++) {
+      for (uint64_t key = 0; key < RECORDS - VERSIONS + epoch; key++) {
+        CompositeKey pkey(false, 0, key);
+        partitions[key % PARTITIONS]->WriteNewVersion(
+            pkey, nullptr, CREATE_MV_TIMESTAMP(epoch, key));
+        Record* rec = (Record*)malloc(sizeof(Record) + record_size);
+        *(uint64_t*)rec->value = key * epoch;
+        pkey.value->value = rec;
+      }
+    }
+  }
+
+  // A leader executor which shares the checkpoint word and low-water mark
+  // with the checkpointer, and has finished up to *epoch.
+  CheckpointTestExecutor* leader(volatile uint32_t* epoch,
+                                 std::vector<char>* channel_data) {
+    static const unsigned int QUEUE_SIZE = 16;
+    static uint64_t allocator_sizes[1] = {16};
+
+    channel_data->resize(2 * CACHE_LINE * QUEUE_SIZE);
+    SimpleQueue<MVRecordList>** cc_channels = new SimpleQueue<MVRecordList>*[1];
+    SimpleQueue<RecordList>** worker_channels = new SimpleQueue<RecordList>*[1];
+    cc_channels[0] = new SimpleQueue<MVRecordList>(
+        channel_data->data(), QUEUE_SIZE);
+    worker_channels[0] = new SimpleQueue<RecordList>(
+        channel_data->data() + CACHE_LINE * QUEUE_SIZE, QUEUE_SIZE);
+
+    GarbageBinConfig gc_config = {
+      1,
+      1,
+      1,
+      0,
+      &low_water_mark,
+      cc_channels,
+      worker_channels,
+    };
+    ExecutorConfig config = {
+      0,
+      1,
+      0,
+      epoch,
+      &low_water_mark,
+      &checkpoint_word,
+      NULL,
+      NULL,
+      1,
+      &record_size,
+      allocator_sizes,
+      1,
+      worker_channels[0],
+      gc_config,
+    };
+    return new (0) CheckpointTestExecutor(config);
+  }
+
+  std::map<uint64_t, uint64_t> read(uint32_t* epoch) {
+    std::map<uint64_t, uint64_t> ret;
+    *epoch = MVCheckpointer::Read(dir,
+        [&ret](uint32_t table_id, uint64_t key, const char* value) {
+          EXPECT_EQ(0u, table_id);
+          EXPECT_EQ(0u, ret.count(key));
+          ret[key] = *(uint64_t*)value;
+        });
+    return ret;
+  }
+};
+
+// A checkpoint holds exactly the versions visible at the end of its epoch,
+// even though later versions exist.
+TEST_P(MVCheckpointTest, snapshotTest) {
+  uint32_t epoch;
+
+  write_versions();
+  checkpointer->Write(2);
+  auto records = read(&epoch);
+  ASSERT_EQ(2u, epoch);
+  ASSERT_EQ(RECORDS - 1, records.size());
+  for (auto& r : records)
+    ASSERT_EQ(r.first * 2, r.second);
+}
+
+// The manifest moves on to the newest checkpoint, and the previous one is
+// removed.
+TEST_P(MVCheckpointTest, replaceTest) {
+  uint32_t epoch;
+
+  write_versions();
+  checkpointer->Write(1);
+  checkpointer->Write(VERSIONS);
+  auto records = read(&epoch);
+  ASSERT_EQ(VERSIONS, epoch);
+  ASSERT_EQ(RECORDS, records.size());
+  for (auto& r : records)
+    ASSERT_EQ(r.first * VERSIONS, r.second);
+
+  std::string old_file = std::string(dir) + "/mv_checkpoint_1_0";
+  ASSERT_NE(0, access(old_file.c_str(), F_OK));
+}
+
+// The leader executor turns a checkpoint request into the epoch after the
+// newest one started, and holds the low-water mark at that epoch until the
+// checkpoint has been written, even once every executor is past it.
+TEST_P(MVCheckpointTest, pinTest) {
+  volatile uint32_t executor_epoch = VERSIONS;
+  std::vector<char> channel_data;
+  CheckpointTestExecutor* executor = leader(&executor_epoch, &channel_data);
+  uint32_t epoch = 0;
+
+  write_versions();
+  std::thread ckpt([&]() { epoch = checkpointer->Checkpoint(); });
+  while (checkpoint_word == MV_CKPT_IDLE ||
+         checkpoint_word == MV_CKPT_REQUEST)
+    executor->adjust_lowwatermark();
+  ASSERT_EQ(VERSIONS + 1, checkpoint_word);
+  ASSERT_EQ(VERSIONS, low_water_mark);
+
+  // The checkpointer only writes once the low-water mark reaches its epoch,
+  // so it cannot have unpinned yet.
+  executor_epoch = VERSIONS + 3;
+  executor->adjust_lowwatermark();
+  ASSERT_EQ(VERSIONS + 1, low_water_mark);
+
+  ckpt.join();
+  ASSERT_EQ(VERSIONS + 1, epoch);
+  ASSERT_EQ(MV_CKPT_IDLE, checkpoint_word);
+  auto records = read(&epoch);
+  ASSERT_EQ(VERSIONS + 1, epoch);
+  ASSERT_EQ(RECORDS, records.size());
+
+  // Once unpinned, the low-water mark moves on.
+  executor->adjust_lowwatermark();
+  ASSERT_EQ(VERSIONS + 3, low_water_mark);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    MVIndexes,
+    MVCheckpointTest,
+    testing::Values(MV_CHAINED_INDEX, MV_BUCKETED_INDEX));
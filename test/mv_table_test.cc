@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <mv_table.h>
+
+
+class MVTablePartitionTest : public testing::TestWithParam<MVIndexType> {
+protected:
+  const unsigned int RECORDS = 100;
+  const unsigned int VERSIONS = 3;
+
+  MVRecordAllocator* alloc;
+  MVTablePartition* part;
+
+  virtual void SetUp() {
+    alloc = new (0) MVRecordAllocator(
+        sizeof(MVRecord) * RECORDS * VERSIONS, 0, 0, 0);
+    // Undersize the partition so that keys share chains, and buckets fill up
+    // and overflow into their neighbours.
+    part = MVTablePartition::Create(GetParam(), RECORDS / 2, 0, alloc);
+  }
+
+  void write_versions() {
+    for (unsigned int epoch = 1; epoch <= VERSIONS; epoch++) {
+      for (unsigned int i = 0; i < RECORDS; i++) {
+        CompositeKey key(false, 0, i);
+        part->WriteNewVersion(key, nullptr, CREATE_MV_TIMESTAMP(epoch, i));
+        ASSERT_EQ(key.value->key, i);
+      }
+    }
+  }
+};
+
+TEST_P(MVTablePartitionTest, missingRecordTest) {
+  CompositeKey key(false, 0, 1);
+  ASSERT_EQ(nullptr, part->GetMVRecord(key, CREATE_MV_TIMESTAMP(1, 0)));
+}
+
+TEST_P(MVTablePartitionTest, versionLookupTest) {
+  write_versions();
+  for (unsigned int i = 0; i < RECORDS; i++) {
+    CompositeKey key(false, 0, i);
+    for (unsigned int epoch = 1; epoch <= VERSIONS; epoch++) {
+      MVRecord* rec = part->GetMVRecord(key, CREATE_MV_TIMESTAMP(epoch, i));
+      ASSERT_NE(nullptr, rec);
+      ASSERT_EQ(i, rec->key);
+      ASSERT_EQ(CREATE_MV_TIMESTAMP(epoch, i), rec->createTimestamp);
+    }
+
+    // Nothing is visible before the first version was created.
+    ASSERT_EQ(nullptr, part->GetMVRecord(key, CREATE_MV_TIMESTAMP(0, 0)));
+  }
+}
+
+TEST_P(MVTablePartitionTest, epochAncestorTest) {
+  write_versions();
+  CompositeKey key(false, 0, 5);
+  MVRecord* newest = part->GetMVRecord(key, CREATE_MV_TIMESTAMP(VERSIONS, 5));
+  ASSERT_NE(nullptr, newest);
+  ASSERT_EQ(newest->recordLink, newest->epoch_ancestor);
+  ASSERT_EQ(CREATE_MV_TIMESTAMP(VERSIONS - 1, 5),
+      newest->epoch_ancestor->createTimestamp);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    MVIndexes,
+    MVTablePartitionTest,
+    testing::Values(MV_CHAINED_INDEX, MV_BUCKETED_INDEX));
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <occ_action.h>
+
+#include <vector>
+
+// Sums the records it reads.
+class SumTxn : public txn {
+public:
+  std::vector<uint64_t> keys;
+  uint64_t sum;
+
+  SumTxn(std::vector<uint64_t> keys) : keys(keys), sum(0) {}
+
+  virtual bool Run() {
+    sum = 0;
+    for (uint64_t key : keys)
+      sum += *(uint64_t*)get_read_ref(key, 0);
+    return true;
+  }
+};
+
+// Increments the record it writes.
+class IncrTxn : public txn {
+public:
+  uint64_t key;
+
+  IncrTxn(uint64_t key) : key(key) {}
+
+  virtual bool Run() {
+    *(uint64_t*)get_write_ref(key, 0) += 1;
+    return true;
+  }
+};
+
+class OCCActionTest : public testing::Test {
+protected:
+  const uint32_t NUM_RECORDS = 16;
+  Table* table;
+  Table* tables[1];
+  Table* lock_tables[1];
+  RecordBuffers* bufs;
+  SumTxn* sum_txn;
+  OCCAction* action;
+
+  virtual void SetUp() {
+    TableConfig table_conf = {0, NUM_RECORDS, 0, 0, 2*NUM_RECORDS,
+                              OCC_RECORD_SIZE(sizeof(uint64_t)), 0};
+    table = new(0) Table(table_conf);
+    for (uint64_t key = 0; key < NUM_RECORDS; key++) {
+      record(key)[0] = CREATE_TID(1, key);
+      record(key)[1] = key;
+    }
+    table->SetInit();
+    tables[0] = table;
+
+    TableConfig lock_conf = {0, 2*NUM_RECORDS, 0, 0, 2*NUM_RECORDS,
+                             sizeof(uint64_t), sizeof(uint64_t)};
+    lock_tables[0] = new(0) Table(lock_conf);
+    uint64_t zero = 0;
+    for (uint64_t key = 0; key < NUM_RECORDS; key++)
+      lock_tables[0]->Put(key, &zero);
+    uint32_t record_size = OCC_RECORD_SIZE(sizeof(uint64_t));
+    RecordBuffersConfig buf_conf = {1, &record_size, 4, 0};
+    bufs = new(0) RecordBuffers(buf_conf);
+
+    sum_txn = new SumTxn({1, 2, 3});
+    action = new OCCAction(sum_txn);
+    sum_txn->set_translator(action);
+    for (uint64_t key : sum_txn->keys)
+      action->add_read_key(0, key);
+    action->set_tables(tables, NULL);
+  }
+
+  OCCAction* incr_action(IncrTxn* incr_txn) {
+    OCCAction* ret = new OCCAction(incr_txn);
+    incr_txn->set_translator(ret);
+    ret->add_write_key(0, incr_txn->key, true);
+    ret->set_tables(tables, lock_tables);
+    ret->set_allocator(bufs);
+    return ret;
+  }
+
+  uint64_t lock_word(uint64_t key) {
+    return *(uint64_t*)lock_tables[0]->GetAlways(key);
+  }
+
+  uint64_t* record(uint64_t key) {
+    return (uint64_t*)table->GetAlways(key);
+  }
+};
+
+// Transactions without writes read the records in the table.
+TEST_F(OCCActionTest, inPlaceTest) {
+  ASSERT_TRUE(action->read_only);
+  action->run();
+  ASSERT_EQ(6u, sum_txn->sum);
+  action->validate_read_only();
+  action->cleanup();
+}
+
+// A write to a record read since the read fails validation.
+TEST_F(OCCActionTest, overwrittenTest) {
+  action->run();
+  record(2)[0] = CREATE_TID(2, 0);
+  try {
+    action->validate_read_only();
+    FAIL();
+  } catch (const occ_validation_exception& e) {
+    ASSERT_EQ(VALIDATION_ERR, e.err);
+  }
+  action->cleanup();
+
+  action->run();
+  action->validate_read_only();
+}
+
+// So does a write which is still being installed.
+TEST_F(OCCActionTest, lockedTest) {
+  action->run();
+  record(3)[0] |= 1;
+  ASSERT_THROW(action->validate_read_only(), occ_validation_exception);
+}
+
+// Any write key disables the fast path.
+TEST_F(OCCActionTest, writerTest) {
+  action->add_write_key(0, 4, true);
+  ASSERT_FALSE(action->read_only);
+}
+
+// Txns run at the compiled in level unless told otherwise, and so do their
+// actions.
+TEST_F(OCCActionTest, isolationTest) {
+  ASSERT_EQ(DEFAULT_ISOLATION, sum_txn->get_isolation());
+  sum_txn->set_isolation(ISOLATION_SERIALIZABLE);
+  ASSERT_EQ(ISOLATION_SERIALIZABLE, action->get_isolation());
+}
+
+// Serializable writes hold the record's lock, and install the txn's TID.
+TEST_F(OCCActionTest, serializableInstallTest) {
+  IncrTxn incr_txn(5);
+  OCCAction* incr = incr_action(&incr_txn);
+  incr->run();
+  incr->acquire_locks<ISOLATION_SERIALIZABLE>();
+  ASSERT_TRUE(IS_LOCKED(record(5)[0]));
+  incr->validate();
+  uint64_t tid = incr->compute_tid(2, 0);
+  incr->install_writes<ISOLATION_SERIALIZABLE>();
+  ASSERT_EQ(tid, record(5)[0]);
+  ASSERT_EQ(6u, record(5)[1]);
+  ASSERT_EQ(0u, lock_word(5));
+  incr->cleanup();
+}
+
+// Read committed writes are ordered by the lock table, and count the
+// versions of the record.
+TEST_F(OCCActionTest, readCommittedInstallTest) {
+  IncrTxn incr_txn(5);
+  incr_txn.set_isolation(ISOLATION_READ_COMMITTED);
+  OCCAction* incr = incr_action(&incr_txn);
+  incr->run();
+  incr->acquire_locks<ISOLATION_READ_COMMITTED>();
+  ASSERT_FALSE(IS_LOCKED(record(5)[0]));
+  ASSERT_TRUE(IS_LOCKED(lock_word(5)));
+  incr->install_writes<ISOLATION_READ_COMMITTED>();
+  ASSERT_EQ(CREATE_TID(1, 5) + 0x10, record(5)[0]);
+  ASSERT_EQ(6u, record(5)[1]);
+  ASSERT_EQ(0u, lock_word(5));
+  incr->cleanup();
+}
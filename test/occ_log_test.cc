@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <occ_log.h>
+#include <occ_action.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+class OCCLogTest : public testing::Test {
+protected:
+  static const uint32_t NUM_WORKERS = 2;
+  static const uint32_t NUM_RECORDS = 16;
+  char dir[64];
+  OCCLog *log;
+  Table *table;
+
+  virtual void SetUp() {
+    strcpy(dir, "/tmp/occ_log_test_XXXXXX");
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    open_log(0);
+    table = new_table();
+  }
+
+  void open_log(uint32_t recovered_epoch) {
+    OCCLogConfig conf = {dir, NUM_WORKERS, 1, 1 << 16, 4, 0, recovered_epoch};
+    log = new OCCLog(conf);
+    log->Run();
+  }
+
+  Table* new_table() {
+    TableConfig table_conf = {0, NUM_RECORDS, 0, 0, 2*NUM_RECORDS,
+                              OCC_RECORD_SIZE(sizeof(uint64_t)), 0};
+    return new(0) Table(table_conf);
+  }
+
+  void make_durable(uint32_t epoch) {
+    for (uint32_t i = 0; i < NUM_WORKERS; ++i)
+      log->GetBuffer(i)->Refresh(epoch);
+    while (log->DurableEpoch() < epoch)
+      usleep(100);
+  }
+
+  virtual void TearDown() {
+    std::string d(dir);
+    unlink((d + "/occ_log_0").c_str());
+    unlink((d + "/occ_durable_epoch").c_str());
+    rmdir(dir);
+  }
+
+  void write(uint32_t worker, uint64_t key, uint64_t tid, uint64_t value) {
+    log->GetBuffer(worker)->Append(0, key, tid, &value, sizeof(value));
+  }
+
+  uint64_t* record(uint64_t key) {
+    return (uint64_t*)table->GetAlways(key);
+  }
+
+  uint64_t recover(uint32_t* durable_epoch) {
+    return OCCLog::Recover(dir, 1, &table, 1, durable_epoch);
+  }
+};
+
+// Refreshing every worker past an epoch makes it durable without any
+// further commits.
+TEST_F(OCCLogTest, durableEpochTest) {
+  uint32_t i;
+
+  log->GetBuffer(0)->BeginCommit(1);
+  write(0, 0, CREATE_TID(1, 1), 10);
+  ASSERT_FALSE(log->GetBuffer(0)->IsDurable(1));
+
+  for (i = 0; i < NUM_WORKERS; ++i)
+    log->GetBuffer(i)->Refresh(2);
+  while (log->DurableEpoch() < 2)
+    usleep(100);
+  ASSERT_TRUE(log->GetBuffer(0)->IsDurable(1));
+  ASSERT_FALSE(log->GetBuffer(0)->IsDurable(2));
+  log->Stop();
+}
+
+// A worker that lags behind holds back the durable epoch.
+TEST_F(OCCLogTest, laggingWorkerTest) {
+  log->GetBuffer(0)->Refresh(5);
+  log->Stop();
+  ASSERT_EQ(0, log->DurableEpoch());
+}
+
+// The write with the highest tid wins regardless of the worker which
+// logged it, and epochs which are not durable are not replayed.
+TEST_F(OCCLogTest, recoverTest) {
+  uint32_t durable;
+  uint64_t applied;
+
+  log->GetBuffer(0)->BeginCommit(1);
+  write(0, 0, CREATE_TID(1, 2), 100);
+  write(0, 1, CREATE_TID(1, 2), 101);
+  log->GetBuffer(1)->BeginCommit(1);
+  write(1, 0, CREATE_TID(1, 1), 200);
+
+  log->GetBuffer(1)->BeginCommit(2);
+  write(1, 1, CREATE_TID(2, 1), 201);
+  write(1, 2, CREATE_TID(2, 1), 202);
+
+  make_durable(3);
+
+  // Never becomes durable.
+  log->GetBuffer(0)->BeginCommit(3);
+  write(0, 3, CREATE_TID(3, 1), 103);
+  log->Stop();
+  ASSERT_EQ(3, log->DurableEpoch());
+
+  // The overwritten write to key 0 is only applied if it was logged first.
+  applied = recover(&durable);
+  ASSERT_EQ(3, durable);
+  ASSERT_LE(4, applied);
+  ASSERT_GE(5, applied);
+  ASSERT_EQ(CREATE_TID(1, 2), record(0)[0]);
+  ASSERT_EQ(100, record(0)[1]);
+  ASSERT_EQ(CREATE_TID(2, 1), record(1)[0]);
+  ASSERT_EQ(201, record(1)[1]);
+  ASSERT_EQ(202, record(2)[1]);
+  ASSERT_EQ(0, record(3)[1]);
+}
+
+// A log reopened with the recovered epoch is appended to, without the writes
+// of epochs which never became durable, even once those epochs are durable.
+TEST_F(OCCLogTest, restartTest) {
+  uint32_t durable;
+
+  log->GetBuffer(0)->BeginCommit(1);
+  write(0, 0, CREATE_TID(1, 1), 100);
+  make_durable(2);
+  log->GetBuffer(0)->BeginCommit(2);
+  write(0, 1, CREATE_TID(2, 1), 101);
+  log->Stop();
+
+  ASSERT_EQ(1, recover(&durable));
+  ASSERT_EQ(2, durable);
+  open_log(durable);
+  ASSERT_EQ(2, log->DurableEpoch());
+  log->GetBuffer(1)->BeginCommit(2);
+  write(1, 2, CREATE_TID(2, 2), 202);
+  make_durable(3);
+  log->Stop();
+
+  table = new_table();
+  ASSERT_EQ(2, recover(&durable));
+  ASSERT_EQ(3, durable);
+  ASSERT_EQ(100, record(0)[1]);
+  ASSERT_EQ(0, record(1)[1]);
+  ASSERT_EQ(202, record(2)[1]);
+}
+
+// Recovery stops at the first block whose checksum doesn't match, and the log
+// is cut back to the blocks before it.
+TEST_F(OCCLogTest, checksumTest) {
+  uint32_t durable;
+  std::string file_name = std::string(dir) + "/occ_log_0";
+  auto read_log = [&]() {
+    std::ifstream in(file_name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+  };
+  auto write_log = [&](const std::string& contents) {
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    out << contents;
+  };
+
+  log->GetBuffer(0)->BeginCommit(1);
+  write(0, 0, CREATE_TID(1, 1), 100);
+  make_durable(2);
+  log->GetBuffer(0)->BeginCommit(2);
+  write(0, 1, CREATE_TID(2, 1), 101);
+  make_durable(3);
+  log->Stop();
+  std::string contents = read_log();
+
+  // A zero-filled block reads as epoch 0, which is durable.
+  write_log(contents + std::string(sizeof(occ_log_block_header) + 64, '\0'));
+  ASSERT_EQ(2, recover(&durable));
+  ASSERT_EQ(3, durable);
+  ASSERT_EQ(100, record(0)[1]);
+  ASSERT_EQ(101, record(1)[1]);
+  ASSERT_EQ(contents, read_log());
+
+  // A damaged value in the second block.
+  uint64_t value = 101;
+  size_t pos = contents.find(std::string((char*)&value, sizeof(value)));
+  ASSERT_NE(std::string::npos, pos);
+  contents[pos] ^= 0x1;
+  write_log(contents);
+  table = new_table();
+  ASSERT_EQ(1, recover(&durable));
+  ASSERT_EQ(100, record(0)[1]);
+  ASSERT_EQ(0, record(1)[1]);
+  ASSERT_GT(contents.size(), read_log().size());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <occ_retry.h>
+
+class OCCRetryTest : public testing::Test {
+protected:
+  const uint64_t BASE = 100;
+  const uint64_t MAX = 100000;
+
+  OCCRetryPolicy* policy;
+
+  virtual void SetUp() {
+    OCCRetryConfig conf = {8, BASE, MAX};
+    policy = new (0) OCCRetryPolicy(conf);
+  }
+
+  // Drives the validation failure rate to about half.
+  void contend() {
+    for (int i = 0; i < 1000; i++) {
+      policy->Committed();
+      policy->Aborted(VALIDATION_ERR, 1);
+    }
+  }
+
+  // Drives the read failure rate to about half.
+  void contend_reads() {
+    for (int i = 0; i < 1000; i++) {
+      policy->Committed();
+      policy->Aborted(READ_ERR, 1);
+    }
+  }
+};
+
+// Without contention, validation failures are retried immediately.
+TEST_F(OCCRetryTest, uncontendedTest) {
+  for (int i = 0; i < 1000; i++)
+    policy->Committed();
+  ASSERT_EQ(0u, policy->ValidationRate());
+  ASSERT_GT(BASE, policy->Aborted(VALIDATION_ERR, 1));
+}
+
+// Under contention the delay of validation failures doubles with every
+// retry, up to the maximum.
+TEST_F(OCCRetryTest, backoffTest) {
+  contend();
+  uint64_t rate = policy->ValidationRate();
+  ASSERT_LT(OCC_RETRY_ONE / 4, rate);
+  ASSERT_GT(3 * OCC_RETRY_ONE / 4, rate);
+
+  uint64_t prev = 0;
+  for (uint32_t retries = 1; retries < 8; retries++) {
+    contend();
+    uint64_t delay = policy->Aborted(VALIDATION_ERR, retries);
+    ASSERT_LT(prev, delay);
+    prev = delay;
+  }
+  contend();
+  ASSERT_GE(MAX, policy->Aborted(VALIDATION_ERR, 1000));
+  ASSERT_LT(MAX / 4, policy->Aborted(VALIDATION_ERR, 1000));
+}
+
+// Read errors are counted separately, and validation failures don't 
+// delay them.
+TEST_F(OCCRetryTest, readErrTest) {
+  contend();
+  uint64_t validation_rate = policy->ValidationRate();
+  ASSERT_GT(BASE, policy->Aborted(READ_ERR, 1));
+  ASSERT_LT(0u, policy->ReadRate());
+  ASSERT_GT(validation_rate, policy->ValidationRate());
+}
+
+// The delay of read errors grows linearly with the retries, scaled by 
+// the worker's read failure rate.
+TEST_F(OCCRetryTest, readRateTest) {
+  for (int i = 0; i < 1000; i++)
+    policy->Committed();
+  uint64_t uncontended = policy->Aborted(READ_ERR, 4);
+
+  contend_reads();
+  uint64_t rate = policy->ReadRate();
+  ASSERT_LT(OCC_RETRY_ONE / 4, rate);
+  ASSERT_GT(3 * OCC_RETRY_ONE / 4, rate);
+  uint64_t contended = policy->Aborted(READ_ERR, 4);
+  ASSERT_LT(uncontended, contended);
+  ASSERT_LT(BASE, contended);
+  ASSERT_GT(4 * BASE, contended);
+
+  contend_reads();
+  uint64_t once = policy->Aborted(READ_ERR, 1);
+  contend_reads();
+  ASSERT_LT(once, policy->Aborted(READ_ERR, 3));
+  contend_reads();
+  ASSERT_GE(MAX, policy->Aborted(READ_ERR, 100000));
+}
@@ -6,13 +6,15 @@
 
 #include <unordered_set>
 
-class PackingTest : public testing::Test {
+// Every scenario is run with both Packer and BitmapPacker.
+class PackingTest : public testing::TestWithParam<bool> {
 private:
   typedef IBatchAction::RecordKeySet RecordKeySet;
   std::vector<RecordKeySet> readSets;
   std::vector<RecordKeySet> writeSets;
 protected:
   std::unique_ptr<ArrayContainer> testContainer;
+  std::unique_ptr<BitmapPacker> bitmapPacker;
 
   void addActionFromSets(
       RecordKeySet writeSet,
@@ -35,6 +37,9 @@ protected:
     }
 
     testContainer = std::make_unique<ArrayContainer>(std::move(actions));
+    if (GetParam()) {
+      bitmapPacker = std::make_unique<BitmapPacker>(testContainer.get());
+    }
   }
 
   std::unordered_set<uint64_t> collect_ids(
@@ -52,7 +57,9 @@ protected:
 
   void assertPackings(std::vector<std::unordered_set<uint64_t>> expected) {
     for (auto& j : expected) {
-      auto packing = Packer::get_packing(testContainer.get());
+      auto packing = GetParam() ?
+        bitmapPacker->get_packing(testContainer.get()) :
+        Packer::get_packing(testContainer.get());
       std::unordered_set<uint64_t> ids = collect_ids(packing);
       EXPECT_EQ(j, ids);
 
@@ -70,7 +77,7 @@ protected:
 // Correct packings would be:
 //    1)  T0, T2
 //    2)  T1
-TEST_F(PackingTest, smallestExclusiveResult) {
+TEST_P(PackingTest, smallestExclusiveResult) {
   addActionFromSets({1}, {}); 
   addActionFromSets({1, 3, 4}, {}); 
   addActionFromSets({2, 3}, {});
@@ -86,7 +93,7 @@ TEST_F(PackingTest, smallestExclusiveResult) {
 // Correct packing: 
 //    1) T0, T1 
 //    2) T2
-TEST_F(PackingTest, smallestLargestExclusiveResult) {
+TEST_P(PackingTest, smallestLargestExclusiveResult) {
   addActionFromSets({1}, {}); 
   addActionFromSets({2, 3, 4, 5}, {}); 
   addActionFromSets({1, 2, 4}, {});
@@ -101,7 +108,7 @@ TEST_F(PackingTest, smallestLargestExclusiveResult) {
 //    T2: 2, 3
 // Correct packing: 
 //    1) T0, T1, T2 
-TEST_F(PackingTest, smallSharedOnlyResult) {
+TEST_P(PackingTest, smallSharedOnlyResult) {
   addActionFromSets({}, {1, 3});
   addActionFromSets({}, {1, 2});
   addActionFromSets({}, {2, 3});
@@ -117,7 +124,7 @@ TEST_F(PackingTest, smallSharedOnlyResult) {
 // Correct packing:
 //    1) T0, T1
 //    2) T2
-TEST_F(PackingTest, smallMixedResult) {
+TEST_P(PackingTest, smallMixedResult) {
   addActionFromSets({2}, {1});
   addActionFromSets({3}, {1});
   addActionFromSets({}, {1, 2, 3});
@@ -126,4 +133,28 @@ TEST_F(PackingTest, smallMixedResult) {
   assertPackings({{0, 1}, {2}});
 }
 
+// Input, mixed, with packings reusing keys held by earlier packings:
+//  T0: 1, 2s
+//  T1: 2, 3s
+//  T2: 3, 1s
+//  T3: 4s
+// Correct packing:
+//    1) T0, T3
+//    2) T1
+//    3) T2
+TEST_P(PackingTest, chainedMixedResult) {
+  addActionFromSets({1}, {2});
+  addActionFromSets({2}, {3});
+  addActionFromSets({3}, {1});
+  addActionFromSets({}, {4});
+  finalizeAddingActions();
+
+  assertPackings({{0, 3}, {1}, {2}});
+}
+
+INSTANTIATE_TEST_CASE_P(
+    PackingEngines,
+    PackingTest,
+    testing::Values(false, true));
+
 // TODO: more tests with mixed cases
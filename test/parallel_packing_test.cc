@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <batch/parallel_packing.h>
+#include <batch/arr_container.h>
+#include <test/test_action.h>
+#include <test/test_txn.h>
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+// Every scenario is run by teams of different sizes.
+class ParallelPackingTest : public testing::TestWithParam<unsigned int> {
+protected:
+  typedef IBatchAction::RecordKeySet RecordKeySet;
+  std::unique_ptr<ParallelPacker> packer;
+  Container::BatchActions actions;
+
+  virtual void SetUp() {
+    packer = std::make_unique<ParallelPacker>(
+        std::vector<int>(GetParam() - 1, 0));
+  }
+
+  void addAction(RecordKeySet writeSet, RecordKeySet readSet) {
+    actions.push_back(
+        std::make_unique<TestAction>(
+          new TestTxn(), writeSet, readSet, actions.size()));
+  }
+
+  uint64_t get_id(IBatchAction* act) {
+    return dynamic_cast<TestAction*>(act)->get_id();
+  }
+
+  std::vector<std::vector<uint64_t>> pack() {
+    ArrayContainer ac(std::move(actions));
+    std::vector<std::vector<uint64_t>> ids;
+    for (auto& packing : packer->get_packings(&ac)) {
+      ids.emplace_back();
+      for (auto& act : packing) {
+        ids.back().push_back(get_id(act.get()));
+      }
+    }
+
+    EXPECT_EQ(0, ac.get_remaining_count());
+    return ids;
+  }
+
+  bool conflict(IBatchAction* a, IBatchAction* b) {
+    auto intersect = [](RecordKeySet* s1, RecordKeySet* s2) {
+      for (auto& key : *s1) {
+        if (s2->count(key) != 0) return true;
+      }
+      return false;
+    };
+
+    return intersect(a->get_writeset_handle(), b->get_writeset_handle()) ||
+      intersect(a->get_writeset_handle(), b->get_readset_handle()) ||
+      intersect(a->get_readset_handle(), b->get_writeset_handle());
+  }
+};
+
+// Input, all exclusive:
+//    T0: 1
+//    T1: 1, 3, 4
+//    T2: 2, 3
+// Correct packings would be:
+//    1)  T0, T2
+//    2)  T1
+TEST_P(ParallelPackingTest, exclusiveTest) {
+  addAction({{1, 0}}, {});
+  addAction({{1, 0}, {3, 0}, {4, 0}}, {});
+  addAction({{2, 0}, {3, 0}}, {});
+
+  std::vector<std::vector<uint64_t>> expected = {{0, 2}, {1}};
+  ASSERT_EQ(expected, pack());
+}
+
+// Input:
+//    T0: excl 1
+//    T1: shared 1, excl 10
+//    T2: shared 1, excl 11, 12
+//    T3: excl 1, 20, 21, 22
+//    T4: shared 1, excl 30, 31, 32, 33
+// Packer would pack T4 together with T1 and T2. Here, T4 must follow T3
+// which precedes it in the serial order. Correct packings would be:
+//    1)  T0
+//    2)  T1, T2
+//    3)  T3
+//    4)  T4
+TEST_P(ParallelPackingTest, sharedGroupsTest) {
+  addAction({{1, 0}}, {});
+  addAction({{10, 0}}, {{1, 0}});
+  addAction({{11, 0}, {12, 0}}, {{1, 0}});
+  addAction({{1, 0}, {20, 0}, {21, 0}, {22, 0}}, {});
+  addAction({{30, 0}, {31, 0}, {32, 0}, {33, 0}}, {{1, 0}});
+
+  std::vector<std::vector<uint64_t>> expected = {{0}, {1, 2}, {3}, {4}};
+  ASSERT_EQ(expected, pack());
+}
+
+// A key both read and written by an action is locked exclusively.
+TEST_P(ParallelPackingTest, readAndWrittenKeyTest) {
+  addAction({{1, 0}}, {{1, 0}});
+  addAction({{2, 0}, {3, 0}}, {{1, 0}});
+
+  std::vector<std::vector<uint64_t>> expected = {{0}, {1}};
+  ASSERT_EQ(expected, pack());
+}
+
+TEST_P(ParallelPackingTest, emptyBatchTest) {
+  ASSERT_EQ(0, pack().size());
+}
+
+// Packings of random batches must never order conflicting actions against
+// the serial order. The same packer is reused for every batch.
+TEST_P(ParallelPackingTest, randomBatchesTest) {
+  std::mt19937 gen(GetParam());
+  std::uniform_int_distribution<uint64_t> key_dist(0, 40);
+  std::uniform_int_distribution<unsigned int> lock_dist(0, 4);
+
+  for (unsigned int batch = 0; batch < 2; batch++) {
+    for (unsigned int i = 0; i < 100; i++) {
+      RecordKeySet writes, reads;
+      unsigned int w = lock_dist(gen), r = lock_dist(gen);
+      for (unsigned int j = 0; j < w; j++) writes.insert({key_dist(gen), 0});
+      for (unsigned int j = 0; j < r; j++) reads.insert({key_dist(gen), 0});
+      addAction(writes, reads);
+    }
+
+    ArrayContainer ac(std::move(actions));
+    std::unordered_map<uint64_t, unsigned int> serial_pos;
+    for (unsigned int i = 0; ac.peek_curr_elt() != nullptr; i++) {
+      serial_pos[get_id(ac.peek_curr_elt())] = i;
+      ac.advance_to_next_elt();
+    }
+    ac.sort_remaining();
+
+    std::vector<std::pair<IBatchAction*, unsigned int>> packed;
+    auto packings = packer->get_packings(&ac);
+    for (unsigned int p = 0; p < packings.size(); p++) {
+      for (auto& act : packings[p]) {
+        packed.push_back({act.get(), p});
+      }
+    }
+
+    ASSERT_EQ(100, packed.size());
+    for (auto& a : packed) {
+      for (auto& b : packed) {
+        if (a.first == b.first || conflict(a.first, b.first) == false) {
+          continue;
+        }
+
+        ASSERT_NE(a.second, b.second);
+        ASSERT_EQ(
+            serial_pos[get_id(a.first)] < serial_pos[get_id(b.first)],
+            a.second < b.second);
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    TeamSizes,
+    ParallelPackingTest,
+    testing::Values(1, 2, 4));
@@ -6,6 +6,7 @@
 #include <thread>
 #include <memory>
 #include <algorithm>
+#include <unistd.h>
 
 class SchedulerManagerTest :
   public testing::Test,
@@ -15,7 +16,7 @@ protected:
   std::shared_ptr<IGlobalSchedule> gs;
   std::shared_ptr<ExecutorThreadManager> etm;
 	const uint32_t batch_size = 100;
-	const uint32_t batch_length_sec = 0;
+	const uint32_t batch_timeout_us = 0;
 	const uint32_t scheduling_threads_count = 3;
   const uint32_t shards = 3;
   const uint32_t first_pin = 0;
@@ -23,9 +24,10 @@ protected:
   const SchedulingSystemConfig conf = {
 		scheduling_threads_count,
 		batch_size,
-		scheduling_threads_count,
+		batch_timeout_us,
     first_pin,
-    shards
+    shards,
+    1
 	};
   const DBStorageConfig db_conf = {
     .tables_definitions = {{
@@ -74,6 +76,75 @@ TEST_F(SchedulerManagerTest, obtain_batchNonConcurrentTest) {
   ASSERT_EQ(batch_size, batch.batch.size());
 };
 
+// merging stages split the declared keys of all tables between them, 
+// including the sparse keys and those of tables other than the first.
+TEST(SchedulerManagerStagesTest, get_stage_rangesTest) {
+  DBStorageConfig db_conf;
+  db_conf.tables_definitions = {
+    {.table_id = 1, .num_records = 3, .record_size = sizeof(uint64_t),
+      .dense_keys = false, .keys = {1ull << 40, 5, 1000}},
+    {.table_id = 0, .num_records = 10}
+  };
+  std::vector<RecordKey> keys;
+  for (uint64_t i = 0; i < 10; i++) keys.push_back({i, 0});
+  for (uint64_t key : {5ull, 1000ull, 1ull << 40}) keys.push_back({key, 1});
+
+  auto ranges = SchedulerManager::get_stage_ranges(db_conf, 4);
+  ASSERT_EQ(4, ranges.size());
+  ASSERT_EQ(keys.front(), ranges.front().first);
+  ASSERT_EQ(keys.back(), ranges.back().second);
+  for (auto& key : keys) {
+    unsigned int containing = 0;
+    for (auto& range : ranges) {
+      if (!(key < range.first) && !(range.second < key)) containing++;
+    }
+    ASSERT_EQ(1, containing);
+  }
+};
+
+// a partial batch is handed out once the timeout expires, even though
+// the actions have never been flushed.
+TEST_F(SchedulerManagerTest, obtain_batchTimeoutTest) {
+  SchedulingSystemConfig timeout_conf = conf;
+  timeout_conf.batch_timeout_us = 1000;
+  auto timeout_sm = 
+    std::make_shared<SchedulerManager>(timeout_conf, db_conf, etm.get());
+  for (unsigned int i = 0; i < 5; i++) {
+    timeout_sm->add_action(
+        std::unique_ptr<TestAction>(
+          TestAction::make_test_action_with_test_txn({}, {}, i)));
+  }
+
+  auto batch = timeout_sm->request_input(timeout_sm->schedulers[0].get());
+  assertBatchIsCorrect(std::move(batch.batch), 5, 0, __LINE__);
+};
+
+// batches are logged with their ids before they are handed out.
+TEST_F(SchedulerManagerTest, obtain_batchCommandLogTest) {
+  char file_name[] = "/tmp/scheduler_manager_test_XXXXXX";
+  close(mkstemp(file_name));
+  SchedulingSystemConfig log_conf = conf;
+  log_conf.command_log_file = file_name;
+  auto log_sm = 
+    std::make_shared<SchedulerManager>(log_conf, db_conf, etm.get());
+  for (unsigned int i = 0; i < 5; i++) {
+    log_sm->add_action(
+        std::unique_ptr<TestAction>(
+          TestAction::make_test_action_with_test_txn({i}, {}, i)));
+  }
+  log_sm->flush_actions();
+
+  auto batch = log_sm->request_input(log_sm->schedulers[0].get());
+  auto logged = BatchCommandLog::read_batches(file_name);
+  unlink(file_name);
+  ASSERT_EQ(1, logged.size());
+  ASSERT_EQ(5, logged[0].size());
+  for (unsigned int i = 0; i < 5; i++) {
+    ASSERT_EQ(*batch.batch[i]->get_writeset_handle(),
+        *logged[0][i]->get_writeset_handle());
+  }
+};
+
 typedef std::function<void (int)> concurrentFun;
 void runConcurrentTest(
     concurrentFun fun,
@@ -5,6 +5,7 @@
 #include "test/test_scheduler_thread_manager.h"
 #include "test/test_action.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -49,12 +50,12 @@ typedef std::vector<ExpectedRecordQueue> ExpectedLockTable;
 void assert_correct_schedule(
     std::shared_ptr<Scheduler> s,
     ExpectedLockTable e) {
-  auto collect_ids_from_lock_stage = [](std::shared_ptr<LockStage> ls){
+  auto collect_ids_from_lock_stage = [](LockStage* ls){
     const LockStage::RequestingActions& r = ls->get_requesters();
     std::unordered_set<uint64_t> ids;
 
     for (const auto& e : r) {
-      TestAction* ta = static_cast<TestAction*>(e.get());
+      TestAction* ta = static_cast<TestAction*>(e);
       ids.insert(ta->get_id());
     }
 
@@ -66,26 +67,28 @@ void assert_correct_schedule(
 
   for (auto rec_pair : e) {
     // batch lock queue, must exist.
-    auto blt_elt = blt.find(rec_pair.first);
+    auto blt_elt = std::find_if(blt.begin(), blt.end(), 
+        [&rec_pair](const BatchLockTable::KeyedQueue& q) {
+          return q.first == rec_pair.first;
+        });
     ASSERT_TRUE(blt_elt != blt.end());
     auto blq = blt_elt->second; 
 
     // head of the queue musn't be null.
-    auto curr_blq_elt = blq.peek_head_elt();
+    auto curr_lock_stage_ptr = blq.peek_head();
 
     // transaction in each stage must correspond to what we expect.
     for (auto stage_ids : rec_pair.second) {
-      ASSERT_TRUE(curr_blq_elt != nullptr);
-      auto curr_lock_stage_ptr = curr_blq_elt->get_contents();
-      auto ids_in_lock_stage = collect_ids_from_lock_stage(*curr_lock_stage_ptr); 
+      ASSERT_TRUE(curr_lock_stage_ptr != nullptr);
+      auto ids_in_lock_stage = collect_ids_from_lock_stage(curr_lock_stage_ptr); 
       ASSERT_EQ(stage_ids.size(), ids_in_lock_stage.size());
       ASSERT_EQ(stage_ids, ids_in_lock_stage); 
 
-      curr_blq_elt = curr_blq_elt->get_next_elt();
+      curr_lock_stage_ptr = curr_lock_stage_ptr->get_next_stage();
     }
 
     // there are no superfluous elements in the blq.
-    ASSERT_TRUE(curr_blq_elt == nullptr);
+    ASSERT_TRUE(curr_lock_stage_ptr == nullptr);
   }
 };
 
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <concurrent_queue.h>
+#include <wait_strategy.h>
+#include <batch/SPSC_ring.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Every scenario is run with each of the wait strategies.
+class WaitStrategyTest : public testing::TestWithParam<uint32_t> {
+protected:
+  static const unsigned int QUEUE_SIZE = 4;
+  WaitStrategyConfig default_conf;
+  std::vector<char> data;
+
+  virtual void SetUp() {
+    default_conf = WaitStrategy::get_config();
+    WaitStrategy::configure({GetParam(), 16, 4, 1000});
+    data.resize(CACHE_LINE * QUEUE_SIZE);
+  }
+
+  virtual void TearDown() {
+    WaitStrategy::configure(default_conf);
+  }
+};
+
+TEST_P(WaitStrategyTest, dequeueBlockingTest) {
+  SimpleQueue<uint64_t> q(data.data(), QUEUE_SIZE);
+  std::thread producer([&q]() {
+    for (uint64_t i = 0; i < 100; i++) {
+      // give the consumer time to park.
+      if (i % 10 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      q.EnqueueBlocking(i);
+    }
+  });
+
+  for (uint64_t i = 0; i < 100; i++) {
+    ASSERT_EQ(i, q.DequeueBlocking());
+  }
+
+  producer.join();
+  uint64_t parked = q.m_parked;
+  ASSERT_EQ(0, parked);
+}
+
+TEST_P(WaitStrategyTest, enqueueBlockingTest) {
+  SimpleQueue<uint64_t> q(data.data(), QUEUE_SIZE);
+  std::thread producer([&q]() {
+    // the queue fills up quickly, so the producer waits for space.
+    for (uint64_t i = 0; i < 100; i++) {
+      q.EnqueueBlocking(i);
+    }
+  });
+
+  for (uint64_t i = 0; i < 100; i++) {
+    if (i % 10 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    ASSERT_EQ(i, q.DequeueBlocking());
+  }
+
+  producer.join();
+}
+
+TEST_P(WaitStrategyTest, ringWaitForPushTest) {
+  SPSCRing<uint64_t> r(QUEUE_SIZE, false);
+  std::thread producer([&r]() {
+    for (uint64_t i = 0; i < 100; i++) {
+      if (i % 10 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      r.push_tail(i);
+    }
+  });
+
+  for (uint64_t i = 0; i < 100; i++) {
+    Waiter w;
+    while (r.is_empty()) {
+      r.wait_for_push(w);
+    }
+
+    ASSERT_EQ(i, r.peek_head());
+    r.pop_head();
+  }
+
+  producer.join();
+}
+
+// A parked thread notices conditions nobody wakes it up for.
+TEST_P(WaitStrategyTest, waitReturnsTest) {
+  volatile uint64_t word = 0;
+  volatile uint64_t parked = 0;
+  Waiter w;
+  for (unsigned int i = 0; i < 100; i++) {
+    w.wait(&word, 0, &parked);
+  }
+
+  ASSERT_EQ(0, parked);
+}
+
+// Timeouts of a second or more are valid, so the thread really sleeps until
+// it is woken up.
+TEST(WaitStrategyParkTest, longTimeoutTest) {
+  WaitStrategyConfig default_conf = WaitStrategy::get_config();
+  WaitStrategy::configure({WAIT_PARK, 16, 0, 2000000});
+  volatile uint64_t word = 0;
+  volatile uint64_t parked = 0;
+  std::thread waker([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    word = 1;
+    wake_parked(&word, &parked);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  Waiter w;
+  w.wait(&word, 0, &parked);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  waker.join();
+  WaitStrategy::configure(default_conf);
+  ASSERT_LE(std::chrono::milliseconds(40), elapsed);
+  ASSERT_GT(std::chrono::milliseconds(1000), elapsed);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Strategies,
+    WaitStrategyTest,
+    testing::Values(WAIT_SPIN, WAIT_BACKOFF, WAIT_PARK));
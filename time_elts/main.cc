@@ -1,9 +1,17 @@
 #include "batch/print_util.h" 
 #include "time_SPSC_queue.h"
+#include "time_SPSC_ring.h"
 #include "time_lock_table.h"
+#include "time_mv_table.h"
+#include "time_packing.h"
+#include "time_wait_strategy.h"
 
 int main() {//int argc, char** argv) {
   TimeSpscQueue::time_queue();
+  TimeSpscRing::time_ring();
   TimeLockTable::time_lock_table();
+  TimeMVTable::time_mv_table();
+  TimePacking::time_packing();
+  TimeWaitStrategy::time_wait_strategy();
   return 0;
 }
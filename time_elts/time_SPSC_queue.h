@@ -1,7 +1,7 @@
 #ifndef TIME_SPSC_QUEUE_H_
 #define TIME_SPSC_QUEUE_H_
 
-#include "batch/time_utilities.h"
+#include "batch/time_util.h"
 
 #include <memory>
 
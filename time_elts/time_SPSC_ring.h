@@ -0,0 +1,124 @@
+#ifndef TIME_SPSC_RING_H_
+#define TIME_SPSC_RING_H_
+
+#include "batch/time_util.h"
+#include "batch/MS_queue.h"
+#include "batch/SPSC_ring.h"
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TimeSpscRing {
+  typedef std::unique_ptr<unsigned int> Elt;
+
+  // Push all of the elements and pop them afterwards within one thread.
+  template <typename Queue>
+  double time_push_and_pop(unsigned int reps) {
+    Queue q;
+    auto time_it = [&reps, &q]() {
+      for (unsigned int i = 0; i < reps; i++) {
+        q.push_tail(Elt(nullptr));
+      }
+
+      for (unsigned int i = 0; i < reps; i++) {
+        Elt trash = std::move(q.peek_head());
+        q.pop_head();
+      }
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  // Hand the elements from a producer thread to the consumer thread,
+  // which is how the batch system uses its queues.
+  template <typename Queue>
+  double time_transfer(unsigned int reps) {
+    Queue q;
+    auto time_it = [&reps, &q]() {
+      std::thread producer([&reps, &q]() {
+        for (unsigned int i = 0; i < reps; i++) {
+          q.push_tail(Elt(nullptr));
+        }
+      });
+
+      for (unsigned int i = 0; i < reps; i++) {
+        while (q.is_empty()) {}
+        Elt trash = std::move(q.peek_head());
+        q.pop_head();
+      }
+
+      producer.join();
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  double time_batched_transfer(unsigned int reps) {
+    const unsigned int batch_size = 32;
+    SPSCRing<Elt> q;
+    auto time_it = [&reps, &q, &batch_size]() {
+      std::thread producer([&reps, &q, &batch_size]() {
+        std::vector<Elt> batch(batch_size);
+        for (unsigned int i = 0; i < reps; i += batch_size) {
+          q.push_tail_batch(batch.begin(), batch.end());
+        }
+      });
+
+      std::vector<Elt> out;
+      out.reserve(batch_size);
+      for (unsigned int i = 0; i < reps;) {
+        out.clear();
+        i += q.pop_head_batch(std::back_inserter(out), batch_size);
+      }
+
+      producer.join();
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  void time_ring() {
+    TablePrinter tp;
+    tp.set_table_header("SPSC ring timing [ms]");
+    tp.add_column_headers({
+       "Tested functions",
+       "10 000 reps",
+       "1 000 000 reps",
+       "10 000 000 reps"
+    });
+
+    auto exec_and_add_to_table = [&tp](
+        std::string row_name,
+        std::function<double (unsigned int)> fun) {
+      tp.add_row();
+      tp.add_to_last_row(row_name);
+
+      for (auto& reps : {10000, 1000000, 10000000}) {
+        double result = fun(reps);
+        tp.add_to_last_row(
+            PrintUtilities::double_to_string(result) +
+              "(" + PrintUtilities::double_to_string(result / reps) + ")"
+        );
+      }
+    };
+
+    exec_and_add_to_table(
+        "MS queue push and pop", time_push_and_pop<MSQueue<Elt>>);
+    exec_and_add_to_table(
+        "ring push and pop", time_push_and_pop<SPSCRing<Elt>>);
+    exec_and_add_to_table(
+        "MS queue transfer", time_transfer<MSQueue<Elt>>);
+    exec_and_add_to_table(
+        "ring transfer", time_transfer<SPSCRing<Elt>>);
+    exec_and_add_to_table(
+        "ring batched transfer", time_batched_transfer);
+
+    tp.print_table();
+  };
+};
+
+#endif // TIME_SPSC_RING_H_
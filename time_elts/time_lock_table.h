@@ -8,7 +8,7 @@
 #include "batch/RMW_batch_action.h"
 #include "batch/batch_action_interface.h"
 #include "batch/SPSC_MR_queue.h"
-#include "batch/time_utilities.h"
+#include "batch/time_util.h"
 
 #include <vector>
 #include <memory>
@@ -49,7 +49,10 @@ namespace TimeLockTable {
     return ActionFactory<RMWBatchAction>::generate_actions(as, txns_num); 
   };
 
+  // Use scheduler class to create the necessary blts. The lock stages are
+  // allocated from st's arena, so st must outlive the blts.
   std::vector<BatchLockTable> prepare_blts(
+      Scheduler& st,
       std::vector<std::unique_ptr<IBatchAction>>&& actions,
       unsigned int txns_in_batch,
       unsigned int batches) {
@@ -58,8 +61,6 @@ namespace TimeLockTable {
     std::vector<BatchLockTable> blts;
     blts.reserve(batches);
     
-    // Use scheduler class to create the necessary blts.
-    Scheduler st(nullptr, 0, 0);
     for (unsigned int i = 0; i < batches; i++) {
       std::vector<std::unique_ptr<IBatchAction>> batch;
       for (unsigned int j = 0; j < txns_in_batch; j++) {
@@ -78,8 +79,9 @@ namespace TimeLockTable {
   double time_merge(
       const unsigned int txns_in_batch, 
       const unsigned int batches) {
+    Scheduler st(nullptr, 0, 0);
     auto actions = prepare_actions(txns_in_batch * batches);
-    auto blts = prepare_blts(std::move(actions), txns_in_batch, batches); 
+    auto blts = prepare_blts(st, std::move(actions), txns_in_batch, batches); 
 
     // Get the lock table into which we will be merging.
     LockTable lt(get_db_config());
@@ -97,8 +99,9 @@ namespace TimeLockTable {
       const unsigned int txns_in_batch, 
       const unsigned int batches,
       const unsigned int merging_threads = 2) {
+    Scheduler st(nullptr, 0, 0);
     auto actions = prepare_actions(txns_in_batch * batches);
-    auto blts = prepare_blts(std::move(actions), txns_in_batch, batches);
+    auto blts = prepare_blts(st, std::move(actions), txns_in_batch, batches);
 
     LockTable lt(get_db_config());
     std::thread threads[merging_threads];
@@ -0,0 +1,155 @@
+#ifndef TIME_MV_TABLE_H_
+#define TIME_MV_TABLE_H_
+
+#include "batch/time_util.h"
+#include "mv_table.h"
+
+#include <vector>
+#include <random>
+#include <string>
+
+namespace TimeMVTable {
+  // Populate a single scheduler partition with one version per record, the
+  // way the loader batch does before an experiment starts.
+  MVTablePartition* get_prepped_partition(
+      MVIndexType type,
+      unsigned int records,
+      unsigned int extra_versions) {
+    MVRecordAllocator* alloc = new (0) MVRecordAllocator(
+        sizeof(MVRecord) * (records + extra_versions), 0, 0, 0);
+    MVTablePartition* part = MVTablePartition::Create(type, records, 0, alloc);
+    for (unsigned int i = 0; i < records; i++) {
+      CompositeKey key(false, 0, i);
+      part->WriteNewVersion(key, nullptr, CREATE_MV_TIMESTAMP(1, i));
+    }
+
+    return part;
+  };
+
+  std::vector<CompositeKey> get_random_keys(
+      unsigned int records,
+      unsigned int lookups) {
+    std::mt19937_64 gen(records);
+    std::uniform_int_distribution<uint64_t> dist(0, records - 1);
+    std::vector<CompositeKey> keys;
+    keys.reserve(lookups);
+    for (unsigned int i = 0; i < lookups; i++) {
+      keys.push_back(CompositeKey(false, 0, dist(gen)));
+    }
+
+    return keys;
+  };
+
+  double time_lookup(MVIndexType type, unsigned int records) {
+    auto part = get_prepped_partition(type, records, 0);
+    auto keys = get_random_keys(records, records);
+    uint64_t version = CREATE_MV_TIMESTAMP(2, 0);
+
+    auto time_it = [&part, &keys, &version]() {
+      for (auto& key : keys) {
+        MVRecord* rec = part->GetMVRecord(key, version);
+        assert(rec != nullptr && rec->key == key.key);
+        (void) rec;
+      }
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  // Lookups pipelined the same way MVScheduler::ScheduleBatch pipelines
+  // them: index entries are prefetched window keys ahead, and version chain
+  // heads window/2 keys ahead.
+  double time_prefetched_lookup(
+      MVIndexType type,
+      unsigned int records,
+      unsigned int window = 16) {
+    auto part = get_prepped_partition(type, records, 0);
+    auto keys = get_random_keys(records, records);
+    uint64_t version = CREATE_MV_TIMESTAMP(2, 0);
+
+    auto time_it = [&part, &keys, &version, &window]() {
+      for (unsigned int i = 0; i < keys.size(); i++) {
+        if (i + window < keys.size()) {
+          part->PrefetchSlot(keys[i + window]);
+        }
+
+        if (i + window / 2 < keys.size()) {
+          part->PrefetchHead(keys[i + window / 2]);
+        }
+
+        MVRecord* rec = part->GetMVRecord(keys[i], version);
+        assert(rec != nullptr && rec->key == keys[i].key);
+        (void) rec;
+      }
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  double time_write(MVIndexType type, unsigned int records) {
+    auto part = get_prepped_partition(type, records, records);
+    auto keys = get_random_keys(records, records);
+
+    auto time_it = [&part, &keys]() {
+      for (unsigned int i = 0; i < keys.size(); i++) {
+        part->WriteNewVersion(keys[i], nullptr, CREATE_MV_TIMESTAMP(2, i));
+      }
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  void time_mv_table() {
+    TablePrinter tp;
+    tp.set_table_header("MV table partition timing [ms]");
+    tp.add_column_headers({
+        "Index / operation",
+        "100 000 records",
+        "1 000 000 records",
+        "2 000 000 records"
+    });
+
+    auto exec_and_add_to_table = [&tp](
+        std::string row_name,
+        std::function<double (unsigned int)> fun) {
+      tp.add_row();
+      tp.add_to_last_row(row_name);
+
+      for (auto& records : {100000, 1000000, 2000000}) {
+        double result = fun(records);
+        tp.add_to_last_row(
+            PrintUtilities::double_to_string(result) +
+              "(" + PrintUtilities::double_to_string(result / records) + ")"
+        );
+      }
+    };
+
+    std::vector<std::pair<std::string, MVIndexType>> indexes = {
+      {"chained", MV_CHAINED_INDEX},
+      {"bucketed", MV_BUCKETED_INDEX}
+    };
+
+    for (auto& index : indexes) {
+      auto type = index.second;
+      exec_and_add_to_table(
+          index.first + " lookup",
+          [type](unsigned int records) {
+            return time_lookup(type, records);
+          });
+      exec_and_add_to_table(
+          index.first + " prefetched lookup",
+          [type](unsigned int records) {
+            return time_prefetched_lookup(type, records);
+          });
+      exec_and_add_to_table(
+          index.first + " write",
+          [type](unsigned int records) {
+            return time_write(type, records);
+          });
+    }
+
+    tp.print_table();
+  };
+};
+
+#endif // TIME_MV_TABLE_H_
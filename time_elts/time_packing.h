@@ -0,0 +1,127 @@
+#ifndef TIME_PACKING_H_
+#define TIME_PACKING_H_
+
+#include "batch/arr_container.h"
+#include "batch/packing.h"
+#include "batch/parallel_packing.h"
+#include "batch/txn_factory.h"
+#include "batch/RMW_batch_action.h"
+#include "batch/time_util.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TimePacking {
+  Container::BatchActions prepare_actions(
+      unsigned int txns_num,
+      unsigned int records) {
+    LockDistributionConfig ldc = {
+      .low_record = 0,
+      .high_record = records - 1,
+      .average_num_locks = 10,
+      .std_dev_of_num_locks = 0
+    };
+
+    ActionSpecification as = {
+      .writes = ldc,
+      .reads = ldc
+    };
+
+    return ActionFactory<RMWBatchAction>::generate_actions(as, txns_num);
+  };
+
+  // Time draining a whole batch into packings, the way 
+  // Scheduler::process_batch does.
+  double time_packing(
+      bool bitmap,
+      unsigned int txns_num,
+      unsigned int records) {
+    ArrayContainer ac(prepare_actions(txns_num, records));
+    auto time_it = [&ac, bitmap]() {
+      std::unique_ptr<BitmapPacker> packer;
+      if (bitmap) {
+        packer = std::make_unique<BitmapPacker>(&ac);
+      }
+
+      while (ac.get_remaining_count() != 0) {
+        auto packing = bitmap ?
+          packer->get_packing(&ac) :
+          Packer::get_packing(&ac);
+        ac.sort_remaining();
+      }
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  // Time a team of threads draining a whole batch. Helpers are pinned
+  // to cpus 1, 2, ...
+  double time_parallel_packing(
+      unsigned int team_size,
+      unsigned int txns_num,
+      unsigned int records) {
+    std::vector<int> helper_cpus;
+    for (unsigned int i = 1; i < team_size; i++) {
+      helper_cpus.push_back(i);
+    }
+
+    ParallelPacker packer(helper_cpus);
+    ArrayContainer ac(prepare_actions(txns_num, records));
+    auto time_it = [&ac, &packer]() {
+      auto packings = packer.get_packings(&ac);
+    };
+
+    return TimeUtilities::time_function_ms(time_it);
+  };
+
+  void time_packing() {
+    TablePrinter tp;
+    tp.set_table_header("Packing Timing [ms]");
+    tp.add_column_headers({
+        "Packer / records",
+        "10 000 txns",
+        "50 000 txns",
+        "100 000 txns"
+    });
+
+    auto exec_and_add_to_table = [&tp](
+        std::string row_name,
+        std::function<double (unsigned int)> fun) {
+      tp.add_row();
+      tp.add_to_last_row(row_name);
+
+      for (auto& txns : {10000, 50000, 100000}) {
+        double result = fun(txns);
+        tp.add_to_last_row(
+            PrintUtilities::double_to_string(result) +
+              "(" + PrintUtilities::double_to_string(result / txns) + ")"
+        );
+      }
+    };
+
+    for (auto& records : {1000000, 10000000}) {
+      std::string recs = ", " + std::to_string(records) + " records";
+      for (auto& bitmap : {false, true}) {
+        exec_and_add_to_table(
+            std::string(bitmap ? "bitmap" : "hash set") + recs,
+            [bitmap, records](unsigned int txns) {
+              return time_packing(bitmap, txns, records);
+            });
+      }
+
+      for (auto& team_size : {1, 2, 4}) {
+        exec_and_add_to_table(
+            std::to_string(team_size) + " thr. parallel" + recs,
+            [team_size, records](unsigned int txns) {
+              return time_parallel_packing(team_size, txns, records);
+            });
+      }
+    }
+
+    tp.print_table();
+  };
+};
+
+#endif // TIME_PACKING_H_
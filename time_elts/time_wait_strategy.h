@@ -0,0 +1,112 @@
+#ifndef TIME_WAIT_STRATEGY_H_
+#define TIME_WAIT_STRATEGY_H_
+
+#include "batch/time_util.h"
+#include "batch/SPSC_ring.h"
+#include "wait_strategy.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <time.h>
+
+namespace TimeWaitStrategy {
+  struct Result {
+    double wall_ms;
+    double consumer_cpu_ms;
+    double avg_latency_us;
+  };
+
+  double thread_cpu_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+  };
+
+  uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  };
+
+  // Bursty load: the producer pushes bursts of timestamps separated by idle
+  // gaps. The consumer waits for each element with the given strategy and
+  // measures how long it took to notice it.
+  Result time_bursts(
+      uint32_t strategy,
+      unsigned int bursts,
+      unsigned int burst_size,
+      unsigned int gap_us) {
+    WaitStrategyConfig default_conf = WaitStrategy::get_config();
+    WaitStrategyConfig conf = default_conf;
+    conf.strategy = strategy;
+    WaitStrategy::configure(conf);
+
+    SPSCRing<uint64_t> q;
+    double consumer_cpu = 0;
+    uint64_t total_latency = 0;
+    unsigned int total = bursts * burst_size;
+    auto time_it = [&]() {
+      std::thread producer([&]() {
+        for (unsigned int b = 0; b < bursts; b++) {
+          std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+          for (unsigned int i = 0; i < burst_size; i++) {
+            q.push_tail(now_ns());
+          }
+        }
+      });
+
+      double start_cpu = thread_cpu_ms();
+      for (unsigned int i = 0; i < total; i++) {
+        Waiter w;
+        while (q.is_empty()) {
+          q.wait_for_push(w);
+        }
+
+        total_latency += now_ns() - q.peek_head();
+        q.pop_head();
+      }
+      consumer_cpu = thread_cpu_ms() - start_cpu;
+
+      producer.join();
+    };
+
+    Result r;
+    r.wall_ms = TimeUtilities::time_function_ms(time_it);
+    r.consumer_cpu_ms = consumer_cpu;
+    r.avg_latency_us = total_latency / 1000.0 / total;
+    WaitStrategy::configure(default_conf);
+    return r;
+  };
+
+  void time_wait_strategy() {
+    const unsigned int bursts = 200;
+    const unsigned int burst_size = 100;
+    const unsigned int gap_us = 1000;
+
+    TablePrinter tp;
+    tp.set_table_header(
+        "Wait strategies, " + std::to_string(bursts) + " bursts of " +
+        std::to_string(burst_size) + " every " + std::to_string(gap_us) +
+        "us");
+    tp.add_column_headers({
+       "Strategy",
+       "Wall time [ms]",
+       "Consumer cpu [ms]",
+       "Avg latency [us]"
+    });
+
+    for (auto& strategy : {WAIT_SPIN, WAIT_BACKOFF, WAIT_PARK}) {
+      Result r = time_bursts(strategy, bursts, burst_size, gap_us);
+      tp.add_row();
+      tp.add_to_last_row(WaitStrategy::get_name(strategy));
+      tp.add_to_last_row(PrintUtilities::double_to_string(r.wall_ms));
+      tp.add_to_last_row(PrintUtilities::double_to_string(r.consumer_cpu_ms));
+      tp.add_to_last_row(PrintUtilities::double_to_string(r.avg_latency_us));
+    }
+
+    tp.print_table();
+  };
+};
+
+#endif // TIME_WAIT_STRATEGY_H_